@@ -250,6 +250,38 @@ function do_benchmark_with_own_binaries() {
         //benchmarks:*
 }
 
+#######################################
+# Runs the google-benchmark suites that cover Nighthawk's own hot paths, and
+# writes their results as JSON, so that regressions of the tool itself can be
+# tracked across changes.
+# Arguments:
+#   None. Results are written to SELF_BENCHMARK_OUTPUT_DIR, which defaults to
+#   ${SRCDIR}/generated/self_benchmark.
+# Returns:
+#   0 on success, exits with return code 1 on failure.
+#######################################
+function do_self_benchmark() {
+    echo "Running self benchmarks"
+    cd "${SRCDIR}"
+    local output_dir="${SELF_BENCHMARK_OUTPUT_DIR:-${SRCDIR}/generated/self_benchmark}"
+    mkdir -p "${output_dir}"
+    run_bazel build ${BAZEL_BUILD_OPTIONS} -c opt //test/benchmark/...
+    for BENCHMARK_NAME in \
+        "rate_limiter_speed_test" \
+        "request_source_speed_test" \
+        "sequencer_speed_test" \
+        "statistic_speed_test" \
+        "stream_decoder_speed_test"; do
+        echo "do_self_benchmark: running ${BENCHMARK_NAME}"
+        "bazel-bin/test/benchmark/${BENCHMARK_NAME}" \
+            --benchmark_repetitions=5 \
+            --benchmark_report_aggregates_only=true \
+            --benchmark_out_format=json \
+            --benchmark_out="${output_dir}/${BENCHMARK_NAME}.json"
+    done
+    echo "do_self_benchmark: results written to ${output_dir}"
+}
+
 function do_check_format() {
     echo "check_format..."
     cd "${SRCDIR}"
@@ -402,6 +434,11 @@ case "$1" in
         do_benchmark_with_own_binaries
         exit 0
     ;;
+    self_benchmark)
+        setup_clang_toolchain
+        do_self_benchmark
+        exit 0
+    ;;
     opt_build)
         setup_clang_toolchain
         do_opt_build
@@ -413,7 +450,7 @@ case "$1" in
         exit 0
     ;;
     *)
-        echo "must be one of [opt_build,build,test,clang_tidy,coverage,coverage_integration,asan,tsan,benchmark_with_own_binaries,docker,check_format,fix_format,fix_requirements,fix_docs,test_gcc]"
+        echo "must be one of [opt_build,build,test,clang_tidy,coverage,coverage_integration,asan,tsan,benchmark_with_own_binaries,self_benchmark,docker,check_format,fix_format,fix_requirements,fix_docs,test_gcc]"
         exit 1
     ;;
 esac
@@ -24,12 +24,6 @@ public:
    */
   virtual StatisticPtrMap statistics() const PURE;
 
-  /**
-   * @return const std::map<std::string, uint64_t>& The worker-specific counter values.
-   * Gets filled when the worker has completed its task, empty before that.
-   */
-  virtual const std::map<std::string, uint64_t>& threadLocalCounterValues() PURE;
-
   /**
    * @return const Phase& associated to this worker.
    */
@@ -26,6 +26,9 @@ namespace Client {
 
 using CommandLineOptionsPtr = std::unique_ptr<nighthawk::client::CommandLineOptions>;
 using TerminationPredicateMap = std::map<std::string, uint64_t>;
+using HdrHistogramConfigMap = std::map<std::string, nighthawk::client::HdrHistogramConfig>;
+using StatisticBackendMap =
+    std::map<std::string, nighthawk::client::StatisticBackend::StatisticBackendOptions>;
 /**
  * Abstract options interface.
  */
@@ -84,6 +87,17 @@ public:
   requestSourcePluginConfig() const PURE;
   virtual const std::optional<envoy::config::core::v3::TypedExtensionConfig>&
   rateLimiterPluginConfig() const PURE;
+  virtual uint32_t sharedRequestSourceCapacity() const PURE;
+  virtual uint32_t progressReportInterval() const PURE;
+  virtual nighthawk::client::HistogramEncoding::HistogramEncodingOptions
+  histogramEncoding() const PURE;
+  virtual std::vector<uint32_t> workerCpus() const PURE;
+  virtual std::optional<uint32_t> flushWorkerCpu() const PURE;
+  virtual bool numaLocalAllocation() const PURE;
+  virtual std::string requestEventLog() const PURE;
+  virtual uint32_t timeSliceInterval() const PURE;
+  virtual HdrHistogramConfigMap hdrHistogramConfigs() const PURE;
+  virtual StatisticBackendMap statisticBackends() const PURE;
   virtual std::string trace() const PURE;
   virtual nighthawk::client::H1ConnectionReuseStrategy::H1ConnectionReuseStrategyOptions
   h1ConnectionReuseStrategy() const PURE;
@@ -96,6 +110,9 @@ public:
   virtual std::vector<nighthawk::client::MultiTarget::Endpoint> multiTargetEndpoints() const PURE;
   virtual std::string multiTargetPath() const PURE;
   virtual bool multiTargetUseHttps() const PURE;
+  virtual nighthawk::client::MultiTargetLbPolicy::MultiTargetLbPolicyOptions
+  multiTargetLbPolicy() const PURE;
+  virtual std::string multiTargetHashHeader() const PURE;
   virtual std::vector<std::string> labels() const PURE;
   virtual bool simpleWarmup() const PURE;
   virtual bool noDuration() const PURE;
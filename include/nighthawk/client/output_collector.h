@@ -35,6 +35,29 @@ public:
       const std::chrono::nanoseconds execution_duration,
       const std::optional<Envoy::SystemTime>& first_acquisition_time,
       const std::vector<nighthawk::client::UserDefinedOutput>& user_defined_output_results) PURE;
+
+  /**
+   * Adds a time slice to a result. The result may be added before or after its time slices.
+   *
+   * @param result_name name of the result the slice belongs to. E.g. global.
+   * @param start start of the slice.
+   * @param duration length of the slice.
+   * @param statistics Reference to a vector of statistics holding the values recorded during the
+   * slice.
+   * @param counters Reference to a map of counter increments during the slice, keyed by name.
+   */
+  virtual void addTimeSlice(absl::string_view result_name, const Envoy::SystemTime& start,
+                            const std::chrono::nanoseconds duration,
+                            const std::vector<StatisticPtr>& statistics,
+                            const std::map<std::string, uint64_t>& counters) PURE;
+
+  /**
+   * Records where a worker thread was placed on the machine.
+   *
+   * @param placement the placement to add to the output.
+   */
+  virtual void addWorkerPlacement(const nighthawk::client::WorkerPlacement& placement) PURE;
+
   /**
    * Directly sets the output value.
    *
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,18 @@ public:
    */
   virtual absl::StatusOr<std::string>
   formatProto(const nighthawk::client::Output& output) const PURE;
+
+  /**
+   * Writes the serialized representation of output to a stream as it is produced, so that it
+   * doesn't have to be held in memory in full. Errors are detected before anything is written, so
+   * that no truncated output is left behind.
+   *
+   * @param output The output to serialize.
+   * @param stream The stream to write to. Untouched when an error is returned.
+   * @return absl::Status An error if the output could not be formatted.
+   */
+  virtual absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                           std::ostream& stream) const PURE;
 };
 
 using OutputFormatterPtr = std::unique_ptr<OutputFormatter>;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "nighthawk/client/output_collector.h"
 
 namespace Nighthawk {
@@ -11,6 +13,11 @@ namespace Client {
  */
 class Process {
 public:
+  /**
+   * Receives a progress report while the process is running.
+   */
+  using ProgressCallback = std::function<void(const nighthawk::client::Output& progress)>;
+
   virtual ~Process() = default;
 
   /**
@@ -28,6 +35,15 @@ public:
    * Will request all workers to cancel execution asap.
    */
   virtual bool requestExecutionCancellation() PURE;
+
+  /**
+   * Sets a callback that receives a progress report every Options::progressReportInterval()
+   * seconds while run() is executing. Each report holds the counter increments and latency
+   * statistics of the interval since the previous report. Must be called before run(). The
+   * callback is invoked on the thread that called run().
+   * @param callback the callback that receives the progress reports.
+   */
+  virtual void setProgressCallback(ProgressCallback callback) PURE;
 };
 
 using ProcessPtr = std::unique_ptr<Process>;
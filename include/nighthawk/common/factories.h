@@ -24,13 +24,18 @@ public:
                               TerminationPredicatePtr&& termination_predicate,
                               Envoy::Stats::Scope& scope,
                               const Envoy::MonotonicTime scheduled_starting_time,
-                              Envoy::Api::Api& api) const PURE;
+                              Envoy::Api::Api& api, uint32_t worker_number) const PURE;
 };
 
 class StatisticFactory {
 public:
   virtual ~StatisticFactory() = default;
-  virtual StatisticPtr create() const PURE;
+  /**
+   * @param id The id of the statistic, which is set on the returned statistic and may be used to
+   * configure it.
+   * @return StatisticPtr The new statistic.
+   */
+  virtual StatisticPtr create(absl::string_view id) const PURE;
 };
 
 class RequestSourceFactory {
@@ -38,7 +43,8 @@ public:
   virtual ~RequestSourceFactory() = default;
   virtual RequestSourcePtr create(const Envoy::Upstream::ClusterManagerPtr& cluster_manager,
                                   Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
-                                  absl::string_view service_cluster_name) const PURE;
+                                  absl::string_view service_cluster_name,
+                                  uint32_t worker_number) const PURE;
 };
 
 class TerminationPredicateFactory {
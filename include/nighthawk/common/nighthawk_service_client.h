@@ -24,9 +24,10 @@ public:
    * StepController, without the duration set.
    *
    * @return StatusOr<ExecutionResponse> If we reached the Nighthawk Service, this is the raw
-   * ExecutionResponse proto, containing the benchmark data or possibly an error message from
+   * final ExecutionResponse proto, containing the benchmark data or possibly an error message from
    * Nighthawk Service; if we had trouble communicating with the Nighthawk Service, we return an
-   * error status.
+   * error status. Progress reports streamed before the final response are skipped, see
+   * NighthawkServiceClientImpl for a variant that consumes them.
    */
   virtual absl::StatusOr<nighthawk::client::ExecutionResponse> PerformNighthawkBenchmark(
       nighthawk::client::NighthawkService::StubInterface* nighthawk_service_stub,
@@ -22,6 +22,10 @@ public:
    * @param duration duration that the calling thread should sleep.
    */
   virtual void sleep(std::chrono::microseconds duration) const PURE;
+  /**
+   * @return std::chrono::nanoseconds CPU time consumed by the calling thread so far.
+   */
+  virtual std::chrono::nanoseconds currentThreadCpuTime() const PURE;
 };
 
 using PlatformUtilPtr = std::unique_ptr<PlatformUtil>;
@@ -23,6 +23,15 @@ public:
    */
   virtual bool tryAcquireOne() PURE;
 
+  /**
+   * Acquire up to a number of controlled resources at once. Behaves like calling tryAcquireOne()
+   * until it fails or max_count resources have been acquired, but allows implementations to do
+   * the work in bulk. Afterwards, scheduledReleaseTime() tells when each acquisition made was due.
+   * @param max_count The maximum number of resources to acquire.
+   * @return uint64_t The number of resources acquired, at most max_count.
+   */
+  virtual uint64_t tryAcquire(uint64_t max_count) PURE;
+
   /**
    * Releases a controlled resource.
    */
@@ -38,6 +47,25 @@ public:
    */
   virtual std::optional<Envoy::SystemTime> firstAcquisitionTime() const PURE;
 
+  /**
+   * @param index Position of the acquisition among those made by the most recent successful call
+   * to tryAcquireOne() or tryAcquire(), counting from 0. Must be less than the number of
+   * acquisitions that call made.
+   * @return std::optional<Envoy::MonotonicTime> The point in time at which the acquisition was
+   * intended to happen according to the pacing of the rate limiter, if it tracks that. Lags behind
+   * the time of the acquisition when the caller falls behind. Latencies measured from this point
+   * include the delay of falling behind, and so are not subject to coordinated omission.
+   */
+  virtual std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const PURE;
+
+  /**
+   * @return std::optional<Envoy::MonotonicTime> The earliest point in time at which
+   * tryAcquireOne() may next succeed, if the rate limiter can tell. Allows callers to wait for it
+   * instead of polling. May be earlier than the actual next release but never later, and lies in
+   * the past when an acquisition is due already.
+   */
+  virtual std::optional<Envoy::MonotonicTime> nextReleaseTime() const PURE;
+
   /**
    * @return std::chrono::nanoseconds elapsed since the first call to tryAcquireOne(). Used by some
    * rate limiter implementations to compute acquisition rate.
@@ -6,6 +6,7 @@
 
 #include "nighthawk/client/options.h"
 #include "nighthawk/common/rate_limiter.h"
+#include "nighthawk/common/worker_context.h"
 
 namespace Nighthawk {
 
@@ -37,6 +38,33 @@ public:
                                                  Envoy::Api::Api& api,
                                                  Envoy::TimeSource& time_source,
                                                  const Client::Options& options) PURE;
+
+  // Instantiates the RateLimiterPlugin for a specific worker. Plugins that pace requests based on
+  // a data set shared between workers override this to hand each worker its own partition of that
+  // data set. The default implementation ignores |worker_context| and calls
+  // createRateLimiterPlugin().
+  //
+  // @param typed_config Taken from TypedExtensionConfig.
+  //
+  // @param api Api parameter that contains timesystem, filesystem, and threadfactory.
+  //
+  // @param time_source TimeSource parameter used by many rate limiters to track time.
+  //
+  // @param options Client Options parameter used for command line error checking.
+  //
+  // @param worker_context Identifies the worker the rate limiter will be used by.
+  //
+  // @return RateLimiterPtr Pointer to the new instance of RateLimiter.
+  //
+  // @throw Envoy::EnvoyException If the Any proto cannot be unpacked as the type expected by the
+  // plugin.
+  virtual RateLimiterPtr createRateLimiterPluginForWorker(
+      const Envoy::Protobuf::Message& typed_config, Envoy::Api::Api& api,
+      Envoy::TimeSource& time_source, const Client::Options& options,
+      const WorkerContext& worker_context) {
+    (void)worker_context;
+    return createRateLimiterPlugin(typed_config, api, time_source, options);
+  }
 };
 
 } // namespace Nighthawk
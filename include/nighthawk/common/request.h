@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <string>
 
 #include "envoy/http/header_map.h"
 
@@ -8,6 +10,12 @@ namespace Nighthawk {
 
 using HeaderMapPtr = std::shared_ptr<const Envoy::Http::RequestHeaderMap>;
 
+/**
+ * Immutable, reference counted request body. Request sources can materialize a body once and hand
+ * out the same handle for each request, and the body can be sent without copying it.
+ */
+using RequestBodySharedPtr = std::shared_ptr<const std::string>;
+
 /**
  * Defines the specifics of requests to be send by the load generator, as well as
  * may hold request-level expectations.
@@ -20,7 +28,17 @@ public:
    * @return HeaderMapPtr shared pointer to a request header specification.
    */
   virtual HeaderMapPtr header() const PURE;
+
+  /**
+   * @return const std::string& the request body. Empty when no body is associated.
+   */
   virtual const std::string& body() const PURE;
+
+  /**
+   * @return RequestBodySharedPtr shared handle to the request body, or nullptr when no body is
+   * associated. Allows the body to be sent without copying it.
+   */
+  virtual RequestBodySharedPtr sharedBody() const PURE;
   // TODO(oschaaf): expectations
 };
 
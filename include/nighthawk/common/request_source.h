@@ -5,6 +5,7 @@
 #include "envoy/http/header_map.h"
 
 #include "nighthawk/common/request.h"
+#include "nighthawk/common/worker_context.h"
 
 namespace Nighthawk {
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "envoy/common/pure.h"
 
@@ -8,6 +11,16 @@
 
 namespace Nighthawk {
 
+/**
+ * Where a worker thread is placed on the machine.
+ */
+struct WorkerPlacement {
+  // The CPU the worker thread is pinned to.
+  uint32_t cpu{0};
+  // When set, memory allocated by the worker thread is preferably placed on this NUMA node.
+  std::optional<uint32_t> numa_node;
+};
+
 /**
  * Interface for a threaded worker.
  */
@@ -20,11 +33,25 @@ public:
    */
   virtual void start() PURE;
 
+  /**
+   * Places the worker thread on the machine once it starts. Must be called before start(). Failing
+   * to apply the placement is logged, but does not stop the worker.
+   * @param placement the placement to apply.
+   */
+  virtual void setPlacement(const WorkerPlacement& placement) PURE;
+
   /**
    * Wait for the worker thread to complete its work.
    */
   virtual void waitForCompletion() PURE;
 
+  /**
+   * Wait for the worker thread to complete its work, for at most the specified duration.
+   * @param timeout the maximum duration to wait for.
+   * @return bool true iff the worker completed its work within the timeout.
+   */
+  virtual bool waitForCompletionFor(std::chrono::milliseconds timeout) PURE;
+
   /**
    * Signals the worker thread to start shutting down, without waiting for it to finish. Idempotent,
    * and implied by shutdown(). Called from the main thread. Allows callers that own multiple
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nighthawk {
+
+/**
+ * Identifies the worker a per-worker component (e.g. a request source or a rate limiter) is
+ * created for. Components that are backed by a data set shared by all workers can use this to
+ * partition that data set across workers.
+ */
+struct WorkerContext {
+  // Zero-based number of the worker the component is created for.
+  uint32_t worker_number{0};
+  // Total number of workers, each of which creates its own instance of the component.
+  uint32_t worker_count{1};
+};
+
+} // namespace Nighthawk
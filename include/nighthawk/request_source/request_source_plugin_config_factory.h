@@ -34,6 +34,32 @@ public:
   virtual RequestSourcePtr createRequestSourcePlugin(const Envoy::Protobuf::Message& typed_config,
                                                      Envoy::Api::Api& api,
                                                      Envoy::Http::RequestHeaderMapPtr header) PURE;
+
+  // Instantiates the RequestSourcePlugin for a specific worker. Plugins backed by a data set that
+  // is shared between workers override this to hand each worker its own partition of that data
+  // set. The default implementation ignores |worker_context| and calls
+  // createRequestSourcePlugin().
+  //
+  // @param typed_config Any typed_config proto taken from the TypedExtensionConfig.
+  //
+  // @param api Api parameter that contains timesystem, filesystem, and threadfactory.
+  //
+  // @param header RequestHeaderMapPtr parameter that acts as a template header for the
+  // requestSource to modify when generating requests.
+  //
+  // @param worker_context Identifies the worker the request source will be used by.
+  //
+  // @return RequestSourcePtr Pointer to the new instance of RequestSource.
+  //
+  // @throw Envoy::EnvoyException If the Any proto cannot be unpacked as the type expected by the
+  // plugin.
+  virtual RequestSourcePtr
+  createRequestSourcePluginForWorker(const Envoy::Protobuf::Message& typed_config,
+                                     Envoy::Api::Api& api, Envoy::Http::RequestHeaderMapPtr header,
+                                     const WorkerContext& worker_context) {
+    (void)worker_context;
+    return createRequestSourcePlugin(typed_config, api, std::move(header));
+  }
 };
 
 } // namespace Nighthawk
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "envoy/common/pure.h"
@@ -41,6 +42,37 @@ public:
    */
   virtual absl::StatusOr<std::vector<nighthawk::client::ExecutionResponse>>
   LoadExecutionResult(absl::string_view execution_id) const PURE;
+
+  /**
+   * Visit the ExecutionResponse instances associated to an execution id one at a time. Allows
+   * folding them into an aggregate without holding all of them in memory at once, when the
+   * implementation supports that. The default implementation visits the result of
+   * LoadExecutionResult().
+   *
+   * @param execution_id Specify an execution_id that the desired set of ExecutionResponse
+   * instances are tagged with.
+   * @param visitor Called for each ExecutionResponse instance. Visiting stops at the first error
+   * it returns.
+   * @return absl::Status The first error returned by the visitor, or kNotFound when no fragments
+   * are found for the provided execution id.
+   */
+  virtual absl::Status VisitExecutionResult(
+      absl::string_view execution_id,
+      const std::function<absl::Status(const nighthawk::client::ExecutionResponse&)>& visitor)
+      const {
+    absl::StatusOr<std::vector<nighthawk::client::ExecutionResponse>> responses =
+        LoadExecutionResult(execution_id);
+    if (!responses.ok()) {
+      return responses.status();
+    }
+    for (const nighthawk::client::ExecutionResponse& response : *responses) {
+      absl::Status status = visitor(response);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    return absl::OkStatus();
+  }
 };
 
 } // namespace Nighthawk
@@ -1,5 +1,7 @@
 #include "source/client/benchmark_client_impl.h"
 
+#include <algorithm>
+
 #include "envoy/common/conn_pool.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/thread_local/thread_local.h"
@@ -7,6 +9,7 @@
 #include "nighthawk/common/statistic.h"
 #include "nighthawk/user_defined_output/user_defined_output_plugin.h"
 
+#include "external/envoy/source/common/common/hash.h"
 #include "external/envoy/source/common/http/header_map_impl.h"
 #include "external/envoy/source/common/http/headers.h"
 #include "external/envoy/source/common/http/utility.h"
@@ -14,6 +17,7 @@
 
 #include "source/client/stream_decoder.h"
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
 
@@ -33,7 +37,8 @@ BenchmarkClientStatistic::BenchmarkClientStatistic(BenchmarkClientStatistic&& st
       latency_4xx_statistic(std::move(statistic.latency_4xx_statistic)),
       latency_5xx_statistic(std::move(statistic.latency_5xx_statistic)),
       latency_xxx_statistic(std::move(statistic.latency_xxx_statistic)),
-      origin_latency_statistic(std::move(statistic.origin_latency_statistic)) {}
+      origin_latency_statistic(std::move(statistic.origin_latency_statistic)),
+      request_generation_statistic(std::move(statistic.request_generation_statistic)) {}
 
 BenchmarkClientStatistic::BenchmarkClientStatistic(
     StatisticPtr&& connect_stat, StatisticPtr&& response_stat,
@@ -41,7 +46,7 @@ BenchmarkClientStatistic::BenchmarkClientStatistic(
     StatisticPtr&& latency_1xx_stat, StatisticPtr&& latency_2xx_stat,
     StatisticPtr&& latency_3xx_stat, StatisticPtr&& latency_4xx_stat,
     StatisticPtr&& latency_5xx_stat, StatisticPtr&& latency_xxx_stat,
-    StatisticPtr&& origin_latency_stat)
+    StatisticPtr&& origin_latency_stat, StatisticPtr&& request_generation_stat)
     : connect_statistic(std::move(connect_stat)), response_statistic(std::move(response_stat)),
       response_header_size_statistic(std::move(response_header_size_stat)),
       response_body_size_statistic(std::move(response_body_size_stat)),
@@ -51,7 +56,8 @@ BenchmarkClientStatistic::BenchmarkClientStatistic(
       latency_4xx_statistic(std::move(latency_4xx_stat)),
       latency_5xx_statistic(std::move(latency_5xx_stat)),
       latency_xxx_statistic(std::move(latency_xxx_stat)),
-      origin_latency_statistic(std::move(origin_latency_stat)) {}
+      origin_latency_statistic(std::move(origin_latency_stat)),
+      request_generation_statistic(std::move(request_generation_stat)) {}
 
 Envoy::Http::ConnectionPool::Cancellable*
 Http1PoolImpl::newStream(Envoy::Http::ResponseDecoder& response_decoder,
@@ -96,7 +102,13 @@ BenchmarkClientHttpImpl::BenchmarkClientHttpImpl(
       request_generator_(std::move(request_generator)),
       provide_resource_backpressure_(provide_resource_backpressure),
       latency_response_header_name_(latency_response_header_name),
-      user_defined_output_plugins_(std::move(user_defined_output_plugins)) {
+      user_defined_output_plugins_(std::move(user_defined_output_plugins)),
+      stream_decoder_pool_(dispatcher_, api_.timeSource(), *this, *statistic_.connect_statistic,
+                           *statistic_.response_statistic,
+                           *statistic_.response_header_size_statistic,
+                           *statistic_.response_body_size_statistic,
+                           *statistic_.origin_latency_statistic, generator_, tracer_,
+                           latency_response_header_name_) {
   statistic_.connect_statistic->setId("benchmark_http_client.queue_to_connect");
   statistic_.response_statistic->setId("benchmark_http_client.request_to_response");
   statistic_.response_header_size_statistic->setId("benchmark_http_client.response_header_size");
@@ -108,6 +120,7 @@ BenchmarkClientHttpImpl::BenchmarkClientHttpImpl(
   statistic_.latency_5xx_statistic->setId("benchmark_http_client.latency_5xx");
   statistic_.latency_xxx_statistic->setId("benchmark_http_client.latency_xxx");
   statistic_.origin_latency_statistic->setId("benchmark_http_client.origin_latency_statistic");
+  statistic_.request_generation_statistic->setId("benchmark_http_client.request_generation");
 }
 
 void BenchmarkClientHttpImpl::terminate() {
@@ -161,13 +174,25 @@ StatisticPtrMap BenchmarkClientHttpImpl::statistics() const {
   statistics[statistic_.latency_5xx_statistic->id()] = statistic_.latency_5xx_statistic.get();
   statistics[statistic_.latency_xxx_statistic->id()] = statistic_.latency_xxx_statistic.get();
   statistics[statistic_.origin_latency_statistic->id()] = statistic_.origin_latency_statistic.get();
+  statistics[statistic_.request_generation_statistic->id()] =
+      statistic_.request_generation_statistic.get();
+  for (const auto& endpoint : endpoint_statistics_) {
+    statistics[endpoint.second->latency_statistic->id()] =
+        endpoint.second->latency_statistic.get();
+  }
   return statistics;
 };
 
 bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completion_callback) {
-  std::optional<Envoy::Upstream::HttpPoolData> pool_data = pool();
-  if (!pool_data.has_value()) {
-    return false;
+  // With a hash header, the endpoint depends on the request, so the pool is picked after the
+  // request has been generated.
+  std::optional<Envoy::Upstream::HttpPoolData> pool_data;
+  if (!hash_header_.has_value()) {
+    pool_data = pool();
+    if (!pool_data.has_value()) {
+      benchmark_client_counters_.pool_unavailable_.inc();
+      return false;
+    }
   }
   if (provide_resource_backpressure_) {
     uint64_t max_active_requests = 0;
@@ -184,13 +209,39 @@ bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completi
       return false;
     }
   }
-  auto request = request_generator_();
+  const bool measure_generation = shouldMeasureLatencies();
+  const Envoy::MonotonicTime generation_start =
+      measure_generation ? api_.timeSource().monotonicTime() : Envoy::MonotonicTime();
+  RequestPtr request = request_generator_();
+  if (measure_generation) {
+    statistic_.request_generation_statistic->addValue(
+        (api_.timeSource().monotonicTime() - generation_start).count());
+  }
   // The header generator may not have something for us to send. We'll try next time.
   // TODO(oschaaf): track occurrences of this via a counter & consider setting up a default failure
   // condition for when this happens.
   if (request == nullptr) {
     return false;
   }
+  if (hash_header_.has_value()) {
+    const Envoy::Http::HeaderMap::GetResult hash_values = request->header()->get(*hash_header_);
+    std::optional<uint64_t> hash_key;
+    if (!hash_values.empty()) {
+      hash_key = Envoy::HashUtil::xxHash64(hash_values[0]->value().getStringView());
+    }
+    HashKeyLoadBalancerContext context(hash_key);
+    pool_data = pool(&context);
+    if (!pool_data.has_value()) {
+      // Waiting for the endpoint the request hashed to could stall the worker indefinitely, so
+      // send the request wherever the load balancer would send a request without a hash.
+      pool_data = pool();
+    }
+    if (!pool_data.has_value()) {
+      // The request has already been drawn from the request source, and is dropped.
+      benchmark_client_counters_.pool_unavailable_.inc();
+      return false;
+    }
+  }
   auto* content_length_header = request->header()->ContentLength();
   uint64_t content_length = 0;
   if (content_length_header != nullptr) {
@@ -201,14 +252,11 @@ bool BenchmarkClientHttpImpl::tryStartRequest(CompletionCallback caller_completi
     }
   }
 
-  auto stream_decoder = new StreamDecoder(
-      dispatcher_, api_.timeSource(), *this, std::move(caller_completion_callback),
-      *statistic_.connect_statistic, *statistic_.response_statistic,
-      *statistic_.response_header_size_statistic, *statistic_.response_body_size_statistic,
-      *statistic_.origin_latency_statistic, request->header(), request->body(),
-      shouldMeasureLatencies(), content_length, generator_, tracer_, latency_response_header_name_);
+  StreamDecoder& stream_decoder = stream_decoder_pool_.acquire(
+      std::move(caller_completion_callback), request->header(), request->sharedBody(),
+      shouldMeasureLatencies(), content_length);
   requests_initiated_++;
-  pool_data.value().newStream(*stream_decoder, *stream_decoder,
+  pool_data.value().newStream(stream_decoder, stream_decoder,
                               {/*can_send_early_data_=*/false,
                                /*can_use_http3_=*/true});
   return true;
@@ -287,6 +335,53 @@ void BenchmarkClientHttpImpl::exportLatency(const uint32_t response_code,
   }
 }
 
+void BenchmarkClientHttpImpl::onEndpointComplete(const Envoy::Upstream::HostDescription& host,
+                                                 uint32_t response_code,
+                                                 std::optional<uint64_t> latency_ns) {
+  if (endpoint_statistic_factory_ == nullptr) {
+    return;
+  }
+  EndpointStatistics& endpoint = endpointStatistics(host);
+  if (response_code == 0) {
+    endpoint.counters.failures_.inc();
+  } else if (response_code > 99 && response_code <= 199) {
+    endpoint.counters.http_1xx_.inc();
+  } else if (response_code > 199 && response_code <= 299) {
+    endpoint.counters.http_2xx_.inc();
+  } else if (response_code > 299 && response_code <= 399) {
+    endpoint.counters.http_3xx_.inc();
+  } else if (response_code > 399 && response_code <= 499) {
+    endpoint.counters.http_4xx_.inc();
+  } else if (response_code > 499 && response_code <= 599) {
+    endpoint.counters.http_5xx_.inc();
+  } else {
+    endpoint.counters.http_xxx_.inc();
+  }
+  if (latency_ns.has_value()) {
+    endpoint.latency_statistic->addValue(latency_ns.value());
+  }
+}
+
+BenchmarkClientHttpImpl::EndpointStatistics&
+BenchmarkClientHttpImpl::endpointStatistics(const Envoy::Upstream::HostDescription& host) {
+  std::unique_ptr<EndpointStatistics>& endpoint = endpoint_statistics_[&host];
+  if (endpoint == nullptr) {
+    // Dots and colons would add levels to the stat name hierarchy, so the address is flattened.
+    std::string address = host.address()->asString();
+    std::replace_if(
+        address.begin(), address.end(), [](char c) { return !absl::ascii_isalnum(c); }, '_');
+    Envoy::Stats::ScopeSharedPtr scope = scope_->createScope(fmt::format("endpoint.{}.", address));
+    BenchmarkClientEndpointCounters counters{
+        ALL_BENCHMARK_CLIENT_ENDPOINT_COUNTERS(POOL_COUNTER(*scope))};
+    const std::string id =
+        fmt::format("benchmark_http_client.request_to_response.endpoint.{}", address);
+    endpoint = std::make_unique<EndpointStatistics>(
+        EndpointStatistics{std::move(scope), std::move(counters), endpoint_statistic_factory_(id)});
+    endpoint->latency_statistic->setId(id);
+  }
+  return *endpoint;
+}
+
 std::vector<nighthawk::client::UserDefinedOutput>
 BenchmarkClientHttpImpl::getUserDefinedOutputResults() const {
   std::vector<nighthawk::client::UserDefinedOutput> outputs;
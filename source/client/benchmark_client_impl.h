@@ -20,12 +20,15 @@
 #include "external/envoy/source/common/http/http1/conn_pool.h"
 #include "external/envoy/source/common/http/http2/conn_pool.h"
 #include "external/envoy/source/common/runtime/runtime_impl.h"
+#include "external/envoy/source/common/upstream/load_balancer_context_base.h"
 
 #include "api/client/options.pb.h"
 
 #include "source/client/stream_decoder.h"
 #include "source/common/statistic_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -41,9 +44,22 @@ using namespace std::chrono_literals;
   COUNTER(http_xxx)                                                                                \
   COUNTER(pool_overflow)                                                                           \
   COUNTER(pool_connection_failure)                                                                 \
+  COUNTER(pool_unavailable)                                                                        \
   COUNTER(user_defined_plugin_handle_headers_failure)                                              \
   COUNTER(user_defined_plugin_handle_data_failure)
 
+// Counters kept per upstream endpoint when targeting multiple endpoints, in the scope
+// "benchmark.endpoint.<address>.", where the dots and colons of the address are replaced by
+// underscores.
+#define ALL_BENCHMARK_CLIENT_ENDPOINT_COUNTERS(COUNTER)                                            \
+  COUNTER(failures)                                                                                \
+  COUNTER(http_1xx)                                                                                \
+  COUNTER(http_2xx)                                                                                \
+  COUNTER(http_3xx)                                                                                \
+  COUNTER(http_4xx)                                                                                \
+  COUNTER(http_5xx)                                                                                \
+  COUNTER(http_xxx)
+
 // For counter metrics, Nighthawk use Envoy Counter directly. For histogram metrics, Nighthawk uses
 // its own Statistic instead of Envoy Histogram. Here BenchmarkClientCounters contains only counters
 // while BenchmarkClientStatistic contains only histograms.
@@ -60,7 +76,8 @@ struct BenchmarkClientStatistic {
                            StatisticPtr&& latency_2xx_stat, StatisticPtr&& latency_3xx_stat,
                            StatisticPtr&& latency_4xx_stat, StatisticPtr&& latency_5xx_stat,
                            StatisticPtr&& latency_xxx_stat,
-                           StatisticPtr&& origin_latency_statistic);
+                           StatisticPtr&& origin_latency_statistic,
+                           StatisticPtr&& request_generation_statistic);
 
   // These are declared order dependent. Changing ordering may trigger on assert upon
   // destruction when tls has been involved during usage.
@@ -75,6 +92,28 @@ struct BenchmarkClientStatistic {
   StatisticPtr latency_5xx_statistic;
   StatisticPtr latency_xxx_statistic;
   StatisticPtr origin_latency_statistic;
+  // Time spent generating requests, a part of the overhead of Nighthawk itself.
+  StatisticPtr request_generation_statistic;
+};
+
+struct BenchmarkClientEndpointCounters {
+  ALL_BENCHMARK_CLIENT_ENDPOINT_COUNTERS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Load balancer context which hands the load balancer a hash of a request header, so that
+ * consistent hashing policies (ring hash, maglev) pick the endpoint based on that header.
+ */
+class HashKeyLoadBalancerContext : public Envoy::Upstream::LoadBalancerContextBase {
+public:
+  /**
+   * @param hash_key the hash of the header value, or std::nullopt if the request lacks the header.
+   */
+  explicit HashKeyLoadBalancerContext(std::optional<uint64_t> hash_key) : hash_key_(hash_key) {}
+  std::optional<uint64_t> computeHashKey() override { return hash_key_; }
+
+private:
+  const std::optional<uint64_t> hash_key_;
 };
 
 class Http1PoolImpl : public Envoy::Http::FixedHttpConnPoolImpl {
@@ -124,6 +163,34 @@ public:
     max_requests_per_connection_ = max_requests_per_connection;
   }
   void setTimeout(std::chrono::seconds timeout) { timeout_ = timeout; }
+  /**
+   * Enables per-endpoint counters and latency statistics. These are created as endpoints are first
+   * seen, and their statistics are included in statistics().
+   *
+   * @param endpoint_statistic_factory creates the latency statistic of a newly seen endpoint, given
+   * the id of the statistic.
+   */
+  void enableEndpointStatistics(
+      std::function<StatisticPtr(absl::string_view id)> endpoint_statistic_factory) {
+    endpoint_statistic_factory_ = std::move(endpoint_statistic_factory);
+  }
+  /**
+   * @param hash_header name of the request header whose value is hashed to pick an endpoint with
+   * consistent hashing load balancing policies. When empty, no hash is offered.
+   */
+  void setHashHeader(absl::string_view hash_header) {
+    hash_header_ = hash_header.empty()
+                       ? std::nullopt
+                       : std::make_optional<Envoy::Http::LowerCaseString>(hash_header);
+  }
+  /**
+   * Records each request started from now on in a request event log.
+   *
+   * @param request_event_log the producer of the log for the worker that owns this client.
+   */
+  void setRequestEventLog(RequestEventLogProducer& request_event_log) {
+    stream_decoder_pool_.setRequestEventLog(&request_event_log);
+  }
 
   // BenchmarkClient
   void terminate() override;
@@ -145,18 +212,29 @@ public:
   void onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason) override;
   void exportLatency(const uint32_t response_code, const uint64_t latency_ns) override;
   void handleResponseData(const Envoy::Buffer::Instance& response_data) override;
+  void onEndpointComplete(const Envoy::Upstream::HostDescription& host, uint32_t response_code,
+                          std::optional<uint64_t> latency_ns) override;
 
   // Helpers
-  std::optional<::Envoy::Upstream::HttpPoolData> pool() {
+  std::optional<::Envoy::Upstream::HttpPoolData>
+  pool(Envoy::Upstream::LoadBalancerContext* context = nullptr) {
     const auto thread_local_cluster = cluster_manager_->getThreadLocalCluster(cluster_name_);
     Envoy::Upstream::HostConstSharedPtr host =
         Envoy::Upstream::LoadBalancer::onlyAllowSynchronousHostSelection(
-            thread_local_cluster->chooseHost(nullptr));
+            thread_local_cluster->chooseHost(context));
     return thread_local_cluster->httpConnPool(host, Envoy::Upstream::ResourcePriority::Default,
-                                              protocol_, nullptr);
+                                              protocol_, context);
   }
 
 private:
+  struct EndpointStatistics {
+    Envoy::Stats::ScopeSharedPtr scope;
+    BenchmarkClientEndpointCounters counters;
+    StatisticPtr latency_statistic;
+  };
+
+  EndpointStatistics& endpointStatistics(const Envoy::Upstream::HostDescription& host);
+
   Envoy::Api::Api& api_;
   Envoy::Event::Dispatcher& dispatcher_;
   Envoy::Stats::ScopeSharedPtr scope_;
@@ -181,6 +259,13 @@ private:
   const std::string latency_response_header_name_;
   Envoy::Event::TimerPtr drain_timer_;
   std::vector<UserDefinedOutputNamePluginPair> user_defined_output_plugins_;
+  std::function<StatisticPtr(absl::string_view id)> endpoint_statistic_factory_;
+  // Keyed by host. Hosts outlive the benchmark client, as the cluster manager does.
+  absl::flat_hash_map<const Envoy::Upstream::HostDescription*, std::unique_ptr<EndpointStatistics>>
+      endpoint_statistics_;
+  std::optional<Envoy::Http::LowerCaseString> hash_header_;
+  // Declared last, so that it is destroyed before the statistics referenced by pooled decoders.
+  StreamDecoderPool stream_decoder_pool_;
 };
 
 } // namespace Client
@@ -26,6 +26,7 @@
 #include "source/client/factories_impl.h"
 #include "source/client/options_impl.h"
 #include "source/client/output_collector_impl.h"
+#include "source/client/output_formatter_impl.h"
 #include "source/client/process_impl.h"
 #include "source/client/remote_process_impl.h"
 #include "source/common/frequency.h"
@@ -35,6 +36,8 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 using namespace std::chrono_literals;
 
@@ -83,6 +86,17 @@ bool Main::run() {
     }
     process = std::move(*process_or_status);
   }
+  if (options_->progressReportInterval() > 0) {
+    process->setProgressCallback([](const nighthawk::client::Output& progress) {
+      for (const nighthawk::client::Result& result : progress.results()) {
+        ENVOY_LOG(info, "Progress: {}",
+                  absl::StrJoin(result.counters(), ", ",
+                                [](std::string* out, const nighthawk::client::Counter& counter) {
+                                  absl::StrAppend(out, counter.name(), ": ", counter.value());
+                                }));
+      }
+    });
+  }
   OutputFormatterFactoryImpl output_formatter_factory;
   OutputCollectorImpl output_collector(time_system, *options_);
   bool result;
@@ -100,13 +114,16 @@ bool Main::run() {
         std::make_unique<SignalHandler>([&process]() { process->requestExecutionCancellation(); });
     result = process->run(output_collector);
     auto formatter = output_formatter_factory.create(options_->outputFormat());
-    absl::StatusOr<std::string> formatted_proto =
-        formatter->formatProto(output_collector.toProto());
-    if (!formatted_proto.ok()) {
+    nighthawk::client::Output output = output_collector.toProto();
+    if (OutputFormatterImpl::rendersPercentiles(options_->outputFormat()) &&
+        !OutputFormatterImpl::renderHistogramEncodings(output).ok()) {
+      ENVOY_LOG(error, "An error occurred while rendering histograms");
+      result = false;
+    }
+    // Written as it is formatted, so that large outputs aren't held in memory twice.
+    if (!formatter->formatProtoToStream(output, std::cout).ok()) {
       ENVOY_LOG(error, "An error occurred while formatting proto");
       result = false;
-    } else {
-      std::cout << *formatted_proto;
     }
     process->shutdown();
   }
@@ -30,7 +30,8 @@ ClientWorkerImpl::ClientWorkerImpl(
       worker_number_(worker_number), tracer_(tracer),
       request_generator_(
           request_generator_factory.create(cluster_manager, *dispatcher_, *worker_number_scope_,
-                                           fmt::format("{}.requestsource", worker_number))),
+                                           fmt::format("{}.requestsource", worker_number),
+                                           worker_number)),
       benchmark_client_(benchmark_client_factory.create(
           api, *dispatcher_, *worker_number_scope_, cluster_manager, tracer_,
           fmt::format("{}", worker_number), worker_number, *request_generator_,
@@ -44,7 +45,8 @@ ClientWorkerImpl::ClientWorkerImpl(
                                           },
                                           termination_predicate_factory_.create(
                                               *time_source_, *worker_number_scope_, starting_time),
-                                          *worker_number_scope_, starting_time, api),
+                                          *worker_number_scope_, starting_time, api,
+                                          worker_number),
                                       true)),
       hardcoded_warmup_style_(hardcoded_warmup_style) {}
 
@@ -66,20 +68,6 @@ void ClientWorkerImpl::work() {
   }
   benchmark_client_->setShouldMeasureLatencies(phase_->shouldMeasureLatencies());
   phase_->run();
-
-  // Save a final snapshot of the worker-specific counter accumulations before
-  // we exit the thread.
-  for (const auto& stat : store_.counters()) {
-    // First, we strip the cluster prefix
-    std::string stat_name = std::string(absl::StripPrefix(stat->name(), "cluster."));
-    stat_name = std::string(absl::StripPrefix(stat_name, "worker."));
-    // Second, we strip our own prefix if it's there, else we skip.
-    const std::string worker_prefix = fmt::format("{}.", worker_number_);
-    if (stat->value() && absl::StartsWith(stat_name, worker_prefix)) {
-      threadLocalCounterValues_[std::string(absl::StripPrefix(stat_name, worker_prefix))] =
-          stat->value();
-    }
-  }
   // Note that benchmark_client_ is not terminated here, but in shutdownThread() below. This is to
   // to prevent the shutdown artifacts from influencing the test result counters. The main thread
   // still needs to be able to read the counters for reporting the global numbers, and those
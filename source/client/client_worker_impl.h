@@ -40,10 +40,6 @@ public:
                    std::vector<UserDefinedOutputNamePluginPair> user_defined_output_plugins);
   StatisticPtrMap statistics() const override;
 
-  const std::map<std::string, uint64_t>& threadLocalCounterValues() override {
-    return threadLocalCounterValues_;
-  }
-
   const Phase& phase() const override { return *phase_; }
 
   void shutdownThread() override;
@@ -72,7 +68,6 @@ private:
   BenchmarkClientPtr benchmark_client_;
   PhasePtr phase_;
   Envoy::LocalInfo::LocalInfoPtr local_info_;
-  std::map<std::string, uint64_t> threadLocalCounterValues_;
   const HardCodedWarmupStyle hardcoded_warmup_style_;
 };
 
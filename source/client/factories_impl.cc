@@ -10,6 +10,7 @@
 
 #include "external/envoy/source/common/config/utility.h"
 #include "external/envoy/source/common/http/header_map_impl.h"
+#include "external/envoy/source/common/protobuf/utility.h"
 
 #include "api/client/options.pb.h"
 
@@ -31,10 +32,31 @@ using namespace std::chrono_literals;
 namespace Nighthawk {
 namespace Client {
 
+namespace {
+
+// Enables interval recording on HdrHistogram backed statistics, so that the flush worker,
+// progress reports and time slices can report on them while the workers are running.
+StatisticPtr maybeRecordIntervals(StatisticPtr statistic, bool record_intervals) {
+  auto* hdr_statistic = dynamic_cast<HdrStatistic*>(statistic.get());
+  if (record_intervals && hdr_statistic != nullptr) {
+    hdr_statistic->enableIntervalRecording();
+  }
+  return statistic;
+}
+
+// The status class latency statistics of most executions only ever see a handful of values, if
+// any. These are kept as-is up to this many, before a histogram gets allocated.
+constexpr uint32_t kRarelyUsedStatisticSparseCapacity = 4096;
+
+} // namespace
+
 OptionBasedFactoryImpl::OptionBasedFactoryImpl(const Options& options) : options_(options) {}
 
-BenchmarkClientFactoryImpl::BenchmarkClientFactoryImpl(const Options& options)
-    : OptionBasedFactoryImpl(options) {}
+BenchmarkClientFactoryImpl::BenchmarkClientFactoryImpl(const Options& options,
+                                                       RequestEventLog* request_event_log,
+                                                       std::function<bool()> reports_progress)
+    : OptionBasedFactoryImpl(options), request_event_log_(request_event_log),
+      reports_progress_(std::move(reports_progress)) {}
 
 BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
     Envoy::Api::Api& api, Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
@@ -42,22 +64,45 @@ BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
     absl::string_view cluster_name, int worker_id, RequestSource& request_generator,
     std::vector<UserDefinedOutputNamePluginPair> user_defined_output_plugins) const {
   StatisticFactoryImpl statistic_factory(options_);
-  // While we lack options to configure which statistic backend goes where, we directly pass
-  // StreamingStatistic for the stats that track response sizes. Ideally we would have options
-  // for this to route the right stat to the right backend (HdrStatistic, SimpleStatistic,
-  // NullStatistic).
-  // TODO(#292): Create options and have the StatisticFactory consider those when instantiating
-  // statistics.
-  BenchmarkClientStatistic statistic(statistic_factory.create(), statistic_factory.create(),
-                                     std::make_unique<StreamingStatistic>(),
-                                     std::make_unique<StreamingStatistic>(),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id),
-                                     std::make_unique<SinkableHdrStatistic>(scope, worker_id));
+  // The interval recorders are read by the flush worker, which only runs when stats sinks are
+  // configured, by progress reports when there is someone to send them to, and by time slices.
+  const bool record_intervals =
+      !options_.statsSinks().empty() ||
+      (options_.progressReportInterval() > 0 && reports_progress_ != nullptr &&
+       reports_progress_()) ||
+      options_.timeSliceInterval() > 0;
+  // Latencies by status class are delivered to stats sinks, when the backend supports it.
+  const auto latency_statistic = [&scope, &statistic_factory, worker_id,
+                                  record_intervals](absl::string_view id) -> StatisticPtr {
+    switch (statistic_factory.backend(id, nighthawk::client::StatisticBackend::HDR)) {
+    case nighthawk::client::StatisticBackend::HDR: {
+      HdrStatisticConfig config = statistic_factory.hdrStatisticConfig(id);
+      config.sparse_capacity = kRarelyUsedStatisticSparseCapacity;
+      return maybeRecordIntervals(std::make_unique<SinkableHdrStatistic>(scope, worker_id, config),
+                                  record_intervals);
+    }
+    case nighthawk::client::StatisticBackend::CIRCLLHIST:
+      return std::make_unique<SinkableCircllhistStatistic>(scope, worker_id);
+    default:
+      return statistic_factory.create(id, nighthawk::client::StatisticBackend::HDR);
+    }
+  };
+  BenchmarkClientStatistic statistic(
+      statistic_factory.create("benchmark_http_client.queue_to_connect"),
+      maybeRecordIntervals(statistic_factory.create("benchmark_http_client.request_to_response"),
+                           record_intervals),
+      statistic_factory.create("benchmark_http_client.response_header_size",
+                               nighthawk::client::StatisticBackend::STREAMING),
+      statistic_factory.create("benchmark_http_client.response_body_size",
+                               nighthawk::client::StatisticBackend::STREAMING),
+      latency_statistic("benchmark_http_client.latency_1xx"),
+      latency_statistic("benchmark_http_client.latency_2xx"),
+      latency_statistic("benchmark_http_client.latency_3xx"),
+      latency_statistic("benchmark_http_client.latency_4xx"),
+      latency_statistic("benchmark_http_client.latency_5xx"),
+      latency_statistic("benchmark_http_client.latency_xxx"),
+      latency_statistic("benchmark_http_client.origin_latency_statistic"),
+      statistic_factory.create("benchmark_http_client.request_generation"));
   auto benchmark_client = std::make_unique<BenchmarkClientHttpImpl>(
       api, dispatcher, scope, statistic, options_.protocol(), cluster_manager, tracer, cluster_name,
       request_generator.get(), !options_.openLoop(), options_.responseHeaderWithLatencyInput(),
@@ -67,12 +112,22 @@ BenchmarkClientPtr BenchmarkClientFactoryImpl::create(
   benchmark_client->setMaxActiveRequests(options_.maxActiveRequests());
   benchmark_client->setMaxRequestsPerConnection(options_.maxRequestsPerConnection());
   benchmark_client->setTimeout(options_.timeout());
+  if (!options_.multiTargetEndpoints().empty()) {
+    benchmark_client->enableEndpointStatistics(
+        [&options = options_](absl::string_view id) {
+          return StatisticFactoryImpl(options).create(id);
+        });
+    benchmark_client->setHashHeader(options_.multiTargetHashHeader());
+  }
+  if (request_event_log_ != nullptr) {
+    benchmark_client->setRequestEventLog(request_event_log_->producer(worker_id));
+  }
 
   return benchmark_client;
 }
 
-SequencerFactoryImpl::SequencerFactoryImpl(const Options& options)
-    : OptionBasedFactoryImpl(options) {}
+SequencerFactoryImpl::SequencerFactoryImpl(const Options& options, uint32_t worker_count)
+    : OptionBasedFactoryImpl(options), worker_count_(worker_count) {}
 
 SequencerPtr SequencerFactoryImpl::create(Envoy::TimeSource& time_source,
                                           Envoy::Event::Dispatcher& dispatcher,
@@ -80,14 +135,15 @@ SequencerPtr SequencerFactoryImpl::create(Envoy::TimeSource& time_source,
                                           TerminationPredicatePtr&& termination_predicate,
                                           Envoy::Stats::Scope& scope,
                                           const Envoy::MonotonicTime scheduled_starting_time,
-                                          Envoy::Api::Api& api) const {
+                                          Envoy::Api::Api& api, uint32_t worker_number) const {
   StatisticFactoryImpl statistic_factory(options_);
   RateLimiterPtr rate_limiter;
 
   // Check if there is a rate limiter plugin to load and use.
   if (options_.rateLimiterPluginConfig().has_value()) {
     absl::StatusOr<RateLimiterPtr> plugin_or =
-        LoadRateLimiterPlugin(options_.rateLimiterPluginConfig().value(), api, time_source);
+        LoadRateLimiterPlugin(options_.rateLimiterPluginConfig().value(), api, time_source,
+                              {worker_number, worker_count_});
     if (!plugin_or.ok()) {
       throw NighthawkException(
           absl::StrCat("Rate Limiter plugin loading error: ", plugin_or.status().message()));
@@ -115,21 +171,29 @@ SequencerPtr SequencerFactoryImpl::create(Envoy::TimeSource& time_source,
     }
   }
 
+  SequencerOverheadStatistics overhead_statistics{
+      statistic_factory.create("sequencer.loop_lag"),
+      statistic_factory.create("sequencer.run_duration"),
+      statistic_factory.create("sequencer.slippage"),
+      statistic_factory.create("sequencer.thread_cpu_time")};
   return std::make_unique<SequencerImpl>(
       platform_util_, dispatcher, time_source, std::move(rate_limiter), sequencer_target,
-      statistic_factory.create(), statistic_factory.create(), options_.sequencerIdleStrategy(),
+      statistic_factory.create("sequencer.callback"),
+      statistic_factory.create("sequencer.blocking"),
+      statistic_factory.create("sequencer.intended_callback"), std::move(overhead_statistics),
+      options_.sequencerIdleStrategy(),
       std::move(termination_predicate), scope);
 }
 
 absl::StatusOr<RateLimiterPtr> SequencerFactoryImpl::LoadRateLimiterPlugin(
     const envoy::config::core::v3::TypedExtensionConfig& config, Envoy::Api::Api& api,
-    Envoy::TimeSource& time_source) const {
+    Envoy::TimeSource& time_source, const WorkerContext& worker_context) const {
   try {
     auto& config_factory =
         Envoy::Config::Utility::getAndCheckFactoryByName<RateLimiterPluginConfigFactory>(
             config.name());
-    return config_factory.createRateLimiterPlugin(config.typed_config(), api, time_source,
-                                                  options_);
+    return config_factory.createRateLimiterPluginForWorker(config.typed_config(), api,
+                                                           time_source, options_, worker_context);
   } catch (const Envoy::EnvoyException& e) {
     return absl::InvalidArgumentError(
         absl::StrCat("Could not load plugin: ", config.name(), ": ", e.what()));
@@ -137,9 +201,70 @@ absl::StatusOr<RateLimiterPtr> SequencerFactoryImpl::LoadRateLimiterPlugin(
 }
 
 StatisticFactoryImpl::StatisticFactoryImpl(const Options& options)
-    : OptionBasedFactoryImpl(options) {}
+    : OptionBasedFactoryImpl(options), hdr_histogram_configs_(options.hdrHistogramConfigs()),
+      statistic_backends_(options.statisticBackends()) {}
 
-StatisticPtr StatisticFactoryImpl::create() const { return std::make_unique<HdrStatistic>(); }
+StatisticPtr StatisticFactoryImpl::create(absl::string_view id) const {
+  return create(id, nighthawk::client::StatisticBackend::HDR);
+}
+
+StatisticPtr StatisticFactoryImpl::create(
+    absl::string_view id,
+    nighthawk::client::StatisticBackend::StatisticBackendOptions default_backend) const {
+  StatisticPtr statistic;
+  switch (backend(id, default_backend)) {
+  case nighthawk::client::StatisticBackend::HDR:
+    statistic = std::make_unique<HdrStatistic>(hdrStatisticConfig(id));
+    break;
+  case nighthawk::client::StatisticBackend::CIRCLLHIST:
+    statistic = std::make_unique<CircllhistStatistic>();
+    break;
+  case nighthawk::client::StatisticBackend::STREAMING:
+    statistic = std::make_unique<StreamingStatistic>();
+    break;
+  case nighthawk::client::StatisticBackend::NONE:
+    statistic = std::make_unique<NullStatistic>();
+    break;
+  case nighthawk::client::StatisticBackend::SKETCH:
+    statistic = std::make_unique<DDSketchStatistic>();
+    break;
+  default:
+    PANIC("not reached");
+  }
+  statistic->setId(id);
+  return statistic;
+}
+
+nighthawk::client::StatisticBackend::StatisticBackendOptions StatisticFactoryImpl::backend(
+    absl::string_view id,
+    nighthawk::client::StatisticBackend::StatisticBackendOptions default_backend) const {
+  auto it = statistic_backends_.find(std::string(id));
+  if (it == statistic_backends_.end()) {
+    it = statistic_backends_.find("*");
+  }
+  if (it != statistic_backends_.end() &&
+      it->second != nighthawk::client::StatisticBackend::DEFAULT) {
+    return it->second;
+  }
+  return default_backend == nighthawk::client::StatisticBackend::DEFAULT
+             ? nighthawk::client::StatisticBackend::HDR
+             : default_backend;
+}
+
+HdrStatisticConfig StatisticFactoryImpl::hdrStatisticConfig(absl::string_view id) const {
+  HdrStatisticConfig config;
+  auto it = hdr_histogram_configs_.find(std::string(id));
+  if (it == hdr_histogram_configs_.end()) {
+    it = hdr_histogram_configs_.find("*");
+  }
+  if (it != hdr_histogram_configs_.end()) {
+    config.highest_trackable_value = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+        it->second, highest_trackable_value, config.highest_trackable_value);
+    config.significant_digits =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(it->second, significant_digits, config.significant_digits);
+  }
+  return config;
+}
 
 OutputFormatterPtr OutputFormatterFactoryImpl::create(
     const nighthawk::client::OutputFormat_OutputFormatOptions output_format) const {
@@ -165,8 +290,9 @@ OutputFormatterPtr OutputFormatterFactoryImpl::create(
   }
 }
 
-RequestSourceFactoryImpl::RequestSourceFactoryImpl(const Options& options, Envoy::Api::Api& api)
-    : OptionBasedFactoryImpl(options), api_(api) {}
+RequestSourceFactoryImpl::RequestSourceFactoryImpl(const Options& options, Envoy::Api::Api& api,
+                                                   uint32_t worker_count)
+    : OptionBasedFactoryImpl(options), api_(api), worker_count_(worker_count) {}
 
 void RequestSourceFactoryImpl::setRequestHeader(Envoy::Http::RequestHeaderMap& header,
                                                 absl::string_view key,
@@ -180,7 +306,33 @@ void RequestSourceFactoryImpl::setRequestHeader(Envoy::Http::RequestHeaderMap& h
 RequestSourcePtr
 RequestSourceFactoryImpl::create(const Envoy::Upstream::ClusterManagerPtr& cluster_manager,
                                  Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
-                                 absl::string_view service_cluster_name) const {
+                                 absl::string_view service_cluster_name,
+                                 uint32_t worker_number) const {
+  const uint32_t shared_request_source_capacity = options_.sharedRequestSourceCapacity();
+  if (shared_request_source_capacity == 0) {
+    return createRequestSource(cluster_manager, dispatcher, scope, service_cluster_name,
+                               {worker_number, worker_count_}, /*consumer_count=*/1);
+  }
+  Envoy::Thread::LockGuard lock_guard(shared_request_source_lock_);
+  if (shared_request_source_ == nullptr) {
+    // A remote request source is bound to the dispatcher of the worker it is created for, so that
+    // worker has to drive it. Everything else is drained by a dedicated producer thread.
+    const SharedRequestSourceImpl::ProducerMode producer_mode =
+        options_.requestSource().empty() ? SharedRequestSourceImpl::ProducerMode::Thread
+                                         : SharedRequestSourceImpl::ProducerMode::OwningWorker;
+    // The upstream request source feeds all workers, so plugins should not partition their input.
+    shared_request_source_ = std::make_shared<SharedRequestSourceImpl>(
+        createRequestSource(cluster_manager, dispatcher, scope, service_cluster_name,
+                            WorkerContext{}, worker_count_),
+        shared_request_source_capacity, producer_mode, api_.threadFactory());
+  }
+  return shared_request_source_->createConsumer(scope);
+}
+
+RequestSourcePtr RequestSourceFactoryImpl::createRequestSource(
+    const Envoy::Upstream::ClusterManagerPtr& cluster_manager, Envoy::Event::Dispatcher& dispatcher,
+    Envoy::Stats::Scope& scope, absl::string_view service_cluster_name,
+    const WorkerContext& worker_context, uint32_t consumer_count) const {
   Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
   if (options_.uri().has_value()) {
     // We set headers based on the URI, but we don't have all the prerequisites to call the
@@ -219,13 +371,15 @@ RequestSourceFactoryImpl::create(const Envoy::Upstream::ClusterManagerPtr& clust
   if (!options_.requestSource().empty()) {
     RELEASE_ASSERT(!service_cluster_name.empty(), "expected cluster name to be set");
     // We pass in options_.requestsPerSecond() as the header buffer length so the grpc client
-    // will shoot for maintaining an amount of headers of at least one second.
-    return std::make_unique<RemoteRequestSourceImpl>(cluster_manager, dispatcher, scope,
-                                                     service_cluster_name, std::move(header),
-                                                     options_.requestsPerSecond());
+    // will shoot for maintaining an amount of headers of at least one second, for each of the
+    // workers it feeds.
+    return std::make_unique<RemoteRequestSourceImpl>(
+        cluster_manager, dispatcher, scope, service_cluster_name, std::move(header),
+        options_.requestsPerSecond() * consumer_count);
   } else if (options_.requestSourcePluginConfig().has_value()) {
-    absl::StatusOr<RequestSourcePtr> plugin_or = LoadRequestSourcePlugin(
-        options_.requestSourcePluginConfig().value(), api_, std::move(header));
+    absl::StatusOr<RequestSourcePtr> plugin_or =
+        LoadRequestSourcePlugin(options_.requestSourcePluginConfig().value(), api_,
+                                std::move(header), worker_context);
     if (!plugin_or.ok()) {
       throw NighthawkException(
           absl::StrCat("Request Source plugin loading error should have been caught "
@@ -240,12 +394,14 @@ RequestSourceFactoryImpl::create(const Envoy::Upstream::ClusterManagerPtr& clust
 }
 absl::StatusOr<RequestSourcePtr> RequestSourceFactoryImpl::LoadRequestSourcePlugin(
     const envoy::config::core::v3::TypedExtensionConfig& config, Envoy::Api::Api& api,
-    Envoy::Http::RequestHeaderMapPtr header) const {
+    Envoy::Http::RequestHeaderMapPtr header,
+    const WorkerContext& worker_context) const {
   try {
     auto& config_factory =
         Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
             config.name());
-    return config_factory.createRequestSourcePlugin(config.typed_config(), api, std::move(header));
+    return config_factory.createRequestSourcePluginForWorker(config.typed_config(), api,
+                                                             std::move(header), worker_context);
   } catch (const Envoy::EnvoyException& e) {
     return absl::InvalidArgumentError(
         absl::StrCat("Could not load plugin: ", config.name(), ": ", e.what()));
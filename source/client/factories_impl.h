@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "envoy/api/api.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -10,9 +12,13 @@
 #include "nighthawk/common/uri.h"
 
 #include "external/envoy/source/common/common/statusor.h"
+#include "external/envoy/source/common/common/thread.h"
 #include "external/envoy/source/common/config/utility.h"
 
 #include "source/common/platform_util_impl.h"
+#include "source/common/request_event_log.h"
+#include "source/common/request_source_impl.h"
+#include "source/common/statistic_impl.h"
 
 namespace Nighthawk {
 namespace Client {
@@ -29,23 +35,41 @@ protected:
 
 class BenchmarkClientFactoryImpl : public OptionBasedFactoryImpl, public BenchmarkClientFactory {
 public:
-  BenchmarkClientFactoryImpl(const Options& options);
+  /**
+   * @param options Options to derive benchmark clients from.
+   * @param request_event_log When not nullptr, benchmark clients record each request in this log,
+   * using the producer of the worker they are created for.
+   * @param reports_progress Called upon create(), tells whether progress reports are sent every
+   * Options::progressReportInterval() seconds. Only then the latency statistics record intervals
+   * for them. When nullptr, no progress reports are sent.
+   */
+  BenchmarkClientFactoryImpl(const Options& options, RequestEventLog* request_event_log = nullptr,
+                             std::function<bool()> reports_progress = nullptr);
   BenchmarkClientPtr
   create(Envoy::Api::Api& api, Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
          Envoy::Upstream::ClusterManagerPtr& cluster_manager,
          Envoy::Tracing::TracerSharedPtr& tracer, absl::string_view cluster_name, int worker_id,
          RequestSource& request_generator,
          std::vector<UserDefinedOutputNamePluginPair> user_defined_output_plugins) const override;
+
+private:
+  RequestEventLog* const request_event_log_;
+  const std::function<bool()> reports_progress_;
 };
 
 class SequencerFactoryImpl : public OptionBasedFactoryImpl, public SequencerFactory {
 public:
-  SequencerFactoryImpl(const Options& options);
+  /**
+   * @param options Options to derive sequencers from.
+   * @param worker_count The number of workers that will each create a sequencer. Passed on to
+   * rate limiter plugins, which may use it to partition their input.
+   */
+  SequencerFactoryImpl(const Options& options, uint32_t worker_count = 1);
   SequencerPtr create(Envoy::TimeSource& time_source, Envoy::Event::Dispatcher& dispatcher,
                       const SequencerTarget& sequencer_target,
                       TerminationPredicatePtr&& termination_predicate, Envoy::Stats::Scope& scope,
-                      const Envoy::MonotonicTime scheduled_starting_time,
-                      Envoy::Api::Api& api) const override;
+                      const Envoy::MonotonicTime scheduled_starting_time, Envoy::Api::Api& api,
+                      uint32_t worker_number) const override;
 
 private:
   /**
@@ -53,17 +77,52 @@ private:
    * @param config Plugin name and typed configuration.
    * @param api Envoy API context.
    * @param time_source Time source used by the rate limiter.
+   * @param worker_context Identifies the worker the rate limiter is created for.
    * @return Initialized plugin or error status.
    */
   absl::StatusOr<RateLimiterPtr>
   LoadRateLimiterPlugin(const envoy::config::core::v3::TypedExtensionConfig& config,
-                        Envoy::Api::Api& api, Envoy::TimeSource& time_source) const;
+                        Envoy::Api::Api& api, Envoy::TimeSource& time_source,
+                        const WorkerContext& worker_context) const;
+
+  const uint32_t worker_count_;
 };
 
 class StatisticFactoryImpl : public OptionBasedFactoryImpl, public StatisticFactory {
 public:
   StatisticFactoryImpl(const Options& options);
-  StatisticPtr create() const override;
+  StatisticPtr create(absl::string_view id) const override;
+
+  /**
+   * @param id The id of the statistic, which is set on the returned statistic.
+   * @param default_backend The backend to use when none is configured for the statistic.
+   * @return StatisticPtr A new statistic of the backend that backend() resolves to.
+   */
+  StatisticPtr create(absl::string_view id,
+                      nighthawk::client::StatisticBackend::StatisticBackendOptions default_backend)
+      const;
+
+  /**
+   * @param id The id of a statistic.
+   * @param default_backend The backend to use when none is configured for the statistic.
+   * @return nighthawk::client::StatisticBackend::StatisticBackendOptions The backend configured
+   * for the statistic through Options::statisticBackends(), falling back to the entry for "*" and
+   * then to default_backend. Never DEFAULT.
+   */
+  nighthawk::client::StatisticBackend::StatisticBackendOptions
+  backend(absl::string_view id,
+          nighthawk::client::StatisticBackend::StatisticBackendOptions default_backend) const;
+
+  /**
+   * @param id The id of a statistic.
+   * @return HdrStatisticConfig The range and precision configured for the statistic through
+   * Options::hdrHistogramConfigs(), falling back to the entry for "*" and then to the defaults.
+   */
+  HdrStatisticConfig hdrStatisticConfig(absl::string_view id) const;
+
+private:
+  const HdrHistogramConfigMap hdr_histogram_configs_;
+  const StatisticBackendMap statistic_backends_;
 };
 
 class OutputFormatterFactoryImpl : public OutputFormatterFactory {
@@ -74,15 +133,46 @@ public:
 
 class RequestSourceFactoryImpl : public OptionBasedFactoryImpl, public RequestSourceFactory {
 public:
-  RequestSourceFactoryImpl(const Options& options, Envoy::Api::Api& api);
+  /**
+   * @param options Options to derive request sources from.
+   * @param api Api parameter that contains timesystem, filesystem, and threadfactory.
+   * @param worker_count The number of workers that will each create a request source. Passed on to
+   * request source plugins, which may use it to partition their input.
+   * When Options::sharedRequestSourceCapacity() is set, the first call to create() sets up a
+   * single upstream request source, and all calls return a view on it for their worker.
+   */
+  RequestSourceFactoryImpl(const Options& options, Envoy::Api::Api& api,
+                           uint32_t worker_count = 1);
   RequestSourcePtr create(const Envoy::Upstream::ClusterManagerPtr& cluster_manager,
                           Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
-                          absl::string_view service_cluster_name) const override;
+                          absl::string_view service_cluster_name,
+                          uint32_t worker_number) const override;
 
 private:
   Envoy::Api::Api& api_;
+  const uint32_t worker_count_;
+  mutable Envoy::Thread::MutexBasicLockable shared_request_source_lock_;
+  mutable SharedRequestSourceImplSharedPtr
+      shared_request_source_ ABSL_GUARDED_BY(shared_request_source_lock_);
   void setRequestHeader(Envoy::Http::RequestHeaderMap& header, absl::string_view key,
                         absl::string_view value) const;
+  /**
+   * Creates a request source based on the options, which is not shared with other workers.
+   *
+   * @param cluster_manager Cluster manager, used by remote request sources.
+   * @param dispatcher Dispatcher of the worker the request source is created for.
+   * @param scope Statistics scope that will be used.
+   * @param service_cluster_name Name of the cluster that remote request sources connect to.
+   * @param worker_context Identifies the worker the request source is created for.
+   * @param consumer_count The number of workers that will draw requests from the request source.
+   * @return RequestSourcePtr The request source.
+   */
+  RequestSourcePtr createRequestSource(const Envoy::Upstream::ClusterManagerPtr& cluster_manager,
+                                       Envoy::Event::Dispatcher& dispatcher,
+                                       Envoy::Stats::Scope& scope,
+                                       absl::string_view service_cluster_name,
+                                       const WorkerContext& worker_context,
+                                       uint32_t consumer_count) const;
   /**
    * Instantiates a RequestSource using a RequestSourcePluginFactory based on the plugin name in
    * |config|, unpacking the plugin-specific config proto within |config|. Validates the config
@@ -92,13 +182,15 @@ private:
    * @param api Api parameter that contains timesystem, filesystem, and threadfactory.
    * @param header Any headers in request specifiers yielded by the request
    * source plugin will override what is specified here.
+   * @param worker_context Identifies the worker the request source is created for.
 
    * @return absl::StatusOr<RequestSourcePtr> Initialized plugin or error status due to missing
    * plugin or config proto validation error.
    */
   absl::StatusOr<RequestSourcePtr>
   LoadRequestSourcePlugin(const envoy::config::core::v3::TypedExtensionConfig& config,
-                          Envoy::Api::Api& api, Envoy::Http::RequestHeaderMapPtr header) const;
+                          Envoy::Api::Api& api, Envoy::Http::RequestHeaderMapPtr header,
+                          const WorkerContext& worker_context) const;
 };
 
 class TerminationPredicateFactoryImpl : public OptionBasedFactoryImpl,
@@ -5,6 +5,8 @@
 
 #include "source/common/utility.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -20,6 +22,11 @@ FlushWorkerImpl::FlushWorkerImpl(const std::chrono::milliseconds& stats_flush_in
   }
 }
 
+void FlushWorkerImpl::addIntervalRecorder(absl::string_view id,
+                                          HdrIntervalRecorderSharedPtr recorder) {
+  interval_sampler_.addRecorder(id, std::move(recorder));
+}
+
 void FlushWorkerImpl::work() {
   stat_flush_timer_ = dispatcher_->createTimer([this]() -> void { flushStats(); });
   stat_flush_timer_->enableTimer(stats_flush_interval_);
@@ -38,6 +45,7 @@ void FlushWorkerImpl::shutdownThread() {
 void FlushWorkerImpl::flushStats() {
   Envoy::Thread::SkipAsserts skip;
 
+  sampleIntervalRecorders();
   // Create a snapshot and flush to all sinks.
   Envoy::Server::InstanceUtil::flushMetricsToSinks(stats_sinks_, store_, cluster_manager_,
                                                    time_source_);
@@ -47,5 +55,23 @@ void FlushWorkerImpl::flushStats() {
   }
 }
 
+void FlushWorkerImpl::sampleIntervalRecorders() {
+  Envoy::Stats::Scope& scope = *store_.rootScope();
+  for (const std::unique_ptr<HdrStatistic>& interval : interval_sampler_.sample()) {
+    const std::vector<std::pair<absl::string_view, uint64_t>> values = {
+        {"count", interval->count()},
+        {"p50", interval->valueAtPercentile(50)},
+        {"p90", interval->valueAtPercentile(90)},
+        {"p99", interval->valueAtPercentile(99)},
+        {"p999", interval->valueAtPercentile(99.9)}};
+    for (const auto& [suffix, value] : values) {
+      scope
+          .gaugeFromString(absl::StrCat("interval.", interval->id(), ".", suffix),
+                           Envoy::Stats::Gauge::ImportMode::NeverImport)
+          .set(value);
+    }
+  }
+}
+
 } // namespace Client
 } // namespace Nighthawk
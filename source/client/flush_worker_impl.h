@@ -3,6 +3,7 @@
 // Flush worker implementation. Flush worker periodically flushes metrics
 // snapshot to all configured stats sinks in Nighthawk.
 
+#include <string>
 #include <vector>
 
 #include "envoy/api/api.h"
@@ -12,6 +13,7 @@
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "source/common/statistic_impl.h"
 #include "source/common/worker_impl.h"
 
 namespace Nighthawk {
@@ -22,6 +24,8 @@ namespace Client {
 // Flush worker periodically flushes metrics snapshot to all configured stats sinks in Nighthawk. It
 // will keep running until exitDispatcher() gets called after all client workers are completed in
 // process_impl.cc. It will make the last flush before shutdown in shutdownThread().
+// Before each flush, it also samples the interval recorders that have been added to it, and
+// publishes live percentiles of the latencies recorded since the previous flush as gauges.
 class FlushWorkerImpl : public WorkerImpl {
 public:
   // Constructor to call parent class's constructor and initialize member
@@ -41,6 +45,15 @@ public:
 
   void shutdownThread() override;
 
+  // Adds an interval recorder to sample on each flush. Recorders added with the same id, e.g. the
+  // same statistic of different client workers, are merged. For each id, the gauges
+  // interval.<id>.count and interval.<id>.p50, p90, p99 and p999 report on the values recorded
+  // since the previous flush. The flush worker samples as a reader of its own, so other readers of
+  // the recorder are unaffected. Must be called before start().
+  // @param id the id of the statistic that feeds the recorder.
+  // @param recorder the interval recorder to sample.
+  void addIntervalRecorder(absl::string_view id, HdrIntervalRecorderSharedPtr recorder);
+
   // exitDispatcher() stops the dispatcher and the flush timer running in flush worker. It must be
   // called after all client workers are completed in process_impl.cc to make sure all metrics will
   // be flushed.
@@ -53,11 +66,14 @@ private:
   // Flush the stats sinks. Note: stats flushing may not be synchronous, depending on each stat
   // sink's implementation. Therefore, this function may return prior to flushing taking place.
   void flushStats();
+  // Samples all interval recorders, and updates the gauges that report on them.
+  void sampleIntervalRecorders();
 
   std::list<std::unique_ptr<Envoy::Stats::Sink>> stats_sinks_;
   const std::chrono::milliseconds stats_flush_interval_;
   Envoy::Event::TimerPtr stat_flush_timer_;
   Envoy::Upstream::ClusterManager& cluster_manager_;
+  HdrIntervalSampler interval_sampler_;
 };
 
 } // namespace Client
@@ -12,12 +12,14 @@
 #include "api/client/options.pb.validate.h"
 
 #include "source/client/output_formatter_impl.h"
+#include "source/common/thread_placement.h"
 #include "source/common/uri_impl.h"
 #include "source/common/utility.h"
 #include "source/common/version_info.h"
 
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "fmt/ranges.h"
 
@@ -246,13 +248,13 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
                   max_concurrent_streams_),
       false, 0, "uint32_t", cmd);
 
-  std::vector<std::string> sequencer_idle_strategies = {"spin", "poll", "sleep"};
+  std::vector<std::string> sequencer_idle_strategies = {"spin", "poll", "sleep", "timer"};
   TCLAP::ValuesConstraint<std::string> sequencer_idle_strategies_allowed(sequencer_idle_strategies);
   TCLAP::ValueArg<std::string> sequencer_idle_strategy(
       "", "sequencer-idle-strategy",
       fmt::format(
-          "Choose between using a busy spin/yield loop or have the thread poll or sleep while "
-          "waiting for the next scheduled request (default: {}).",
+          "Choose between using a busy spin/yield loop, have the thread poll or sleep, or arm a "
+          "timer for the next scheduled request while waiting for it (default: {}).",
           absl::AsciiStrToLower(
               nighthawk::client::SequencerIdleStrategy_SequencerIdleStrategyOptions_Name(
                   sequencer_idle_strategy_))),
@@ -313,10 +315,11 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
 
   TCLAP::MultiArg<std::string> multi_target_endpoints(
       "", "multi-target-endpoint",
-      "Target endpoint in the form IPv4:port, [IPv6]:port, or DNS:port. "
+      "Target endpoint in the form IPv4:port, [IPv6]:port, or DNS:port, optionally followed by "
+      "@weight to set the relative share of traffic the endpoint receives (default: 1). "
       "This argument is intended to be specified multiple times. "
-      "Nighthawk will spread traffic across all endpoints with "
-      "round robin distribution. "
+      "Nighthawk will spread traffic across all endpoints according to "
+      "--multi-target-lb-policy, and reports latencies and response counters per endpoint. "
       "Mutually exclusive with providing a URI.",
       false, "string", cmd);
   TCLAP::ValueArg<std::string> multi_target_path(
@@ -330,6 +333,24 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
       "Use HTTPS to connect to the target endpoints. Otherwise HTTP is used. "
       "Mutually exclusive with providing a URI.",
       cmd);
+  std::vector<std::string> multi_target_lb_policies = {"round_robin", "least_request", "random",
+                                                       "ring_hash", "maglev"};
+  TCLAP::ValuesConstraint<std::string> multi_target_lb_policies_allowed(multi_target_lb_policies);
+  TCLAP::ValueArg<std::string> multi_target_lb_policy(
+      "", "multi-target-lb-policy",
+      fmt::format("How traffic is distributed across the --multi-target-endpoint endpoints. "
+                  "'ring_hash' and 'maglev' hash the value of --multi-target-hash-header. "
+                  "(default: {}).",
+                  absl::AsciiStrToLower(
+                      nighthawk::client::MultiTargetLbPolicy_MultiTargetLbPolicyOptions_Name(
+                          multi_target_lb_policy_))),
+      false, "", &multi_target_lb_policies_allowed, cmd);
+  TCLAP::ValueArg<std::string> multi_target_hash_header(
+      "", "multi-target-hash-header",
+      "The request header whose value is hashed to pick an endpoint. Required with "
+      "--multi-target-lb-policy ring_hash or maglev, and only allowed with those. Requests that "
+      "lack the header go to a random endpoint.",
+      false, "", "string", cmd);
 
   TCLAP::MultiArg<std::string> labels("", "label",
                                       "Label. Allows specifying multiple labels which will be "
@@ -361,6 +382,99 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
       "test_value:\"3\"}}",
       false, "", "string", cmd);
 
+  TCLAP::ValueArg<uint32_t> shared_request_source_capacity(
+      "", "shared-request-source-capacity",
+      "When set to a value larger than 0, create a single request source that is shared by all "
+      "workers, instead of one per worker. Requests are buffered in a ring that holds at least "
+      "this many requests. With --request-source, only a single gRPC stream will be opened, which "
+      "the first worker tops the ring up from as it draws requests. The other workers are then "
+      "paced by the first one. Workers that find the ring empty increment their shared_request_source_starved counter. "
+      "Default: 0 (disabled).",
+      false, 0, "uint32_t", cmd);
+
+  TCLAP::MultiArg<std::string> hdr_histogram_configs(
+      "", "hdr-histogram-config",
+      "Range and precision of an HdrHistogram backed statistic, as its id, the highest trackable "
+      "value (nanoseconds for latencies) and the number of significant digits (1-5). Larger "
+      "values are dropped. The id '*' applies to all statistics without an entry of their own. A "
+      "smaller range or precision takes less memory per statistic. Example: "
+      "benchmark_http_client.queue_to_connect:1000000000:3. Default: a range of 60 seconds at 4 "
+      "significant digits.",
+      false, "string:uint64_t:uint32_t", cmd);
+
+  TCLAP::MultiArg<std::string> statistic_backends(
+      "", "statistic-backend",
+      "Backend of a statistic, as its id and one of hdr, circllhist, streaming, none or sketch. "
+      "hdr is exact to the configured number of significant digits, circllhist is compact but of "
+      "low precision, streaming only tracks the count, mean, standard deviation, min and max, "
+      "none discards all values, and sketch reports percentiles within 1% of the exact value. "
+      "The id '*' applies to all statistics without an entry of their own. Example: "
+      "--statistic-backend *:none --statistic-backend "
+      "benchmark_http_client.request_to_response:hdr. Default: hdr for latencies, streaming for "
+      "response sizes.",
+      false, "string:string", cmd);
+
+  TCLAP::ValueArg<uint32_t> progress_report_interval(
+      "", "progress-report-interval",
+      "When set to a value larger than 0, the NighthawkService streams a progress report every "
+      "this many seconds while the execution is running, holding the counter increments and "
+      "latency statistics of the interval since the previous report. The CLI logs the counters of "
+      "each progress report, also when it executes remotely through --nighthawk-service. "
+      "Default: 0 (disabled).",
+      false, 0, "uint32_t", cmd);
+
+  std::vector<std::string> histogram_encodings = {"percentiles", "native",
+                                                  "percentiles_and_native"};
+  TCLAP::ValuesConstraint<std::string> histogram_encodings_allowed(histogram_encodings);
+  TCLAP::ValueArg<std::string> histogram_encoding(
+      "", "histogram-encoding",
+      fmt::format(
+          "How histograms are encoded in the output. 'native' embeds the compact native "
+          "HdrHistogram encoding instead of a list of percentiles, which allows exact merging "
+          "downstream. Output formats other than json and yaml render it back into percentiles. "
+          "(default: {}).",
+          absl::AsciiStrToLower(nighthawk::client::HistogramEncoding_HistogramEncodingOptions_Name(
+              histogram_encoding_))),
+      false, "", &histogram_encodings_allowed, cmd);
+
+  TCLAP::ValueArg<std::string> worker_cpus(
+      "", "worker-cpus",
+      "CPUs to pin the client workers to, in the format used by taskset -c, e.g. '0-3,8'. Linux "
+      "only. Worker n is pinned to the n-th CPU listed, wrapping around when there are more "
+      "workers than CPUs. When --concurrency is 'auto', one worker is started per CPU listed. "
+      "Default: workers are not pinned.",
+      false, "", "cpu list", cmd);
+
+  TCLAP::ValueArg<uint32_t> flush_worker_cpu(
+      "", "flush-worker-cpu",
+      "CPU to pin the worker that flushes stats sinks to. Linux only. Default: not pinned.", false,
+      0, "uint32_t", cmd);
+
+  TCLAP::SwitchArg numa_local_allocation(
+      "", "numa-local-allocation",
+      "Preferably place memory allocated by each client worker on the NUMA node of the CPU it is "
+      "pinned to. Linux only, requires --worker-cpus. Default is false.",
+      cmd);
+
+  TCLAP::ValueArg<std::string> request_event_log(
+      "", "request-event-log",
+      "Path of a file to record every request in, as a fixed-size binary record holding its "
+      "start, connect, first byte and completion times, status, byte counts, connection, worker "
+      "and request index. Records are buffered per worker and written by a background thread; "
+      "when a buffer fills up, records are dropped. nighthawk_output_transform "
+      "--request-event-log turns the file into csv or time-bucketed histograms. "
+      "Default: not recorded.",
+      false, "", "string", cmd);
+
+  TCLAP::ValueArg<uint32_t> time_slice_interval(
+      "", "time-slice-interval",
+      "When set to a value larger than 0, the latency statistics and counters of the global "
+      "result are also recorded in time slices of this many seconds, to show how they evolve "
+      "over the execution. Slices are aligned to multiples of the interval since the epoch, so "
+      "that they can be merged across executions when --histogram-encoding includes native. "
+      "Default: 0 (disabled).",
+      false, 0, "uint32_t", cmd);
+
   TCLAP::ValueArg<std::string> rate_limiter_plugin_config(
       "", "rate-limiter-plugin-config",
       "Rate Limiter plugin configuration in json. "
@@ -545,6 +659,65 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
                    "Failed to parse sequencer idle strategy");
   }
   TCLAP_SET_IF_SPECIFIED(request_source, request_source_);
+  TCLAP_SET_IF_SPECIFIED(shared_request_source_capacity, shared_request_source_capacity_);
+  TCLAP_SET_IF_SPECIFIED(progress_report_interval, progress_report_interval_);
+  if (histogram_encoding.isSet()) {
+    std::string upper_cased = histogram_encoding.getValue();
+    absl::AsciiStrToUpper(&upper_cased);
+    RELEASE_ASSERT(nighthawk::client::HistogramEncoding::HistogramEncodingOptions_Parse(
+                       upper_cased, &histogram_encoding_),
+                   "Failed to parse histogram encoding");
+  }
+  if (worker_cpus.isSet()) {
+    absl::StatusOr<std::vector<uint32_t>> cpus =
+        ThreadPlacement::parseCpuList(worker_cpus.getValue());
+    if (!cpus.ok()) {
+      throw MalformedArgvException(
+          fmt::format("Invalid value for --worker-cpus: {}", cpus.status().message()));
+    }
+    worker_cpus_ = *std::move(cpus);
+  }
+  if (flush_worker_cpu.isSet()) {
+    flush_worker_cpu_ = flush_worker_cpu.getValue();
+  }
+  TCLAP_SET_IF_SPECIFIED(numa_local_allocation, numa_local_allocation_);
+  TCLAP_SET_IF_SPECIFIED(request_event_log, request_event_log_);
+  TCLAP_SET_IF_SPECIFIED(time_slice_interval, time_slice_interval_);
+  for (const std::string& hdr_histogram_config : hdr_histogram_configs) {
+    // Split from the right, so that ids may contain ':', like those of endpoint statistics.
+    const std::vector<absl::string_view> parts = absl::StrSplit(hdr_histogram_config, ':');
+    uint64_t highest_trackable_value = 0;
+    uint32_t significant_digits = 0;
+    if (parts.size() < 3 ||
+        !absl::SimpleAtoi(parts[parts.size() - 2], &highest_trackable_value) ||
+        !absl::SimpleAtoi(parts[parts.size() - 1], &significant_digits)) {
+      throw MalformedArgvException(
+          fmt::format("--hdr-histogram-config must be in the format "
+                      "id:highest_trackable_value:significant_digits. Got '{}'",
+                      hdr_histogram_config));
+    }
+    const std::string id = absl::StrJoin(parts.begin(), parts.end() - 2, ":");
+    nighthawk::client::HdrHistogramConfig& config = hdr_histogram_configs_[id];
+    config.mutable_highest_trackable_value()->set_value(highest_trackable_value);
+    config.mutable_significant_digits()->set_value(significant_digits);
+  }
+  for (const std::string& statistic_backend : statistic_backends) {
+    const size_t separator = statistic_backend.rfind(':');
+    nighthawk::client::StatisticBackend::StatisticBackendOptions backend;
+    std::string upper_cased =
+        separator == std::string::npos ? "" : statistic_backend.substr(separator + 1);
+    absl::AsciiStrToUpper(&upper_cased);
+    if (separator == std::string::npos ||
+        !nighthawk::client::StatisticBackend::StatisticBackendOptions_Parse(upper_cased,
+                                                                            &backend) ||
+        backend == nighthawk::client::StatisticBackend::DEFAULT) {
+      throw MalformedArgvException(
+          fmt::format("--statistic-backend must be in the format id:backend, with backend one of "
+                      "hdr, circllhist, streaming, none or sketch. Got '{}'",
+                      statistic_backend));
+    }
+    statistic_backends_[statistic_backend.substr(0, separator)] = backend;
+  }
 
   if (experimental_h1_connection_reuse_strategy.isSet()) {
     std::string upper_cased = experimental_h1_connection_reuse_strategy.getValue();
@@ -580,18 +753,40 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv) {
   TCLAP_SET_IF_SPECIFIED(nighthawk_service, nighthawk_service_);
   TCLAP_SET_IF_SPECIFIED(multi_target_use_https, multi_target_use_https_);
   TCLAP_SET_IF_SPECIFIED(multi_target_path, multi_target_path_);
+  if (multi_target_lb_policy.isSet()) {
+    std::string upper_cased = multi_target_lb_policy.getValue();
+    absl::AsciiStrToUpper(&upper_cased);
+    RELEASE_ASSERT(nighthawk::client::MultiTargetLbPolicy::MultiTargetLbPolicyOptions_Parse(
+                       upper_cased, &multi_target_lb_policy_),
+                   "Failed to parse multi target lb policy");
+  }
+  TCLAP_SET_IF_SPECIFIED(multi_target_hash_header, multi_target_hash_header_);
   if (multi_target_endpoints.isSet()) {
-    for (const std::string& host_port : multi_target_endpoints.getValue()) {
+    for (const std::string& endpoint_spec : multi_target_endpoints.getValue()) {
+      absl::string_view host_port = endpoint_spec;
+      uint32_t weight = 0;
+      const size_t weight_separator = host_port.rfind('@');
+      if (weight_separator != absl::string_view::npos) {
+        if (!absl::SimpleAtoi(host_port.substr(weight_separator + 1), &weight) || weight == 0) {
+          throw MalformedArgvException(fmt::format(
+              "--multi-target-endpoint weight must be a positive integer. Got '{}'",
+              endpoint_spec));
+        }
+        host_port = host_port.substr(0, weight_separator);
+      }
       std::string host;
       int port;
-      if (!Utility::parseHostPort(host_port, &host, &port)) {
+      if (!Utility::parseHostPort(std::string(host_port), &host, &port)) {
         throw MalformedArgvException(fmt::format("--multi-target-endpoint must be in the format "
                                                  "IPv4:port, [IPv6]:port, or DNS:port. Got '{}'",
-                                                 host_port));
+                                                 endpoint_spec));
       }
       nighthawk::client::MultiTarget::Endpoint endpoint;
       endpoint.mutable_address()->set_value(host);
       endpoint.mutable_port()->set_value(port);
+      if (weight > 0) {
+        endpoint.mutable_weight()->set_value(weight);
+      }
       multi_target_endpoints_.push_back(endpoint);
     }
   }
@@ -852,6 +1047,10 @@ OptionsImpl::OptionsImpl(const nighthawk::client::CommandLineOptions& options) {
          options.multi_target().endpoints()) {
       multi_target_endpoints_.push_back(endpoint);
     }
+    multi_target_lb_policy_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options.multi_target(), lb_policy,
+                                                              multi_target_lb_policy_);
+    multi_target_hash_header_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+        options.multi_target(), hash_header, multi_target_hash_header_);
   }
 
   h2_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, h2, h2_);
@@ -917,6 +1116,29 @@ OptionsImpl::OptionsImpl(const nighthawk::client::CommandLineOptions& options) {
     rate_limiter_plugin_config_.emplace(envoy::config::core::v3::TypedExtensionConfig());
     rate_limiter_plugin_config_.value().MergeFrom(options.rate_limiter_plugin_config());
   }
+  shared_request_source_capacity_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      options, shared_request_source_capacity, shared_request_source_capacity_);
+  progress_report_interval_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, progress_report_interval, progress_report_interval_);
+  histogram_encoding_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, histogram_encoding, histogram_encoding_);
+  worker_cpus_.assign(options.worker_cpus().begin(), options.worker_cpus().end());
+  if (options.has_flush_worker_cpu()) {
+    flush_worker_cpu_ = options.flush_worker_cpu().value();
+  }
+  numa_local_allocation_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, numa_local_allocation, numa_local_allocation_);
+  request_event_log_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, request_event_log, request_event_log_);
+  time_slice_interval_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, time_slice_interval, time_slice_interval_);
+  for (const auto& [id, config] : options.hdr_histogram_configs()) {
+    hdr_histogram_configs_[id] = config;
+  }
+  for (const auto& [id, backend] : options.statistic_backends()) {
+    statistic_backends_[id] =
+        static_cast<nighthawk::client::StatisticBackend::StatisticBackendOptions>(backend);
+  }
 
   max_pending_requests_ =
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, max_pending_requests, max_pending_requests_);
@@ -1049,7 +1271,7 @@ void OptionsImpl::validate() const {
       throw MalformedArgvException(fmt::format("Invalid target URI: ''", uri_.value()));
     }
     if (!multi_target_endpoints_.empty() || !multi_target_path_.empty() ||
-        multi_target_use_https_) {
+        multi_target_use_https_ || !multi_target_hash_header_.empty()) {
       throw MalformedArgvException("URI and --multi-target-* options cannot both be specified.");
     }
   } else {
@@ -1059,6 +1281,16 @@ void OptionsImpl::validate() const {
     if (multi_target_path_.empty()) {
       throw MalformedArgvException("--multi-target-path must be specified.");
     }
+    const bool hashing =
+        multi_target_lb_policy_ == nighthawk::client::MultiTargetLbPolicy::RING_HASH ||
+        multi_target_lb_policy_ == nighthawk::client::MultiTargetLbPolicy::MAGLEV;
+    if (hashing != !multi_target_hash_header_.empty()) {
+      throw MalformedArgvException("--multi-target-hash-header is required with, and only allowed "
+                                   "with, --multi-target-lb-policy ring_hash or maglev.");
+    }
+  }
+  if (numa_local_allocation_ && worker_cpus_.empty()) {
+    throw MalformedArgvException("--numa-local-allocation requires --worker-cpus.");
   }
 
   try {
@@ -1104,6 +1336,13 @@ CommandLineOptionsPtr OptionsImpl::toCommandLineOptionsInternal() const {
       nighthawk::client::MultiTarget::Endpoint* proto_endpoint = multi_target->add_endpoints();
       proto_endpoint->mutable_address()->set_value(endpoint.address().value());
       proto_endpoint->mutable_port()->set_value(endpoint.port().value());
+      if (endpoint.has_weight()) {
+        proto_endpoint->mutable_weight()->set_value(endpoint.weight().value());
+      }
+    }
+    multi_target->mutable_lb_policy()->set_value(multi_target_lb_policy_);
+    if (!multi_target_hash_header_.empty()) {
+      multi_target->mutable_hash_header()->set_value(multi_target_hash_header_);
     }
   }
   command_line_options->mutable_concurrency()->set_value(concurrency_);
@@ -1145,6 +1384,29 @@ CommandLineOptionsPtr OptionsImpl::toCommandLineOptionsInternal() const {
     *(command_line_options->mutable_rate_limiter_plugin_config()) =
         rate_limiter_plugin_config_.value();
   }
+  command_line_options->mutable_shared_request_source_capacity()->set_value(
+      shared_request_source_capacity_);
+  command_line_options->mutable_progress_report_interval()->set_value(progress_report_interval_);
+  command_line_options->mutable_histogram_encoding()->set_value(histogram_encoding_);
+  for (const uint32_t cpu : worker_cpus_) {
+    command_line_options->add_worker_cpus(cpu);
+  }
+  if (flush_worker_cpu_.has_value()) {
+    command_line_options->mutable_flush_worker_cpu()->set_value(flush_worker_cpu_.value());
+  }
+  command_line_options->mutable_numa_local_allocation()->set_value(numa_local_allocation_);
+  if (!request_event_log_.empty()) {
+    command_line_options->mutable_request_event_log()->set_value(request_event_log_);
+  }
+  command_line_options->mutable_time_slice_interval()->set_value(time_slice_interval_);
+  auto hdr_histogram_configs_option = command_line_options->mutable_hdr_histogram_configs();
+  for (const auto& [id, config] : hdr_histogram_configs_) {
+    (*hdr_histogram_configs_option)[id] = config;
+  }
+  auto statistic_backends_option = command_line_options->mutable_statistic_backends();
+  for (const auto& [id, backend] : statistic_backends_) {
+    (*statistic_backends_option)[id] = backend;
+  }
 
   // Only set the tls context if needed, to avoid a warning being logged about field deprecation.
   // Ideally this would follow the way transport_socket uses std::optional below.
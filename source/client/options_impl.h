@@ -93,6 +93,19 @@ public:
   rateLimiterPluginConfig() const override {
     return rate_limiter_plugin_config_;
   }
+  uint32_t sharedRequestSourceCapacity() const override { return shared_request_source_capacity_; }
+  uint32_t progressReportInterval() const override { return progress_report_interval_; }
+  nighthawk::client::HistogramEncoding::HistogramEncodingOptions
+  histogramEncoding() const override {
+    return histogram_encoding_;
+  }
+  std::vector<uint32_t> workerCpus() const override { return worker_cpus_; }
+  std::optional<uint32_t> flushWorkerCpu() const override { return flush_worker_cpu_; }
+  bool numaLocalAllocation() const override { return numa_local_allocation_; }
+  std::string requestEventLog() const override { return request_event_log_; }
+  uint32_t timeSliceInterval() const override { return time_slice_interval_; }
+  HdrHistogramConfigMap hdrHistogramConfigs() const override { return hdr_histogram_configs_; }
+  StatisticBackendMap statisticBackends() const override { return statistic_backends_; }
 
   std::string trace() const override { return trace_; }
   nighthawk::client::H1ConnectionReuseStrategy::H1ConnectionReuseStrategyOptions
@@ -113,6 +126,11 @@ public:
   }
   std::string multiTargetPath() const override { return multi_target_path_; }
   bool multiTargetUseHttps() const override { return multi_target_use_https_; }
+  nighthawk::client::MultiTargetLbPolicy::MultiTargetLbPolicyOptions
+  multiTargetLbPolicy() const override {
+    return multi_target_lb_policy_;
+  }
+  std::string multiTargetHashHeader() const override { return multi_target_hash_header_; }
   bool simpleWarmup() const override { return simple_warmup_; }
   bool noDuration() const override { return no_duration_; }
   std::vector<envoy::config::metrics::v3::StatsSink> statsSinks() const override {
@@ -175,6 +193,17 @@ private:
   std::optional<envoy::config::core::v3::TransportSocket> transport_socket_;
   std::optional<envoy::config::core::v3::TypedExtensionConfig> request_source_plugin_config_;
   std::optional<envoy::config::core::v3::TypedExtensionConfig> rate_limiter_plugin_config_;
+  uint32_t shared_request_source_capacity_{0};
+  uint32_t progress_report_interval_{0};
+  nighthawk::client::HistogramEncoding::HistogramEncodingOptions histogram_encoding_{
+      nighthawk::client::HistogramEncoding::PERCENTILES};
+  std::vector<uint32_t> worker_cpus_;
+  std::optional<uint32_t> flush_worker_cpu_;
+  bool numa_local_allocation_{false};
+  std::string request_event_log_;
+  uint32_t time_slice_interval_{0};
+  HdrHistogramConfigMap hdr_histogram_configs_;
+  StatisticBackendMap statistic_backends_;
 
   uint32_t max_pending_requests_{0};
   // This default is based the minimum recommendation for SETTINGS_MAX_CONCURRENT_STREAMS over at
@@ -198,6 +227,9 @@ private:
   std::vector<nighthawk::client::MultiTarget::Endpoint> multi_target_endpoints_;
   std::string multi_target_path_;
   bool multi_target_use_https_{false};
+  nighthawk::client::MultiTargetLbPolicy::MultiTargetLbPolicyOptions multi_target_lb_policy_{
+      nighthawk::client::MultiTargetLbPolicy::ROUND_ROBIN};
+  std::string multi_target_hash_header_;
   std::vector<std::string> labels_;
   bool simple_warmup_{false};
   bool no_duration_{false};
@@ -3,16 +3,19 @@
 #include <google/protobuf/util/time_util.h>
 
 #include <chrono>
+#include <iterator>
 #include <sstream>
 
 #include "external/envoy/source/common/protobuf/utility.h"
 
+#include "source/common/statistic_impl.h"
 #include "source/common/version_info.h"
 
 namespace Nighthawk {
 namespace Client {
 
-OutputCollectorImpl::OutputCollectorImpl(Envoy::TimeSource& time_source, const Options& options) {
+OutputCollectorImpl::OutputCollectorImpl(Envoy::TimeSource& time_source, const Options& options)
+    : histogram_encoding_(options.histogramEncoding()) {
   *(output_.mutable_timestamp()) = Envoy::Protobuf::util::TimeUtil::NanosecondsToTimestamp(
       std::chrono::duration_cast<std::chrono::nanoseconds>(
           time_source.systemTime().time_since_epoch())
@@ -23,6 +26,28 @@ OutputCollectorImpl::OutputCollectorImpl(Envoy::TimeSource& time_source, const O
 
 nighthawk::client::Output OutputCollectorImpl::toProto() const { return output_; }
 
+void OutputCollectorImpl::addHistogramEncoding(const Statistic& statistic,
+                                               nighthawk::client::Statistic& proto) const {
+  if (histogram_encoding_ != nighthawk::client::HistogramEncoding::NATIVE &&
+      histogram_encoding_ != nighthawk::client::HistogramEncoding::PERCENTILES_AND_NATIVE) {
+    return;
+  }
+  if (dynamic_cast<const HdrStatistic*>(&statistic) == nullptr || statistic.count() == 0) {
+    return;
+  }
+  absl::StatusOr<std::unique_ptr<std::istream>> encoding = statistic.serializeNative();
+  if (!encoding.ok()) {
+    ENVOY_LOG(warn, "Failed to encode histogram of '{}', keeping percentiles: {}", statistic.id(),
+              encoding.status().message());
+    return;
+  }
+  proto.set_hdr_histogram(
+      std::string(std::istreambuf_iterator<char>(**encoding), std::istreambuf_iterator<char>()));
+  if (histogram_encoding_ == nighthawk::client::HistogramEncoding::NATIVE) {
+    proto.clear_percentiles();
+  }
+}
+
 void OutputCollectorImpl::addResult(
     absl::string_view name, const std::vector<StatisticPtr>& statistics,
     const std::map<std::string, uint64_t>& counters,
@@ -38,14 +63,7 @@ void OutputCollectorImpl::addResult(
             .count());
   }
   for (auto& statistic : statistics) {
-    // TODO(#292): Looking at if the statistic id ends with "_size" to determine how it should be
-    // serialized is kind of hacky. Maybe we should have a lookup table of sorts, to determine how
-    // statistics should we serialized. Doing so may give us a canonical place to consolidate their
-    // ids as well too.
-    Statistic::SerializationDomain serialization_domain =
-        absl::EndsWith(statistic->id(), "_size") ? Statistic::SerializationDomain::RAW
-                                                 : Statistic::SerializationDomain::DURATION;
-    *(result->add_statistics()) = statistic->toProto(serialization_domain);
+    *result->add_statistics() = toStatisticProto(*statistic);
   }
   for (const auto& counter : counters) {
     auto new_counters = result->add_counters();
@@ -59,6 +77,54 @@ void OutputCollectorImpl::addResult(
        user_defined_output_results) {
     *result->add_user_defined_outputs() = user_defined_result;
   }
+  const auto pending = pending_time_slices_.find(std::string(name));
+  if (pending != pending_time_slices_.end()) {
+    for (nighthawk::client::TimeSlice& time_slice : pending->second) {
+      *result->add_time_slices() = std::move(time_slice);
+    }
+    pending_time_slices_.erase(pending);
+  }
+}
+
+void OutputCollectorImpl::addTimeSlice(absl::string_view result_name,
+                                       const Envoy::SystemTime& start,
+                                       const std::chrono::nanoseconds duration,
+                                       const std::vector<StatisticPtr>& statistics,
+                                       const std::map<std::string, uint64_t>& counters) {
+  nighthawk::client::TimeSlice time_slice;
+  *time_slice.mutable_start() = Envoy::Protobuf::util::TimeUtil::NanosecondsToTimestamp(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count());
+  *time_slice.mutable_duration() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(duration.count());
+  for (const StatisticPtr& statistic : statistics) {
+    *time_slice.add_statistics() = toStatisticProto(*statistic);
+  }
+  for (const auto& [name, value] : counters) {
+    nighthawk::client::Counter* counter = time_slice.add_counters();
+    counter->set_name(name);
+    counter->set_value(value);
+  }
+  for (nighthawk::client::Result& result : *output_.mutable_results()) {
+    if (result.name() == result_name) {
+      *result.add_time_slices() = std::move(time_slice);
+      return;
+    }
+  }
+  pending_time_slices_[std::string(result_name)].push_back(std::move(time_slice));
+}
+
+nighthawk::client::Statistic
+OutputCollectorImpl::toStatisticProto(const Statistic& statistic) const {
+  // TODO(#292): Looking at if the statistic id ends with "_size" to determine how it should be
+  // serialized is kind of hacky. Maybe we should have a lookup table of sorts, to determine how
+  // statistics should we serialized. Doing so may give us a canonical place to consolidate their
+  // ids as well too.
+  Statistic::SerializationDomain serialization_domain =
+      absl::EndsWith(statistic.id(), "_size") ? Statistic::SerializationDomain::RAW
+                                              : Statistic::SerializationDomain::DURATION;
+  nighthawk::client::Statistic proto = statistic.toProto(serialization_domain);
+  addHistogramEncoding(statistic, proto);
+  return proto;
 }
 
 } // namespace Client
@@ -1,16 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "envoy/common/time.h"
 
 #include "nighthawk/client/options.h"
 #include "nighthawk/client/output_collector.h"
 
+#include "external/envoy/source/common/common/logger.h"
+
 namespace Nighthawk {
 namespace Client {
 
-class OutputCollectorImpl : public OutputCollector {
+class OutputCollectorImpl : public OutputCollector,
+                            public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
 public:
   /**
    * @param time_source Time source that will be used to generate a timestamp in the output.
@@ -24,12 +30,27 @@ public:
                  const std::optional<Envoy::SystemTime>& first_acquisition_time,
                  const std::vector<nighthawk::client::UserDefinedOutput>&
                      user_defined_output_results) override;
+  void addTimeSlice(absl::string_view result_name, const Envoy::SystemTime& start,
+                    const std::chrono::nanoseconds duration,
+                    const std::vector<StatisticPtr>& statistics,
+                    const std::map<std::string, uint64_t>& counters) override;
+  void addWorkerPlacement(const nighthawk::client::WorkerPlacement& placement) override {
+    *output_.add_worker_placements() = placement;
+  }
   void setOutput(const nighthawk::client::Output& output) override { output_ = output; }
 
   nighthawk::client::Output toProto() const override;
 
 private:
+  nighthawk::client::Statistic toStatisticProto(const Statistic& statistic) const;
+  // Embeds the native encoding of HdrHistogram backed statistics, as selected by the histogram
+  // encoding option.
+  void addHistogramEncoding(const Statistic& statistic, nighthawk::client::Statistic& proto) const;
+
   nighthawk::client::Output output_;
+  // Time slices of results that have not been added yet, keyed by result name.
+  std::map<std::string, std::vector<nighthawk::client::TimeSlice>> pending_time_slices_;
+  const nighthawk::client::HistogramEncoding::HistogramEncodingOptions histogram_encoding_;
 };
 
 } // namespace Client
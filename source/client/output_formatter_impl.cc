@@ -1,12 +1,20 @@
 #include "source/client/output_formatter_impl.h"
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/json_util.h>
 #include <google/protobuf/util/time_util.h>
+#include <google/protobuf/util/type_resolver_util.h>
 
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
 #include <optional>
-#include <regex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "nighthawk/common/exception.h"
 
@@ -15,6 +23,7 @@
 #include "api/client/options.pb.h"
 #include "api/client/transform/fortio.pb.h"
 
+#include "source/common/statistic_impl.h"
 #include "source/common/version_info.h"
 
 #include "absl/status/statusor.h"
@@ -26,6 +35,72 @@ namespace Client {
 
 using ::nighthawk::client::Protocol;
 
+namespace {
+
+// Counts what is written to it, and throws it away.
+class DiscardingOutputStream : public Envoy::Protobuf::io::ZeroCopyOutputStream {
+public:
+  bool Next(void** data, int* size) override {
+    *data = buffer_;
+    *size = sizeof(buffer_);
+    byte_count_ += sizeof(buffer_);
+    return true;
+  }
+  void BackUp(int count) override { byte_count_ -= count; }
+  int64_t ByteCount() const override { return byte_count_; }
+
+private:
+  char buffer_[4096];
+  int64_t byte_count_{0};
+};
+
+/**
+ * Writes a message as pretty printed json, like Envoy::MessageUtil::getJsonStringFromMessage()
+ * formats it, without holding the json in memory. The json is produced from the binary encoding
+ * of the message, which is a fraction of its size.
+ *
+ * @param message The message to write.
+ * @param stream The stream to write to. Untouched when an error is returned.
+ * @return absl::Status An error if the message could not be converted to json.
+ */
+absl::Status writeJsonToStream(const Envoy::Protobuf::Message& message, std::ostream& stream) {
+  std::string binary;
+  {
+    Envoy::Protobuf::io::StringOutputStream binary_stream(&binary);
+    Envoy::Protobuf::io::CodedOutputStream coded_stream(&binary_stream);
+    // Orders map entries by key, like the json printer does for messages.
+    coded_stream.SetSerializationDeterministic(true);
+    if (!message.SerializeToCodedStream(&coded_stream)) {
+      return absl::Status(absl::StatusCode::kInternal,
+                          absl::StrCat("failed to serialize ", message.GetTypeName()));
+    }
+  }
+  const std::unique_ptr<Envoy::Protobuf::util::TypeResolver> type_resolver(
+      Envoy::Protobuf::util::NewTypeResolverForDescriptorPool(
+          "type.googleapis.com", Envoy::Protobuf::DescriptorPool::generated_pool()));
+  const std::string type_url = absl::StrCat("type.googleapis.com/", message.GetTypeName());
+  Envoy::Protobuf::util::JsonPrintOptions options;
+  options.preserve_proto_field_names = true;
+  options.add_whitespace = true;
+  options.always_print_fields_with_no_presence = true;
+  const auto convert = [&](Envoy::Protobuf::io::ZeroCopyOutputStream& output) {
+    Envoy::Protobuf::io::ArrayInputStream input(binary.data(), binary.size());
+    return Envoy::Protobuf::util::BinaryToJsonStream(type_resolver.get(), type_url, &input,
+                                                     &output, options);
+  };
+  // Conversion fails on e.g. an Any holding an unknown type. A dry run finds that out before
+  // anything is written, which is cheaper than holding the json.
+  DiscardingOutputStream dry_run;
+  absl::Status status = convert(dry_run);
+  if (!status.ok()) {
+    return status;
+  }
+  Envoy::Protobuf::io::OstreamOutputStream output(&stream);
+  return convert(output);
+}
+
+} // namespace
+
 std::vector<std::string> OutputFormatterImpl::getLowerCaseOutputFormats() {
   const Envoy::Protobuf::EnumDescriptor* enum_descriptor =
       nighthawk::client::OutputFormat::OutputFormatOptions_descriptor();
@@ -39,6 +114,44 @@ std::vector<std::string> OutputFormatterImpl::getLowerCaseOutputFormats() {
   return values;
 }
 
+absl::StatusOr<std::string>
+OutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
+  std::ostringstream stream;
+  const absl::Status status = formatProtoToStream(output, stream);
+  if (!status.ok()) {
+    return status;
+  }
+  return stream.str();
+}
+
+
+absl::Status OutputFormatterImpl::renderHistogramEncodings(nighthawk::client::Output& output) {
+  for (nighthawk::client::Result& result : *output.mutable_results()) {
+    for (nighthawk::client::Statistic& statistic : *result.mutable_statistics()) {
+      absl::Status status = HdrStatistic::renderPercentiles(statistic);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+    for (nighthawk::client::TimeSlice& time_slice : *result.mutable_time_slices()) {
+      for (nighthawk::client::Statistic& statistic : *time_slice.mutable_statistics()) {
+        absl::Status status = HdrStatistic::renderPercentiles(statistic);
+        if (!status.ok()) {
+          return status;
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool OutputFormatterImpl::rendersPercentiles(
+    nighthawk::client::OutputFormat::OutputFormatOptions format) {
+  // The structured formats are a faithful rendition of the output proto.
+  return format != nighthawk::client::OutputFormat::JSON &&
+         format != nighthawk::client::OutputFormat::YAML;
+}
+
 void OutputFormatterImpl::iteratePercentiles(
     const nighthawk::client::Statistic& statistic,
     const std::function<void(const nighthawk::client::Percentile&)>& callback) const {
@@ -55,10 +168,22 @@ void OutputFormatterImpl::iteratePercentiles(
   }
 }
 
-absl::StatusOr<std::string>
-ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-  std::stringstream ss;
-  ss << "Nighthawk - A layer 7 protocol benchmarking tool." << std::endl << std::endl;
+absl::Status
+ConsoleOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                                std::ostream& stream) const {
+  stream << "Nighthawk - A layer 7 protocol benchmarking tool." << std::endl << std::endl;
+  if (!output.worker_placements().empty()) {
+    stream << fmt::format("{:<{}}{:<{}}{}", "Worker placement", 40, "CPU", 12, "NUMA node")
+           << std::endl;
+    for (const auto& placement : output.worker_placements()) {
+      stream << fmt::format(
+                    "{:<{}}{:<{}}{}", placement.name(), 40, placement.cpu(), 12,
+                    placement.has_numa_node() ? fmt::format("{}", placement.numa_node().value())
+                                              : "-")
+             << std::endl;
+    }
+    stream << std::endl;
+  }
   for (const auto& result : output.results()) {
     if (result.name() == "global") {
       for (const auto& statistic : result.statistics()) {
@@ -76,50 +201,58 @@ ConsoleOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
                                          ? formatProtoDuration(statistic.pstdev())
                                          : fmt::format("{}", statistic.raw_pstdev());
 
-        ss << fmt::format("{} ({} samples)", statIdtoFriendlyStatName(statistic.id()),
-                          statistic.count())
-           << std::endl;
-        ss << fmt::format("  min: {} | ", s_min);
-        ss << fmt::format("mean: {} | ", s_mean);
-        ss << fmt::format("max: {} | ", s_max);
-        ss << fmt::format("pstdev: {}", s_pstdev) << std::endl;
+        stream << fmt::format("{} ({} samples)", statIdtoFriendlyStatName(statistic.id()),
+                              statistic.count())
+               << std::endl;
+        stream << fmt::format("  min: {} | ", s_min);
+        stream << fmt::format("mean: {} | ", s_mean);
+        stream << fmt::format("max: {} | ", s_max);
+        stream << fmt::format("pstdev: {}", s_pstdev) << std::endl;
+        if (statistic.dropped_count() > 0) {
+          stream << fmt::format("  dropped: {} (above the histogram range)",
+                                statistic.dropped_count())
+                 << std::endl;
+        }
 
         bool header_written = false;
-        iteratePercentiles(statistic, [&ss, this, &header_written](
+        iteratePercentiles(statistic, [&stream, this, &header_written](
                                           const nighthawk::client::Percentile& percentile) {
           const auto p = percentile.percentile();
           // Don't show the min / max, as we already show that above.
           if (p > 0 && p < 1) {
             if (!header_written) {
-              ss << std::endl
-                 << fmt::format("  {:<{}}{:<{}}{:<{}}", "Percentile", 12, "Count", 12, "Value", 15)
-                 << std::endl;
+              stream << std::endl
+                     << fmt::format("  {:<{}}{:<{}}{:<{}}", "Percentile", 12, "Count", 12, "Value",
+                                    15)
+                     << std::endl;
               header_written = true;
             }
             auto s_percentile = fmt::format("{:.{}g}", p, 8);
-            ss << fmt::format("  {:<{}}{:<{}}{:<{}}", s_percentile, 12, percentile.count(), 12,
-                              percentile.has_duration()
-                                  ? formatProtoDuration(percentile.duration())
-                                  : fmt::format("{}", static_cast<int64_t>(percentile.raw_value())),
-                              15)
-               << std::endl;
+            stream << fmt::format(
+                          "  {:<{}}{:<{}}{:<{}}", s_percentile, 12, percentile.count(), 12,
+                          percentile.has_duration()
+                              ? formatProtoDuration(percentile.duration())
+                              : fmt::format("{}", static_cast<int64_t>(percentile.raw_value())),
+                          15)
+                   << std::endl;
           }
         });
-        ss << std::endl;
+        stream << std::endl;
       }
-      ss << fmt::format("{:<{}}{:<{}}{}", "Counter", 40, "Value", 12, "Per second") << std::endl;
+      stream << fmt::format("{:<{}}{:<{}}{}", "Counter", 40, "Value", 12, "Per second")
+             << std::endl;
       for (const auto& counter : result.counters()) {
         const auto nanos =
             Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(result.execution_duration());
-        ss << fmt::format("{:<{}}{:<{}}{:.{}f}", counter.name(), 40, counter.value(), 12,
-                          counter.value() / (nanos / 1e9), 2)
-           << std::endl;
+        stream << fmt::format("{:<{}}{:<{}}{:.{}f}", counter.name(), 40, counter.value(), 12,
+                              counter.value() / (nanos / 1e9), 2)
+               << std::endl;
       }
-      ss << std::endl;
+      stream << std::endl;
     }
   }
 
-  return ss.str();
+  return absl::OkStatus();
 }
 
 std::string
@@ -136,8 +269,12 @@ std::string ConsoleOutputFormatterImpl::statIdtoFriendlyStatName(absl::string_vi
     return "Request start to response end";
   } else if (stat_id == "sequencer.callback") {
     return "Initiation to completion";
+  } else if (stat_id == "sequencer.intended_callback") {
+    return "Intended initiation to completion";
   } else if (stat_id == "sequencer.blocking") {
     return "Blocking. Results are skewed when significant numbers are reported here.";
+  } else if (stat_id == "sequencer.slippage") {
+    return "Initiation behind schedule. Nighthawk may be saturated when this grows large.";
   } else if (stat_id == "benchmark_http_client.response_body_size") {
     return "Response body size in bytes";
   } else if (stat_id == "benchmark_http_client.response_header_size") {
@@ -147,21 +284,24 @@ std::string ConsoleOutputFormatterImpl::statIdtoFriendlyStatName(absl::string_vi
   return std::string(stat_id);
 }
 
-absl::StatusOr<std::string>
-JsonOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-  return Envoy::MessageUtil::getJsonStringFromMessage(output, true, true).value();
+absl::Status
+JsonOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                             std::ostream& stream) const {
+  return writeJsonToStream(output, stream);
 }
 
-absl::StatusOr<std::string>
-YamlOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-  return Envoy::MessageUtil::getYamlStringFromMessage(output, true, true);
+absl::Status
+YamlOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                             std::ostream& stream) const {
+  // Envoy renders yaml from a json string, so the document is held in memory once here.
+  stream << Envoy::MessageUtil::getYamlStringFromMessage(output, true, true);
+  return absl::OkStatus();
 }
 
-absl::StatusOr<std::string>
-CsvOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-
-  std::stringstream ss;
-  ss << "Nighthawk - A layer 7 protocol benchmarking tool." << std::endl << std::endl;
+absl::Status
+CsvOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                            std::ostream& stream) const {
+  stream << "Nighthawk - A layer 7 protocol benchmarking tool." << std::endl << std::endl;
   for (const nighthawk::client::Result& result : output.results()) {
     if (result.name() == "global") {
       for (const nighthawk::client::Statistic& statistic : result.statistics()) {
@@ -179,52 +319,53 @@ CsvOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) con
                                          ? formatProtoDuration(statistic.pstdev())
                                          : fmt::format("{}", statistic.raw_pstdev());
 
-        ss << fmt::format("{} ({} samples)", statIdtoFriendlyStatName(statistic.id()),
-                          statistic.count())
-           << std::endl;
+        stream << fmt::format("{} ({} samples)", statIdtoFriendlyStatName(statistic.id()),
+                              statistic.count())
+               << std::endl;
 
         // Descriptive statistics
-        ss << "Min,Mean,Max,Pstdev" << std::endl;
-        ss << fmt::format("{},{},{},{}", s_min, s_mean, s_max, s_pstdev) << std::endl;
+        stream << "Min,Mean,Max,Pstdev" << std::endl;
+        stream << fmt::format("{},{},{},{}", s_min, s_mean, s_max, s_pstdev) << std::endl;
 
         bool header_written = false;
-        iteratePercentiles(statistic, [&ss, this, &header_written](
+        iteratePercentiles(statistic, [&stream, this, &header_written](
                                           const nighthawk::client::Percentile& percentile) {
           const double p = percentile.percentile();
           // Don't show the min / max, as we already show that above.
           if (p > 0 && p < 1) {
             // Table headers
             if (!header_written) {
-              ss << "Percentile,Count,Value(microseconds),Value" << std::endl;
+              stream << "Percentile,Count,Value(microseconds),Value" << std::endl;
               header_written = true;
             }
             std::string s_percentile = fmt::format("{:.{}g}", p, 8);
-            ss << fmt::format("{},{},{},{}", s_percentile, percentile.count(),
-                              Envoy::Protobuf::util::TimeUtil::DurationToMicroseconds(
-                                  percentile.duration()),
-                              percentile.has_duration()
-                                  ? formatProtoDuration(percentile.duration())
-                                  : fmt::format("{}", static_cast<int64_t>(percentile.raw_value())),
-                              15)
-               << std::endl;
+            stream << fmt::format(
+                          "{},{},{},{}", s_percentile, percentile.count(),
+                          Envoy::Protobuf::util::TimeUtil::DurationToMicroseconds(
+                              percentile.duration()),
+                          percentile.has_duration()
+                              ? formatProtoDuration(percentile.duration())
+                              : fmt::format("{}", static_cast<int64_t>(percentile.raw_value())),
+                          15)
+                   << std::endl;
           }
         });
-        ss << std::endl;
+        stream << std::endl;
       }
 
       // Counters
-      ss << fmt::format("{},{},{}", "Counter", "Value", "Per second") << std::endl;
+      stream << fmt::format("{},{},{}", "Counter", "Value", "Per second") << std::endl;
       for (const nighthawk::client::Counter& counter : result.counters()) {
         const int64_t nanos =
             Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(result.execution_duration());
-        ss << fmt::format("{},{},{:.{}f}", counter.name(), counter.value(),
-                          counter.value() / (nanos / 1e9), 2)
-           << std::endl;
+        stream << fmt::format("{},{},{:.{}f}", counter.name(), counter.value(),
+                              counter.value() / (nanos / 1e9), 2)
+               << std::endl;
       }
-      ss << std::endl;
+      stream << std::endl;
     }
   }
-  return ss.str();
+  return absl::OkStatus();
 }
 
 std::string
@@ -241,8 +382,12 @@ std::string CsvOutputFormatterImpl::statIdtoFriendlyStatName(absl::string_view s
     return "Request start to response end";
   } else if (stat_id == "sequencer.callback") {
     return "Initiation to completion";
+  } else if (stat_id == "sequencer.intended_callback") {
+    return "Intended initiation to completion";
   } else if (stat_id == "sequencer.blocking") {
     return "Blocking. Results are skewed when significant numbers are reported here.";
+  } else if (stat_id == "sequencer.slippage") {
+    return "Initiation behind schedule. Nighthawk may be saturated when this grows large.";
   } else if (stat_id == "benchmark_http_client.response_body_size") {
     return "Response body size in bytes";
   } else if (stat_id == "benchmark_http_client.response_header_size") {
@@ -252,9 +397,9 @@ std::string CsvOutputFormatterImpl::statIdtoFriendlyStatName(absl::string_view s
   return std::string(stat_id);
 }
 
-absl::StatusOr<std::string>
-DottedStringOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-  std::stringstream ss;
+absl::Status
+DottedStringOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                                     std::ostream& stream) const {
   for (const auto& result : output.results()) {
     for (const auto& statistic : result.statistics()) {
       const std::string prefix = fmt::format("{}.{}", result.name(), statistic.id());
@@ -279,33 +424,34 @@ DottedStringOutputFormatterImpl::formatProto(const nighthawk::client::Output& ou
                                       statistic.pstdev()))
               : fmt::format("{}", statistic.raw_pstdev());
 
-      ss << fmt::format("{}.samples: {}", prefix, statistic.count()) << std::endl;
-      ss << fmt::format("{}.mean: {}", prefix, s_mean) << std::endl;
-      ss << fmt::format("{}.pstdev: {}", prefix, s_pstdev) << std::endl;
-      ss << fmt::format("{}.min: {}", prefix, s_min) << std::endl;
-      ss << fmt::format("{}.max: {}", prefix, s_max) << std::endl;
+      stream << fmt::format("{}.samples: {}", prefix, statistic.count()) << std::endl;
+      stream << fmt::format("{}.mean: {}", prefix, s_mean) << std::endl;
+      stream << fmt::format("{}.pstdev: {}", prefix, s_pstdev) << std::endl;
+      stream << fmt::format("{}.min: {}", prefix, s_min) << std::endl;
+      stream << fmt::format("{}.max: {}", prefix, s_max) << std::endl;
 
-      iteratePercentiles(statistic, [&ss, prefix](const nighthawk::client::Percentile& percentile) {
+      iteratePercentiles(statistic, [&stream,
+                                     prefix](const nighthawk::client::Percentile& percentile) {
         const std::string percentile_prefix =
             fmt::format("{}.permilles-{:.{}f}", prefix, percentile.percentile() * 1000, 0);
-        ss << fmt::format("{}.count: {}", percentile_prefix, percentile.count()) << std::endl;
+        stream << fmt::format("{}.count: {}", percentile_prefix, percentile.count()) << std::endl;
         if (percentile.has_duration()) {
-          ss << fmt::format(
+          stream << fmt::format(
               "{}.microseconds: {}", percentile_prefix,
               Envoy::Protobuf::util::TimeUtil::DurationToMicroseconds(percentile.duration()));
         } else {
-          ss << fmt::format("{}.value: {}", percentile_prefix,
-                            static_cast<int64_t>(percentile.raw_value()));
+          stream << fmt::format("{}.value: {}", percentile_prefix,
+                                static_cast<int64_t>(percentile.raw_value()));
         }
-        ss << std::endl;
+        stream << std::endl;
       });
     }
     for (const auto& counter : result.counters()) {
       const std::string prefix = fmt::format("{}.{}", result.name(), counter.name());
-      ss << fmt::format("{}:{}", prefix, counter.value()) << std::endl;
+      stream << fmt::format("{}:{}", prefix, counter.value()) << std::endl;
     }
   }
-  return ss.str();
+  return absl::OkStatus();
 }
 
 std::optional<const nighthawk::client::Result>
@@ -358,8 +504,18 @@ FortioOutputFormatterImpl::durationToSeconds(const Envoy::Protobuf::Duration& du
   return Envoy::Protobuf::util::TimeUtil::DurationToNanoseconds(duration) / 1e9;
 }
 
-absl::StatusOr<std::string>
-FortioOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
+absl::Status
+FortioOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                               std::ostream& stream) const {
+  absl::StatusOr<nighthawk::client::FortioResult> fortio_result = renderFortioResult(output);
+  if (!fortio_result.ok()) {
+    return fortio_result.status();
+  }
+  return writeJsonToStream(*fortio_result, stream);
+}
+
+absl::StatusOr<nighthawk::client::FortioResult>
+FortioOutputFormatterImpl::renderFortioResult(const nighthawk::client::Output& output) const {
   nighthawk::client::FortioResult fortio_output;
   // Iff there's only a single worker we will have only a single result. Otherwise the number of
   // workers can be derived by substracting one from the number of results (for the
@@ -426,7 +582,7 @@ FortioOutputFormatterImpl::formatProto(const nighthawk::client::Output& output)
   if (statistic != nullptr) {
     fortio_output.mutable_headersizes()->CopyFrom(renderFortioDurationHistogram(*statistic));
   }
-  return Envoy::MessageUtil::getJsonStringFromMessage(fortio_output, true, true).value();
+  return fortio_output;
 }
 
 const nighthawk::client::DurationHistogram FortioOutputFormatterImpl::renderFortioDurationHistogram(
@@ -500,28 +656,216 @@ const nighthawk::client::DurationHistogram FortioOutputFormatterImpl::renderFort
   return fortio_histogram;
 }
 
-absl::StatusOr<std::string>
-FortioPedanticOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
-  absl::StatusOr<std::string> res_status = FortioOutputFormatterImpl::formatProto(output);
-  if (!res_status.ok()) {
-    return res_status;
-  }
-  std::string res = *res_status;
-  // clang-format off
-  // Fix two types of quirks. We disable linting because we use std::regex directly.
-  // This should be OK as the regular expression we use can be trusted.
-  // 1. We misdefined RequestedRPS as an int, whereas Fortio outputs that as a string.
-  res = std::regex_replace(res, std::regex(R"EOF("RequestedQPS"\: ([0-9]*))EOF"),
-                           R"EOF("RequestedQPS": "$1")EOF");
-  // 2. Our uint64's get serialized as json strings. Fortio outputs them as json integers.
-  // An example of a string that would match the regular expression below would be:
-  // "Count": "100", which then would be replaced to look like: "Count": 100.
-  // NOTE: [0-9][0-9][0-9] looks for string fields referring to http status codes, which get counted.
- res = std::regex_replace(
-      res, std::regex(R"EOF("([0-9][0-9][0-9]|Count|BytesSent|BytesReceived)"\: "([0-9]*)")EOF"),
-      R"EOF("$1": $2)EOF");
-  // clang-format on
-  return res;
+absl::Status
+FortioPedanticOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                                       std::ostream& stream) const {
+  absl::StatusOr<nighthawk::client::FortioResult> fortio_result = renderFortioResult(output);
+  if (!fortio_result.ok()) {
+    return fortio_result.status();
+  }
+  writeFortioJson(*fortio_result, stream);
+  return absl::OkStatus();
+}
+
+namespace {
+
+/**
+ * Writes pretty printed json in the layout of the protobuf json printer: one space of indentation
+ * per level, and empty objects and arrays on a single line.
+ */
+class JsonStreamWriter {
+public:
+  explicit JsonStreamWriter(std::ostream& stream) : stream_(stream) {}
+
+  void beginObject() {
+    beginValue();
+    open('{');
+  }
+  void beginObject(absl::string_view key) {
+    writeKey(key);
+    open('{');
+  }
+  void endObject() { close('}'); }
+  void beginArray(absl::string_view key) {
+    writeKey(key);
+    open('[');
+  }
+  void endArray() { close(']'); }
+
+  void writeString(absl::string_view key, absl::string_view value) {
+    writeKey(key);
+    writeQuoted(value);
+  }
+  void writeBool(absl::string_view key, bool value) {
+    writeKey(key);
+    stream_ << (value ? "true" : "false");
+  }
+  void writeUnsigned(absl::string_view key, uint64_t value, bool quoted) {
+    writeKey(key);
+    if (quoted) {
+      stream_ << '"' << value << '"';
+    } else {
+      stream_ << value;
+    }
+  }
+  void writeDouble(absl::string_view key, double value) {
+    writeKey(key);
+    // Like the protobuf json printer, we use the shortest of two precisions that round-trips, and
+    // quote the values json numbers can't represent.
+    if (std::isnan(value)) {
+      stream_ << "\"NaN\"";
+    } else if (std::isinf(value)) {
+      stream_ << (value > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    } else {
+      std::string formatted = fmt::format("{:.15g}", value);
+      if (std::strtod(formatted.c_str(), nullptr) != value) {
+        formatted = fmt::format("{:.17g}", value);
+      }
+      stream_ << formatted;
+    }
+  }
+
+  // Terminates the document.
+  void finish() { stream_ << std::endl; }
+
+private:
+  void beginValue() {
+    if (!first_in_scope_.empty()) {
+      if (!first_in_scope_.back()) {
+        stream_ << ',';
+      }
+      first_in_scope_.back() = false;
+      stream_ << '\n' << std::string(first_in_scope_.size(), ' ');
+    }
+  }
+  void writeKey(absl::string_view key) {
+    beginValue();
+    writeQuoted(key);
+    stream_ << ": ";
+  }
+  void writeQuoted(absl::string_view value) {
+    stream_ << '"';
+    for (const char c : value) {
+      switch (c) {
+      case '"':
+        stream_ << "\\\"";
+        break;
+      case '\\':
+        stream_ << "\\\\";
+        break;
+      case '\n':
+        stream_ << "\\n";
+        break;
+      case '\r':
+        stream_ << "\\r";
+        break;
+      case '\t':
+        stream_ << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          stream_ << fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+        } else {
+          stream_ << c;
+        }
+      }
+    }
+    stream_ << '"';
+  }
+  void open(char bracket) {
+    stream_ << bracket;
+    first_in_scope_.push_back(true);
+  }
+  void close(char bracket) {
+    const bool empty = first_in_scope_.back();
+    first_in_scope_.pop_back();
+    if (!empty) {
+      stream_ << '\n' << std::string(first_in_scope_.size(), ' ');
+    }
+    stream_ << bracket;
+  }
+
+  std::ostream& stream_;
+  // Per open object or array, whether nothing has been written into it yet.
+  std::vector<bool> first_in_scope_;
+};
+
+void writeFortioHistogram(JsonStreamWriter& writer, absl::string_view key,
+                          const nighthawk::client::DurationHistogram& histogram) {
+  writer.beginObject(key);
+  writer.writeUnsigned("Count", histogram.count(), false);
+  writer.beginArray("Data");
+  for (const nighthawk::client::DataEntry& data_entry : histogram.data()) {
+    writer.beginObject();
+    writer.writeDouble("Start", data_entry.start());
+    writer.writeDouble("End", data_entry.end());
+    writer.writeDouble("Percent", data_entry.percent());
+    writer.writeUnsigned("Count", data_entry.count(), false);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.writeDouble("Min", histogram.min());
+  writer.writeDouble("Max", histogram.max());
+  writer.writeDouble("Sum", histogram.sum());
+  writer.writeDouble("Avg", histogram.avg());
+  writer.writeDouble("StdDev", histogram.stddev());
+  writer.beginArray("Percentiles");
+  for (const nighthawk::client::FortioPercentile& percentile : histogram.percentiles()) {
+    writer.beginObject();
+    writer.writeDouble("Percentile", percentile.percentile());
+    writer.writeDouble("Value", percentile.value());
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.endObject();
+}
+
+} // namespace
+
+void FortioPedanticOutputFormatterImpl::writeFortioJson(
+    const nighthawk::client::FortioResult& fortio_result, std::ostream& stream) {
+  // Fields are written in field number order, like the protobuf json printer does. Unlike it, we
+  // write 64 bit integers unquoted, and RequestedQPS quoted, because that is what Fortio does.
+  JsonStreamWriter writer(stream);
+  writer.beginObject();
+  writer.writeString("Labels", fortio_result.labels());
+  if (fortio_result.has_starttime()) {
+    writer.writeString("StartTime",
+                       Envoy::Protobuf::util::TimeUtil::ToString(fortio_result.starttime()));
+  }
+  writer.writeUnsigned("RequestedQPS", fortio_result.requestedqps(), true);
+  if (fortio_result.has_requestedduration()) {
+    writer.writeString("RequestedDuration", Envoy::Protobuf::util::TimeUtil::ToString(
+                                                fortio_result.requestedduration()));
+  }
+  writer.writeDouble("ActualQPS", fortio_result.actualqps());
+  writer.writeDouble("ActualDuration", fortio_result.actualduration());
+  writer.writeUnsigned("NumThreads", fortio_result.numthreads(), false);
+  if (fortio_result.has_durationhistogram()) {
+    writeFortioHistogram(writer, "DurationHistogram", fortio_result.durationhistogram());
+  }
+  writer.beginObject("RetCodes");
+  // Map iteration order is unspecified, so we sort the status codes.
+  const std::map<std::string, uint64_t> ret_codes(fortio_result.retcodes().begin(),
+                                                  fortio_result.retcodes().end());
+  for (const auto& ret_code : ret_codes) {
+    writer.writeUnsigned(ret_code.first, ret_code.second, false);
+  }
+  writer.endObject();
+  writer.writeString("URL", fortio_result.url());
+  writer.writeString("Version", fortio_result.version());
+  writer.writeBool("Jitter", fortio_result.jitter());
+  writer.writeString("RunType", fortio_result.runtype());
+  if (fortio_result.has_sizes()) {
+    writeFortioHistogram(writer, "Sizes", fortio_result.sizes());
+  }
+  if (fortio_result.has_headersizes()) {
+    writeFortioHistogram(writer, "HeaderSizes", fortio_result.headersizes());
+  }
+  writer.writeUnsigned("BytesSent", fortio_result.bytessent(), false);
+  writer.writeUnsigned("BytesReceived", fortio_result.bytesreceived(), false);
+  writer.endObject();
+  writer.finish();
 }
 
 void PrometheusOutputFormatterImpl::populateMetric(
@@ -539,8 +883,9 @@ void PrometheusOutputFormatterImpl::populateMetric(
                              << std::endl;
 }
 
-absl::StatusOr<std::string>
-PrometheusOutputFormatterImpl::formatProto(const nighthawk::client::Output& output) const {
+absl::Status
+PrometheusOutputFormatterImpl::formatProtoToStream(const nighthawk::client::Output& output,
+                                                   std::ostream& stream) const {
   const std::string metric_prefix = "nighthawk";
 
   // Map to store aggregated prometheus metric output by type definition.
@@ -635,13 +980,12 @@ PrometheusOutputFormatterImpl::formatProto(const nighthawk::client::Output& outp
     }
   }
 
-  std::stringstream ss;
   for (const auto& entry : metrics_output) {
-    ss << fmt::format("# TYPE {}", entry.first) << std::endl;
-    ss << entry.second.str();
+    stream << fmt::format("# TYPE {}", entry.first) << std::endl;
+    stream << entry.second.str();
   }
 
-  return ss.str();
+  return absl::OkStatus();
 }
 
 } // namespace Client
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <ostream>
 
 #include "envoy/common/time.h"
 
@@ -10,6 +11,7 @@
 #include "external/envoy/source/common/protobuf/protobuf.h"
 #include "external/googletest/googletest/include/gtest/gtest_prod.h"
 
+#include "api/client/options.pb.h"
 #include "api/client/output.pb.h"
 #include "api/client/transform/fortio.pb.h"
 
@@ -22,8 +24,29 @@ namespace Client {
 
 class OutputFormatterImpl : public OutputFormatter {
 public:
+  /**
+   * Formats the output into a string by way of formatProtoToStream().
+   */
+  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+
   static std::vector<std::string> getLowerCaseOutputFormats();
 
+  /**
+   * Fills in the percentiles of statistics that only carry a native HdrHistogram encoding, see
+   * CommandLineOptions.histogram_encoding.
+   *
+   * @param output The output to update.
+   * @return absl::Status An error if an embedded encoding could not be decoded.
+   */
+  static absl::Status renderHistogramEncodings(nighthawk::client::Output& output);
+
+  /**
+   * @param format An output format.
+   * @return bool true iff the output format renders percentiles, and needs
+   * renderHistogramEncodings() to be applied to outputs that only carry native encodings.
+   */
+  static bool rendersPercentiles(nighthawk::client::OutputFormat::OutputFormatOptions format);
+
 protected:
   void iteratePercentiles(
       const nighthawk::client::Statistic& statistic,
@@ -32,7 +55,8 @@ protected:
 
 class ConsoleOutputFormatterImpl : public OutputFormatterImpl {
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
   static std::string statIdtoFriendlyStatName(absl::string_view stat_id);
 
 private:
@@ -41,12 +65,14 @@ private:
 
 class JsonOutputFormatterImpl : public OutputFormatterImpl {
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 };
 
 class YamlOutputFormatterImpl : public OutputFormatterImpl {
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 };
 
 /**
@@ -58,9 +84,11 @@ public:
    * Transforms the Nighthawk output to csv format.
    *
    * @param output the Nighthawk output proto
-   * @return the Nighthawk output as a csv string
+   * @param stream the stream to write the csv to
+   * @return absl::Status an error if the output could not be formatted
    */
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 
   /**
    * Return name associated with the specified stat id.
@@ -85,16 +113,27 @@ private:
 
 class DottedStringOutputFormatterImpl : public OutputFormatterImpl {
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 };
 
 class FortioOutputFormatterImpl : public OutputFormatterImpl {
   FRIEND_TEST(FortioOutputCollectorTest, MissingGlobalResultGetGlobalResult);
 
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 
 protected:
+  /**
+   * Transforms the Nighthawk output to Fortio's result proto.
+   *
+   * @param output the Nighthawk output proto
+   * @return the corresponding Fortio result, or an error if the output has no global result
+   */
+  absl::StatusOr<nighthawk::client::FortioResult>
+  renderFortioResult(const nighthawk::client::Output& output) const;
+
   /**
    * Return the result that represents all workers (the one with the "global" name).
    *
@@ -149,24 +188,35 @@ protected:
 };
 
 /**
- * Applies corrections to the output of the original FortioOutputFormatterImpl class,
- * to make the output adhere better to Fortio's actual output.
- * In particular, the proto json serializer outputs 64 bits integers as strings, whereas
+ * Deviates from the output of the original FortioOutputFormatterImpl class, to make the output
+ * adhere better to Fortio's actual output.
+ * In particular, the proto json mapping represents 64 bits integers as strings, whereas
  * Fortio outputs them unquoted / as integers, trusting that consumers side can take that
- * well. We also fix the RequestedQPS field which was defined as an integer, but gets
- * represented as a string in Fortio's json output.
+ * well. We also write the RequestedQPS field which was defined as an integer as a string, like
+ * Fortio does.
  */
 class FortioPedanticOutputFormatterImpl : public FortioOutputFormatterImpl {
 public:
   /**
    * Format Nighthawk's native output proto to Fortio's output format.
-   * This relies on the base class to provide the initial render, and applies
-   * post processing to make corrections afterwards.
    *
    * @param output Nighthawk's native output proto that will be transformed.
-   * @return std::string Fortio formatted json string.
+   * @param stream The stream to write the Fortio formatted json to.
+   * @return absl::Status An error if the output could not be transformed.
    */
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
+
+private:
+  /**
+   * Writes a Fortio result as pretty printed json, in the layout of the protobuf json printer but
+   * with numbers formatted the way Fortio does.
+   *
+   * @param fortio_result the Fortio result to write.
+   * @param stream the stream to write to.
+   */
+  static void writeFortioJson(const nighthawk::client::FortioResult& fortio_result,
+                              std::ostream& stream);
 };
 
 /**
@@ -174,7 +224,8 @@ public:
  */
 class PrometheusOutputFormatterImpl : public OutputFormatterImpl {
 public:
-  absl::StatusOr<std::string> formatProto(const nighthawk::client::Output& output) const override;
+  absl::Status formatProtoToStream(const nighthawk::client::Output& output,
+                                   std::ostream& stream) const override;
 
 private:
   void populateMetric(const std::string& metric_name, const std::string& metric_type,
@@ -1,5 +1,8 @@
 #include "source/client/output_transform_main.h"
 
+#include <fstream>
+#include <map>
+
 #include "nighthawk/common/exception.h"
 
 #include "external/envoy/source/common/protobuf/message_validator_impl.h"
@@ -10,6 +13,9 @@
 #include "source/client/options_impl.h"
 #include "source/client/output_collector_impl.h"
 #include "source/client/output_formatter_impl.h"
+#include "source/common/request_event_log.h"
+#include "source/common/result_merger.h"
+#include "source/common/statistic_impl.h"
 #include "source/common/utility.h"
 #include "source/common/version_info.h"
 
@@ -20,6 +26,86 @@
 namespace Nighthawk {
 namespace Client {
 
+namespace {
+
+// Statistics and counters of the requests in a time bucket of a request event log.
+struct RequestEventBucket {
+  explicit RequestEventBucket(StatisticPtr prototype)
+      : queue_to_connect(prototype->createNewInstanceOfSameType()),
+        request_to_response(prototype->createNewInstanceOfSameType()),
+        time_to_first_byte(std::move(prototype)) {
+    queue_to_connect->setId("request_event_log.queue_to_connect");
+    request_to_response->setId("request_event_log.request_to_response");
+    time_to_first_byte->setId("request_event_log.time_to_first_byte");
+  }
+
+  void add(const RequestEventRecord& record) {
+    counters["requests"]++;
+    if (record.connect_ns > 0) {
+      queue_to_connect->addValue(record.connect_ns - record.start_ns);
+    }
+    switch (record.outcome) {
+    case RequestEventOutcome::Complete:
+      counters[fmt::format("http_{}xx", record.response_code >= 100 && record.response_code < 600
+                                            ? std::to_string(record.response_code / 100)
+                                            : "x")]++;
+      if (record.connect_ns > 0) {
+        request_to_response->addValue(record.complete_ns - record.connect_ns);
+      }
+      break;
+    case RequestEventOutcome::StreamReset:
+      counters["stream_resets"]++;
+      break;
+    case RequestEventOutcome::PoolFailure:
+      counters["pool_failures"]++;
+      break;
+    }
+    if (record.connect_ns > 0 && record.first_byte_ns > 0) {
+      time_to_first_byte->addValue(record.first_byte_ns - record.connect_ns);
+    }
+  }
+
+  void toProto(nighthawk::client::Result& result) const {
+    for (const Statistic* statistic :
+         {queue_to_connect.get(), request_to_response.get(), time_to_first_byte.get()}) {
+      if (statistic->count() > 0) {
+        *result.add_statistics() =
+            statistic->toProto(Statistic::SerializationDomain::DURATION);
+      }
+    }
+    for (const auto& [name, value] : counters) {
+      nighthawk::client::Counter* counter = result.add_counters();
+      counter->set_name(name);
+      counter->set_value(value);
+    }
+  }
+
+  StatisticPtr queue_to_connect;
+  StatisticPtr request_to_response;
+  StatisticPtr time_to_first_byte;
+  std::map<std::string, uint64_t> counters;
+};
+
+// Formats a point in time of a record as nanoseconds since the start of the log. Points in time
+// that were not reached are left empty.
+std::string formatOffset(uint64_t time_ns, uint64_t origin_ns) {
+  return time_ns == 0 ? "" : std::to_string(static_cast<int64_t>(time_ns - origin_ns));
+}
+
+absl::string_view outcomeName(RequestEventOutcome outcome) {
+  switch (outcome) {
+  case RequestEventOutcome::Complete:
+    return "complete";
+  case RequestEventOutcome::StreamReset:
+    return "stream_reset";
+  case RequestEventOutcome::PoolFailure:
+    return "pool_failure";
+  }
+  return "unknown";
+}
+
+} // namespace
+
 OutputTransformMain::OutputTransformMain(int argc, const char* const* argv, std::istream& input)
     : input_(input) {
   const char* descr = "L7 (HTTP/HTTPS/HTTP2) performance characterization transformation tool.";
@@ -29,8 +115,29 @@ OutputTransformMain::OutputTransformMain(int argc, const char* const* argv, std:
   TCLAP::ValueArg<std::string> output_format(
       "", "output-format", fmt::format("Output format. Possible values: {}.", output_formats), true,
       "", &output_formats_allowed, cmd);
+  TCLAP::SwitchArg merge_results(
+      "", "merge-results",
+      "Replace the results of the input by a single result named 'global', which exactly merges "
+      "the native HdrHistogram encodings of their statistics (see --histogram-encoding) and sums "
+      "their counters. Statistics without an encoding are left out.",
+      cmd);
+  TCLAP::ValueArg<std::string> request_event_log(
+      "", "request-event-log",
+      "Read the request event log at this path, as written by nighthawk_client "
+      "--request-event-log, instead of reading an output from stdin. Without --bucket-width, "
+      "one csv line is written per request, which requires --output-format csv.",
+      false, "", "string", cmd);
+  TCLAP::ValueArg<uint32_t> bucket_width(
+      "", "bucket-width",
+      "With --request-event-log, group the requests in time buckets of this many milliseconds, "
+      "by completion time, and write an output in --output-format with a result per bucket, "
+      "holding its latency histograms and counters, and a 'global' result for the whole log.",
+      false, 0, "uint32_t", cmd);
   Utility::parseCommand(cmd, argc, argv);
   output_format_ = output_format.getValue();
+  merge_results_ = merge_results.getValue();
+  request_event_log_ = request_event_log.getValue();
+  bucket_width_ms_ = bucket_width.getValue();
 }
 
 std::string OutputTransformMain::readInput() {
@@ -47,6 +154,9 @@ uint32_t OutputTransformMain::run() {
   RELEASE_ASSERT(nighthawk::client::OutputFormat_OutputFormatOptions_Parse(
                      absl::AsciiStrToUpper(output_format_), &translated_format),
                  "Invalid output format");
+  if (!request_event_log_.empty()) {
+    return runRequestEventLog(translated_format);
+  }
   std::string input = readInput();
   try {
     Envoy::MessageUtil::loadFromJson(input, output,
@@ -55,14 +165,125 @@ uint32_t OutputTransformMain::run() {
     std::cerr << "Input error: " << e.what();
     return 1;
   }
+  if (merge_results_) {
+    ResultMerger merger("global");
+    for (const nighthawk::client::Result& result : output.results()) {
+      absl::Status merge_status = merger.addResult(result);
+      if (!merge_status.ok()) {
+        std::cerr << "Merge error: " << merge_status.message();
+        return 1;
+      }
+    }
+    output.clear_results();
+    *output.add_results() = merger.toProto();
+  }
+  // Statistics that only carry a native encoding are rendered back into percentiles.
+  absl::Status render_status = OutputFormatterImpl::renderHistogramEncodings(output);
+  if (!render_status.ok()) {
+    std::cerr << "Input error: " << render_status.message();
+    return 1;
+  }
   OutputFormatterFactoryImpl factory;
   OutputFormatterPtr formatter = factory.create(translated_format);
-  absl::StatusOr<std::string> format_status = formatter->formatProto(output);
-  if (!format_status.ok()) {
+  if (!formatter->formatProtoToStream(output, std::cout).ok()) {
+    ENVOY_LOG(error, "error while formatting proto");
+    return 1;
+  }
+  return 0;
+}
+
+uint32_t OutputTransformMain::runRequestEventLog(
+    const nighthawk::client::OutputFormat_OutputFormatOptions format) {
+  if (bucket_width_ms_ == 0 && format != nighthawk::client::OutputFormat::CSV) {
+    std::cerr << "Without --bucket-width, request event logs can only be written as csv.";
+    return 1;
+  }
+  std::ifstream input(request_event_log_, std::ios::in | std::ios::binary);
+  if (!input.is_open()) {
+    std::cerr << "Input error: failed to open " << request_event_log_;
+    return 1;
+  }
+  RequestEventLogReader reader(input);
+  absl::Status header_status = reader.readHeader();
+  if (!header_status.ok()) {
+    std::cerr << "Input error: " << header_status.message();
+    return 1;
+  }
+  const uint64_t origin_ns = reader.header().monotonic_origin_ns;
+  const std::chrono::nanoseconds bucket_width = std::chrono::milliseconds(bucket_width_ms_);
+  // Per bucket histograms use the compact log-linear backend, so that long runs with narrow buckets
+  // don't need a full size HdrHistogram per bucket.
+  std::map<uint64_t, RequestEventBucket> buckets;
+  RequestEventBucket global(std::make_unique<HdrStatistic>());
+  if (bucket_width_ms_ == 0) {
+    std::cout << "worker,request_index,connection_id,start_ns,connect_ns,first_byte_ns,complete_ns,"
+                 "outcome,response_code,request_bytes,response_bytes\n";
+  }
+  RequestEventRecord record;
+  for (;;) {
+    absl::StatusOr<bool> next = reader.next(record);
+    if (!next.ok()) {
+      std::cerr << "Input error: " << next.status().message();
+      return 1;
+    }
+    if (!*next) {
+      break;
+    }
+    if (bucket_width_ms_ == 0) {
+      std::cout << record.worker_id << ',' << record.request_index << ','
+                << (record.connection_id == RequestEventLogFormat::kNoConnectionId
+                        ? ""
+                        : std::to_string(record.connection_id))
+                << ',' << formatOffset(record.start_ns, origin_ns) << ','
+                << formatOffset(record.connect_ns, origin_ns) << ','
+                << formatOffset(record.first_byte_ns, origin_ns) << ','
+                << formatOffset(record.complete_ns, origin_ns) << ','
+                << outcomeName(record.outcome) << ',' << record.response_code << ','
+                << record.request_bytes << ',' << record.response_bytes << '\n';
+      continue;
+    }
+    const uint64_t offset_ns = record.complete_ns > origin_ns ? record.complete_ns - origin_ns : 0;
+    const uint64_t bucket = offset_ns / bucket_width.count();
+    auto it = buckets.find(bucket);
+    if (it == buckets.end()) {
+      it = buckets.emplace(bucket, std::make_unique<CircllhistStatistic>()).first;
+    }
+    it->second.add(record);
+    global.add(record);
+  }
+  if (bucket_width_ms_ == 0) {
+    return 0;
+  }
+
+  nighthawk::client::Output output;
+  const uint64_t system_origin_ns = reader.header().system_origin_ns;
+  *output.mutable_timestamp() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToTimestamp(system_origin_ns);
+  for (const auto& [bucket, statistics] : buckets) {
+    nighthawk::client::Result* result = output.add_results();
+    const uint64_t bucket_offset_ns = bucket * bucket_width.count();
+    result->set_name(fmt::format("bucket_{}ms", bucket * bucket_width_ms_));
+    *result->mutable_execution_start() = Envoy::Protobuf::util::TimeUtil::NanosecondsToTimestamp(
+        system_origin_ns + bucket_offset_ns);
+    *result->mutable_execution_duration() =
+        Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(bucket_width.count());
+    statistics.toProto(*result);
+  }
+  nighthawk::client::Result* result = output.add_results();
+  result->set_name("global");
+  *result->mutable_execution_start() =
+      Envoy::Protobuf::util::TimeUtil::NanosecondsToTimestamp(system_origin_ns);
+  if (!buckets.empty()) {
+    *result->mutable_execution_duration() = Envoy::Protobuf::util::TimeUtil::NanosecondsToDuration(
+        (buckets.rbegin()->first + 1) * bucket_width.count());
+  }
+  global.toProto(*result);
+  OutputFormatterFactoryImpl factory;
+  OutputFormatterPtr formatter = factory.create(format);
+  if (!formatter->formatProtoToStream(output, std::cout).ok()) {
     ENVOY_LOG(error, "error while formatting proto");
     return 1;
   }
-  std::cout << *format_status;
   return 0;
 }
 
@@ -3,6 +3,8 @@
 #include "external/envoy/source/common/common/logger.h"
 #include "external/envoy/source/common/event/real_time_system.h"
 
+#include "api/client/options.pb.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -13,8 +15,13 @@ public:
 
 private:
   std::string readInput();
+  // Transforms the request event log at request_event_log_ instead of an Output read from input_.
+  uint32_t runRequestEventLog(const nighthawk::client::OutputFormat_OutputFormatOptions format);
   Envoy::Event::RealTimeSystem time_system_; // NO_CHECK_FORMAT(real_time)
   std::string output_format_;
+  bool merge_results_{};
+  std::string request_event_log_;
+  uint32_t bucket_width_ms_{};
   std::istream& input_;
 };
 
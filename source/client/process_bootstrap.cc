@@ -188,6 +188,38 @@ Cluster createNighthawkClusterForWorker(const Client::Options& options,
   return cluster;
 }
 
+// Configures how the nighthawk cluster spreads traffic across the multi-target endpoints. The
+// cluster must hold one endpoint per multi-target endpoint, in the same order.
+void applyMultiTargetLoadBalancing(const Client::Options& options, Cluster& cluster) {
+  switch (options.multiTargetLbPolicy()) {
+  case nighthawk::client::MultiTargetLbPolicy::LEAST_REQUEST:
+    cluster.set_lb_policy(Cluster::LEAST_REQUEST);
+    break;
+  case nighthawk::client::MultiTargetLbPolicy::RANDOM:
+    cluster.set_lb_policy(Cluster::RANDOM);
+    break;
+  case nighthawk::client::MultiTargetLbPolicy::RING_HASH:
+    cluster.set_lb_policy(Cluster::RING_HASH);
+    break;
+  case nighthawk::client::MultiTargetLbPolicy::MAGLEV:
+    cluster.set_lb_policy(Cluster::MAGLEV);
+    break;
+  default:
+    cluster.set_lb_policy(Cluster::ROUND_ROBIN);
+    break;
+  }
+  const std::vector<nighthawk::client::MultiTarget::Endpoint> endpoints =
+      options.multiTargetEndpoints();
+  LocalityLbEndpoints* lb_endpoints = cluster.mutable_load_assignment()->mutable_endpoints(0);
+  ASSERT(static_cast<size_t>(lb_endpoints->lb_endpoints_size()) == endpoints.size());
+  for (size_t i = 0; i < endpoints.size(); i++) {
+    if (endpoints[i].has_weight()) {
+      lb_endpoints->mutable_lb_endpoints(i)->mutable_load_balancing_weight()->set_value(
+          endpoints[i].weight().value());
+    }
+  }
+}
+
 // Extracts URIs of the targets and the request source (if specified) from the
 // Nighthawk options.
 // Resolves all the extracted URIs.
@@ -267,6 +299,9 @@ absl::StatusOr<Bootstrap> createBootstrapConfiguration(
     Cluster nighthawk_cluster =
         is_tunneling ? createNighthawkClusterForWorker(options, encap_uris, worker_number)
                      : createNighthawkClusterForWorker(options, uris, worker_number);
+    if (!is_tunneling && !options.uri().has_value()) {
+      applyMultiTargetLoadBalancing(options, nighthawk_cluster);
+    }
 
     if (needTransportSocket(options, uris)) {
       absl::StatusOr<TransportSocket> transport_socket = createTransportSocket(options, uris);
@@ -2,9 +2,11 @@
 
 #include <sys/file.h>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <optional>
 #include <random>
@@ -61,6 +63,8 @@
 #include "api/client/output.pb.h"
 
 #include "source/common/frequency.h"
+#include "source/common/statistic_impl.h"
+#include "source/common/thread_placement.h"
 #include "source/common/uri_impl.h"
 #include "source/common/utility.h"
 
@@ -69,6 +73,7 @@
 #include "source/client/client_worker_impl.h"
 #include "source/client/factories_impl.h"
 #include "source/client/options_impl.h"
+#include "source/client/output_collector_impl.h"
 #include "source/client/sni_utility.h"
 
 #include "source/user_defined_output/user_defined_output_plugin_creator.h"
@@ -91,7 +96,10 @@ public:
   static uint32_t determineConcurrency(const Options& options) {
     bool autoscale = options.concurrency() == "auto";
     uint32_t concurrency;
-    if (autoscale) {
+    if (autoscale && !options.workerCpus().empty()) {
+      concurrency = options.workerCpus().size();
+      ENVOY_LOG(info, "Starting one worker per CPU listed in --worker-cpus.");
+    } else if (autoscale) {
       uint32_t cpu_cores_with_affinity = Envoy::OptionsImplPlatform::getCpuCount();
       ENVOY_LOG(info, "Detected {} (v)CPUs with affinity..", cpu_cores_with_affinity);
       concurrency = cpu_cores_with_affinity;
@@ -588,9 +596,16 @@ ProcessImpl::ProcessImpl(const Options& options, Envoy::Event::TimeSystem& time_
       api_(std::make_unique<Envoy::Api::Impl>(platform_impl_.threadFactory(), store_root_,
                                               time_system_, platform_impl_.fileSystem(), generator_,
                                               bootstrap_)),
-      dispatcher_(api_->allocateDispatcher("main_thread")), benchmark_client_factory_(options),
-      termination_predicate_factory_(options), sequencer_factory_(options),
-      request_generator_factory_(options, *api_), init_manager_("nh_init_manager"),
+      dispatcher_(api_->allocateDispatcher("main_thread")),
+      request_event_log_(options.requestEventLog().empty()
+                             ? nullptr
+                             : std::make_unique<RequestEventLog>(options.requestEventLog(),
+                                                                 number_of_workers_)),
+      benchmark_client_factory_(options, request_event_log_.get(),
+                                [this]() { return progress_callback_ != nullptr; }),
+      termination_predicate_factory_(options), sequencer_factory_(options, number_of_workers_),
+      request_generator_factory_(options, *api_, number_of_workers_),
+      init_manager_("nh_init_manager"),
       local_info_(new Envoy::LocalInfo::LocalInfoImpl(
           store_root_.symbolTable(), node_, node_context_params_,
           Envoy::Network::Utility::getLocalAddress(Envoy::Network::Address::IpVersion::v4),
@@ -734,6 +749,7 @@ absl::Status ProcessImpl::createWorkers(const uint32_t concurrency,
       computeFirstWorkerStart(time_system_, scheduled_start, concurrency);
   const std::chrono::nanoseconds inter_worker_delay =
       computeInterWorkerDelay(concurrency, options_.requestsPerSecond());
+  const std::vector<uint32_t> worker_cpus = options_.workerCpus();
   int worker_number = 0;
   while (workers_.size() < concurrency) {
     absl::StatusOr<std::vector<UserDefinedOutputNamePluginPair>> plugins =
@@ -741,6 +757,22 @@ absl::Status ProcessImpl::createWorkers(const uint32_t concurrency,
     if (!plugins.ok()) {
       return plugins.status();
     }
+    std::optional<WorkerPlacement> placement;
+    if (!worker_cpus.empty()) {
+      placement.emplace();
+      placement->cpu = worker_cpus[worker_number % worker_cpus.size()];
+      if (options_.numaLocalAllocation()) {
+        placement->numa_node = ThreadPlacement::numaNodeOfCpu(placement->cpu);
+        if (!placement->numa_node.has_value()) {
+          ENVOY_LOG(warn, "NUMA node of CPU {} unknown, not placing memory of worker_{}.",
+                    placement->cpu, worker_number);
+        }
+      }
+    }
+    // Allocations made while constructing the worker, like its dispatcher and statistics, land on
+    // the NUMA node the worker will run on.
+    ScopedNumaNodePreference numa_node_preference(placement.has_value() ? placement->numa_node
+                                                                        : std::nullopt);
     workers_.push_back(std::make_unique<ClientWorkerImpl>(
         *api_, tls_, cluster_manager_, benchmark_client_factory_, termination_predicate_factory_,
         sequencer_factory_, request_generator_factory_, store_root_, worker_number,
@@ -748,11 +780,29 @@ absl::Status ProcessImpl::createWorkers(const uint32_t concurrency,
         options_.simpleWarmup() ? ClientWorkerImpl::HardCodedWarmupStyle::ON
                                 : ClientWorkerImpl::HardCodedWarmupStyle::OFF,
         std::move(*plugins)));
+    if (placement.has_value()) {
+      workers_.back()->setPlacement(*placement);
+      recordWorkerPlacement(fmt::format("worker_{}", worker_number), *placement);
+    }
     worker_number++;
   }
   return absl::OkStatus();
 }
 
+void ProcessImpl::recordWorkerPlacement(absl::string_view name,
+                                        const WorkerPlacement& placement) {
+  nighthawk::client::WorkerPlacement placement_proto;
+  placement_proto.set_name(std::string(name));
+  placement_proto.set_cpu(placement.cpu);
+  if (placement.numa_node.has_value()) {
+    placement_proto.mutable_numa_node()->set_value(placement.numa_node.value());
+  }
+  ENVOY_LOG(info, "Placing {} on CPU {}, NUMA node {}.", name, placement.cpu,
+            placement.numa_node.has_value() ? fmt::format("{}", placement.numa_node.value())
+                                            : "unknown");
+  worker_placements_.push_back(std::move(placement_proto));
+}
+
 void ProcessImpl::configureComponentLogLevels(spdlog::level::level_enum level) {
   // TODO(oschaaf): Add options to tweak the log level of the various log tags
   // that are available.
@@ -776,32 +826,26 @@ ProcessImpl::vectorizeStatisticPtrMap(const StatisticPtrMap& statistics) const {
 
 std::vector<StatisticPtr>
 ProcessImpl::mergeWorkerStatistics(const std::vector<ClientWorkerPtr>& workers) const {
-  // First we init merged_statistics with newly created statistics instances.
-  // We do that by adding the same amount of Statistic instances that the first worker has.
-  // (We always have at least one worker, and all workers have the same number of Statistic
-  // instances associated to them, in the same order).
-  std::vector<StatisticPtr> merged_statistics;
-  StatisticPtrMap w0_statistics;
-  if (!workers.empty()) {
-    w0_statistics = workers[0]->statistics();
-  }
-  for (const auto& w0_statistic : w0_statistics) {
-    auto new_statistic = w0_statistic.second->createNewInstanceOfSameType();
-    new_statistic->setId(w0_statistic.first);
-    merged_statistics.push_back(std::move(new_statistic));
-  }
-
-  // Merge the statistics of all workers into the statistics vector we initialized above.
+  // Statistics are merged by id. Most statistics are held by all workers, but per-endpoint ones
+  // only exist on the workers that sent requests to that endpoint.
+  std::map<std::string, StatisticPtr> merged_statistics;
   for (auto& w : workers) {
-    uint32_t i = 0;
     for (const auto& wx_statistic : w->statistics()) {
-      auto merged = merged_statistics[i]->combine(*(wx_statistic.second));
-      merged->setId(merged_statistics[i]->id());
-      merged_statistics[i] = std::move(merged);
-      i++;
+      StatisticPtr& merged = merged_statistics[wx_statistic.first];
+      if (merged == nullptr) {
+        merged = wx_statistic.second->createNewInstanceOfSameType();
+        merged->setId(wx_statistic.first);
+      }
+      StatisticPtr combined = merged->combine(*(wx_statistic.second));
+      combined->setId(wx_statistic.first);
+      merged = std::move(combined);
     }
   }
-  return merged_statistics;
+  std::vector<StatisticPtr> statistics;
+  for (auto& merged_statistic : merged_statistics) {
+    statistics.push_back(std::move(merged_statistic.second));
+  }
+  return statistics;
 }
 
 void ProcessImpl::addTracingCluster(envoy::config::bootstrap::v3::Bootstrap& bootstrap,
@@ -884,6 +928,114 @@ void ProcessImpl::setupStatsSinks(const envoy::config::bootstrap::v3::Bootstrap&
   }
 }
 
+void ProcessImpl::forEachWorkerIntervalRecorder(
+    const std::function<void(absl::string_view, HdrIntervalRecorderSharedPtr)>& fn) const {
+  for (const auto& w : workers_) {
+    for (const auto& [id, statistic] : w->statistics()) {
+      const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(statistic);
+      if (hdr_statistic != nullptr && hdr_statistic->intervalRecorder() != nullptr) {
+        fn(id, hdr_statistic->intervalRecorder());
+      }
+    }
+  }
+}
+
+std::map<std::string, uint64_t>
+ProcessImpl::sampleCounterIncrements(std::map<std::string, uint64_t>& previous_counters) {
+  // Counters only go up, so report the increments since the previous sample.
+  std::map<std::string, uint64_t> counters = Utility().mapCountersFromStore(
+      store_root_, [](absl::string_view, uint64_t value) { return value > 0; });
+  std::map<std::string, uint64_t> counter_increments;
+  for (const auto& [name, value] : counters) {
+    const auto previous = previous_counters.find(name);
+    const uint64_t increment =
+        previous == previous_counters.end() ? value : value - previous->second;
+    if (increment > 0) {
+      counter_increments[name] = increment;
+    }
+  }
+  previous_counters = std::move(counters);
+  return counter_increments;
+}
+
+void ProcessImpl::reportIntervalsUntilWorkersComplete(OutputCollector& collector) {
+  const bool report_progress =
+      progress_callback_ != nullptr && options_.progressReportInterval() > 0;
+  const bool record_time_slices = options_.timeSliceInterval() > 0;
+  const std::chrono::seconds progress_interval(options_.progressReportInterval());
+  const std::chrono::seconds time_slice_interval(options_.timeSliceInterval());
+  std::map<std::string, uint64_t> previous_progress_counters;
+  std::map<std::string, uint64_t> previous_time_slice_counters;
+  Envoy::MonotonicTime progress_start = time_system_.monotonicTime();
+
+  // Time slices are aligned to multiples of the interval since the epoch, so that slices of
+  // executions on different machines line up. Their deadlines are mapped onto the monotonic clock
+  // which the workers are waited on with.
+  const auto time_slice_deadline = [this](const Envoy::SystemTime& time_slice_end) {
+    return time_system_.monotonicTime() +
+           std::max<std::chrono::nanoseconds>(time_slice_end - time_system_.systemTime(), 0ns);
+  };
+  Envoy::SystemTime time_slice_start;
+  Envoy::MonotonicTime time_slice_end;
+  if (record_time_slices) {
+    const std::chrono::nanoseconds since_epoch = time_system_.systemTime().time_since_epoch();
+    time_slice_start = Envoy::SystemTime(std::chrono::duration_cast<Envoy::SystemTime::duration>(
+        since_epoch - since_epoch % time_slice_interval));
+    time_slice_end = time_slice_deadline(time_slice_start + time_slice_interval);
+  }
+  const auto add_time_slice = [&]() {
+    std::vector<StatisticPtr> statistics;
+    for (std::unique_ptr<HdrStatistic>& statistic : time_slice_sampler_.sample()) {
+      statistics.push_back(std::move(statistic));
+    }
+    collector.addTimeSlice("global", time_slice_start, time_slice_interval, statistics,
+                           sampleCounterIncrements(previous_time_slice_counters));
+  };
+
+  for (;;) {
+    Envoy::MonotonicTime deadline = Envoy::MonotonicTime::max();
+    if (report_progress) {
+      deadline = std::min(deadline, progress_start + progress_interval);
+    }
+    if (record_time_slices) {
+      deadline = std::min(deadline, time_slice_end);
+    }
+    const bool completed =
+        std::all_of(workers_.begin(), workers_.end(), [this, deadline](const ClientWorkerPtr& w) {
+          const auto remaining = std::max<std::chrono::nanoseconds>(
+              deadline - time_system_.monotonicTime(), 0ns);
+          // Round up, so that we do not wake up just ahead of the deadline.
+          return w->waitForCompletionFor(std::chrono::ceil<std::chrono::milliseconds>(remaining));
+        });
+    if (completed) {
+      break;
+    }
+    const Envoy::MonotonicTime now = time_system_.monotonicTime();
+    if (report_progress && now >= progress_start + progress_interval) {
+      std::vector<StatisticPtr> statistics;
+      for (std::unique_ptr<HdrStatistic>& statistic : progress_sampler_.sample()) {
+        statistics.push_back(std::move(statistic));
+      }
+      OutputCollectorImpl progress_collector(time_system_, options_);
+      progress_collector.addResult("progress", statistics,
+                                   sampleCounterIncrements(previous_progress_counters),
+                                   now - progress_start, std::nullopt, {});
+      progress_callback_(progress_collector.toProto());
+      progress_start = now;
+    }
+    if (record_time_slices && now >= time_slice_end) {
+      add_time_slice();
+      time_slice_start += time_slice_interval;
+      time_slice_end = time_slice_deadline(time_slice_start + time_slice_interval);
+    }
+  }
+  // The final progress report is the result itself, but the final time slice still needs to be
+  // added.
+  if (record_time_slices) {
+    add_time_slice();
+  }
+}
+
 bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_uri,
                               const Envoy::Network::DnsResolverSharedPtr& dns_resolver,
                               const std::optional<Envoy::SystemTime>& scheduled_start) {
@@ -983,6 +1135,15 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
         store_root_.setTagProducer(std::move(producer_or_error.value()));
       }
 
+      if (request_event_log_ != nullptr) {
+        absl::Status log_status = request_event_log_->start(api_->threadFactory(), time_system_);
+        if (!log_status.ok()) {
+          ENVOY_LOG(error, "Failed to start the request event log: {}", log_status.message());
+          result = false;
+          return;
+        }
+      }
+
       absl::Status workers_status = createWorkers(number_of_workers_, scheduled_start);
       if (!workers_status.ok()) {
         ENVOY_LOG(error, "createWorkers failed. Received bad status: {}", workers_status.message());
@@ -1068,8 +1229,31 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
         // There should be only a single live flush worker instance at any time.
         flush_worker_ = std::make_unique<FlushWorkerImpl>(
             stats_flush_interval, *api_, tls_, store_root_, stats_sinks, *cluster_manager_);
+        if (options_.flushWorkerCpu().has_value()) {
+          const WorkerPlacement placement{options_.flushWorkerCpu().value(), std::nullopt};
+          flush_worker_->setPlacement(placement);
+          recordWorkerPlacement("flush_worker", placement);
+        }
+        // Let the flush worker report live percentiles on the statistics the workers record
+        // intervals for.
+        forEachWorkerIntervalRecorder(
+            [this](absl::string_view id, HdrIntervalRecorderSharedPtr recorder) {
+              flush_worker_->addIntervalRecorder(id, std::move(recorder));
+            });
         flush_worker_->start();
       }
+      if (progress_callback_ != nullptr && options_.progressReportInterval() > 0) {
+        forEachWorkerIntervalRecorder(
+            [this](absl::string_view id, HdrIntervalRecorderSharedPtr recorder) {
+              progress_sampler_.addRecorder(id, std::move(recorder));
+            });
+      }
+      if (options_.timeSliceInterval() > 0) {
+        forEachWorkerIntervalRecorder(
+            [this](absl::string_view id, HdrIntervalRecorderSharedPtr recorder) {
+              time_slice_sampler_.addRecorder(id, std::move(recorder));
+            });
+      }
 
       for (auto& w : workers_) {
         w->start();
@@ -1088,9 +1272,16 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     return false;
   }
 
+  if ((progress_callback_ != nullptr && options_.progressReportInterval() > 0) ||
+      options_.timeSliceInterval() > 0) {
+    reportIntervalsUntilWorkersComplete(collector);
+  }
   for (auto& w : workers_) {
     w->waitForCompletion();
   }
+  if (request_event_log_ != nullptr) {
+    request_event_log_->stop();
+  }
 
   if (!options_.statsSinks().empty() && flush_worker_ != nullptr) {
     // Stop the running dispatcher in flush_worker_. Needs to be called after all
@@ -1099,6 +1290,13 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     flush_worker_->waitForCompletion();
   }
 
+  // Query the live counters once, to get to both the per-worker and the global numbers. To make
+  // sure the numbers line up, we must take care not to shut down the benchmark clients before we
+  // do this, as that will increment certain counters like connections closed, etc.
+  const CounterValuesByWorker counter_values = Utility().mapCountersFromStoreByWorker(
+      store_root_, [](absl::string_view, uint64_t value) { return value > 0; });
+  const std::map<std::string, uint64_t>& counters = counter_values.global;
+
   int i = 0;
   std::chrono::nanoseconds total_execution_duration = 0ns;
   std::optional<Envoy::SystemTime> first_acquisition_time = std::nullopt;
@@ -1123,26 +1321,26 @@ bool ProcessImpl::runInternal(OutputCollector& collector, const UriPtr& tracing_
     // results will be precisely the same.
     if (workers_.size() > 1) {
       StatisticFactoryImpl statistic_factory(options_);
+      const auto worker_counters = counter_values.per_worker.find(i);
       collector.addResult(fmt::format("worker_{}", i),
                           vectorizeStatisticPtrMap(worker->statistics()),
-                          worker->threadLocalCounterValues(), sequencer_execution_duration,
-                          worker_first_acquisition_time, worker_user_defined_outputs);
+                          worker_counters != counter_values.per_worker.end()
+                              ? worker_counters->second
+                              : std::map<std::string, uint64_t>(),
+                          sequencer_execution_duration, worker_first_acquisition_time,
+                          worker_user_defined_outputs);
     }
     total_execution_duration += sequencer_execution_duration;
     i++;
   }
 
-  // Note that above we use use counter values snapshotted by the workers right after its
-  // execution completes. Here we query the live counters to get to the global numbers. To make
-  // sure the global aggregated numbers line up, we must take care not to shut down the benchmark
-  // client before we do this, as that will increment certain counters like connections closed,
-  // etc.
-  const std::map<std::string, uint64_t>& counters = Utility().mapCountersFromStore(
-      store_root_, [](absl::string_view, uint64_t value) { return value > 0; });
   StatisticFactoryImpl statistic_factory(options_);
   std::vector<nighthawk::client::UserDefinedOutput> global_user_defined_outputs =
       compileGlobalUserDefinedPluginOutputs(user_defined_outputs_by_plugin,
                                             user_defined_output_factories_);
+  for (const nighthawk::client::WorkerPlacement& placement : worker_placements_) {
+    collector.addWorkerPlacement(placement);
+  }
   if (workers_.size() > 0) {
     collector.addResult("global", mergeWorkerStatistics(workers_), counters,
                         total_execution_duration / workers_.size(), first_acquisition_time,
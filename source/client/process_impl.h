@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 
@@ -39,6 +40,9 @@
 #include "external/envoy/source/server/options_impl.h"
 #include "external/envoy_api/envoy/config/bootstrap/v3/bootstrap.pb.h"
 
+#include "source/common/request_event_log.h"
+#include "source/common/statistic_impl.h"
+
 #include "source/client/benchmark_client_impl.h"
 #include "source/client/factories_impl.h"
 #include "source/client/flush_worker_impl.h"
@@ -96,6 +100,10 @@ public:
 
   bool requestExecutionCancellation() override;
 
+  void setProgressCallback(ProgressCallback callback) override {
+    progress_callback_ = std::move(callback);
+  }
+
 private:
   // Use CreateProcessImpl to construct an instance of ProcessImpl.
   ProcessImpl(const Options& options, Envoy::Event::TimeSystem& time_system,
@@ -117,6 +125,13 @@ private:
    */
   absl::Status createWorkers(const uint32_t concurrency,
                              const std::optional<Envoy::SystemTime>& schedule);
+  /**
+   * Logs a worker placement, and remembers it for the output.
+   *
+   * @param name the name of the placed worker.
+   * @param placement the placement of the worker.
+   */
+  void recordWorkerPlacement(absl::string_view name, const WorkerPlacement& placement);
   std::vector<StatisticPtr> vectorizeStatisticPtrMap(const StatisticPtrMap& statistics) const;
   std::vector<StatisticPtr>
   mergeWorkerStatistics(const std::vector<ClientWorkerPtr>& workers) const;
@@ -130,6 +145,31 @@ private:
    */
   void setupStatsSinks(const envoy::config::bootstrap::v3::Bootstrap& bootstrap,
                        std::list<std::unique_ptr<Envoy::Stats::Sink>>& stats_sinks);
+  /**
+   * Calls fn for every interval recorder of the workers' statistics.
+   *
+   * @param fn receives the id of the statistic and its interval recorder.
+   */
+  void forEachWorkerIntervalRecorder(
+      const std::function<void(absl::string_view, HdrIntervalRecorderSharedPtr)>& fn) const;
+  /**
+   * Samples the counters of all workers.
+   *
+   * @param previous_counters the counter values of the previous sample, which are replaced with
+   * the current ones.
+   * @return std::map<std::string, uint64_t> the counter increments since the previous sample,
+   * keyed by name. Counters that did not increase are left out.
+   */
+  std::map<std::string, uint64_t>
+  sampleCounterIncrements(std::map<std::string, uint64_t>& previous_counters);
+  /**
+   * Waits for all workers to complete. Until they do, passes a progress report to
+   * progress_callback_ every Options::progressReportInterval() seconds, and adds a time slice of
+   * the global result to the collector every Options::timeSliceInterval() seconds.
+   *
+   * @param collector receives the time slices.
+   */
+  void reportIntervalsUntilWorkersComplete(OutputCollector& collector);
   bool runInternal(OutputCollector& collector, const UriPtr& tracing_uri,
                    const Envoy::Network::DnsResolverSharedPtr& dns_resolver,
                    const std::optional<Envoy::SystemTime>& schedule);
@@ -183,6 +223,8 @@ private:
   Envoy::Api::ApiPtr api_;
   Envoy::Event::DispatcherPtr dispatcher_;
   std::vector<ClientWorkerPtr> workers_;
+  // Declared before benchmark_client_factory_, which hands its producers to the workers.
+  RequestEventLogPtr request_event_log_;
   const BenchmarkClientFactoryImpl benchmark_client_factory_;
   const TerminationPredicateFactoryImpl termination_predicate_factory_;
   const SequencerFactoryImpl sequencer_factory_;
@@ -216,6 +258,13 @@ private:
   Envoy::Thread::MutexBasicLockable workers_lock_;
   bool cancelled_{false};
   std::unique_ptr<FlushWorkerImpl> flush_worker_;
+  // Placements of the pinned workers, reported in the output.
+  std::vector<nighthawk::client::WorkerPlacement> worker_placements_;
+  ProgressCallback progress_callback_;
+  // Reader of the workers' interval recorders used for progress reports.
+  HdrIntervalSampler progress_sampler_;
+  // Reader of the workers' interval recorders used for time slices.
+  HdrIntervalSampler time_slice_sampler_;
   Envoy::Router::ContextImpl router_context_;
   Envoy::OptionsImpl envoy_options_;
   // Null server implementation used as a placeholder. Its methods should never get called
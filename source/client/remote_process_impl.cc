@@ -10,7 +10,6 @@
 #include "api/client/output.pb.h"
 
 #include "source/client/options_impl.h"
-#include "source/common/nighthawk_service_client_impl.h"
 #include "source/common/uri_impl.h"
 
 namespace Nighthawk {
@@ -27,9 +26,13 @@ bool RemoteProcessImpl::run(OutputCollector& collector) {
   // nighthawk_service will ignore the option, but if someone ever changes that this
   // is probably desireable.
   options->mutable_nighthawk_service()->Clear();
+  if (progress_callback_ == nullptr) {
+    // Nobody is interested in progress reports, so don't have the service record and stream them.
+    options->clear_progress_report_interval();
+  }
 
   const absl::StatusOr<const nighthawk::client::ExecutionResponse> result =
-      service_client_->PerformNighthawkBenchmark(&stub_, *options);
+      service_client_->PerformNighthawkBenchmark(&stub_, *options, progress_callback_);
   if (result.ok()) {
     collector.setOutput(result.value().output());
     return true;
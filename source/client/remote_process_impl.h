@@ -7,6 +7,8 @@
 
 #include "external/envoy/source/common/common/logger.h"
 
+#include "source/common/nighthawk_service_client_impl.h"
+
 #include "api/client/service.grpc.pb.h"
 
 namespace Nighthawk {
@@ -37,10 +39,19 @@ public:
 
   bool requestExecutionCancellation() override;
 
+  /**
+   * The remote nighthawk service is only asked to stream progress reports when a callback is set,
+   * which they are then forwarded to.
+   */
+  void setProgressCallback(ProgressCallback callback) override {
+    progress_callback_ = std::move(callback);
+  }
+
 private:
   const Options& options_;
-  const std::unique_ptr<NighthawkServiceClient> service_client_;
+  const std::unique_ptr<NighthawkServiceClientImpl> service_client_;
   nighthawk::client::NighthawkService::Stub& stub_;
+  ProgressCallback progress_callback_;
 };
 
 } // namespace Client
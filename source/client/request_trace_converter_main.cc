@@ -0,0 +1,89 @@
+#include "source/client/request_trace_converter_main.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "external/envoy/source/common/protobuf/message_validator_impl.h"
+#include "external/envoy/source/common/protobuf/utility.h"
+
+#include "api/client/options.pb.h"
+
+#include "source/common/request_trace.h"
+#include "source/common/utility.h"
+#include "source/common/version_info.h"
+
+#include "fmt/ranges.h"
+#include "tclap/CmdLine.h"
+
+namespace Nighthawk {
+namespace Client {
+
+RequestTraceConverterMain::RequestTraceConverterMain(int argc, const char* const* argv,
+                                                     std::istream& input)
+    : input_(input) {
+  const char* descr = "Converts a RequestOptionsList in json or yaml format, read from stdin, to a "
+                      "binary request trace for the mapped trace request source plugin.";
+  TCLAP::CmdLine cmd(descr, ' ', VersionInfo::version()); // NOLINT
+  TCLAP::ValueArg<std::string> output("", "output", "Path of the request trace to write.", true,
+                                      "", "string", cmd);
+  TCLAP::ValueArg<uint32_t> index_stride(
+      "", "index-stride",
+      fmt::format("Number of records between two consecutive index entries. Lower values speed "
+                  "up seeking to the start of a worker's partition, at the cost of a larger "
+                  "index. Default: {}.",
+                  RequestTraceFormat::kDefaultIndexStride),
+      false, RequestTraceFormat::kDefaultIndexStride, "uint32_t", cmd);
+  Utility::parseCommand(cmd, argc, argv);
+  output_path_ = output.getValue();
+  index_stride_ = index_stride.getValue();
+}
+
+std::string RequestTraceConverterMain::readInput() {
+  std::stringstream input;
+  input << input_.rdbuf();
+  return input.str();
+}
+
+uint32_t RequestTraceConverterMain::run() {
+  if (index_stride_ == 0) {
+    std::cerr << "--index-stride must be larger than 0" << std::endl;
+    return 1;
+  }
+  nighthawk::client::RequestOptionsList options_list;
+  try {
+    Envoy::MessageUtil::loadFromYaml(readInput(), options_list,
+                                     Envoy::ProtobufMessage::getStrictValidationVisitor());
+  } catch (Envoy::EnvoyException& e) {
+    std::cerr << "Input error: " << e.what();
+    return 1;
+  }
+  std::ofstream output(output_path_, std::ios::binary | std::ios::trunc);
+  if (!output.is_open()) {
+    std::cerr << "Failed to open " << output_path_ << " for writing" << std::endl;
+    return 1;
+  }
+  RequestTraceWriter writer(output, index_stride_);
+  for (nighthawk::client::RequestOptions& request_options : *options_list.mutable_options()) {
+    // The start offset is stored in the record header, so we don't duplicate it in the payload.
+    const std::chrono::nanoseconds start_offset =
+        std::chrono::seconds(request_options.start_offset().seconds()) +
+        std::chrono::nanoseconds(request_options.start_offset().nanos());
+    request_options.clear_start_offset();
+    absl::Status status = writer.addRecord(request_options, start_offset);
+    if (!status.ok()) {
+      ENVOY_LOG(error, "error while writing request trace: {}", status.message());
+      return 1;
+    }
+  }
+  absl::Status status = writer.finish();
+  if (!status.ok()) {
+    ENVOY_LOG(error, "error while writing request trace: {}", status.message());
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace Client
+} // namespace Nighthawk
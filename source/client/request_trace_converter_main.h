@@ -0,0 +1,27 @@
+#pragma once
+
+#include <istream>
+#include <string>
+
+#include "external/envoy/source/common/common/logger.h"
+
+namespace Nighthawk {
+namespace Client {
+
+// Converts a RequestOptionsList in json or yaml format, read from |input|, into a binary request
+// trace that can be replayed by the mapped trace request source plugin. The start_offset of each
+// RequestOptions is stored with its record, and must not decrease from one entry to the next.
+class RequestTraceConverterMain : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  RequestTraceConverterMain(int argc, const char* const* argv, std::istream& input);
+  uint32_t run();
+
+private:
+  std::string readInput();
+  std::string output_path_;
+  uint32_t index_stride_;
+  std::istream& input_;
+};
+
+} // namespace Client
+} // namespace Nighthawk
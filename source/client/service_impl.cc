@@ -1,5 +1,7 @@
 #include "source/client/service_impl.h"
 
+#include <algorithm>
+
 #include <grpc++/grpc++.h>
 
 #include "envoy/config/core/v3/base.pb.h"
@@ -51,6 +53,12 @@ void ServiceImpl::handleExecutionRequest(const nighthawk::client::ExecutionReque
   }
   ProcessPtr process = std::move(*process_or_status);
 
+  process->setProgressCallback([this](const nighthawk::client::Output& progress) {
+    nighthawk::client::ExecutionResponse progress_response;
+    *(progress_response.mutable_output()) = progress;
+    progress_response.set_progress_report(true);
+    writeResponse(progress_response);
+  });
   OutputCollectorImpl output_collector(time_system_, *options);
   const bool ok = process->run(output_collector);
   if (!ok) {
@@ -167,11 +175,18 @@ grpc::Status RequestSourceServiceImpl::RequestStream(
     // 2. Read a and dispatch a header stream from disk.
     RequestSourcePtr request_source = createStaticEmptyRequestSource(request.quantity());
     RequestGenerator request_generator = request_source->get();
+    // Clients that predate batching leave max_batch_size unset, and expect a single
+    // request_specifier per response.
+    uint32_t batch_size = std::max<uint32_t>(request.max_batch_size(), 1);
+    if (max_batch_size_ > 0) {
+      batch_size = std::min(batch_size, max_batch_size_);
+    }
     RequestPtr request;
+    nighthawk::request_source::RequestStreamResponse response;
     while (ok && (request = request_generator()) != nullptr) {
       HeaderMapPtr headers = request->header();
-      nighthawk::request_source::RequestStreamResponse response;
-      auto* request_specifier = response.mutable_request_specifier();
+      auto* request_specifier = batch_size > 1 ? response.add_request_specifiers()
+                                               : response.mutable_request_specifier();
       auto* request_headers = request_specifier->mutable_v3_headers();
       headers->iterate([&request_headers](const Envoy::Http::HeaderEntry& header)
                            -> Envoy::Http::HeaderMap::Iterate {
@@ -179,7 +194,15 @@ grpc::Status RequestSourceServiceImpl::RequestStream(
         return Envoy::Http::RequestHeaderMap::Iterate::Continue;
       });
       // TODO(oschaaf): add static configuration for other fields plus expectations
-      ok = ok && stream->Write(response);
+      if (batch_size == 1 ||
+          static_cast<uint32_t>(response.request_specifiers_size()) == batch_size) {
+        ok = ok && stream->Write(response);
+        response.Clear();
+      }
+    }
+    // Flush the last, partially filled batch.
+    if (ok && response.request_specifiers_size() > 0) {
+      ok = stream->Write(response);
     }
     if (!ok) {
       ENVOY_LOG(error, "Failed to send the complete set of replay data.");
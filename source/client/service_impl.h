@@ -83,8 +83,13 @@ class RequestSourceServiceImpl final
 public:
   /**
    * Constructs a new RequestSourceServiceImpl instance.
+   *
+   * @param max_batch_size Upper bound on the number of request specifiers packed into a single
+   * response, for clients that ask for batched responses. 0 means that only the limit requested by
+   * the client applies, 1 disables batching.
    */
-  RequestSourceServiceImpl() {
+  explicit RequestSourceServiceImpl(const uint32_t max_batch_size = 0)
+      : max_batch_size_(max_batch_size) {
     logging_context_ = std::make_unique<Envoy::Logger::Context>(
         spdlog::level::from_str("info"), "[%T.%f][%t][%L] %v", log_lock_, false);
   }
@@ -97,6 +102,7 @@ public:
 private:
   Envoy::Thread::MutexBasicLockable log_lock_;
   std::unique_ptr<Envoy::Logger::Context> logging_context_;
+  const uint32_t max_batch_size_;
   RequestSourcePtr createStaticEmptyRequestSource(const uint32_t amount);
 };
 
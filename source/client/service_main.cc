@@ -36,12 +36,19 @@ ServiceMain::ServiceMain(int argc, const char** argv) {
   TCLAP::ValueArg<std::string> service_arg(
       "", "service", "Specifies which service to run. Default 'traffic-generator-service'.", false,
       "traffic-generator-service", &service_names_allowed, cmd);
+
+  TCLAP::ValueArg<uint32_t> request_source_max_batch_size_arg(
+      "", "request-source-max-batch-size",
+      "Upper bound on the number of request specifiers the dummy-request-source packs into a "
+      "single response. 0 lets clients pick the batch size, 1 disables batching. Default: 0.",
+      false, 0, "uint32_t", cmd);
   Utility::parseCommand(cmd, argc, argv);
 
   if (service_arg.getValue() == "traffic-generator-service") {
     service_ = std::make_unique<ServiceImpl>();
   } else if (service_arg.getValue() == "dummy-request-source") {
-    service_ = std::make_unique<RequestSourceServiceImpl>();
+    service_ =
+        std::make_unique<RequestSourceServiceImpl>(request_source_max_batch_size_arg.getValue());
   }
   RELEASE_ASSERT(service_ != nullptr, "Service mapping failed");
   listener_bound_address_ = appendDefaultPortIfNeeded(listen_arg.getValue());
@@ -22,12 +22,12 @@ namespace Client {
 
 void StreamDecoder::decodeHeaders(Envoy::Http::ResponseHeaderMapPtr&& headers, bool end_stream) {
   ASSERT(!complete_);
-  stream_info_.upstreamInfo()->upstreamTiming().onFirstUpstreamRxByteReceived(time_source_);
+  stream_info_->upstreamInfo()->upstreamTiming().onFirstUpstreamRxByteReceived(time_source_);
   complete_ = end_stream;
   response_headers_ = std::move(headers);
   response_header_sizes_statistic_.addValue(response_headers_->byteSize());
   const uint64_t response_code = Envoy::Http::Utility::getResponseStatus(*response_headers_);
-  stream_info_.setResponseCode(static_cast<uint32_t>(response_code));
+  stream_info_->setResponseCode(static_cast<uint32_t>(response_code));
   if (!latency_response_header_name_.empty()) {
     const auto timing_header_name = Envoy::Http::LowerCaseString(latency_response_header_name_);
     const Envoy::Http::HeaderMap::GetResult& timing_header =
@@ -54,7 +54,7 @@ void StreamDecoder::decodeData(Envoy::Buffer::Instance& data, bool end_stream) {
   complete_ = end_stream;
   // This will show up in the zipkin UI as 'response_size'. In Envoy this tracks bytes send by Envoy
   // to the downstream.
-  stream_info_.addBytesSent(data.length());
+  stream_info_->addBytesSent(data.length());
   if (complete_) {
     onComplete(true);
   }
@@ -73,20 +73,21 @@ void StreamDecoder::decodeTrailers(Envoy::Http::ResponseTrailerMapPtr&& headers)
 
 void StreamDecoder::onComplete(bool success) {
   ASSERT(!success || complete_);
+  std::optional<uint64_t> latency_ns;
   if (success && measure_latencies_) {
-    latency_statistic_.addValue((time_source_.monotonicTime() - request_start_).count());
+    latency_ns = (time_source_.monotonicTime() - request_start_).count();
+    latency_statistic_.addValue(latency_ns.value());
     // At this point StreamDecoder::decodeHeaders() should have been called.
-    if (stream_info_.responseCode().has_value()) {
-      decoder_completion_callback_.exportLatency(
-          stream_info_.responseCode().value(),
-          (time_source_.monotonicTime() - request_start_).count());
+    if (stream_info_->responseCode().has_value()) {
+      decoder_completion_callback_.exportLatency(stream_info_->responseCode().value(),
+                                                 latency_ns.value());
     } else {
       ENVOY_LOG_EVERY_POW_2(warn, "response_code is not available in onComplete");
     }
   }
-  stream_info_.upstreamInfo()->upstreamTiming().onLastUpstreamRxByteReceived(time_source_);
-  response_body_sizes_statistic_.addValue(stream_info_.bytesSent());
-  stream_info_.onRequestComplete();
+  stream_info_->upstreamInfo()->upstreamTiming().onLastUpstreamRxByteReceived(time_source_);
+  response_body_sizes_statistic_.addValue(stream_info_->bytesSent());
+  stream_info_->onRequestComplete();
   if (response_headers_ != nullptr) {
     decoder_completion_callback_.onComplete(success, *response_headers_);
   } else {
@@ -94,36 +95,52 @@ void StreamDecoder::onComplete(bool success) {
         /* max_headers_kb = */ 0, /* max_headers_count = */ 0);
     decoder_completion_callback_.onComplete(success, *empty_headers);
   }
+  if (upstream_host_ != nullptr) {
+    decoder_completion_callback_.onEndpointComplete(
+        *upstream_host_, success ? stream_info_->responseCode().value_or(0) : 0,
+        stream_info_->responseCode().has_value() ? latency_ns : std::nullopt);
+  }
   finalizeActiveSpan();
+  maybeLogRequestEvent(success ? RequestEventOutcome::Complete : RequestEventOutcome::StreamReset);
   caller_completion_callback_(complete_, success);
-  dispatcher_.deferredDelete(std::unique_ptr<StreamDecoder>(this));
+  dispose();
 }
 
 void StreamDecoder::onResetStream(Envoy::Http::StreamResetReason reason,
                                   absl::string_view /* transport_failure_reason */) {
 
-  stream_info_.setResponseFlag(streamResetReasonToResponseFlag(reason));
+  stream_info_->setResponseFlag(streamResetReasonToResponseFlag(reason));
   onComplete(false);
 }
 
 void StreamDecoder::onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason,
                                   absl::string_view /* transport_failure_reason */,
-                                  Envoy::Upstream::HostDescriptionConstSharedPtr) {
+                                  Envoy::Upstream::HostDescriptionConstSharedPtr host) {
   decoder_completion_callback_.onPoolFailure(reason);
-  stream_info_.setResponseFlag(Envoy::StreamInfo::CoreResponseFlag::UpstreamConnectionFailure);
+  if (host != nullptr) {
+    decoder_completion_callback_.onEndpointComplete(*host, 0, std::nullopt);
+  }
+  stream_info_->setResponseFlag(Envoy::StreamInfo::CoreResponseFlag::UpstreamConnectionFailure);
   finalizeActiveSpan();
+  maybeLogRequestEvent(RequestEventOutcome::PoolFailure);
   caller_completion_callback_(false, false);
-  dispatcher_.deferredDelete(std::unique_ptr<StreamDecoder>(this));
+  dispose();
 }
 
 void StreamDecoder::onPoolReady(Envoy::Http::RequestEncoder& encoder,
-                                Envoy::Upstream::HostDescriptionConstSharedPtr,
-                                Envoy::StreamInfo::StreamInfo&,
+                                Envoy::Upstream::HostDescriptionConstSharedPtr host,
+                                Envoy::StreamInfo::StreamInfo& connection_stream_info,
                                 std::optional<Envoy::Http::Protocol>) {
+  upstream_host_ = std::move(host);
+  if (request_event_log_ != nullptr) {
+    connection_id_ = connection_stream_info.downstreamAddressProvider().connectionID().value_or(
+        RequestEventLogFormat::kNoConnectionId);
+  }
   encoder.getStream().addCallbacks(*this);
-  stream_info_.upstreamInfo()->upstreamTiming().onFirstUpstreamTxByteSent(
+  stream_info_->upstreamInfo()->upstreamTiming().onFirstUpstreamTxByteSent(
       time_source_); // XXX(oschaaf): is this correct?
-  const bool end_stream = request_body_size_ == 0 && request_body_.empty();
+  const bool has_request_body = request_body_ != nullptr && !request_body_->empty();
+  const bool end_stream = request_body_size_ == 0 && !has_request_body;
   const Envoy::Http::Status status = encoder.encodeHeaders(*request_headers_, end_stream);
   if (!status.ok()) {
     ENVOY_LOG_EVERY_POW_2(error,
@@ -131,26 +148,32 @@ void StreamDecoder::onPoolReady(Envoy::Http::RequestEncoder& encoder,
                           "HTTP headers in {}.",
                           *request_headers_);
   }
-  if (request_body_size_ > 0 || !request_body_.empty()) {
+  if (request_body_size_ > 0 || has_request_body) {
     // TODO(https://github.com/envoyproxy/nighthawk/issues/138): This will show up in the zipkin UI
     // as 'response_size'. We add it here, optimistically assuming it will all be send. Ideally,
     // we'd track the encoder events of the stream to dig up and forward more information. For now,
     // we take the risk of erroneously reporting that we did send all the bytes, instead of always
     // reporting 0 bytes.
     Envoy::Buffer::OwnedImpl body_buffer;
-    if (request_body_.empty()) {
+    if (!has_request_body) {
       // Revisit this when we have non-uniform request distributions and on-the-fly reconfiguration
       // in place. The string size below MUST match the cap we put on
       // RequestOptions::request_body_size in api/client/options.proto!
-      stream_info_.addBytesReceived(request_body_size_);
+      stream_info_->addBytesReceived(request_body_size_);
       auto* fragment = new Envoy::Buffer::BufferFragmentImpl(
           staticUploadContent().data(), request_body_size_,
           [](const void*, size_t, const Envoy::Buffer::BufferFragmentImpl* frag) { delete frag; });
       body_buffer.addBufferFragment(*fragment);
 
     } else {
-      stream_info_.addBytesReceived(request_body_.size());
-      body_buffer.add(absl::string_view(request_body_));
+      stream_info_->addBytesReceived(request_body_->size());
+      // Reference the shared body instead of copying it. The fragment holds on to a reference,
+      // which keeps the body alive until the codec is done with it.
+      auto* fragment = new Envoy::Buffer::BufferFragmentImpl(
+          request_body_->data(), request_body_->size(),
+          [body = request_body_](const void*, size_t,
+                                 const Envoy::Buffer::BufferFragmentImpl* frag) { delete frag; });
+      body_buffer.addBufferFragment(*fragment);
     }
     encoder.encodeData(body_buffer, true);
   }
@@ -161,6 +184,164 @@ void StreamDecoder::onPoolReady(Envoy::Http::RequestEncoder& encoder,
   }
 }
 
+void StreamDecoder::maybeLogRequestEvent(RequestEventOutcome outcome) {
+  if (request_event_log_ == nullptr) {
+    return;
+  }
+  // The upstream timing already holds the points in time we are interested in, which saves us
+  // from sampling the clock on behalf of the log.
+  const Envoy::StreamInfo::UpstreamTiming& timing = stream_info_->upstreamInfo()->upstreamTiming();
+  const auto nanoseconds = [](const std::optional<Envoy::MonotonicTime>& time) -> uint64_t {
+    return time.has_value() ? time->time_since_epoch().count() : 0;
+  };
+  RequestEventRecord record{};
+  record.start_ns = connect_start_.time_since_epoch().count();
+  record.connect_ns = nanoseconds(timing.first_upstream_tx_byte_sent_);
+  record.first_byte_ns = nanoseconds(timing.first_upstream_rx_byte_received_);
+  record.complete_ns = outcome == RequestEventOutcome::PoolFailure
+                           ? time_source_.monotonicTime().time_since_epoch().count()
+                           : nanoseconds(timing.last_upstream_rx_byte_received_);
+  record.connection_id = connection_id_;
+  record.request_index = request_index_;
+  record.request_bytes = stream_info_->bytesReceived() +
+                         (request_headers_ != nullptr ? request_headers_->byteSize() : 0);
+  record.response_bytes = stream_info_->bytesSent() +
+                          (response_headers_ != nullptr ? response_headers_->byteSize() : 0);
+  record.response_code = static_cast<uint16_t>(stream_info_->responseCode().value_or(0));
+  record.outcome = outcome;
+  request_event_log_->record(record);
+}
+
+void StreamDecoder::initializeStreamInfo() {
+  stream_info_.emplace(time_source_, downstream_address_setter_,
+                       Envoy::StreamInfo::FilterState::LifeSpan::FilterChain);
+  if (measure_latencies_ && tracer_ != nullptr) {
+    setupForTracing();
+  }
+  // The previous stream info released its reference when it got replaced above. Spans may still
+  // hold on to the upstream info, in which case it is left to them.
+  if (upstream_info_ == nullptr || upstream_info_.use_count() > 1) {
+    upstream_info_ = std::make_shared<Envoy::StreamInfo::UpstreamInfoImpl>();
+  } else {
+    *upstream_info_ = Envoy::StreamInfo::UpstreamInfoImpl();
+  }
+  stream_info_->setUpstreamInfo(upstream_info_);
+}
+
+void StreamDecoder::reuse(OperationCallback caller_completion_callback,
+                          HeaderMapPtr request_headers, RequestBodySharedPtr request_body,
+                          bool measure_latencies, uint32_t request_body_size) {
+  ASSERT(!in_use_);
+  in_use_ = true;
+  caller_completion_callback_ = std::move(caller_completion_callback);
+  request_headers_ = std::move(request_headers);
+  request_body_ = std::move(request_body);
+  connect_start_ = time_source_.monotonicTime();
+  request_start_ = Envoy::MonotonicTime();
+  complete_ = false;
+  measure_latencies_ = measure_latencies;
+  request_body_size_ = request_body_size;
+  connection_id_ = RequestEventLogFormat::kNoConnectionId;
+  initializeStreamInfo();
+}
+
+void StreamDecoder::clearRequestState() {
+  caller_completion_callback_ = nullptr;
+  request_headers_.reset();
+  request_body_.reset();
+  response_headers_.reset();
+  trailer_headers_.reset();
+  active_span_.reset();
+  upstream_host_.reset();
+}
+
+void StreamDecoder::dispose() {
+  if (pool_ != nullptr) {
+    pool_->release(*this);
+  } else {
+    dispatcher_.deferredDelete(std::unique_ptr<StreamDecoder>(this));
+  }
+}
+
+StreamDecoderPool::StreamDecoderPool(
+    Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
+    StreamDecoderCompletionCallback& decoder_completion_callback, Statistic& connect_statistic,
+    Statistic& latency_statistic, Statistic& response_header_sizes_statistic,
+    Statistic& response_body_sizes_statistic, Statistic& origin_latency_statistic,
+    Envoy::Random::RandomGenerator& random_generator, Envoy::Tracing::TracerSharedPtr& tracer,
+    absl::string_view latency_response_header_name)
+    : dispatcher_(dispatcher), time_source_(time_source),
+      decoder_completion_callback_(decoder_completion_callback),
+      connect_statistic_(connect_statistic), latency_statistic_(latency_statistic),
+      response_header_sizes_statistic_(response_header_sizes_statistic),
+      response_body_sizes_statistic_(response_body_sizes_statistic),
+      origin_latency_statistic_(origin_latency_statistic), random_generator_(random_generator),
+      tracer_(tracer), latency_response_header_name_(latency_response_header_name) {}
+
+StreamDecoderPool::~StreamDecoderPool() {
+  // Decoders which are still associated to in-flight streams may get callbacks after we are gone.
+  // Detach those, so they fall back to deleting themselves upon completion.
+  for (std::unique_ptr<StreamDecoder>& decoder : decoders_) {
+    if (decoder->in_use_) {
+      decoder->pool_ = nullptr;
+      decoder.release();
+    }
+  }
+}
+
+StreamDecoder& StreamDecoderPool::acquire(OperationCallback caller_completion_callback,
+                                          HeaderMapPtr request_headers,
+                                          RequestBodySharedPtr request_body,
+                                          bool measure_latencies, uint32_t request_body_size) {
+  if (!idle_.empty()) {
+    StreamDecoder* decoder = idle_.back();
+    idle_.pop_back();
+    decoder->reuse(std::move(caller_completion_callback), std::move(request_headers),
+                   std::move(request_body), measure_latencies, request_body_size);
+    assignRequestEventLog(*decoder);
+    return *decoder;
+  }
+  decoders_.push_back(std::make_unique<StreamDecoder>(
+      dispatcher_, time_source_, decoder_completion_callback_,
+      std::move(caller_completion_callback), connect_statistic_, latency_statistic_,
+      response_header_sizes_statistic_, response_body_sizes_statistic_, origin_latency_statistic_,
+      std::move(request_headers), std::move(request_body), measure_latencies, request_body_size,
+      random_generator_, tracer_, latency_response_header_name_));
+  StreamDecoder& decoder = *decoders_.back();
+  decoder.pool_ = this;
+  assignRequestEventLog(decoder);
+  return decoder;
+}
+
+void StreamDecoderPool::assignRequestEventLog(StreamDecoder& decoder) {
+  decoder.request_event_log_ = request_event_log_;
+  if (request_event_log_ != nullptr) {
+    decoder.request_index_ = request_event_log_->nextRequestIndex();
+  }
+}
+
+void StreamDecoderPool::release(StreamDecoder& decoder) {
+  ASSERT(decoder.in_use_);
+  decoder.in_use_ = false;
+  // The decoder may still be referenced further up the call stack, so we can't hand it out again
+  // right away. It becomes available on the next dispatcher loop iteration.
+  released_.push_back(&decoder);
+  if (recycle_callback_ == nullptr) {
+    recycle_callback_ = dispatcher_.createSchedulableCallback([this]() { recycleReleased(); });
+  }
+  if (!recycle_callback_->enabled()) {
+    recycle_callback_->scheduleCallbackNextIteration();
+  }
+}
+
+void StreamDecoderPool::recycleReleased() {
+  for (StreamDecoder* decoder : released_) {
+    decoder->clearRequestState();
+    idle_.push_back(decoder);
+  }
+  released_.clear();
+}
+
 // TODO(https://github.com/envoyproxy/nighthawk/issues/139): duplicated from
 // envoy/source/common/router/router.cc
 Envoy::StreamInfo::CoreResponseFlag
@@ -196,7 +377,7 @@ void StreamDecoder::finalizeActiveSpan() {
   if (active_span_ != nullptr) {
     Envoy::Tracing::HttpTracerUtility::finalizeDownstreamSpan(
         *active_span_, request_headers_.get(), response_headers_.get(), trailer_headers_.get(),
-        stream_info_, config_);
+        *stream_info_, config_);
   }
 }
 
@@ -210,7 +391,7 @@ void StreamDecoder::setupForTracing() {
   uuid_generator.set(*headers_copy, /* edge_request= */ true, /* keep_external_id= */ false);
   uuid_generator.setTraceReason(*headers_copy, Envoy::Tracing::Reason::ClientForced);
   Envoy::Tracing::HttpTraceContext trace_context(*headers_copy);
-  active_span_ = tracer_->startSpan(config_, trace_context, stream_info_, tracing_decision);
+  active_span_ = tracer_->startSpan(config_, trace_context, *stream_info_, tracing_decision);
   active_span_->injectContext(trace_context, /*upstream=*/nullptr);
   request_headers_.reset(headers_copy.release());
   // We pass in a fake remote address; recently trace finalization mandates setting this, and will
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
@@ -17,6 +20,8 @@
 #include "external/envoy/source/common/stream_info/stream_info_impl.h"
 #include "external/envoy/source/common/tracing/http_tracer_impl.h"
 
+#include "source/common/request_event_log.h"
+
 namespace Nighthawk {
 namespace Client {
 
@@ -27,12 +32,24 @@ public:
   virtual void onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason reason) PURE;
   virtual void exportLatency(const uint32_t response_code, const uint64_t latency_ns) PURE;
   virtual void handleResponseData(const Envoy::Buffer::Instance& response_data) PURE;
+  /**
+   * Called once per request that got assigned an upstream host, after onComplete() or
+   * onPoolFailure(). Used to break results down per endpoint when targeting multiple endpoints.
+   *
+   * @param host the upstream host the request was assigned to.
+   * @param response_code the response code, or 0 if no response was received.
+   * @param latency_ns the request-to-response latency, if latencies were measured for the request
+   * and a response was received.
+   */
+  virtual void onEndpointComplete(const Envoy::Upstream::HostDescription& host,
+                                  uint32_t response_code, std::optional<uint64_t> latency_ns) PURE;
 };
 
-// TODO(oschaaf): create a StreamDecoderPool?
+class StreamDecoderPool;
 
 /**
- * A self destructing response decoder that discards the response body.
+ * A self destructing response decoder that discards the response body. When handed out by a
+ * StreamDecoderPool, the decoder returns itself to the pool upon completion instead.
  */
 class StreamDecoder : public Envoy::Http::ResponseDecoder,
                       public Envoy::Http::StreamCallbacks,
@@ -40,18 +57,14 @@ class StreamDecoder : public Envoy::Http::ResponseDecoder,
                       public Envoy::Event::DeferredDeletable,
                       public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
 public:
-  // TODO(pelintehcoder): Optimize request body handling by reconsidering the use of std::string.
-  // - Evaluate whether absl::string_view or const std::string& can be used instead of storing full
-  // copies.
-  // - Ensure that lifetime concerns are properly handled to avoid dangling references.
-  // - This will reduce unnecessary copies while maintaining safety.
   StreamDecoder(Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
                 StreamDecoderCompletionCallback& decoder_completion_callback,
                 OperationCallback caller_completion_callback, Statistic& connect_statistic,
                 Statistic& latency_statistic, Statistic& response_header_sizes_statistic,
                 Statistic& response_body_sizes_statistic, Statistic& origin_latency_statistic,
-                HeaderMapPtr request_headers, std::string request_body, bool measure_latencies,
-                uint32_t request_body_size, Envoy::Random::RandomGenerator& random_generator,
+                HeaderMapPtr request_headers, RequestBodySharedPtr request_body,
+                bool measure_latencies, uint32_t request_body_size,
+                Envoy::Random::RandomGenerator& random_generator,
                 Envoy::Tracing::TracerSharedPtr& tracer,
                 absl::string_view latency_response_header_name)
       : dispatcher_(dispatcher), time_source_(time_source),
@@ -67,14 +80,9 @@ public:
         downstream_address_setter_(std::make_shared<Envoy::Network::ConnectionInfoSetterImpl>(
             // The two addresses aren't used in an execution of Nighthawk.
             /* downstream_local_address = */ nullptr, /* downstream_remote_address = */ nullptr)),
-        stream_info_(time_source_, downstream_address_setter_,
-                     Envoy::StreamInfo::FilterState::LifeSpan::FilterChain),
         random_generator_(random_generator), tracer_(tracer),
         latency_response_header_name_(latency_response_header_name) {
-    if (measure_latencies_ && tracer_ != nullptr) {
-      setupForTracing();
-    }
-    stream_info_.setUpstreamInfo(std::make_shared<Envoy::StreamInfo::UpstreamInfoImpl>());
+    initializeStreamInfo();
   }
 
   // Http::StreamDecoder
@@ -107,7 +115,31 @@ public:
   void setupForTracing();
 
 private:
+  friend class StreamDecoderPool;
+
   void onComplete(bool success);
+  void initializeStreamInfo();
+  /**
+   * Re-arms a recycled decoder for a new request. The worker-level state (dispatcher, statistics,
+   * tracer, etc.) is retained, the request-level state is replaced.
+   */
+  void reuse(OperationCallback caller_completion_callback, HeaderMapPtr request_headers,
+             RequestBodySharedPtr request_body, bool measure_latencies,
+             uint32_t request_body_size);
+  /**
+   * Drops references to request-level state, so that an idle pooled decoder doesn't keep
+   * header maps, spans or callback captures alive.
+   */
+  void clearRequestState();
+  /**
+   * Disposes of this decoder once it is done. Pooled decoders are handed back to their pool, others
+   * are scheduled for deferred deletion.
+   */
+  void dispose();
+  /**
+   * Appends a record describing the request to the request event log, if one is configured.
+   */
+  void maybeLogRequestEvent(RequestEventOutcome outcome);
   static const std::string& staticUploadContent() {
     static const auto s = new std::string(4194304, 'a');
     return *s;
@@ -123,21 +155,115 @@ private:
   Statistic& response_body_sizes_statistic_;
   Statistic& origin_latency_statistic_;
   HeaderMapPtr request_headers_;
-  const std::string request_body_;
+  // Shared with the request source; sent without copying.
+  RequestBodySharedPtr request_body_;
   Envoy::Http::ResponseHeaderMapPtr response_headers_;
   Envoy::Http::ResponseTrailerMapPtr trailer_headers_;
-  const Envoy::MonotonicTime connect_start_;
+  Envoy::MonotonicTime connect_start_;
   Envoy::MonotonicTime request_start_;
   bool complete_ = false;
   bool measure_latencies_;
-  const uint32_t request_body_size_;
+  uint32_t request_body_size_;
   Envoy::Tracing::EgressConfigImpl config_;
   std::shared_ptr<Envoy::Network::ConnectionInfoSetterImpl> downstream_address_setter_;
-  Envoy::StreamInfo::StreamInfoImpl stream_info_;
+  // Held in an optional so that pooled decoders can re-create it in place for each request.
+  std::optional<Envoy::StreamInfo::StreamInfoImpl> stream_info_;
+  // Handed to each stream_info_, and reset in place for the next request once nothing else holds
+  // on to it.
+  std::shared_ptr<Envoy::StreamInfo::UpstreamInfoImpl> upstream_info_;
   Envoy::Random::RandomGenerator& random_generator_;
   Envoy::Tracing::TracerSharedPtr& tracer_;
   Envoy::Tracing::SpanPtr active_span_;
   const std::string latency_response_header_name_;
+  // The upstream host the request got assigned to, once known.
+  Envoy::Upstream::HostDescriptionConstSharedPtr upstream_host_;
+  // Set when this decoder is owned by a StreamDecoderPool.
+  StreamDecoderPool* pool_{nullptr};
+  bool in_use_{true};
+  // Set by the pool when requests should be recorded in a request event log.
+  RequestEventLogProducer* request_event_log_{nullptr};
+  uint64_t request_index_{0};
+  uint64_t connection_id_{RequestEventLogFormat::kNoConnectionId};
+};
+
+/**
+ * A per-worker free-list of StreamDecoder instances. Decoders obtained via acquire() hand
+ * themselves back upon completion, and become available for reuse on the next dispatcher loop
+ * iteration. At that point the codec is guaranteed to no longer reference them, which is the same
+ * guarantee deferred deletion offers. This avoids allocating a decoder, its StreamInfo, its
+ * upstream info and its connection info setter for each request. The FilterState that each
+ * StreamInfo creates is still allocated per request.
+ * Not thread safe; must be used exclusively from the thread that runs the dispatcher.
+ */
+class StreamDecoderPool {
+public:
+  StreamDecoderPool(Envoy::Event::Dispatcher& dispatcher, Envoy::TimeSource& time_source,
+                    StreamDecoderCompletionCallback& decoder_completion_callback,
+                    Statistic& connect_statistic, Statistic& latency_statistic,
+                    Statistic& response_header_sizes_statistic,
+                    Statistic& response_body_sizes_statistic, Statistic& origin_latency_statistic,
+                    Envoy::Random::RandomGenerator& random_generator,
+                    Envoy::Tracing::TracerSharedPtr& tracer,
+                    absl::string_view latency_response_header_name);
+  ~StreamDecoderPool();
+
+  /**
+   * Obtains a decoder for a new request, recycling an idle one when available.
+   *
+   * @param caller_completion_callback callback to invoke when the request completes.
+   * @param request_headers headers to send.
+   * @param request_body body to send. When empty or nullptr, request_body_size bytes of filler are
+   * sent.
+   * @param measure_latencies whether latencies should be recorded for this request.
+   * @param request_body_size size of the filler body to send when request_body is empty.
+   * @return StreamDecoder& a decoder which is owned by the pool.
+   */
+  StreamDecoder& acquire(OperationCallback caller_completion_callback,
+                         HeaderMapPtr request_headers, RequestBodySharedPtr request_body,
+                         bool measure_latencies, uint32_t request_body_size);
+
+  /**
+   * Makes decoders handed out from now on record each request in a request event log.
+   *
+   * @param request_event_log the worker's producer of the log, or nullptr to stop recording.
+   */
+  void setRequestEventLog(RequestEventLogProducer* request_event_log) {
+    request_event_log_ = request_event_log;
+  }
+
+  /**
+   * @return uint64_t the number of decoders allocated by the pool over its lifetime.
+   */
+  uint64_t allocatedCount() const { return decoders_.size(); }
+
+  /**
+   * @return uint64_t the number of decoders that are ready for reuse.
+   */
+  uint64_t idleCount() const { return idle_.size(); }
+
+private:
+  friend class StreamDecoder;
+
+  void release(StreamDecoder& decoder);
+  void recycleReleased();
+  void assignRequestEventLog(StreamDecoder& decoder);
+
+  Envoy::Event::Dispatcher& dispatcher_;
+  Envoy::TimeSource& time_source_;
+  StreamDecoderCompletionCallback& decoder_completion_callback_;
+  Statistic& connect_statistic_;
+  Statistic& latency_statistic_;
+  Statistic& response_header_sizes_statistic_;
+  Statistic& response_body_sizes_statistic_;
+  Statistic& origin_latency_statistic_;
+  Envoy::Random::RandomGenerator& random_generator_;
+  Envoy::Tracing::TracerSharedPtr& tracer_;
+  const std::string latency_response_header_name_;
+  std::vector<std::unique_ptr<StreamDecoder>> decoders_;
+  std::vector<StreamDecoder*> idle_;
+  std::vector<StreamDecoder*> released_;
+  Envoy::Event::SchedulableCallbackPtr recycle_callback_;
+  RequestEventLogProducer* request_event_log_{nullptr};
 };
 
 } // namespace Client
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "external/envoy/source/common/common/assert.h"
+
+namespace Nighthawk {
+
+/**
+ * Bounded, lock-free, multi-producer multi-consumer FIFO queue. Based on Dmitry Vyukov's bounded
+ * MPMC queue: each slot carries a sequence number that tells producers and consumers whether the
+ * slot is ready for them, so that a push or pop costs a single compare-and-swap on the shared
+ * position in the uncontended case.
+ *
+ * All methods are thread safe. T must be default constructible and move assignable.
+ */
+template <class T> class MpmcRingBuffer {
+public:
+  /**
+   * @param capacity The minimum number of elements the buffer can hold. Rounded up to the next
+   * power of two, and to at least two: with a single slot, a full and an empty slot would carry
+   * the same sequence number. Must be larger than 0.
+   */
+  explicit MpmcRingBuffer(uint64_t capacity)
+      : mask_(roundUpToPowerOfTwo(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+    for (uint64_t i = 0; i <= mask_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+  MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+  /**
+   * Appends an element, unless the buffer is full.
+   *
+   * @param value The element to append. Only moved from when the push succeeds.
+   * @return bool true if the element was appended, false if the buffer was full.
+   */
+  bool tryPush(T&& value) {
+    uint64_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[position & mask_];
+      const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const int64_t difference = static_cast<int64_t>(sequence - position);
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes the oldest element, unless the buffer is empty.
+   *
+   * @param value Set to the removed element.
+   * @return bool true if an element was removed, false if the buffer was empty.
+   */
+  bool tryPop(T& value) {
+    uint64_t position = dequeue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[position & mask_];
+      const uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const int64_t difference = static_cast<int64_t>(sequence - (position + 1));
+      if (difference == 0) {
+        if (dequeue_position_.compare_exchange_weak(position, position + 1,
+                                                    std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->value);
+    // Release the slot to the producer that will wrap around to it.
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @return uint64_t The maximum number of elements the buffer can hold.
+   */
+  uint64_t capacity() const { return mask_ + 1; }
+
+  /**
+   * @return uint64_t The number of elements in the buffer. Only a snapshot when other threads are
+   * pushing or popping concurrently.
+   */
+  uint64_t sizeApprox() const {
+    const uint64_t dequeue_position = dequeue_position_.load(std::memory_order_relaxed);
+    const uint64_t enqueue_position = enqueue_position_.load(std::memory_order_relaxed);
+    return enqueue_position > dequeue_position ? enqueue_position - dequeue_position : 0;
+  }
+
+private:
+  static constexpr uint64_t kCacheLineSize = 64;
+
+  struct Cell {
+    std::atomic<uint64_t> sequence{0};
+    T value{};
+  };
+
+  static uint64_t roundUpToPowerOfTwo(uint64_t capacity) {
+    RELEASE_ASSERT(capacity > 0 && capacity <= (uint64_t(1) << 62), "invalid ring capacity");
+    uint64_t rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  const uint64_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  // Producers and consumers each hammer their own position, keep them on separate cache lines.
+  alignas(kCacheLineSize) std::atomic<uint64_t> enqueue_position_{0};
+  alignas(kCacheLineSize) std::atomic<uint64_t> dequeue_position_{0};
+};
+
+} // namespace Nighthawk
@@ -8,6 +8,14 @@ absl::StatusOr<nighthawk::client::ExecutionResponse>
 NighthawkServiceClientImpl::PerformNighthawkBenchmark(
     nighthawk::client::NighthawkService::StubInterface* nighthawk_service_stub,
     const nighthawk::client::CommandLineOptions& command_line_options) const {
+  return PerformNighthawkBenchmark(nighthawk_service_stub, command_line_options, nullptr);
+}
+
+absl::StatusOr<nighthawk::client::ExecutionResponse>
+NighthawkServiceClientImpl::PerformNighthawkBenchmark(
+    nighthawk::client::NighthawkService::StubInterface* nighthawk_service_stub,
+    const nighthawk::client::CommandLineOptions& command_line_options,
+    const ProgressCallback& progress_callback) const {
   nighthawk::client::ExecutionRequest request;
   nighthawk::client::ExecutionResponse response;
   *request.mutable_start_request()->mutable_options() = command_line_options;
@@ -24,10 +32,18 @@ NighthawkServiceClientImpl::PerformNighthawkBenchmark(
   }
 
   bool got_response = false;
-  while (stream->Read(&response)) {
+  nighthawk::client::ExecutionResponse received;
+  while (stream->Read(&received)) {
+    if (received.progress_report()) {
+      if (progress_callback != nullptr) {
+        progress_callback(received.output());
+      }
+      continue;
+    }
     RELEASE_ASSERT(!got_response,
                    "Nighthawk Service has started responding with more than one message.");
     got_response = true;
+    response = std::move(received);
   }
   if (!got_response) {
     return absl::InternalError("Nighthawk Service did not send a gRPC response.");
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "nighthawk/common/nighthawk_service_client.h"
 
 #include "external/envoy/source/common/common/statusor.h"
@@ -19,9 +21,28 @@ namespace Nighthawk {
  */
 class NighthawkServiceClientImpl : public NighthawkServiceClient {
 public:
+  using ProgressCallback = std::function<void(const nighthawk::client::Output& progress)>;
+
   absl::StatusOr<nighthawk::client::ExecutionResponse> PerformNighthawkBenchmark(
       nighthawk::client::NighthawkService::StubInterface* nighthawk_service_stub,
       const nighthawk::client::CommandLineOptions& command_line_options) const override;
+
+  /**
+   * Like PerformNighthawkBenchmark() above, but hands the progress reports that precede the final
+   * response to a callback.
+   *
+   * @param nighthawk_service_stub Nighthawk Service gRPC stub.
+   * @param command_line_options Nighthawk Service benchmark request proto. Set
+   * progress_report_interval to have the Nighthawk Service send progress reports.
+   * @param progress_callback Invoked with the output of each progress report, on the calling
+   * thread. May be nullptr, in which case progress reports are skipped.
+   *
+   * @return StatusOr<ExecutionResponse> See PerformNighthawkBenchmark() above.
+   */
+  absl::StatusOr<nighthawk::client::ExecutionResponse>
+  PerformNighthawkBenchmark(nighthawk::client::NighthawkService::StubInterface* nighthawk_service_stub,
+                            const nighthawk::client::CommandLineOptions& command_line_options,
+                            const ProgressCallback& progress_callback) const;
 };
 
 } // namespace Nighthawk
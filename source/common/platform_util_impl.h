@@ -1,6 +1,7 @@
 #pragma once
 
 #include <pthread.h>
+#include <time.h>
 
 #include <thread>
 
@@ -22,6 +23,13 @@ public:
   void sleep(std::chrono::microseconds duration) const override {
     std::this_thread::sleep_for(duration); // NO_CHECK_FORMAT(real_time)
   };
+  std::chrono::nanoseconds currentThreadCpuTime() const override {
+    timespec cpu_time{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::seconds(cpu_time.tv_sec) + std::chrono::nanoseconds(cpu_time.tv_nsec);
+  }
 };
 
 } // namespace Nighthawk
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "source/common/rate_limiter_impl.h"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
@@ -16,6 +17,8 @@
 #include "external/envoy/source/common/protobuf/utility.h"
 #include "nighthawk/common/rate_limiter_plugin_config_factory.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Nighthawk {
 
 using namespace std::chrono_literals;
@@ -54,6 +57,25 @@ bool BurstingRateLimiter::tryAcquireOne() {
   return false;
 }
 
+uint64_t BurstingRateLimiter::tryAcquire(uint64_t max_count) {
+  uint64_t count = 0;
+  if (!releasing_) {
+    // Accumulating goes through the wrapped rate limiter, until a burst is released.
+    if (max_count == 0 || !tryAcquireOne()) {
+      return 0;
+    }
+    count = 1;
+  }
+  // Drain what remains of the released burst in one go.
+  const uint64_t drained = std::min(max_count - count, accumulated_);
+  if (drained > 0) {
+    accumulated_ -= drained;
+    releasing_ = accumulated_ > 0;
+    previously_releasing_ = true;
+  }
+  return count + drained;
+}
+
 void BurstingRateLimiter::releaseOne() {
   ASSERT(accumulated_ < burst_size_);
   ASSERT(previously_releasing_ != std::nullopt && previously_releasing_ == true);
@@ -64,6 +86,13 @@ void BurstingRateLimiter::releaseOne() {
   previously_releasing_ = std::nullopt;
 }
 
+std::optional<Envoy::MonotonicTime> BurstingRateLimiter::nextReleaseTime() const {
+  // While releasing, the accumulated burst is due already: the release time of the acquisition
+  // that completed it lies in the past. Otherwise the next burst can not be released before the
+  // next acquisition of the wrapped rate limiter.
+  return releasing_ ? rate_limiter_->scheduledReleaseTime(0) : rate_limiter_->nextReleaseTime();
+}
+
 ScheduledStartingRateLimiter::ScheduledStartingRateLimiter(
     RateLimiterPtr&& rate_limiter, const Envoy::MonotonicTime scheduled_starting_time)
     : ForwardingRateLimiterImpl(std::move(rate_limiter)),
@@ -73,10 +102,12 @@ ScheduledStartingRateLimiter::ScheduledStartingRateLimiter(
   }
 }
 
-bool ScheduledStartingRateLimiter::tryAcquireOne() {
+bool ScheduledStartingRateLimiter::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+uint64_t ScheduledStartingRateLimiter::tryAcquire(uint64_t max_count) {
   if (timeSource().monotonicTime() < scheduled_starting_time_) {
     aquisition_attempted_ = true;
-    return false;
+    return 0;
   }
   // If we start forwarding right away on the first attempt that is remarkable, so leave a hint
   // about this happening in the logs.
@@ -84,7 +115,23 @@ bool ScheduledStartingRateLimiter::tryAcquireOne() {
     aquisition_attempted_ = true;
     ENVOY_LOG(warn, "ScheduledStartingRateLimiter: first acquisition attempt was late");
   }
-  return rate_limiter_->tryAcquireOne();
+  return rate_limiter_->tryAcquire(max_count);
+}
+
+std::optional<Envoy::MonotonicTime> ScheduledStartingRateLimiter::nextReleaseTime() const {
+  const std::optional<Envoy::MonotonicTime> next_release_time = rate_limiter_->nextReleaseTime();
+  if (next_release_time == std::nullopt) {
+    // Once started, a wrapped rate limiter that can't tell (e.g. because it is exhausted) is left
+    // to the periodic timer. Returning the start time here would make callers spin on it.
+    if (timeSource().monotonicTime() < scheduled_starting_time_) {
+      return scheduled_starting_time_;
+    }
+    return std::nullopt;
+  }
+  if (next_release_time.value() < scheduled_starting_time_) {
+    return scheduled_starting_time_;
+  }
+  return next_release_time;
 }
 
 void ScheduledStartingRateLimiter::releaseOne() {
@@ -101,14 +148,25 @@ LinearRateLimiter::LinearRateLimiter(Envoy::TimeSource& time_source, const Frequ
   }
 }
 
-bool LinearRateLimiter::tryAcquireOne() {
+bool LinearRateLimiter::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+uint64_t LinearRateLimiter::tryAcquire(uint64_t max_count) {
   // TODO(oschaaf): consider adding an explicit start() call to the interface.
-  if (acquireable_count_ > 0) {
-    acquireable_count_--;
-    acquired_count_++;
-    return true;
+  if (acquireable_count_ <= 0) {
+    updateAcquireableCount();
+  }
+  if (acquireable_count_ <= 0 || max_count == 0) {
+    return 0;
   }
+  const uint64_t count = std::min<uint64_t>(max_count, acquireable_count_);
+  acquireable_count_ -= count;
+  batch_first_acquisition_number_ = acquired_count_ + 1;
+  batch_count_ = count;
+  acquired_count_ += count;
+  return count;
+}
 
+void LinearRateLimiter::updateAcquireableCount() {
   // As the common case for configured execution duration is in seconds, we shift phase so that
   // acquisitions timed at one second boundaries will be avoided.
   // For example, at three rps our timings should look like [0.16667s, 0.5s, 0.83333s,...].
@@ -116,7 +174,6 @@ bool LinearRateLimiter::tryAcquireOne() {
   const auto phase_shifted = elapsed() + (frequency_.interval() / 2);
   acquireable_count_ =
       static_cast<int64_t>(std::floor(phase_shifted / frequency_.interval())) - acquired_count_;
-  return acquireable_count_ > 0 ? tryAcquireOne() : false;
 }
 
 void LinearRateLimiter::releaseOne() {
@@ -124,6 +181,23 @@ void LinearRateLimiter::releaseOne() {
   acquired_count_--;
 }
 
+std::chrono::nanoseconds LinearRateLimiter::acquisitionOffset(uint64_t acquisition_number) const {
+  // Undo the phase shift in tryAcquireOne() to get at the point in time an acquisition is due.
+  return std::chrono::duration_cast<std::chrono::nanoseconds>((acquisition_number - 0.5) *
+                                                              frequency_.interval());
+}
+
+std::optional<Envoy::MonotonicTime> LinearRateLimiter::scheduledReleaseTime(uint64_t index) const {
+  if (index >= batch_count_) {
+    return std::nullopt;
+  }
+  return timeAtOffset(acquisitionOffset(batch_first_acquisition_number_ + index));
+}
+
+std::optional<Envoy::MonotonicTime> LinearRateLimiter::nextReleaseTime() const {
+  return timeAtOffset(acquisitionOffset(acquired_count_ + 1));
+}
+
 LinearRampingRateLimiterImpl::LinearRampingRateLimiterImpl(Envoy::TimeSource& time_source,
                                                            const std::chrono::nanoseconds ramp_time,
                                                            const Frequency frequency)
@@ -139,11 +213,38 @@ LinearRampingRateLimiterImpl::LinearRampingRateLimiterImpl(Envoy::TimeSource& ti
   }
 }
 
-bool LinearRampingRateLimiterImpl::tryAcquireOne() {
-  if (acquireable_count_) {
-    acquired_count_++;
-    return acquireable_count_--;
+std::chrono::nanoseconds
+LinearRampingRateLimiterImpl::acquisitionOffset(uint64_t acquisition_number) const {
+  // Inverts the computation of the number of acquireable requests in tryAcquireOne(). That rounds,
+  // so an acquisition becomes due when the exact count reaches half a request below its number.
+  const double exact_count = acquisition_number - 0.5;
+  if (acquisition_number <= static_cast<uint64_t>(total_ramp_requests_)) {
+    // While ramping, count = t^2 * frequency / (2 * ramp_time).
+    return std::chrono::nanoseconds(static_cast<int64_t>(
+        std::sqrt(2.0 * exact_count * ramp_time_.count() / target_freq_ns_)));
+  }
+  return ramp_time_ + std::chrono::nanoseconds(static_cast<int64_t>(
+                          (exact_count - total_ramp_requests_) / target_freq_ns_));
+}
+
+bool LinearRampingRateLimiterImpl::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+uint64_t LinearRampingRateLimiterImpl::tryAcquire(uint64_t max_count) {
+  if (acquireable_count_ <= 0) {
+    updateAcquireableCount();
   }
+  if (acquireable_count_ <= 0 || max_count == 0) {
+    return 0;
+  }
+  const uint64_t count = std::min<uint64_t>(max_count, acquireable_count_);
+  acquireable_count_ -= count;
+  batch_first_acquisition_number_ = acquired_count_ + 1;
+  batch_count_ = count;
+  acquired_count_ += count;
+  return count;
+}
+
+void LinearRampingRateLimiterImpl::updateAcquireableCount() {
   const std::chrono::nanoseconds elapsed_time = elapsed();
   int64_t total = 0;
 
@@ -162,7 +263,6 @@ bool LinearRampingRateLimiterImpl::tryAcquireOne() {
         total_ramp_requests_ + std::round((elapsed_time - ramp_time_).count() * target_freq_ns_);
   }
   acquireable_count_ = total - acquired_count_;
-  return acquireable_count_ > 0 ? tryAcquireOne() : false;
 }
 
 void LinearRampingRateLimiterImpl::releaseOne() {
@@ -170,6 +270,18 @@ void LinearRampingRateLimiterImpl::releaseOne() {
   acquired_count_--;
 }
 
+std::optional<Envoy::MonotonicTime>
+LinearRampingRateLimiterImpl::scheduledReleaseTime(uint64_t index) const {
+  if (index >= batch_count_) {
+    return std::nullopt;
+  }
+  return timeAtOffset(acquisitionOffset(batch_first_acquisition_number_ + index));
+}
+
+std::optional<Envoy::MonotonicTime> LinearRampingRateLimiterImpl::nextReleaseTime() const {
+  return timeAtOffset(acquisitionOffset(acquired_count_ + 1));
+}
+
 RateLimiterPtr LinearRampingRateLimiterImplFactory::createRateLimiterPlugin(
     const Envoy::Protobuf::Message& typed_config, Envoy::Api::Api& api,
     Envoy::TimeSource& time_source, const Nighthawk::Client::Options& options) {
@@ -198,15 +310,143 @@ RateLimiterPtr LinearRampingRateLimiterImplFactory::createRateLimiterPlugin(
 
 REGISTER_FACTORY(LinearRampingRateLimiterImplFactory, RateLimiterPluginConfigFactory);
 
+TraceReplayRateLimiterImpl::TraceReplayRateLimiterImpl(Envoy::TimeSource& time_source,
+                                                       RequestTraceCursor cursor,
+                                                       const double speedup)
+    : RateLimiterBaseImpl(time_source), cursor_(std::move(cursor)), speedup_(speedup) {
+  if (speedup_ <= 0) {
+    throw NighthawkException("speedup must be positive and > 0");
+  }
+  loadNextRelease();
+}
+
+void TraceReplayRateLimiterImpl::loadNextRelease() {
+  next_release_ = std::nullopt;
+  if (cursor_.done()) {
+    return;
+  }
+  absl::StatusOr<RequestTraceRecord> record = cursor_.next();
+  if (!record.ok()) {
+    ENVOY_LOG(error, "Failed to read request trace: {}", record.status().message());
+    return;
+  }
+  next_release_ = std::chrono::nanoseconds(
+      static_cast<int64_t>(std::round(record->start_offset.count() / speedup_)));
+}
+
+bool TraceReplayRateLimiterImpl::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+void TraceReplayRateLimiterImpl::addToBatch(uint64_t count, std::chrono::nanoseconds offset) {
+  if (count == 0) {
+    batch_offsets_.clear();
+  }
+  batch_offsets_.push_back(offset);
+}
+
+uint64_t TraceReplayRateLimiterImpl::tryAcquire(uint64_t max_count) {
+  uint64_t count = 0;
+  while (count < max_count && !returned_offsets_.empty()) {
+    addToBatch(count++, returned_offsets_.back());
+    returned_offsets_.pop_back();
+  }
+  if (count == max_count || next_release_ == std::nullopt) {
+    return count;
+  }
+  const std::chrono::nanoseconds elapsed_time = elapsed();
+  while (count < max_count && next_release_ != std::nullopt &&
+         elapsed_time >= next_release_.value()) {
+    addToBatch(count++, next_release_.value());
+    loadNextRelease();
+  }
+  return count;
+}
+
+void TraceReplayRateLimiterImpl::releaseOne() {
+  // The caller hands back the last acquisition it made.
+  if (batch_offsets_.empty()) {
+    returned_offsets_.push_back(0ns);
+    return;
+  }
+  returned_offsets_.push_back(batch_offsets_.back());
+  batch_offsets_.pop_back();
+}
+
+std::optional<Envoy::MonotonicTime>
+TraceReplayRateLimiterImpl::scheduledReleaseTime(uint64_t index) const {
+  if (index >= batch_offsets_.size()) {
+    return std::nullopt;
+  }
+  return timeAtOffset(batch_offsets_[index]);
+}
+
+std::optional<Envoy::MonotonicTime> TraceReplayRateLimiterImpl::nextReleaseTime() const {
+  if (!returned_offsets_.empty()) {
+    return timeAtOffset(0ns);
+  }
+  if (next_release_ == std::nullopt) {
+    return std::nullopt;
+  }
+  return timeAtOffset(next_release_.value());
+}
+
+RateLimiterPtr TraceReplayRateLimiterImplFactory::createRateLimiterPlugin(
+    const Envoy::Protobuf::Message& typed_config, Envoy::Api::Api& api,
+    Envoy::TimeSource& time_source, const Nighthawk::Client::Options& options) {
+  return createRateLimiterPluginForWorker(typed_config, api, time_source, options, {});
+}
+
+RateLimiterPtr TraceReplayRateLimiterImplFactory::createRateLimiterPluginForWorker(
+    const Envoy::Protobuf::Message& typed_config, Envoy::Api::Api& api,
+    Envoy::TimeSource& time_source, const Nighthawk::Client::Options& options,
+    const WorkerContext& worker_context) {
+  UNREFERENCED_PARAMETER(api);
+  UNREFERENCED_PARAMETER(options);
+  const auto* any = Envoy::Protobuf::DynamicCastMessage<const Envoy::Protobuf::Any>(&typed_config);
+  if (any == nullptr) {
+    throw Envoy::EnvoyException("typed_config cannot be cast to an Any proto");
+  }
+  nighthawk::rate_limiter::TraceReplayRateLimiterConfig config;
+  Envoy::MessageUtil::anyConvert(*any, config);
+
+  absl::StatusOr<MappedRequestTraceSharedPtr> trace_or =
+      MappedRequestTrace::open(config.file_path());
+  if (!trace_or.ok()) {
+    throw NighthawkException(std::string(trace_or.status().message()));
+  }
+  MappedRequestTraceSharedPtr trace = *std::move(trace_or);
+  if (!trace->hasStartOffsets()) {
+    throw NighthawkException(absl::StrCat(
+        "request trace '", config.file_path(),
+        "' does not have start offsets, re-create it with nighthawk_request_trace_converter"));
+  }
+  const RequestTracePartition partition =
+      RequestTracePartition::create(config.partitioning(), trace->recordCount(), worker_context);
+  absl::StatusOr<RequestTraceCursor> cursor_or =
+      RequestTraceCursor::create(std::move(trace), partition);
+  if (!cursor_or.ok()) {
+    throw NighthawkException(std::string(cursor_or.status().message()));
+  }
+  const double speedup = config.has_speedup() ? config.speedup().value() : 1.0;
+  return std::make_unique<TraceReplayRateLimiterImpl>(time_source, *std::move(cursor_or), speedup);
+}
+
+REGISTER_FACTORY(TraceReplayRateLimiterImplFactory, RateLimiterPluginConfigFactory);
+
 DelegatingRateLimiterImpl::DelegatingRateLimiterImpl(
     RateLimiterPtr&& rate_limiter, RateLimiterDelegate random_distribution_generator)
     : ForwardingRateLimiterImpl(std::move(rate_limiter)),
       random_distribution_generator_(std::move(random_distribution_generator)) {}
 
-bool DelegatingRateLimiterImpl::tryAcquireOne() {
+bool DelegatingRateLimiterImpl::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+uint64_t DelegatingRateLimiterImpl::tryAcquire(uint64_t max_count) {
   const Envoy::MonotonicTime now = timeSource().monotonicTime();
-  if (rate_limiter_->tryAcquireOne()) {
-    const Envoy::MonotonicTime adjusted = now + random_distribution_generator_();
+  const uint64_t acquired = rate_limiter_->tryAcquire(max_count);
+  for (uint64_t i = 0; i < acquired; i++) {
+    // Offset the time the wrapped rate limiter intended to release at, so that falling behind
+    // shows up as queueing delay instead of being absorbed by the offset.
+    const Envoy::MonotonicTime adjusted =
+        rate_limiter_->scheduledReleaseTime(i).value_or(now) + random_distribution_generator_();
     // We track a sorted list of timings, where the one at the front is the one that should
     // be applied the soonest.
     distributed_timings_.insert(
@@ -214,13 +454,33 @@ bool DelegatingRateLimiterImpl::tryAcquireOne() {
         adjusted);
   }
 
-  if (!distributed_timings_.empty() && distributed_timings_.front() <= now) {
+  uint64_t count = 0;
+  while (count < max_count && !distributed_timings_.empty() &&
+         distributed_timings_.front() <= now) {
+    if (count == 0) {
+      scheduled_release_times_.clear();
+    }
+    scheduled_release_times_.push_back(distributed_timings_.front());
     distributed_timings_.pop_front();
+    count++;
+  }
+  if (count > 0) {
     sanity_check_pending_release_ = false;
-    return true;
   }
+  return count;
+}
 
-  return false;
+std::optional<Envoy::MonotonicTime> DelegatingRateLimiterImpl::nextReleaseTime() const {
+  // Offsets are never negative, so the wrapped rate limiter bounds releases that are not tracked
+  // yet.
+  const std::optional<Envoy::MonotonicTime> next_release_time = rate_limiter_->nextReleaseTime();
+  if (distributed_timings_.empty()) {
+    return next_release_time;
+  }
+  if (next_release_time.has_value()) {
+    return std::min(distributed_timings_.front(), next_release_time.value());
+  }
+  return distributed_timings_.front();
 }
 
 void DelegatingRateLimiterImpl::releaseOne() {
@@ -241,8 +501,22 @@ FilteringRateLimiterImpl::FilteringRateLimiterImpl(RateLimiterPtr&& rate_limiter
                                                    RateLimiterFilter filter)
     : ForwardingRateLimiterImpl(std::move(rate_limiter)), filter_(std::move(filter)) {}
 
-bool FilteringRateLimiterImpl::tryAcquireOne() {
-  return rate_limiter_->tryAcquireOne() ? filter_() : false;
+bool FilteringRateLimiterImpl::tryAcquireOne() { return tryAcquire(1) == 1; }
+
+uint64_t FilteringRateLimiterImpl::tryAcquire(uint64_t max_count) {
+  // The filter is consulted for each acquisition, and suppressed acquisitions are lost.
+  const uint64_t acquired = rate_limiter_->tryAcquire(max_count);
+  uint64_t count = 0;
+  for (uint64_t i = 0; i < acquired; i++) {
+    if (filter_()) {
+      if (count == 0) {
+        passed_indices_.clear();
+      }
+      passed_indices_.push_back(i);
+      count++;
+    }
+  }
+  return count;
 }
 
 GraduallyOpeningRateLimiterFilter::GraduallyOpeningRateLimiterFilter(
@@ -3,6 +3,7 @@
 #include <list>
 #include <optional>
 #include <random>
+#include <vector>
 
 #include "envoy/common/time.h"
 
@@ -11,10 +12,12 @@
 #include "external/envoy/source/common/common/logger.h"
 
 #include "source/common/frequency.h"
+#include "source/common/request_trace.h"
 
 #include "absl/random/random.h"
 #include "absl/random/zipf_distribution.h"
 #include "api/rate_limiter/linear_ramping_rate_limiter.pb.h"
+#include "api/rate_limiter/trace_replay_rate_limiter.pb.h"
 #include "nighthawk/common/rate_limiter_plugin_config_factory.h"
 
 namespace Nighthawk {
@@ -42,6 +45,24 @@ public:
     return first_acquisition_time_;
   }
 
+  // Derivations that track the pacing of their acquisitions override this.
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t) const override {
+    return std::nullopt;
+  }
+
+protected:
+  /**
+   * @param offset Offset from the first call to elapsed().
+   * @return std::optional<Envoy::MonotonicTime> The point in time at the offset, or std::nullopt
+   * if elapsed() has not been called yet.
+   */
+  std::optional<Envoy::MonotonicTime> timeAtOffset(std::chrono::nanoseconds offset) const {
+    if (start_time_ == std::nullopt) {
+      return std::nullopt;
+    }
+    return start_time_.value() + offset;
+  }
+
 private:
   Envoy::TimeSource& time_source_;
   std::optional<Envoy::MonotonicTime> start_time_;
@@ -58,11 +79,23 @@ class LinearRateLimiter : public RateLimiterBaseImpl,
 public:
   LinearRateLimiter(Envoy::TimeSource& time_source, const Frequency frequency);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override;
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override;
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
 
 protected:
+  // Returns the offset from the start at which the acquisition with the given number, counting
+  // from 1, is due.
+  std::chrono::nanoseconds acquisitionOffset(uint64_t acquisition_number) const;
+  // Updates acquireable_count_ with the acquisitions that have become due.
+  void updateAcquireableCount();
+
   int64_t acquireable_count_{0};
   uint64_t acquired_count_{0};
+  // Number of the first acquisition made by the most recent successful call, and how many it made.
+  uint64_t batch_first_acquisition_number_{0};
+  uint64_t batch_count_{0};
   const Frequency frequency_;
 };
 
@@ -75,11 +108,23 @@ public:
   LinearRampingRateLimiterImpl(Envoy::TimeSource& time_source,
                                const std::chrono::nanoseconds ramp_time, const Frequency frequency);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override;
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override;
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
 
 private:
+  // Returns the offset from the start at which the acquisition with the given number, counting
+  // from 1, is due.
+  std::chrono::nanoseconds acquisitionOffset(uint64_t acquisition_number) const;
+  // Updates acquireable_count_ with the acquisitions that have become due.
+  void updateAcquireableCount();
+
   int64_t acquireable_count_{0};
   uint64_t acquired_count_{0};
+  // Number of the first acquisition made by the most recent successful call, and how many it made.
+  uint64_t batch_first_acquisition_number_{0};
+  uint64_t batch_count_{0};
   const std::chrono::nanoseconds ramp_time_;
   const Frequency frequency_;
   const double target_freq_ns_;
@@ -101,6 +146,69 @@ public:
                                          const Nighthawk::Client::Options& options) override;
 };
 
+/**
+ * A rate limiter which replays the arrival pattern of a request trace. Each record of the trace is
+ * released once its start offset, divided by the speedup factor, has elapsed. Once all records
+ * have been released, acquisitions will no longer succeed.
+ */
+class TraceReplayRateLimiterImpl : public RateLimiterBaseImpl,
+                                   public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param time_source Time source used to track elapsed time.
+   * @param cursor Cursor over the records of the trace that should be released, in order.
+   * @param speedup Time compression factor applied to the start offsets of the records. Must be
+   * larger than 0.
+   */
+  TraceReplayRateLimiterImpl(Envoy::TimeSource& time_source, RequestTraceCursor cursor,
+                             const double speedup);
+  bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
+  void releaseOne() override;
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override;
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
+
+private:
+  // Reads the next record from cursor_, and sets next_release_ to the point in time, relative to
+  // the first acquisition attempt, at which it should be released.
+  void loadNextRelease();
+  // Adds an acquisition that was due at the offset to the acquisitions made by the current call,
+  // which has made count acquisitions so far.
+  void addToBatch(uint64_t count, std::chrono::nanoseconds offset);
+
+  RequestTraceCursor cursor_;
+  const double speedup_;
+  // Unset once all records have been released.
+  std::optional<std::chrono::nanoseconds> next_release_;
+  // Offsets of the acquisitions made by the most recent successful call.
+  std::vector<std::chrono::nanoseconds> batch_offsets_;
+  // Offsets of acquisitions that were handed back through releaseOne(), which can be re-acquired
+  // right away. The earliest is at the back.
+  std::vector<std::chrono::nanoseconds> returned_offsets_;
+};
+
+// Factory class for creating TraceReplayRateLimiterImpl objects. Each worker replays the records
+// of its partition of the trace, partitioned like the mapped trace request source does.
+class TraceReplayRateLimiterImplFactory
+    : public virtual Nighthawk::RateLimiterPluginConfigFactory {
+public:
+  std::string name() const override { return "nighthawk.trace-replay-rate-limiter-plugin"; }
+
+  Envoy::ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<nighthawk::rate_limiter::TraceReplayRateLimiterConfig>();
+  }
+
+  RateLimiterPtr createRateLimiterPlugin(const Envoy::Protobuf::Message& typed_config,
+                                         Envoy::Api::Api& api, Envoy::TimeSource& time_source,
+                                         const Nighthawk::Client::Options& options) override;
+
+  RateLimiterPtr createRateLimiterPluginForWorker(const Envoy::Protobuf::Message& typed_config,
+                                                  Envoy::Api::Api& api,
+                                                  Envoy::TimeSource& time_source,
+                                                  const Nighthawk::Client::Options& options,
+                                                  const WorkerContext& worker_context) override;
+};
+
 /**
  * Base for a rate limiter which wraps another rate limiter, and forwards
  * some calls.
@@ -114,6 +222,12 @@ public:
   std::optional<Envoy::SystemTime> firstAcquisitionTime() const override {
     return rate_limiter_->firstAcquisitionTime();
   }
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override {
+    return rate_limiter_->scheduledReleaseTime(index);
+  }
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override {
+    return rate_limiter_->nextReleaseTime();
+  }
 
 protected:
   const RateLimiterPtr rate_limiter_;
@@ -132,7 +246,13 @@ class BurstingRateLimiter : public ForwardingRateLimiterImpl,
 public:
   BurstingRateLimiter(RateLimiterPtr&& rate_limiter, const uint64_t burst_size);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override;
+  // All acquisitions of a burst were due when the acquisition that completed it was due.
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t) const override {
+    return rate_limiter_->scheduledReleaseTime(0);
+  }
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
 
 private:
   const uint64_t burst_size_;
@@ -155,7 +275,9 @@ public:
   ScheduledStartingRateLimiter(RateLimiterPtr&& rate_limiter,
                                const Envoy::MonotonicTime scheduled_starting_time);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override;
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
 
 private:
   const Envoy::MonotonicTime scheduled_starting_time_;
@@ -179,13 +301,23 @@ public:
   DelegatingRateLimiterImpl(RateLimiterPtr&& rate_limiter,
                             RateLimiterDelegate random_distribution_generator);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override;
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override {
+    if (index >= scheduled_release_times_.size()) {
+      return std::nullopt;
+    }
+    return scheduled_release_times_[index];
+  }
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override;
 
 protected:
   const RateLimiterDelegate random_distribution_generator_;
 
 private:
   std::list<Envoy::MonotonicTime> distributed_timings_;
+  // The offsetted timings of the acquisitions made by the most recent successful call.
+  std::vector<Envoy::MonotonicTime> scheduled_release_times_;
   // Used to enforce that releaseOne() is always paired with a successfull tryAcquireOne().
   bool sanity_check_pending_release_{true};
 };
@@ -225,10 +357,22 @@ class FilteringRateLimiterImpl : public ForwardingRateLimiterImpl,
 public:
   FilteringRateLimiterImpl(RateLimiterPtr&& rate_limiter, RateLimiterFilter filter);
   bool tryAcquireOne() override;
+  uint64_t tryAcquire(uint64_t max_count) override;
   void releaseOne() override { rate_limiter_->releaseOne(); }
+  std::optional<Envoy::MonotonicTime> scheduledReleaseTime(uint64_t index) const override {
+    if (index >= passed_indices_.size()) {
+      return std::nullopt;
+    }
+    return rate_limiter_->scheduledReleaseTime(passed_indices_[index]);
+  }
 
 protected:
   const RateLimiterFilter filter_;
+
+private:
+  // Positions, among the acquisitions of the wrapped rate limiter, of those that passed the filter
+  // during the most recent successful call.
+  std::vector<uint64_t> passed_indices_;
 };
 
 /**
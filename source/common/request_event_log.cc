@@ -0,0 +1,145 @@
+#include "source/common/request_event_log.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "external/envoy/source/common/common/assert.h"
+
+#include "absl/base/config.h"
+#include "absl/strings/str_cat.h"
+
+// Records are written and read by copying them to and from memory as-is.
+#ifndef ABSL_IS_LITTLE_ENDIAN
+#error "The request event log format is only supported on little endian hosts."
+#endif
+
+namespace Nighthawk {
+
+using namespace std::chrono_literals;
+
+RequestEventLog::RequestEventLog(std::string path, uint32_t worker_count, uint64_t ring_capacity)
+    : path_(std::move(path)) {
+  producers_.reserve(worker_count);
+  for (uint32_t worker_id = 0; worker_id < worker_count; worker_id++) {
+    producers_.push_back(std::make_unique<RequestEventLogProducer>(worker_id, ring_capacity));
+  }
+}
+
+RequestEventLog::~RequestEventLog() { stop(); }
+
+absl::Status RequestEventLog::start(Envoy::Thread::ThreadFactory& thread_factory,
+                                    Envoy::TimeSource& time_source) {
+  RELEASE_ASSERT(writer_thread_ == nullptr, "start() may only be called once");
+  output_.open(path_, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output_.is_open()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Failed to open request event log '", path_, "': ", strerror(errno)));
+  }
+  RequestEventLogFileHeader header{};
+  memcpy(header.magic, RequestEventLogFormat::kMagic.data(), sizeof(header.magic));
+  header.version = RequestEventLogFormat::kVersion;
+  header.record_size = sizeof(RequestEventRecord);
+  header.monotonic_origin_ns = time_source.monotonicTime().time_since_epoch().count();
+  header.system_origin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                time_source.systemTime().time_since_epoch())
+                                .count();
+  output_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!output_.good()) {
+    return absl::InternalError(absl::StrCat("Failed to write request event log '", path_, "'"));
+  }
+  writer_thread_ = thread_factory.createThread([this]() { runWriterThread(); },
+                                               Envoy::Thread::Options{"request_event_log"});
+  return absl::OkStatus();
+}
+
+void RequestEventLog::stop() {
+  if (writer_thread_ == nullptr || shutdown_.exchange(true)) {
+    return;
+  }
+  writer_thread_->join();
+  output_.close();
+  const uint64_t dropped = recordsDropped();
+  if (dropped > 0) {
+    ENVOY_LOG(warn,
+              "Request event log '{}': {} records written, {} dropped because a ring was full.",
+              path_, recordsWritten(), dropped);
+  } else {
+    ENVOY_LOG(info, "Request event log '{}': {} records written.", path_, recordsWritten());
+  }
+}
+
+RequestEventLogProducer& RequestEventLog::producer(uint32_t worker_id) {
+  RELEASE_ASSERT(worker_id < producers_.size(), "worker_id out of range");
+  return *producers_[worker_id];
+}
+
+uint64_t RequestEventLog::recordsDropped() const {
+  uint64_t dropped = 0;
+  for (const std::unique_ptr<RequestEventLogProducer>& producer : producers_) {
+    dropped += producer->dropped();
+  }
+  return dropped;
+}
+
+void RequestEventLog::runWriterThread() {
+  while (!shutdown_.load(std::memory_order_acquire)) {
+    if (drain() == 0) {
+      platform_util_.sleep(1ms);
+    }
+  }
+  // Pick up what the workers queued while we were last asleep.
+  drain();
+  output_.flush();
+  if (!output_.good()) {
+    ENVOY_LOG(error, "Failed to write request event log '{}'.", path_);
+  }
+}
+
+uint64_t RequestEventLog::drain() {
+  batch_.clear();
+  RequestEventRecord record;
+  for (const std::unique_ptr<RequestEventLogProducer>& producer : producers_) {
+    while (producer->ring_.tryPop(record)) {
+      batch_.push_back(record);
+    }
+  }
+  if (!batch_.empty()) {
+    output_.write(reinterpret_cast<const char*>(batch_.data()),
+                  batch_.size() * sizeof(RequestEventRecord));
+    records_written_.fetch_add(batch_.size(), std::memory_order_relaxed);
+  }
+  return batch_.size();
+}
+
+absl::Status RequestEventLogReader::readHeader() {
+  input_.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+  if (input_.gcount() != sizeof(header_)) {
+    return absl::InvalidArgumentError("Request event log is too small to hold a header");
+  }
+  if (absl::string_view(header_.magic, sizeof(header_.magic)) != RequestEventLogFormat::kMagic) {
+    return absl::InvalidArgumentError("Input is not a request event log");
+  }
+  if (header_.version != RequestEventLogFormat::kVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported request event log version ", header_.version));
+  }
+  if (header_.record_size != sizeof(RequestEventRecord)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unexpected request event log record size ", header_.record_size));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> RequestEventLogReader::next(RequestEventRecord& record) {
+  input_.read(reinterpret_cast<char*>(&record), sizeof(record));
+  const std::streamsize read = input_.gcount();
+  if (read == 0) {
+    return false;
+  }
+  if (read != sizeof(record)) {
+    return absl::DataLossError("Request event log ends with a partial record");
+  }
+  return true;
+}
+
+} // namespace Nighthawk
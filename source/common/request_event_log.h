@@ -0,0 +1,244 @@
+#pragma once
+
+// Per-request binary event log.
+//
+// When enabled, each worker appends a fixed-size RequestEventRecord to its own ring for every
+// request it completes. A background writer thread drains the rings to a file, so that the workers
+// never block on file I/O. When a ring is full, records are dropped and counted.
+//
+// Layout (all integers are little endian):
+//
+//   RequestEventLogFileHeader
+//   record 0 .. record n - 1
+//
+// Records of different workers are interleaved in the order they were drained, and are not sorted
+// by time. Time stamps are monotonic nanoseconds, and can be mapped to wall clock time using the
+// pair of origins in the header.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/thread/thread.h"
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "source/common/mpmc_ring_buffer.h"
+#include "source/common/platform_util_impl.h"
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+
+struct RequestEventLogFileHeader {
+  // Must equal RequestEventLogFormat::kMagic.
+  char magic[8];
+  // Must equal RequestEventLogFormat::kVersion.
+  uint32_t version;
+  // Must equal sizeof(RequestEventRecord).
+  uint32_t record_size;
+  // Monotonic time at which the log was started, in nanoseconds.
+  uint64_t monotonic_origin_ns;
+  // Wall clock time at which the log was started, in nanoseconds since the epoch.
+  uint64_t system_origin_ns;
+};
+static_assert(sizeof(RequestEventLogFileHeader) == 32,
+              "unexpected RequestEventLogFileHeader padding");
+
+enum class RequestEventOutcome : uint8_t {
+  // A complete response was received.
+  Complete = 0,
+  // The stream was reset before the response completed.
+  StreamReset = 1,
+  // The connection pool failed to provide a stream.
+  PoolFailure = 2,
+};
+
+// A single request. Points in time which were not reached are zero.
+struct RequestEventRecord {
+  // Monotonic time at which the request was queued up with the connection pool.
+  uint64_t start_ns;
+  // Monotonic time at which a stream was available and the request got sent.
+  uint64_t connect_ns;
+  // Monotonic time at which the first byte of the response was received.
+  uint64_t first_byte_ns;
+  // Monotonic time at which the request completed or failed.
+  uint64_t complete_ns;
+  // Id of the upstream connection, or RequestEventLogFormat::kNoConnectionId.
+  uint64_t connection_id;
+  // Zero-based position of the request in the sequence of requests started by the worker.
+  uint64_t request_index;
+  // Request header and body bytes.
+  uint32_t request_bytes;
+  // Response header and body bytes.
+  uint32_t response_bytes;
+  uint32_t worker_id;
+  // Response status code, or 0 if no response headers were received.
+  uint16_t response_code;
+  RequestEventOutcome outcome;
+  uint8_t reserved;
+};
+static_assert(sizeof(RequestEventRecord) == 64, "unexpected RequestEventRecord padding");
+
+class RequestEventLogFormat {
+public:
+  static constexpr absl::string_view kMagic{"NHEVLOG\0", 8};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint64_t kNoConnectionId = UINT64_MAX;
+  // Records buffered per worker. 64k records of 64 bytes cover well over 100ms at 100k rps.
+  static constexpr uint64_t kDefaultRingCapacity = 65536;
+};
+
+/**
+ * The per-worker side of a RequestEventLog. record() and nextRequestIndex() must only be called
+ * from the worker's thread.
+ */
+class RequestEventLogProducer {
+public:
+  RequestEventLogProducer(uint32_t worker_id, uint64_t ring_capacity)
+      : worker_id_(worker_id), ring_(ring_capacity) {}
+
+  /**
+   * Queues a record for the writer thread. Drops the record if the ring is full.
+   *
+   * @param record The record to queue. Its worker_id is filled in.
+   */
+  void record(RequestEventRecord& record) {
+    record.worker_id = worker_id_;
+    if (!ring_.tryPush(std::move(record))) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @return uint64_t The index to assign to the next request of the worker.
+   */
+  uint64_t nextRequestIndex() { return next_request_index_++; }
+
+  /**
+   * @return uint64_t The number of records dropped because the ring was full.
+   */
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  friend class RequestEventLog;
+
+  const uint32_t worker_id_;
+  MpmcRingBuffer<RequestEventRecord> ring_;
+  std::atomic<uint64_t> dropped_{0};
+  uint64_t next_request_index_{0};
+};
+
+/**
+ * Owns the per-worker rings and the writer thread that drains them to a file.
+ */
+class RequestEventLog : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param path Path of the file to write. Truncated when the log is started.
+   * @param worker_count The number of workers which will record requests.
+   * @param ring_capacity The minimum number of records each worker can buffer.
+   */
+  RequestEventLog(std::string path, uint32_t worker_count,
+                  uint64_t ring_capacity = RequestEventLogFormat::kDefaultRingCapacity);
+  ~RequestEventLog();
+
+  /**
+   * Opens the file, writes the header and starts the writer thread.
+   *
+   * @param thread_factory Used to create the writer thread.
+   * @param time_source Used to sample the origins written in the header.
+   * @return absl::Status Error status if the file could not be written.
+   */
+  absl::Status start(Envoy::Thread::ThreadFactory& thread_factory, Envoy::TimeSource& time_source);
+
+  /**
+   * Stops the writer thread after draining all queued records, and closes the file. Records
+   * queued after this call are not written. Safe to call more than once.
+   */
+  void stop();
+
+  /**
+   * @param worker_id The worker to obtain the producer for. Must be less than the worker count.
+   * @return RequestEventLogProducer& The producer for the worker.
+   */
+  RequestEventLogProducer& producer(uint32_t worker_id);
+
+  /**
+   * @return uint64_t The number of records written so far.
+   */
+  uint64_t recordsWritten() const { return records_written_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return uint64_t The number of records dropped by all workers so far.
+   */
+  uint64_t recordsDropped() const;
+
+  /**
+   * @return const std::string& The path of the file.
+   */
+  const std::string& path() const { return path_; }
+
+private:
+  void runWriterThread();
+  // Moves all queued records to the file. Returns the number of records written.
+  uint64_t drain();
+
+  const std::string path_;
+  std::vector<std::unique_ptr<RequestEventLogProducer>> producers_;
+  std::ofstream output_;
+  // Only accessed by the writer thread.
+  std::vector<RequestEventRecord> batch_;
+  std::atomic<uint64_t> records_written_{0};
+  std::atomic<bool> shutdown_{false};
+  PlatformUtilImpl platform_util_;
+  Envoy::Thread::ThreadPtr writer_thread_;
+};
+
+using RequestEventLogPtr = std::unique_ptr<RequestEventLog>;
+
+/**
+ * Sequentially reads the header and records of a request event log. Not thread safe.
+ */
+class RequestEventLogReader {
+public:
+  /**
+   * @param input The stream to read from, opened in binary mode. Must outlive the reader.
+   */
+  explicit RequestEventLogReader(std::istream& input) : input_(input) {}
+
+  /**
+   * Reads and validates the header. Must be called once, before next().
+   *
+   * @return absl::Status Error status if the input does not start with a valid header.
+   */
+  absl::Status readHeader();
+
+  /**
+   * @return const RequestEventLogFileHeader& The header, once readHeader() succeeded.
+   */
+  const RequestEventLogFileHeader& header() const { return header_; }
+
+  /**
+   * Reads the next record.
+   *
+   * @param record Set to the record that was read.
+   * @return absl::StatusOr<bool> true if a record was read, false at the end of the log, or an
+   * error status if the log ends with a partial record.
+   */
+  absl::StatusOr<bool> next(RequestEventRecord& record);
+
+private:
+  std::istream& input_;
+  RequestEventLogFileHeader header_{};
+};
+
+} // namespace Nighthawk
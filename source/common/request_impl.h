@@ -7,19 +7,28 @@
 
 #include "nighthawk/common/request.h"
 
+#include "external/envoy/source/common/common/empty_string.h"
+
 namespace Nighthawk {
 
 class RequestImpl : public Request {
 public:
   RequestImpl(HeaderMapPtr header, std::string json_body = "")
-      : header_(std::move(header)), json_body_(json_body) {}
+      : header_(std::move(header)),
+        body_(json_body.empty() ? nullptr
+                                : std::make_shared<const std::string>(std::move(json_body))) {}
+  RequestImpl(HeaderMapPtr header, RequestBodySharedPtr body)
+      : header_(std::move(header)), body_(std::move(body)) {}
 
   HeaderMapPtr header() const override { return header_; }
-  const std::string& body() const override { return json_body_; }
+  const std::string& body() const override {
+    return body_ == nullptr ? Envoy::EMPTY_STRING : *body_;
+  }
+  RequestBodySharedPtr sharedBody() const override { return body_; }
 
 private:
   HeaderMapPtr header_;
-  std::string json_body_;
+  RequestBodySharedPtr body_;
 };
 
 } // namespace Nighthawk
@@ -5,6 +5,7 @@
 #include "envoy/common/exception.h"
 
 #include "external/envoy/source/common/common/assert.h"
+#include "external/envoy/source/common/http/header_map_impl.h"
 
 #include "source/common/request_impl.h"
 
@@ -59,7 +60,7 @@ void RemoteRequestSourceImpl::connectToRequestStreamGrpcService() {
   THROW_IF_NOT_OK_REF(raw_async_client.status());
 
   grpc_client_ = std::make_unique<RequestStreamGrpcClientImpl>(
-      *std::move(raw_async_client), dispatcher_, *base_header_, header_buffer_length_);
+      *std::move(raw_async_client), dispatcher_, *base_header_, header_buffer_length_, scope_);
   grpc_client_->start();
   const Envoy::MonotonicTime start = time_source.monotonicTime();
   bool timeout = false;
@@ -83,4 +84,133 @@ RequestGenerator RemoteRequestSourceImpl::get() {
   return [this]() -> RequestPtr { return grpc_client_->maybeDequeue(); };
 }
 
+SharedRequestSourceImpl::SharedRequestSourceImpl(RequestSourcePtr upstream, uint32_t capacity,
+                                                 ProducerMode producer_mode,
+                                                 Envoy::Thread::ThreadFactory& thread_factory)
+    : upstream_(std::move(upstream)), producer_mode_(producer_mode), ring_(capacity) {
+  RELEASE_ASSERT(upstream_ != nullptr, "upstream can't equal nullptr");
+  if (producer_mode_ == ProducerMode::Thread) {
+    producer_thread_ = thread_factory.createThread([this]() { runProducerThread(); },
+                                                   Envoy::Thread::Options{"request_source"});
+  }
+}
+
+SharedRequestSourceImpl::~SharedRequestSourceImpl() {
+  shutdown_ = true;
+  if (producer_thread_ != nullptr) {
+    producer_thread_->join();
+  }
+}
+
+RequestSourcePtr SharedRequestSourceImpl::createConsumer(Envoy::Stats::Scope& scope) {
+  // The first consumer is created for the worker whose dispatcher the upstream source is bound to.
+  const bool owns_upstream = producer_mode_ == ProducerMode::OwningWorker && !owner_assigned_;
+  owner_assigned_ = owner_assigned_ || owns_upstream;
+  return std::make_unique<SharedRequestSourceConsumerImpl>(shared_from_this(), scope,
+                                                           owns_upstream);
+}
+
+uint64_t SharedRequestSourceImpl::produce() {
+  uint64_t produced = 0;
+  while (!exhausted_.load(std::memory_order_relaxed)) {
+    if (pending_ == nullptr) {
+      pending_ = upstream_generator_();
+      if (pending_ == nullptr) {
+        if (producer_mode_ == ProducerMode::Thread) {
+          exhausted_.store(true, std::memory_order_release);
+        }
+        break;
+      }
+    }
+    if (!ring_.tryPush(std::move(pending_))) {
+      break;
+    }
+    ++produced;
+  }
+  return produced;
+}
+
+RequestPtr SharedRequestSourceImpl::pop(Envoy::Stats::Counter& starved) {
+  RequestPtr request;
+  if (ring_.tryPop(request)) {
+    return request;
+  }
+  if (exhausted_.load(std::memory_order_acquire)) {
+    // The final requests may have been pushed between the first attempt and the upstream source
+    // being marked as exhausted.
+    ring_.tryPop(request);
+    return request;
+  }
+  starved.inc();
+  return nullptr;
+}
+
+void SharedRequestSourceImpl::initUpstreamOnThread() {
+  upstream_->initOnThread();
+  upstream_generator_ = upstream_->get();
+}
+
+void SharedRequestSourceImpl::destroyUpstreamOnThread() {
+  upstream_generator_ = nullptr;
+  upstream_->destroyOnThread();
+}
+
+void SharedRequestSourceImpl::runProducerThread() {
+  initUpstreamOnThread();
+  while (!shutdown_ && !exhausted_) {
+    if (produce() == 0) {
+      // Either the ring is full, or the workers have stopped consuming. Back off like the
+      // sequencer's sleep idle strategy does.
+      platform_util_.sleep(50us);
+    }
+  }
+  ENVOY_LOG(debug, "Shared request source producer done, upstream exhausted: {}",
+            exhausted_.load());
+  destroyUpstreamOnThread();
+}
+
+SharedRequestSourceConsumerImpl::SharedRequestSourceConsumerImpl(
+    SharedRequestSourceImplSharedPtr shared_source, Envoy::Stats::Scope& scope, bool owns_upstream)
+    : shared_source_(std::move(shared_source)),
+      starved_(scope.counterFromString("shared_request_source_starved")),
+      owns_upstream_(owns_upstream) {}
+
+RequestGenerator SharedRequestSourceConsumerImpl::get() {
+  return [this]() -> RequestPtr {
+    if (owns_upstream_) {
+      shared_source_->produce();
+    }
+    RequestPtr request = shared_source_->pop(starved_);
+    if (request == nullptr) {
+      return nullptr;
+    }
+    return std::make_unique<RequestImpl>(ownHeader(request->header()), request->sharedBody());
+  };
+}
+
+HeaderMapPtr SharedRequestSourceConsumerImpl::ownHeader(const HeaderMapPtr& shared_header) {
+  // Other workers may read the shared header map at the same time. Copying only iterates it, which
+  // unlike lookups doesn't touch its lazily built index. Upstream sources commonly yield the same
+  // header map over and over, in which case the copy is reused.
+  if (shared_header != last_shared_header_) {
+    Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+    Envoy::Http::HeaderMapImpl::copyFrom(*header, *shared_header);
+    last_header_ = std::move(header);
+    last_shared_header_ = shared_header;
+  }
+  return last_header_;
+}
+
+void SharedRequestSourceConsumerImpl::initOnThread() {
+  if (owns_upstream_) {
+    shared_source_->initUpstreamOnThread();
+  }
+}
+
+void SharedRequestSourceConsumerImpl::destroyOnThread() {
+  if (owns_upstream_) {
+    shared_source_->destroyUpstreamOnThread();
+  }
+}
+
 } // namespace Nighthawk
@@ -1,12 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
+#include "envoy/thread/thread.h"
 
 #include "nighthawk/common/request.h"
 #include "nighthawk/common/request_source.h"
 
 #include "external/envoy/source/common/common/logger.h"
 
+#include "source/common/mpmc_ring_buffer.h"
+#include "source/common/platform_util_impl.h"
 #include "source/common/request_stream_grpc_client_impl.h"
 
 namespace Nighthawk {
@@ -69,4 +77,116 @@ private:
   const uint32_t header_buffer_length_;
 };
 
+/**
+ * Process-wide request source, which lets all workers draw from a single upstream request source.
+ * Requests yielded by the upstream source are buffered in a bounded lock-free ring, from which the
+ * per-worker request sources created by createConsumer() pop. This avoids each worker holding its
+ * own copy of the request data, or maintaining its own gRPC stream to a remote request source.
+ * When a worker finds the ring empty while the upstream source is not exhausted, it yields nullptr
+ * and increments its shared_request_source_starved counter.
+ *
+ * Upstream sources may hand out the same header map for many requests, and Envoy header maps are
+ * not safe to read concurrently: lookups lazily build an index. So each worker sends its own copy
+ * of the headers, see SharedRequestSourceConsumerImpl.
+ */
+class SharedRequestSourceImpl : public std::enable_shared_from_this<SharedRequestSourceImpl>,
+                                public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  enum class ProducerMode {
+    // A dedicated producer thread initializes the upstream source and keeps the ring topped up.
+    // The upstream source yielding nullptr is taken to mean that it is exhausted.
+    Thread,
+    // The first consumer owns the upstream source: it initializes the upstream source on its
+    // worker thread, and tops up the ring each time its generator is called. Meant for upstream
+    // sources that are bound to a worker's dispatcher, like RemoteRequestSourceImpl. The upstream
+    // source yielding nullptr is taken to mean that no request is available yet.
+    // Note that the ring is only topped up as fast as the owning worker draws requests, so all
+    // workers are paced by it: when it is rate limited, stalls, or finishes early, the others
+    // starve.
+    OwningWorker,
+  };
+
+  /**
+   * @param upstream The request source to draw requests from.
+   * @param capacity The minimum number of requests to buffer. Rounded up to a power of two.
+   * @param producer_mode Selects the thread that draws requests from the upstream source.
+   * @param thread_factory Used to create the producer thread in ProducerMode::Thread.
+   */
+  SharedRequestSourceImpl(RequestSourcePtr upstream, uint32_t capacity,
+                          ProducerMode producer_mode,
+                          Envoy::Thread::ThreadFactory& thread_factory);
+  ~SharedRequestSourceImpl();
+
+  /**
+   * Creates a request source for a single worker, which pops requests from the shared ring. The
+   * returned source keeps this instance alive. Must not be called concurrently.
+   *
+   * @param scope Scope of the worker, used for its starvation counter.
+   * @return RequestSourcePtr The request source for the worker.
+   */
+  RequestSourcePtr createConsumer(Envoy::Stats::Scope& scope);
+
+  /**
+   * @return uint64_t The number of requests the ring can hold.
+   */
+  uint64_t capacity() const { return ring_.capacity(); }
+
+private:
+  friend class SharedRequestSourceConsumerImpl;
+
+  // Moves requests from the upstream source into the ring until it is full, or the upstream
+  // source has nothing to offer. Must only be called by the producer. Returns the number of
+  // requests added to the ring.
+  uint64_t produce();
+  RequestPtr pop(Envoy::Stats::Counter& starved);
+  void initUpstreamOnThread();
+  void destroyUpstreamOnThread();
+  void runProducerThread();
+
+  const RequestSourcePtr upstream_;
+  const ProducerMode producer_mode_;
+  MpmcRingBuffer<RequestPtr> ring_;
+  // Only accessed by the producer.
+  RequestGenerator upstream_generator_;
+  // A request drawn from the upstream source that did not fit in the ring.
+  RequestPtr pending_;
+  std::atomic<bool> exhausted_{false};
+  std::atomic<bool> shutdown_{false};
+  bool owner_assigned_{false};
+  PlatformUtilImpl platform_util_;
+  Envoy::Thread::ThreadPtr producer_thread_;
+};
+
+using SharedRequestSourceImplSharedPtr = std::shared_ptr<SharedRequestSourceImpl>;
+
+/**
+ * Per-worker view of a SharedRequestSourceImpl. Not thread safe, each worker gets its own.
+ * Requests are yielded with a copy of the headers that is only read by this worker.
+ */
+class SharedRequestSourceConsumerImpl : public BaseRequestSourceImpl {
+public:
+  /**
+   * @param shared_source The shared source to pop requests from.
+   * @param scope Scope of the worker, used for its starvation counter.
+   * @param owns_upstream Whether this consumer drives the upstream source, see
+   * SharedRequestSourceImpl::ProducerMode::OwningWorker.
+   */
+  SharedRequestSourceConsumerImpl(SharedRequestSourceImplSharedPtr shared_source,
+                                  Envoy::Stats::Scope& scope, bool owns_upstream);
+  RequestGenerator get() override;
+  void initOnThread() override;
+  void destroyOnThread() override;
+
+private:
+  HeaderMapPtr ownHeader(const HeaderMapPtr& shared_header);
+
+  const SharedRequestSourceImplSharedPtr shared_source_;
+  Envoy::Stats::Counter& starved_;
+  const bool owns_upstream_;
+  // The most recently copied header map, and the copy. Holding on to the former ensures that its
+  // address is not reused while the copy is.
+  HeaderMapPtr last_shared_header_;
+  HeaderMapPtr last_header_;
+};
+
 } // namespace Nighthawk
@@ -1,5 +1,6 @@
 #include "source/common/request_stream_grpc_client_impl.h"
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/api/v2/core/base.pb.h"
@@ -23,37 +24,78 @@ using ::nighthawk::request_source::RequestSpecifier;
 const std::string RequestStreamGrpcClientImpl::METHOD_NAME =
     "nighthawk.request_source.NighthawkRequestSourceService.RequestStream";
 
+namespace {
+
+// The number of request specifiers carried by a message.
+int requestSpecifierCount(const nighthawk::request_source::RequestStreamResponse& message) {
+  return std::max(message.request_specifiers_size(), 1);
+}
+
+} // namespace
+
 RequestStreamGrpcClientImpl::RequestStreamGrpcClientImpl(
-    Envoy::Grpc::RawAsyncClientPtr async_client, Envoy::Event::Dispatcher&,
-    const Envoy::Http::RequestHeaderMap& base_header, const uint32_t header_buffer_length)
+    Envoy::Grpc::RawAsyncClientPtr async_client, Envoy::Event::Dispatcher& dispatcher,
+    const Envoy::Http::RequestHeaderMap& base_header, const uint32_t header_buffer_length,
+    Envoy::Stats::Scope& scope, const uint32_t max_batch_size)
     : async_client_(std::move(async_client)),
       service_method_(
           *Envoy::Protobuf::DescriptorPool::generated_pool()->FindMethodByName(METHOD_NAME)),
-      base_header_(base_header), header_buffer_length_(header_buffer_length) {}
+      base_header_(base_header), time_source_(dispatcher.timeSource()),
+      starved_(scope.counterFromString("remote_request_source_starved")),
+      max_batch_size_(max_batch_size),
+      max_prefetch_window_(std::max<uint64_t>(header_buffer_length, 1) *
+                           kMaxPrefetchWindowMultiplier),
+      prefetch_window_(std::max<uint64_t>(header_buffer_length, 1)) {}
 
 void RequestStreamGrpcClientImpl::start() {
   stream_ = async_client_->start(service_method_, *this, Envoy::Http::AsyncClient::StreamOptions());
   ENVOY_LOG(trace, "stream establishment status ok: {}", stream_ != nullptr);
+  adaptPrefetchWindow();
   trySendRequest();
 }
 
 void RequestStreamGrpcClientImpl::trySendRequest() {
   if (stream_ != nullptr) {
     nighthawk::request_source::RequestStreamRequest request;
-    request.set_quantity(header_buffer_length_);
+    const uint64_t quantity =
+        prefetch_window_ > buffered_headers_ ? prefetch_window_ - buffered_headers_ : 1;
+    request.set_quantity(quantity);
+    request.set_max_batch_size(max_batch_size_);
     stream_->sendMessage(request, false);
-    in_flight_headers_ = header_buffer_length_;
+    in_flight_headers_ = quantity;
     ENVOY_LOG(trace, "send request: {}", absl::StrCat(request));
   }
 }
 
+void RequestStreamGrpcClientImpl::maybeRequestMore() {
+  if (in_flight_headers_ == 0 && buffered_headers_ < std::max<uint64_t>(prefetch_window_ / 2, 1)) {
+    adaptPrefetchWindow();
+    trySendRequest();
+  }
+}
+
+void RequestStreamGrpcClientImpl::adaptPrefetchWindow() {
+  const Envoy::MonotonicTime now = time_source_.monotonicTime();
+  if (last_request_time_.has_value() && now > *last_request_time_) {
+    const double elapsed = std::chrono::duration<double>(now - *last_request_time_).count();
+    const double horizon = std::chrono::duration<double>(kPrefetchHorizon).count();
+    const uint64_t target = std::clamp<uint64_t>(dequeued_since_last_request_ * horizon / elapsed,
+                                                 1, max_prefetch_window_);
+    // Move halfway towards the target, so that a single burst or lull does not swing the window.
+    prefetch_window_ = (prefetch_window_ + target + 1) / 2;
+  }
+  last_request_time_ = now;
+  dequeued_since_last_request_ = 0;
+}
+
 void RequestStreamGrpcClientImpl::onCreateInitialMetadata(Envoy::Http::RequestHeaderMap&) {}
 
 void RequestStreamGrpcClientImpl::onReceiveInitialMetadata(Envoy::Http::ResponseHeaderMapPtr&&) {}
 
 void RequestStreamGrpcClientImpl::onReceiveMessage(
     Envoy::Grpc::ResponsePtr<nighthawk::request_source::RequestStreamResponse>&& message) {
-  in_flight_headers_--;
+  const uint64_t request_specifier_count = requestSpecifierCount(*message);
+  in_flight_headers_ -= std::min(in_flight_headers_, request_specifier_count);
   total_messages_received_++;
   emplaceMessage(std::move(message));
 }
@@ -77,74 +119,87 @@ void RequestStreamGrpcClientImpl::onRemoteClose(Envoy::Grpc::Status::GrpcStatus
 RequestPtr ProtoRequestHelper::messageToRequest(
     const Envoy::Http::RequestHeaderMap& base_header,
     const nighthawk::request_source::RequestStreamResponse& message) {
+  // An absent request specifier reads as the default instance, which leaves the base header as-is.
+  return requestSpecifierToRequest(base_header, message.request_specifier());
+}
+
+RequestPtr ProtoRequestHelper::requestSpecifierToRequest(
+    const Envoy::Http::RequestHeaderMap& base_header, const RequestSpecifier& request_specifier) {
   std::shared_ptr<Envoy::Http::RequestHeaderMapImpl> header(
       Envoy::Http::RequestHeaderMapImpl::create().release());
   header->copyFrom(*header, base_header);
   RequestPtr request = std::make_unique<RequestImpl>(header);
 
-  if (message.has_request_specifier()) {
-    const RequestSpecifier& request_specifier = message.request_specifier();
-
-    if (request_specifier.has_v3_headers()) {
-      const envoy::config::core::v3::HeaderMap& message_request_headers =
-          request_specifier.v3_headers();
-      for (const envoy::config::core::v3::HeaderValue& message_header :
-           message_request_headers.headers()) {
-        Envoy::Http::LowerCaseString header_name(message_header.key());
-        header->remove(header_name);
-        header->addCopy(header_name, message_header.value());
-      }
-    } else if (request_specifier.has_headers()) {
-      const envoy::api::v2::core::HeaderMap& message_request_headers = request_specifier.headers();
-      for (const envoy::api::v2::core::HeaderValue& message_header :
-           message_request_headers.headers()) {
-        Envoy::Http::LowerCaseString header_name(message_header.key());
-        header->remove(header_name);
-        header->addCopy(header_name, message_header.value());
-      }
+  if (request_specifier.has_v3_headers()) {
+    const envoy::config::core::v3::HeaderMap& message_request_headers =
+        request_specifier.v3_headers();
+    for (const envoy::config::core::v3::HeaderValue& message_header :
+         message_request_headers.headers()) {
+      Envoy::Http::LowerCaseString header_name(message_header.key());
+      header->remove(header_name);
+      header->addCopy(header_name, message_header.value());
     }
-
-    if (request_specifier.has_content_length()) {
-      std::string s_content_length = absl::StrCat("", request_specifier.content_length().value());
-      header->remove(Envoy::Http::Headers::get().ContentLength);
-      header->setContentLength(s_content_length);
-    }
-    if (request_specifier.has_authority()) {
-      header->remove(Envoy::Http::Headers::get().Host);
-      header->setHost(request_specifier.authority().value());
-    }
-    if (request_specifier.has_path()) {
-      header->remove(Envoy::Http::Headers::get().Path);
-      header->setPath(request_specifier.path().value());
-    }
-    if (request_specifier.has_method()) {
-      header->remove(Envoy::Http::Headers::get().Method);
-      header->setMethod(request_specifier.method().value());
+  } else if (request_specifier.has_headers()) {
+    const envoy::api::v2::core::HeaderMap& message_request_headers = request_specifier.headers();
+    for (const envoy::api::v2::core::HeaderValue& message_header :
+         message_request_headers.headers()) {
+      Envoy::Http::LowerCaseString header_name(message_header.key());
+      header->remove(header_name);
+      header->addCopy(header_name, message_header.value());
     }
   }
 
+  if (request_specifier.has_content_length()) {
+    std::string s_content_length = absl::StrCat("", request_specifier.content_length().value());
+    header->remove(Envoy::Http::Headers::get().ContentLength);
+    header->setContentLength(s_content_length);
+  }
+  if (request_specifier.has_authority()) {
+    header->remove(Envoy::Http::Headers::get().Host);
+    header->setHost(request_specifier.authority().value());
+  }
+  if (request_specifier.has_path()) {
+    header->remove(Envoy::Http::Headers::get().Path);
+    header->setPath(request_specifier.path().value());
+  }
+  if (request_specifier.has_method()) {
+    header->remove(Envoy::Http::Headers::get().Method);
+    header->setMethod(request_specifier.method().value());
+  }
+
   // TODO(oschaaf): associate the expectations from the proto to the request,
   // and process those by verifying expectations on request completion.
   return request;
 }
 
 RequestPtr RequestStreamGrpcClientImpl::maybeDequeue() {
-  RequestPtr request = nullptr;
-  if (!messages_.empty()) {
-    const auto& message = messages_.front();
-    request = ProtoRequestHelper::messageToRequest(base_header_, *message);
-    messages_.pop();
-    if (in_flight_headers_ == 0 && messages_.size() < header_buffer_length_) {
-      trySendRequest();
+  if (messages_.empty()) {
+    if (stream_ != nullptr) {
+      starved_.inc();
+      prefetch_window_ = std::min(prefetch_window_ * 2, max_prefetch_window_);
+      maybeRequestMore();
     }
+    return nullptr;
   }
-
+  const nighthawk::request_source::RequestStreamResponse& message = *messages_.front();
+  RequestPtr request = ProtoRequestHelper::requestSpecifierToRequest(
+      base_header_, message.request_specifiers().empty()
+                        ? message.request_specifier()
+                        : message.request_specifiers(front_index_));
+  if (++front_index_ >= requestSpecifierCount(message)) {
+    messages_.pop();
+    front_index_ = 0;
+  }
+  buffered_headers_--;
+  dequeued_since_last_request_++;
+  maybeRequestMore();
   return request;
 }
 
 void RequestStreamGrpcClientImpl::emplaceMessage(
     Envoy::Grpc::ResponsePtr<nighthawk::request_source::RequestStreamResponse>&& message) {
   ENVOY_LOG(trace, "message received: {}", absl::StrCat(*message));
+  buffered_headers_ += requestSpecifierCount(*message);
   messages_.emplace(std::move(message));
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <queue>
 #include <string>
 
+#include "envoy/common/time.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "nighthawk/common/request.h"
@@ -32,10 +36,18 @@ public:
   static RequestPtr
   messageToRequest(const Envoy::Http::RequestHeaderMap& base_header,
                    const nighthawk::request_source::RequestStreamResponse& message);
+  static RequestPtr
+  requestSpecifierToRequest(const Envoy::Http::RequestHeaderMap& base_header,
+                            const nighthawk::request_source::RequestSpecifier& request_specifier);
 };
 
 /**
  * gRPC client for communicating with a remote request-source service.
+ *
+ * The client asks the service for batches of request specifiers, and keeps a prefetch window of
+ * them buffered. The window adapts to the rate at which requests are dequeued, aiming to hold
+ * kPrefetchHorizon worth of requests, and doubles whenever maybeDequeue() finds the buffer empty.
+ * Each such starvation event increments the remote_request_source_starved counter.
  */
 class RequestStreamGrpcClientImpl
     : public RequestStreamGrpcClient,
@@ -47,12 +59,22 @@ public:
    * @param dispatcher Dispatcher that will be used.
    * @param base_header Any headers in request specifiers yielded by the remote request
    * source service will override what is specified here.
-   * @param header_buffer_length The number of messages to buffer.
+   * @param header_buffer_length The initial prefetch window, in requests. The window may grow to
+   * kMaxPrefetchWindowMultiplier times this value.
+   * @param scope Statistics scope for the starvation counter.
+   * @param max_batch_size The maximum number of request specifiers to ask the service to pack in a
+   * single response. 1 disables batching.
    */
   RequestStreamGrpcClientImpl(Envoy::Grpc::RawAsyncClientPtr async_client,
                               Envoy::Event::Dispatcher& dispatcher,
                               const Envoy::Http::RequestHeaderMap& base_header,
-                              const uint32_t header_buffer_length);
+                              const uint32_t header_buffer_length, Envoy::Stats::Scope& scope,
+                              const uint32_t max_batch_size = kDefaultMaxBatchSize);
+
+  // The amount of time worth of requests the prefetch window aims to hold.
+  static constexpr std::chrono::seconds kPrefetchHorizon{1};
+  static constexpr uint64_t kMaxPrefetchWindowMultiplier = 8;
+  static constexpr uint32_t kDefaultMaxBatchSize = 128;
 
   // Grpc::AsyncStreamCallbacks
   void onCreateInitialMetadata(Envoy::Http::RequestHeaderMap& metadata) override;
@@ -69,9 +91,19 @@ public:
     return stream_ == nullptr || total_messages_received_ > 0;
   }
 
+  /**
+   * @return uint64_t The current prefetch window, in requests.
+   */
+  uint64_t prefetchWindow() const { return prefetch_window_; }
+
 private:
   static const std::string METHOD_NAME;
   void trySendRequest();
+  // Requests more request specifiers when less than half of the prefetch window is buffered, and
+  // none are in flight.
+  void maybeRequestMore();
+  // Resizes the prefetch window based on the dequeue rate observed since the previous request.
+  void adaptPrefetchWindow();
   Envoy::Grpc::AsyncClient<nighthawk::request_source::RequestStreamRequest,
                            nighthawk::request_source::RequestStreamResponse>
       async_client_;
@@ -80,10 +112,20 @@ private:
   std::queue<Envoy::Grpc::ResponsePtr<nighthawk::request_source::RequestStreamResponse>> messages_;
   void emplaceMessage(
       Envoy::Grpc::ResponsePtr<nighthawk::request_source::RequestStreamResponse>&& message);
-  uint32_t in_flight_headers_{0};
+  // Index of the next request specifier to dequeue from the front message.
+  int front_index_{0};
+  // The number of request specifiers buffered in messages_.
+  uint64_t buffered_headers_{0};
+  uint64_t in_flight_headers_{0};
   uint32_t total_messages_received_{0};
   const Envoy::Http::RequestHeaderMap& base_header_;
-  const uint32_t header_buffer_length_;
+  Envoy::TimeSource& time_source_;
+  Envoy::Stats::Counter& starved_;
+  const uint32_t max_batch_size_;
+  const uint64_t max_prefetch_window_;
+  uint64_t prefetch_window_;
+  std::optional<Envoy::MonotonicTime> last_request_time_;
+  uint64_t dequeued_since_last_request_{0};
 };
 
 } // namespace Nighthawk
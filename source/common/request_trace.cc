@@ -0,0 +1,313 @@
+#include "source/common/request_trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include "external/envoy/source/common/common/assert.h"
+
+#include "absl/base/config.h"
+#include "absl/strings/str_cat.h"
+
+// The trace format is little endian, and is read and written by copying integers to and from
+// memory as-is.
+#ifndef ABSL_IS_LITTLE_ENDIAN
+#error "The request trace format is only supported on little endian hosts."
+#endif
+
+namespace Nighthawk {
+
+namespace {
+
+template <class T> T loadInteger(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+template <class T> void writeInteger(std::ostream& output, T value) {
+  output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+RequestTraceWriter::RequestTraceWriter(std::ostream& output, uint32_t index_stride)
+    : output_(output), index_stride_(index_stride) {
+  // Reserve space for the header. The real header is written once the index offset is known.
+  output_.write(std::string(sizeof(RequestTraceFileHeader), '\0').data(),
+                sizeof(RequestTraceFileHeader));
+  offset_ = sizeof(RequestTraceFileHeader);
+}
+
+absl::Status RequestTraceWriter::addRecord(const nighthawk::client::RequestOptions& request_options,
+                                           std::chrono::nanoseconds start_offset) {
+  if (finished_) {
+    return absl::FailedPreconditionError("Cannot add records to a finished request trace");
+  }
+  if (index_stride_ == 0) {
+    return absl::InvalidArgumentError("index_stride must be larger than 0");
+  }
+  if (start_offset < last_start_offset_) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Start offset ", start_offset.count(), "ns of record ", record_count_,
+                     " is less than the start offset of the preceding record"));
+  }
+  serialized_.clear();
+  if (!request_options.SerializeToString(&serialized_)) {
+    return absl::InvalidArgumentError("Failed to serialize request options");
+  }
+  if (serialized_.size() > std::numeric_limits<uint32_t>::max()) {
+    return absl::InvalidArgumentError("Request options exceed the maximum record size");
+  }
+  if (record_count_ % index_stride_ == 0) {
+    index_.push_back(offset_);
+  }
+  writeInteger<uint32_t>(output_, serialized_.size());
+  writeInteger<uint64_t>(output_, start_offset.count());
+  output_.write(serialized_.data(), serialized_.size());
+  if (!output_.good()) {
+    return absl::InternalError("Failed to write request trace record");
+  }
+  offset_ += RequestTraceFormat::kRecordLengthSize + RequestTraceFormat::kRecordStartOffsetSize +
+             serialized_.size();
+  last_start_offset_ = start_offset;
+  ++record_count_;
+  return absl::OkStatus();
+}
+
+absl::Status RequestTraceWriter::finish() {
+  if (finished_) {
+    return absl::FailedPreconditionError("Request trace has already been finished");
+  }
+  finished_ = true;
+  const uint64_t index_offset = offset_;
+  for (const uint64_t record_offset : index_) {
+    writeInteger<uint64_t>(output_, record_offset);
+  }
+  return writeHeader(index_offset);
+}
+
+absl::Status RequestTraceWriter::writeHeader(uint64_t index_offset) {
+  RequestTraceFileHeader header;
+  memcpy(header.magic, RequestTraceFormat::kMagic.data(), sizeof(header.magic));
+  header.version = RequestTraceFormat::kVersion;
+  header.index_stride = index_stride_;
+  header.record_count = record_count_;
+  header.index_offset = index_offset;
+  output_.seekp(0);
+  output_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  output_.seekp(0, std::ios_base::end);
+  output_.flush();
+  if (!output_.good()) {
+    return absl::InternalError("Failed to write request trace header");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<MappedRequestTraceSharedPtr> MappedRequestTrace::open(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Failed to open request trace '", path, "': ", strerror(errno)));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    const int fstat_errno = errno;
+    ::close(fd);
+    return absl::InternalError(
+        absl::StrCat("Failed to stat request trace '", path, "': ", strerror(fstat_errno)));
+  }
+  const uint64_t size = file_stat.st_size;
+  if (size < sizeof(RequestTraceFileHeader)) {
+    ::close(fd);
+    return absl::InvalidArgumentError(
+        absl::StrCat("'", path, "' is too small to hold a request trace"));
+  }
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  const int mmap_errno = errno;
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return absl::InternalError(
+        absl::StrCat("Failed to map request trace '", path, "': ", strerror(mmap_errno)));
+  }
+  // Records are consumed front to back by each worker.
+  madvise(mapping, size, MADV_SEQUENTIAL);
+  std::shared_ptr<MappedRequestTrace> trace(
+      new MappedRequestTrace(static_cast<const char*>(mapping), size));
+
+  RequestTraceFileHeader header;
+  memcpy(&header, trace->data_, sizeof(header));
+  if (absl::string_view(header.magic, sizeof(header.magic)) != RequestTraceFormat::kMagic) {
+    return absl::InvalidArgumentError(absl::StrCat("'", path, "' is not a request trace"));
+  }
+  if (header.version < RequestTraceFormat::kMinimumVersion ||
+      header.version > RequestTraceFormat::kVersion) {
+    return absl::InvalidArgumentError(absl::StrCat("Unsupported request trace version ",
+                                                   header.version, " in '", path, "'"));
+  }
+  if (header.index_stride == 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Request trace '", path, "' has an invalid index stride"));
+  }
+  const uint64_t index_entries =
+      header.record_count / header.index_stride + (header.record_count % header.index_stride != 0);
+  if (header.index_offset < sizeof(RequestTraceFileHeader) || header.index_offset > size ||
+      index_entries > (size - header.index_offset) / sizeof(uint64_t)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Request trace '", path, "' has an invalid index"));
+  }
+  trace->record_count_ = header.record_count;
+  trace->records_end_ = header.index_offset;
+  trace->index_stride_ = header.index_stride;
+  if (header.version >= 2) {
+    trace->record_prefix_size_ += RequestTraceFormat::kRecordStartOffsetSize;
+  }
+  trace->index_ = trace->data_ + header.index_offset;
+  return trace;
+}
+
+MappedRequestTrace::MappedRequestTrace(const char* data, uint64_t size)
+    : data_(data), size_(size) {}
+
+MappedRequestTrace::~MappedRequestTrace() {
+  munmap(const_cast<char*>(data_), size_);
+}
+
+absl::StatusOr<uint64_t> MappedRequestTrace::recordOffset(uint64_t record_number) const {
+  if (record_number >= record_count_) {
+    return absl::OutOfRangeError(absl::StrCat("Record ", record_number, " is out of range"));
+  }
+  uint64_t offset =
+      loadInteger<uint64_t>(index_ + (record_number / index_stride_) * sizeof(uint64_t));
+  for (uint64_t skip = record_number % index_stride_; skip > 0; --skip) {
+    absl::StatusOr<RequestTraceRecord> record = recordAt(offset, offset);
+    if (!record.ok()) {
+      return record.status();
+    }
+  }
+  if (offset >= records_end_) {
+    return absl::DataLossError(absl::StrCat("Index entry for record ", record_number,
+                                            " points beyond the end of the records"));
+  }
+  return offset;
+}
+
+absl::StatusOr<RequestTraceRecord> MappedRequestTrace::recordAt(uint64_t offset,
+                                                                 uint64_t& next_offset) const {
+  if (offset < firstRecordOffset() || offset > records_end_ ||
+      records_end_ - offset < record_prefix_size_) {
+    return absl::DataLossError(
+        absl::StrCat("Request trace record offset ", offset, " is out of bounds"));
+  }
+  RequestTraceRecord record;
+  const uint32_t length = loadInteger<uint32_t>(data_ + offset);
+  if (hasStartOffsets()) {
+    record.start_offset = std::chrono::nanoseconds(
+        loadInteger<uint64_t>(data_ + offset + RequestTraceFormat::kRecordLengthSize));
+  }
+  const uint64_t payload_offset = offset + record_prefix_size_;
+  if (length > records_end_ - payload_offset) {
+    return absl::DataLossError(
+        absl::StrCat("Request trace record at offset ", offset, " exceeds the trace bounds"));
+  }
+  next_offset = payload_offset + length;
+  record.request_options = absl::string_view(data_ + payload_offset, length);
+  return record;
+}
+
+RequestTracePartition RequestTracePartition::contiguous(uint64_t trace_records,
+                                                        const WorkerContext& worker_context) {
+  const uint64_t worker_count = std::max<uint32_t>(worker_context.worker_count, 1);
+  const uint64_t worker_number = worker_context.worker_number % worker_count;
+  RequestTracePartition partition;
+  partition.first_record = trace_records * worker_number / worker_count;
+  partition.record_count =
+      trace_records * (worker_number + 1) / worker_count - partition.first_record;
+  return partition;
+}
+
+RequestTracePartition RequestTracePartition::strided(uint64_t trace_records,
+                                                     const WorkerContext& worker_context) {
+  const uint64_t worker_count = std::max<uint32_t>(worker_context.worker_count, 1);
+  const uint64_t worker_number = worker_context.worker_number % worker_count;
+  RequestTracePartition partition;
+  partition.first_record = worker_number;
+  partition.stride = worker_count;
+  partition.record_count =
+      trace_records > worker_number ? (trace_records - worker_number - 1) / worker_count + 1 : 0;
+  return partition;
+}
+
+RequestTracePartition RequestTracePartition::create(
+    nighthawk::request_source::MappedTraceRequestSourceConfig::Partitioning partitioning,
+    uint64_t trace_records, const WorkerContext& worker_context) {
+  switch (partitioning) {
+  case nighthawk::request_source::MappedTraceRequestSourceConfig::CONTIGUOUS:
+    return contiguous(trace_records, worker_context);
+  case nighthawk::request_source::MappedTraceRequestSourceConfig::STRIDED:
+    return strided(trace_records, worker_context);
+  default:
+    PANIC("not reached");
+  }
+}
+
+absl::StatusOr<RequestTraceCursor>
+RequestTraceCursor::create(MappedRequestTraceSharedPtr trace,
+                           const RequestTracePartition& partition) {
+  if (partition.record_count == 0) {
+    return RequestTraceCursor(std::move(trace), partition, 0);
+  }
+  if (partition.stride == 0 ||
+      partition.first_record + (partition.record_count - 1) * partition.stride >=
+          trace->recordCount()) {
+    return absl::InvalidArgumentError("Request trace partition exceeds the trace");
+  }
+  absl::StatusOr<uint64_t> first_offset = trace->recordOffset(partition.first_record);
+  if (!first_offset.ok()) {
+    return first_offset.status();
+  }
+  return RequestTraceCursor(std::move(trace), partition, *first_offset);
+}
+
+RequestTraceCursor::RequestTraceCursor(MappedRequestTraceSharedPtr trace,
+                                       const RequestTracePartition& partition,
+                                       uint64_t first_offset)
+    : trace_(std::move(trace)), partition_(partition), first_offset_(first_offset),
+      offset_(first_offset) {}
+
+absl::StatusOr<RequestTraceRecord> RequestTraceCursor::next() {
+  if (done()) {
+    return absl::OutOfRangeError("All records of the request trace partition have been read");
+  }
+  uint64_t next_offset = 0;
+  absl::StatusOr<RequestTraceRecord> record = trace_->recordAt(offset_, next_offset);
+  if (!record.ok()) {
+    return record.status();
+  }
+  ++position_;
+  if (!done()) {
+    // Skip over the records that belong to other partitions.
+    for (uint64_t skip = partition_.stride - 1; skip > 0; --skip) {
+      absl::StatusOr<RequestTraceRecord> skipped = trace_->recordAt(next_offset, next_offset);
+      if (!skipped.ok()) {
+        return skipped.status();
+      }
+    }
+  }
+  offset_ = next_offset;
+  return record;
+}
+
+void RequestTraceCursor::rewind() {
+  offset_ = first_offset_;
+  position_ = 0;
+}
+
+} // namespace Nighthawk
@@ -0,0 +1,296 @@
+#pragma once
+
+// Compact binary request trace format, and helpers to write and memory-map it.
+//
+// A request trace stores a sequence of nighthawk::client::RequestOptions. It is designed to be
+// memory-mapped read-only and shared by all workers, so that replaying a trace with tens of
+// millions of requests does not require materializing it in memory.
+//
+// Layout (all integers are little endian):
+//
+//   RequestTraceFileHeader
+//   record 0 .. record (record_count - 1)
+//   index
+//
+// Each record is a uint32 payload length, followed by a uint64 start offset in nanoseconds, and
+// then the serialized RequestOptions payload. The start offset is the point in time, relative to
+// the start of the trace, at which the request was originally sent. Start offsets never decrease
+// from one record to the next. Version 1 traces lack the start offset.
+// The index is an array of uint64 byte offsets, pointing at every index_stride'th record. It
+// allows seeking to an arbitrary record by skipping at most index_stride - 1 records.
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "nighthawk/common/worker_context.h"
+
+#include "api/client/options.pb.h"
+#include "api/request_source/request_source_plugin.pb.h"
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+
+struct RequestTraceFileHeader {
+  // Must equal RequestTraceFormat::kMagic.
+  char magic[8];
+  // Must equal RequestTraceFormat::kVersion.
+  uint32_t version;
+  // The number of records between two consecutive index entries.
+  uint32_t index_stride;
+  // The number of records in the trace.
+  uint64_t record_count;
+  // Byte offset of the index, which also marks the end of the records.
+  uint64_t index_offset;
+};
+static_assert(sizeof(RequestTraceFileHeader) == 32, "unexpected RequestTraceFileHeader padding");
+
+class RequestTraceFormat {
+public:
+  static constexpr absl::string_view kMagic{"NHTRACE\0", 8};
+  // The version written by RequestTraceWriter.
+  static constexpr uint32_t kVersion = 2;
+  // The oldest version that can still be read. Version 1 records have no start offset.
+  static constexpr uint32_t kMinimumVersion = 1;
+  static constexpr uint32_t kDefaultIndexStride = 1024;
+  // Size of the length prefix which precedes each record.
+  static constexpr uint64_t kRecordLengthSize = sizeof(uint32_t);
+  // Size of the start offset which follows the length prefix, as of version 2.
+  static constexpr uint64_t kRecordStartOffsetSize = sizeof(uint64_t);
+};
+
+// A single record of a request trace.
+struct RequestTraceRecord {
+  // Offset from the start of the trace at which the request was originally sent. Always zero for
+  // traces that lack start offsets.
+  std::chrono::nanoseconds start_offset{0};
+  // Serialized nighthawk::client::RequestOptions, pointing into the mapped trace.
+  absl::string_view request_options;
+};
+
+// Writes a request trace to a seekable output stream. Records are appended with addRecord(), and
+// the trace is completed by calling finish(), which writes the index and the final header. The
+// trace is not valid until finish() returns successfully. Not thread safe.
+class RequestTraceWriter {
+public:
+  /**
+   * @param output Seekable stream to write the trace to. Must outlive the writer.
+   * @param index_stride The number of records between two consecutive index entries. Must be
+   * larger than 0.
+   */
+  RequestTraceWriter(std::ostream& output,
+                     uint32_t index_stride = RequestTraceFormat::kDefaultIndexStride);
+
+  /**
+   * Appends a record to the trace.
+   *
+   * @param request_options The request to append.
+   * @param start_offset Offset from the start of the trace at which the request was originally
+   * sent. Must not be less than the start offset of the previously added record.
+   * @return absl::Status Error status if the request could not be serialized or written, or if
+   * the start offset is out of order.
+   */
+  absl::Status addRecord(const nighthawk::client::RequestOptions& request_options,
+                         std::chrono::nanoseconds start_offset = std::chrono::nanoseconds::zero());
+
+  /**
+   * Writes the index and the file header. No records can be added after this call.
+   *
+   * @return absl::Status Error status if the trace could not be written.
+   */
+  absl::Status finish();
+
+  /**
+   * @return uint64_t The number of records added so far.
+   */
+  uint64_t recordCount() const { return record_count_; }
+
+private:
+  absl::Status writeHeader(uint64_t index_offset);
+
+  std::ostream& output_;
+  const uint32_t index_stride_;
+  uint64_t record_count_{0};
+  uint64_t offset_{0};
+  std::chrono::nanoseconds last_start_offset_{0};
+  std::vector<uint64_t> index_;
+  std::string serialized_;
+  bool finished_{false};
+};
+
+// Read-only, memory-mapped view of a request trace. The mapping is created once and can be shared
+// by any number of threads: all methods are const and thread safe. Record payloads are only paged
+// in when they are accessed.
+class MappedRequestTrace {
+public:
+  /**
+   * Memory-maps and validates the header and index of the trace file at |path|.
+   *
+   * @param path Path of the trace file.
+   * @return absl::StatusOr<std::shared_ptr<const MappedRequestTrace>> The mapped trace, or an
+   * error status if the file could not be mapped or does not hold a valid trace.
+   */
+  static absl::StatusOr<std::shared_ptr<const MappedRequestTrace>> open(const std::string& path);
+
+  ~MappedRequestTrace();
+  MappedRequestTrace(const MappedRequestTrace&) = delete;
+  MappedRequestTrace& operator=(const MappedRequestTrace&) = delete;
+
+  /**
+   * @return uint64_t The number of records in the trace.
+   */
+  uint64_t recordCount() const { return record_count_; }
+
+  /**
+   * @return bool Whether the records of the trace carry start offsets.
+   */
+  bool hasStartOffsets() const {
+    return record_prefix_size_ > RequestTraceFormat::kRecordLengthSize;
+  }
+
+  /**
+   * Looks up the byte offset of a record, using the index and skipping forward from the nearest
+   * indexed record.
+   *
+   * @param record_number The zero-based number of the record. Must be less than recordCount().
+   * @return absl::StatusOr<uint64_t> The byte offset of the record, or an error status if the trace
+   * is corrupt.
+   */
+  absl::StatusOr<uint64_t> recordOffset(uint64_t record_number) const;
+
+  /**
+   * Reads the record that starts at |offset|.
+   *
+   * @param offset Byte offset of the record, as obtained from recordOffset() or a previous call.
+   * @param next_offset Set to the byte offset of the next record.
+   * @return absl::StatusOr<RequestTraceRecord> The record, or an error status if the record
+   * exceeds the bounds of the trace.
+   */
+  absl::StatusOr<RequestTraceRecord> recordAt(uint64_t offset, uint64_t& next_offset) const;
+
+  /**
+   * @return uint64_t Byte offset of the first record.
+   */
+  static constexpr uint64_t firstRecordOffset() { return sizeof(RequestTraceFileHeader); }
+
+private:
+  MappedRequestTrace(const char* data, uint64_t size);
+
+  const char* const data_;
+  const uint64_t size_;
+  uint64_t record_count_{0};
+  uint64_t records_end_{0};
+  uint32_t index_stride_{0};
+  uint64_t record_prefix_size_{RequestTraceFormat::kRecordLengthSize};
+  const char* index_{nullptr};
+};
+
+using MappedRequestTraceSharedPtr = std::shared_ptr<const MappedRequestTrace>;
+
+// Describes the records of a trace that are replayed by a single worker: record_count records,
+// starting at first_record, and stride records apart.
+struct RequestTracePartition {
+  uint64_t first_record{0};
+  uint64_t stride{1};
+  uint64_t record_count{0};
+
+  /**
+   * Splits a trace in worker_count contiguous ranges of (almost) equal size, one per worker.
+   *
+   * @param trace_records The number of records in the trace.
+   * @param worker_context Identifies the worker to compute the partition for.
+   * @return RequestTracePartition The range of records for the worker. May be empty when there
+   * are fewer records than workers.
+   */
+  static RequestTracePartition contiguous(uint64_t trace_records,
+                                          const WorkerContext& worker_context);
+
+  /**
+   * Deals the records of a trace out to the workers round-robin, so that worker n replays records
+   * n, n + worker_count, n + 2 * worker_count, and so on. When the records are replayed at their
+   * original start offsets, all workers together reproduce the original arrival pattern.
+   *
+   * @param trace_records The number of records in the trace.
+   * @param worker_context Identifies the worker to compute the partition for.
+   * @return RequestTracePartition The records for the worker. May be empty when there are fewer
+   * records than workers.
+   */
+  static RequestTracePartition strided(uint64_t trace_records,
+                                       const WorkerContext& worker_context);
+
+  /**
+   * Partitions a trace the way the components replaying it are configured to. The request source
+   * and the rate limiter replaying the same trace both use this, so that with the same setting
+   * each worker sends exactly the records it releases.
+   *
+   * @param partitioning Either contiguous() or strided() partitioning.
+   * @param trace_records The number of records in the trace.
+   * @param worker_context Identifies the worker to compute the partition for.
+   * @return RequestTracePartition The records for the worker. May be empty when there are fewer
+   * records than workers.
+   */
+  static RequestTracePartition
+  create(nighthawk::request_source::MappedTraceRequestSourceConfig::Partitioning partitioning,
+         uint64_t trace_records, const WorkerContext& worker_context);
+};
+
+// Sequentially reads the records of a partition of a mapped trace. Copies of a cursor advance
+// independently. Not thread safe, but distinct cursors over the same trace can be used
+// concurrently.
+class RequestTraceCursor {
+public:
+  /**
+   * @param trace The trace to read.
+   * @param partition The records to read. Must lie within the trace.
+   * @return absl::StatusOr<RequestTraceCursor> A cursor positioned at the first record of the
+   * partition, or an error status if the partition could not be located in the trace.
+   */
+  static absl::StatusOr<RequestTraceCursor> create(MappedRequestTraceSharedPtr trace,
+                                                   const RequestTracePartition& partition);
+
+  /**
+   * @return bool Whether all records of the partition have been read.
+   */
+  bool done() const { return position_ == partition_.record_count; }
+
+  /**
+   * Reads the next record of the partition.
+   *
+   * @return absl::StatusOr<RequestTraceRecord> The record, or an error status if the trace is
+   * corrupt or the cursor is done().
+   */
+  absl::StatusOr<RequestTraceRecord> next();
+
+  /**
+   * Repositions the cursor at the first record of the partition.
+   */
+  void rewind();
+
+  /**
+   * @return const RequestTracePartition& The partition read by this cursor.
+   */
+  const RequestTracePartition& partition() const { return partition_; }
+
+  /**
+   * @return const MappedRequestTrace& The trace read by this cursor.
+   */
+  const MappedRequestTrace& trace() const { return *trace_; }
+
+private:
+  RequestTraceCursor(MappedRequestTraceSharedPtr trace, const RequestTracePartition& partition,
+                     uint64_t first_offset);
+
+  MappedRequestTraceSharedPtr trace_;
+  RequestTracePartition partition_;
+  uint64_t first_offset_;
+  uint64_t offset_;
+  uint64_t position_{0};
+};
+
+} // namespace Nighthawk
@@ -0,0 +1,135 @@
+#include "source/common/result_merger.h"
+
+#include <google/protobuf/util/time_util.h>
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "source/common/statistic_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Nighthawk {
+
+using ::Envoy::Protobuf::util::TimeUtil;
+
+ResultMerger::ResultMerger(absl::string_view name) : name_(name) {}
+
+absl::Status ResultMerger::decodeStatistics(
+    absl::string_view origin,
+    const Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Statistic>& statistics,
+    DecodedStatistics& decoded) const {
+  for (const nighthawk::client::Statistic& statistic : statistics) {
+    if (statistic.hdr_histogram().empty()) {
+      if (statistic.count() > 0) {
+        return absl::Status(absl::StatusCode::kFailedPrecondition,
+                            absl::StrCat("Statistic '", statistic.id(), "' of ", origin,
+                                         " has no native encoding and can not be merged."));
+      }
+      continue;
+    }
+    absl::StatusOr<std::unique_ptr<HdrStatistic>> hdr_statistic =
+        HdrStatistic::fromProto(statistic);
+    if (!hdr_statistic.ok()) {
+      return hdr_statistic.status();
+    }
+    decoded.emplace_back(&statistic, *std::move(hdr_statistic));
+  }
+  return absl::OkStatus();
+}
+
+void ResultMerger::merge(
+    DecodedStatistics& decoded,
+    const Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Counter>& counters,
+    Aggregate& aggregate) {
+  for (auto& [proto, statistic] : decoded) {
+    auto it = aggregate.statistics.find(proto->id());
+    if (it == aggregate.statistics.end()) {
+      aggregate.statistics[proto->id()] =
+          MergedStatistic{std::move(statistic), HdrStatistic::serializationDomain(*proto)};
+    } else {
+      it->second.statistic = it->second.statistic->combine(*statistic);
+      it->second.statistic->setId(proto->id());
+    }
+  }
+  for (const nighthawk::client::Counter& counter : counters) {
+    aggregate.counters[counter.name()] += counter.value();
+  }
+}
+
+void ResultMerger::toProto(
+    const Aggregate& aggregate,
+    Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Statistic>& statistics,
+    Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Counter>& counters) {
+  for (const auto& [id, merged] : aggregate.statistics) {
+    nighthawk::client::Statistic* statistic = statistics.Add();
+    *statistic = merged.statistic->toProto(merged.domain);
+    absl::StatusOr<std::unique_ptr<std::istream>> encoding = merged.statistic->serializeNative();
+    if (encoding.ok()) {
+      statistic->set_hdr_histogram(std::string(std::istreambuf_iterator<char>(**encoding),
+                                               std::istreambuf_iterator<char>()));
+    }
+  }
+  for (const auto& [name, value] : aggregate.counters) {
+    nighthawk::client::Counter* counter = counters.Add();
+    counter->set_name(name);
+    counter->set_value(value);
+  }
+}
+
+absl::Status ResultMerger::addResult(const nighthawk::client::Result& result) {
+  // Decode all statistics up front, so that a bad encoding leaves the aggregate untouched.
+  const std::string origin = absl::StrCat("result '", result.name(), "'");
+  DecodedStatistics decoded;
+  absl::Status status = decodeStatistics(origin, result.statistics(), decoded);
+  if (!status.ok()) {
+    return status;
+  }
+  std::vector<DecodedStatistics> decoded_time_slices(result.time_slices_size());
+  for (int i = 0; i < result.time_slices_size(); i++) {
+    status = decodeStatistics(absl::StrCat("a time slice of ", origin),
+                              result.time_slices(i).statistics(), decoded_time_slices[i]);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  merge(decoded, result.counters(), aggregate_);
+  for (int i = 0; i < result.time_slices_size(); i++) {
+    const nighthawk::client::TimeSlice& time_slice = result.time_slices(i);
+    const TimeSliceKey key{TimeUtil::TimestampToNanoseconds(time_slice.start()),
+                           TimeUtil::DurationToNanoseconds(time_slice.duration())};
+    merge(decoded_time_slices[i], time_slice.counters(), time_slices_[key]);
+  }
+  if (result.has_execution_start() &&
+      (!execution_start_.has_value() || result.execution_start() < *execution_start_)) {
+    execution_start_ = result.execution_start();
+  }
+  total_execution_duration_ +=
+      std::chrono::nanoseconds(TimeUtil::DurationToNanoseconds(result.execution_duration()));
+  ++result_count_;
+  return absl::OkStatus();
+}
+
+nighthawk::client::Result ResultMerger::toProto() const {
+  nighthawk::client::Result result;
+  result.set_name(name_);
+  toProto(aggregate_, *result.mutable_statistics(), *result.mutable_counters());
+  if (execution_start_.has_value()) {
+    *result.mutable_execution_start() = *execution_start_;
+  }
+  if (result_count_ > 0) {
+    *result.mutable_execution_duration() =
+        TimeUtil::NanosecondsToDuration((total_execution_duration_ / result_count_).count());
+  }
+  for (const auto& [key, aggregate] : time_slices_) {
+    nighthawk::client::TimeSlice* time_slice = result.add_time_slices();
+    *time_slice->mutable_start() = TimeUtil::NanosecondsToTimestamp(key.first);
+    *time_slice->mutable_duration() = TimeUtil::NanosecondsToDuration(key.second);
+    toProto(aggregate, *time_slice->mutable_statistics(), *time_slice->mutable_counters());
+  }
+  return result;
+}
+
+} // namespace Nighthawk
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nighthawk/common/statistic.h"
+
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+#include "api/client/output.pb.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+
+class HdrStatistic;
+
+/**
+ * Incrementally merges results into a single aggregate result. Statistics are merged exactly,
+ * from the native HdrHistogram encodings embedded in them (see
+ * CommandLineOptions.histogram_encoding), and counters are summed. Time slices are merged the same
+ * way, with those that share a start and duration. Only the aggregate is retained, so memory usage
+ * does not grow with the number of merged results.
+ *
+ * This is not thread safe.
+ */
+class ResultMerger {
+public:
+  /**
+   * @param name The name of the aggregate result.
+   */
+  explicit ResultMerger(absl::string_view name);
+
+  /**
+   * Merges a result into the aggregate.
+   *
+   * @param result The result to merge.
+   * @return absl::Status An error if an embedded encoding could not be decoded, or status
+   * kFailedPrecondition if a statistic that has samples carries no native encoding and can not be
+   * merged exactly. The aggregate is left untouched in either case.
+   */
+  absl::Status addResult(const nighthawk::client::Result& result);
+
+  /**
+   * @return uint64_t The number of results merged so far.
+   */
+  uint64_t resultCount() const { return result_count_; }
+
+  /**
+   * @return nighthawk::client::Result The aggregate of the results merged so far. Its statistics
+   * carry both percentiles and the native encoding, so aggregates can be merged in turn. The
+   * execution duration is the average over the merged results, like for the global result of a
+   * single run.
+   */
+  nighthawk::client::Result toProto() const;
+
+private:
+  struct MergedStatistic {
+    StatisticPtr statistic;
+    Statistic::SerializationDomain domain;
+  };
+  using DecodedStatistics =
+      std::vector<std::pair<const nighthawk::client::Statistic*, std::unique_ptr<HdrStatistic>>>;
+  // The merged statistics and counters of a result, or of a time slice.
+  struct Aggregate {
+    std::map<std::string, MergedStatistic> statistics;
+    std::map<std::string, uint64_t> counters;
+  };
+  // Time slices are keyed by start and duration, in nanoseconds.
+  using TimeSliceKey = std::pair<int64_t, int64_t>;
+
+  absl::Status decodeStatistics(
+      absl::string_view origin,
+      const Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Statistic>& statistics,
+      DecodedStatistics& decoded) const;
+  static void merge(DecodedStatistics& decoded,
+                    const Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Counter>& counters,
+                    Aggregate& aggregate);
+  static void
+  toProto(const Aggregate& aggregate,
+          Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Statistic>& statistics,
+          Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Counter>& counters);
+
+  const std::string name_;
+  Aggregate aggregate_;
+  std::map<TimeSliceKey, Aggregate> time_slices_;
+  std::optional<Envoy::Protobuf::Timestamp> execution_start_;
+  std::chrono::nanoseconds total_execution_duration_{0};
+  uint64_t result_count_{0};
+};
+
+} // namespace Nighthawk
@@ -1,5 +1,8 @@
 #include "source/common/sequencer_impl.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "nighthawk/common/exception.h"
 #include "nighthawk/common/platform_util.h"
 
@@ -13,12 +16,15 @@ SequencerImpl::SequencerImpl(
     const PlatformUtil& platform_util, Envoy::Event::Dispatcher& dispatcher,
     Envoy::TimeSource& time_source, RateLimiterPtr&& rate_limiter, SequencerTarget target,
     StatisticPtr&& latency_statistic, StatisticPtr&& blocked_statistic,
+    StatisticPtr&& intended_latency_statistic, SequencerOverheadStatistics&& overhead_statistics,
     nighthawk::client::SequencerIdleStrategy::SequencerIdleStrategyOptions idle_strategy,
     TerminationPredicatePtr&& termination_predicate, Envoy::Stats::Scope& scope)
     : target_(std::move(target)), platform_util_(platform_util), dispatcher_(dispatcher),
       time_source_(time_source), rate_limiter_(std::move(rate_limiter)),
       latency_statistic_(std::move(latency_statistic)),
-      blocked_statistic_(std::move(blocked_statistic)), idle_strategy_(idle_strategy),
+      blocked_statistic_(std::move(blocked_statistic)),
+      intended_latency_statistic_(std::move(intended_latency_statistic)),
+      overhead_statistics_(std::move(overhead_statistics)), idle_strategy_(idle_strategy),
       termination_predicate_(std::move(termination_predicate)),
       last_termination_status_(TerminationPredicate::Status::PROCEED),
       scope_(scope.createScope("sequencer.")),
@@ -29,18 +35,42 @@ SequencerImpl::SequencerImpl(
   spin_timer_ = dispatcher_.createTimer([this]() { run(false); });
   latency_statistic_->setId("sequencer.callback");
   blocked_statistic_->setId("sequencer.blocking");
+  intended_latency_statistic_->setId("sequencer.intended_callback");
+  overhead_statistics_.loop_lag->setId("sequencer.loop_lag");
+  overhead_statistics_.run_duration->setId("sequencer.run_duration");
+  overhead_statistics_.slippage->setId("sequencer.slippage");
+  overhead_statistics_.thread_cpu_time->setId("sequencer.thread_cpu_time");
 }
 
 void SequencerImpl::start() {
   ASSERT(!running_);
   running_ = true;
+  thread_cpu_time_at_start_ = platform_util_.currentThreadCpuTime();
   // Initiate the periodic timer loop.
-  scheduleRun();
+  dispatcher_.updateApproximateMonotonicTime();
+  scheduleRun(time_source_.monotonicTime());
   // Immediately run.
   run(false);
 }
 
-void SequencerImpl::scheduleRun() { periodic_timer_->enableHRTimer(NighthawkTimerResolution); }
+void SequencerImpl::scheduleRun(const Envoy::MonotonicTime& now) {
+  const std::chrono::microseconds interval =
+      idle_strategy_ == nighthawk::client::SequencerIdleStrategy::TIMER
+          ? TimerIdleStrategyPollInterval
+          : NighthawkTimerResolution;
+  periodic_wakeup_ = now + interval;
+  periodic_timer_->enableHRTimer(interval);
+}
+
+void SequencerImpl::recordLoopLag(const Envoy::MonotonicTime& due,
+                                  const Envoy::MonotonicTime& now) {
+  overhead_statistics_.loop_lag->addValue(now > due ? (now - due).count() : 0);
+}
+
+Envoy::MonotonicTime SequencerImpl::intendedStart(uint64_t index,
+                                                 const Envoy::MonotonicTime& now) const {
+  return std::min(rate_limiter_->scheduledReleaseTime(index).value_or(now), now);
+}
 
 void SequencerImpl::stop(bool failed) {
   ASSERT(running_);
@@ -50,6 +80,9 @@ void SequencerImpl::stop(bool failed) {
     sequencer_stats_.failed_terminations_.inc();
   }
   running_ = false;
+  const std::chrono::nanoseconds thread_cpu_time =
+      platform_util_.currentThreadCpuTime() - thread_cpu_time_at_start_;
+  overhead_statistics_.thread_cpu_time->addValue(thread_cpu_time.count());
   periodic_timer_->disableTimer();
   spin_timer_->disableTimer();
   periodic_timer_.reset();
@@ -57,15 +90,17 @@ void SequencerImpl::stop(bool failed) {
   dispatcher_.exit();
   unblockAndUpdateStatisticIfNeeded(time_source_.monotonicTime());
   const auto ran_for = std::chrono::duration_cast<std::chrono::milliseconds>(executionDuration());
+  const auto cpu_for = std::chrono::duration_cast<std::chrono::milliseconds>(thread_cpu_time);
   ENVOY_LOG(info,
             "Stopping after {} ms. Initiated: {} / Completed: {}. "
-            "(Completion rate was {} per second.)",
-            ran_for.count(), targets_initiated_, targets_completed_, rate);
+            "(Completion rate was {} per second, used {} ms of CPU time.)",
+            ran_for.count(), targets_initiated_, targets_completed_, rate, cpu_for.count());
 }
 
 void SequencerImpl::unblockAndUpdateStatisticIfNeeded(const Envoy::MonotonicTime& now) {
   if (blocked_) {
     blocked_ = false;
+    unblocked_at_ = now;
     blocked_statistic_->addValue((now - blocked_start_).count());
   }
 }
@@ -77,6 +112,41 @@ void SequencerImpl::updateStartBlockingTimeIfNeeded() {
   }
 }
 
+void SequencerImpl::calibrateSpinWindowIfNeeded(const Envoy::MonotonicTime& now) {
+  if (armed_wakeup_ == std::nullopt || now < armed_wakeup_.value()) {
+    return;
+  }
+  recordLoopLag(armed_wakeup_.value(), now);
+  // Exponentially weighted, so that a single late wakeup doesn't blow up the spin window.
+  timer_lateness_ = (timer_lateness_ * 7 + (now - armed_wakeup_.value())) / 8;
+  spin_window_ = std::clamp<std::chrono::nanoseconds>(
+      2 * timer_lateness_, TimerIdleStrategyMinSpinWindow, TimerIdleStrategyMaxSpinWindow);
+  armed_wakeup_ = std::nullopt;
+}
+
+void SequencerImpl::armReleaseTimer(const Envoy::MonotonicTime& now) {
+  armed_wakeup_ = std::nullopt;
+  if (blocked_) {
+    // The target refused to start. Its completion callbacks and the periodic timer will wake us up.
+    return;
+  }
+  const std::optional<Envoy::MonotonicTime> next_release_time = rate_limiter_->nextReleaseTime();
+  if (next_release_time == std::nullopt) {
+    // Rely on the periodic timer.
+    return;
+  }
+  const std::chrono::nanoseconds until_release = next_release_time.value() - now;
+  if (until_release <= spin_window_) {
+    // Too close to the release to trust the timer, spin.
+    spin_timer_->enableHRTimer(0us);
+    return;
+  }
+  const auto sleep_for =
+      std::chrono::duration_cast<std::chrono::microseconds>(until_release - spin_window_);
+  armed_wakeup_ = now + sleep_for;
+  spin_timer_->enableHRTimer(sleep_for);
+}
+
 void SequencerImpl::run(bool from_periodic_timer) {
   ASSERT(running_);
   // CachedTimeSource relies on the dispatcher's updateApproximateMonotonicTime() /
@@ -92,6 +162,13 @@ void SequencerImpl::run(bool from_periodic_timer) {
   // functionality (TOC/TOU).
   dispatcher_.updateApproximateMonotonicTime();
   const auto now = time_source_.monotonicTime();
+  if (from_periodic_timer) {
+    if (periodic_wakeup_ != std::nullopt) {
+      recordLoopLag(periodic_wakeup_.value(), now);
+    }
+  } else {
+    calibrateSpinWindowIfNeeded(now);
+  }
 
   last_termination_status_ = last_termination_status_ == TerminationPredicate::Status::PROCEED
                                  ? termination_predicate_->evaluateChain()
@@ -103,41 +180,72 @@ void SequencerImpl::run(bool from_periodic_timer) {
     return;
   }
 
-  while (rate_limiter_->tryAcquireOne()) {
+  uint64_t started = 0;
+  for (;;) {
+    if (unstarted_acquisitions_ == 0) {
+      // Acquire everything that is due in one go. The whole batch is started with the time
+      // sample taken above.
+      unstarted_acquisitions_ = rate_limiter_->tryAcquire(std::numeric_limits<uint64_t>::max());
+      if (unstarted_acquisitions_ == 0) {
+        break;
+      }
+      acquired_batch_size_ = unstarted_acquisitions_;
+      unstarted_intended_start_ = intendedStart(0, now);
+      // The first acquisition of the batch was due the earliest. Releases that were due while the
+      // target refused to start are late because of the target. Anything beyond that means we
+      // didn't get around to starting them in time ourselves.
+      if (now - std::max(unstarted_intended_start_, unblocked_at_) >
+          GeneratorSaturationThreshold) {
+        sequencer_stats_.generator_saturated_.inc();
+      }
+    }
     // The rate limiter says it's OK to proceed and call the target. Let's see if the target is OK
     // with that as well.
-    const bool target_could_start = target_([this, now](bool, bool) {
-      // Update cached time, as we need an accurate value for latency reporting.
-      dispatcher_.updateApproximateMonotonicTime();
-      const auto dur = time_source_.monotonicTime() - now;
-      latency_statistic_->addValue(dur.count());
-      targets_completed_++;
-      // Callbacks may fire after stop() is called. When the worker teardown runs the dispatcher,
-      // in-flight work might wrap up and fire this callback. By then we wouldn't want to
-      // re-enable any timers here.
-      if (this->running_) {
-        // Immediately schedule us to check again, as chances are we can get on with the next
-        // task.
-        spin_timer_->enableHRTimer(0ms);
-      }
-    });
+    InflightOperation& operation = acquireOperation();
+    operation.start = now;
+    operation.intended_start = unstarted_intended_start_;
+    // Capturing a single pointer keeps the callback within the inline storage of std::function,
+    // so starting a target call doesn't allocate.
+    const bool target_could_start = target_(
+        [operation = &operation](bool, bool) { operation->sequencer->complete(*operation); });
     if (target_could_start) {
       unblockAndUpdateStatisticIfNeeded(now);
+      overhead_statistics_.slippage->addValue((now - unstarted_intended_start_).count());
       targets_initiated_++;
+      started++;
+      unstarted_acquisitions_--;
+      if (unstarted_acquisitions_ > 0) {
+        unstarted_intended_start_ =
+            intendedStart(acquired_batch_size_ - unstarted_acquisitions_, now);
+      }
     } else {
       // This should only happen when we are running in closed-loop mode.The target wasn't able to
-      // proceed. Update the rate limiter.
+      // proceed. We hold on to the acquisitions that we couldn't start yet.
+      free_operations_.push_back(&operation);
       updateStartBlockingTimeIfNeeded();
-      rate_limiter_->releaseOne();
       // Retry later. When all target_ calls have completed we are going to spin until target_
       // stops returning false. Otherwise the periodic timer will wake us up to re-check.
       break;
     }
   }
 
+  // Only runs that did work are timed. Idle runs are cheap, and would drown out the others when
+  // spinning.
+  Envoy::MonotonicTime run_end = now;
+  if (started > 0) {
+    dispatcher_.updateApproximateMonotonicTime();
+    run_end = time_source_.monotonicTime();
+    overhead_statistics_.run_duration->addValue((run_end - now).count());
+  }
+
+  if (idle_strategy_ == nighthawk::client::SequencerIdleStrategy::TIMER) {
+    // The spin timer may be armed from either timer, it replaces any earlier arming.
+    armReleaseTimer(run_end);
+  }
+
   if (from_periodic_timer) {
     // Re-schedule the periodic timer if it was responsible for waking up this code.
-    scheduleRun();
+    scheduleRun(run_end);
   } else {
     if (idle_strategy_ == nighthawk::client::SequencerIdleStrategy::SPIN &&
         (targets_initiated_ == targets_completed_)) {
@@ -157,6 +265,36 @@ void SequencerImpl::run(bool from_periodic_timer) {
   }
 }
 
+SequencerImpl::InflightOperation& SequencerImpl::acquireOperation() {
+  if (free_operations_.empty()) {
+    operations_.push_back(std::make_unique<InflightOperation>());
+    operations_.back()->sequencer = this;
+    return *operations_.back();
+  }
+  InflightOperation* operation = free_operations_.back();
+  free_operations_.pop_back();
+  return *operation;
+}
+
+void SequencerImpl::complete(InflightOperation& operation) {
+  // Update cached time, as we need an accurate value for latency reporting.
+  dispatcher_.updateApproximateMonotonicTime();
+  const Envoy::MonotonicTime completion_time = time_source_.monotonicTime();
+  latency_statistic_->addValue((completion_time - operation.start).count());
+  intended_latency_statistic_->addValue((completion_time - operation.intended_start).count());
+  free_operations_.push_back(&operation);
+  targets_completed_++;
+  // Callbacks may fire after stop() is called. When the worker teardown runs the dispatcher,
+  // in-flight work might wrap up and fire this callback. By then we wouldn't want to
+  // re-enable any timers here.
+  if (running_) {
+    // Immediately schedule us to check again, as chances are we can get on with the next
+    // task. This supersedes a wakeup armed by the timer idle strategy.
+    armed_wakeup_ = std::nullopt;
+    spin_timer_->enableHRTimer(0ms);
+  }
+}
+
 void SequencerImpl::waitForCompletion() {
   // It's possible that we have already finished when we get here.
   if (running_) {
@@ -170,6 +308,12 @@ StatisticPtrMap SequencerImpl::statistics() const {
   StatisticPtrMap statistics;
   statistics[latency_statistic_->id()] = latency_statistic_.get();
   statistics[blocked_statistic_->id()] = blocked_statistic_.get();
+  statistics[intended_latency_statistic_->id()] = intended_latency_statistic_.get();
+  statistics[overhead_statistics_.loop_lag->id()] = overhead_statistics_.loop_lag.get();
+  statistics[overhead_statistics_.run_duration->id()] = overhead_statistics_.run_duration.get();
+  statistics[overhead_statistics_.slippage->id()] = overhead_statistics_.slippage.get();
+  statistics[overhead_statistics_.thread_cpu_time->id()] =
+      overhead_statistics_.thread_cpu_time.get();
   return statistics;
 };
 
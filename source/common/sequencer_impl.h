@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "envoy/common/pure.h"
 #include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
@@ -20,15 +23,43 @@ using namespace std::chrono_literals;
 
 // We shoot for a 40kHz resolution.
 constexpr std::chrono::microseconds NighthawkTimerResolution = 25us;
+// With the timer idle strategy the periodic timer is only a safety net, for when the rate limiter
+// can't tell when it will release next.
+constexpr std::chrono::microseconds TimerIdleStrategyPollInterval = 1ms;
+// Bounds and initial value of the window before a release during which the timer idle strategy
+// spins instead of relying on the timer.
+constexpr std::chrono::nanoseconds TimerIdleStrategyMinSpinWindow = 5us;
+constexpr std::chrono::nanoseconds TimerIdleStrategyMaxSpinWindow = 200us;
+constexpr std::chrono::nanoseconds TimerIdleStrategyInitialSpinWindow = 50us;
+// Starting a batch of releases later than this behind the pace of the rate limiter, for reasons
+// other than the target refusing to start, counts as the load generator being saturated.
+constexpr std::chrono::nanoseconds GeneratorSaturationThreshold = 1ms;
 
 } // namespace
 
-#define ALL_SEQUENCER_STATS(COUNTER) COUNTER(failed_terminations)
+#define ALL_SEQUENCER_STATS(COUNTER)                                                               \
+  COUNTER(failed_terminations)                                                                     \
+  COUNTER(generator_saturated)
 
 struct SequencerStats {
   ALL_SEQUENCER_STATS(GENERATE_COUNTER_STRUCT)
 };
 
+/**
+ * Statistics on the time the sequencer spends on its own account. They tell whether Nighthawk kept
+ * up with the pace of the rate limiter, or was itself the bottleneck of an execution.
+ */
+struct SequencerOverheadStatistics {
+  // How late the timers driving the sequencer fired, relative to the time they were armed for.
+  StatisticPtr loop_lag;
+  // Duration of the runs that started target calls.
+  StatisticPtr run_duration;
+  // How late target calls were started, relative to the time the rate limiter intended.
+  StatisticPtr slippage;
+  // CPU time the thread spent while the sequencer was running. Holds a single value.
+  StatisticPtr thread_cpu_time;
+};
+
 /**
  * The Sequencer will drive calls to the SequencerTarget at a pace indicated by the associated
  * RateLimiter. The contract with the target is that it will call the provided callback when it is
@@ -46,6 +77,7 @@ public:
       const PlatformUtil& platform_util, Envoy::Event::Dispatcher& dispatcher,
       Envoy::TimeSource& time_source, RateLimiterPtr&& rate_limiter, SequencerTarget target,
       StatisticPtr&& latency_statistic, StatisticPtr&& blocked_statistic,
+      StatisticPtr&& intended_latency_statistic, SequencerOverheadStatistics&& overhead_statistics,
       nighthawk::client::SequencerIdleStrategy::SequencerIdleStrategyOptions idle_strategy,
       TerminationPredicatePtr&& termination_predicate, Envoy::Stats::Scope& scope);
 
@@ -75,6 +107,8 @@ public:
 
   const Statistic& blockedStatistic() const { return *blocked_statistic_; }
   const Statistic& latencyStatistic() const { return *latency_statistic_; }
+  const Statistic& intendedLatencyStatistic() const { return *intended_latency_statistic_; }
+  const SequencerOverheadStatistics& overheadStatistics() const { return overhead_statistics_; }
 
 protected:
   /**
@@ -99,16 +133,78 @@ protected:
    * For more context on the current implementation of how we spin, see the the review discussion:
    * https://github.com/envoyproxy/envoy-perf/pull/49#discussion_r259133387
    *
+   * The timer idle strategy avoids spinning for the most part: it asks the rate limiter when the
+   * next release is due, and arms the spin timer to fire shortly before that. Only the last few
+   * microseconds are spun, where the length of that window tracks how late the timer has been
+   * observed to fire.
+   *
    * @param from_periodic_timer Indicates if we this is called from the periodic timer.
    * Used to determine if re-enablement of the periodic timer should be performed before returning.
    */
   void run(bool from_periodic_timer);
-  void scheduleRun();
+  /**
+   * Arms the periodic timer.
+   *
+   * @param now The current time, which the lag of the periodic timer is measured against.
+   */
+  void scheduleRun(const Envoy::MonotonicTime& now);
   void stop(bool timed_out);
   void unblockAndUpdateStatisticIfNeeded(const Envoy::MonotonicTime& now);
+  /**
+   * Records how late a timer fired.
+   *
+   * @param due The point in time the timer was armed for.
+   * @param now The current time.
+   */
+  void recordLoopLag(const Envoy::MonotonicTime& due, const Envoy::MonotonicTime& now);
   void updateStartBlockingTimeIfNeeded();
+  /**
+   * Arms the spin timer to wake up just ahead of the next release of the rate limiter. Used by
+   * the timer idle strategy.
+   *
+   * @param now The current time.
+   */
+  void armReleaseTimer(const Envoy::MonotonicTime& now);
+  /**
+   * Updates the spin window used by armReleaseTimer() based on how late the timer fired.
+   *
+   * @param now The current time.
+   */
+  void calibrateSpinWindowIfNeeded(const Envoy::MonotonicTime& now);
+  /**
+   * When we fall behind, the rate limiter releases acquisitions later than it intended to. Also
+   * measuring latency from the intended point in time includes that delay, which avoids
+   * coordinated omission.
+   *
+   * @param index Position of the acquisition in the batch most recently acquired.
+   * @param now The current time.
+   * @return Envoy::MonotonicTime The point in time the acquisition was due, or now if the rate
+   * limiter does not track that.
+   */
+  Envoy::MonotonicTime intendedStart(uint64_t index, const Envoy::MonotonicTime& now) const;
 
 private:
+  /**
+   * State of a target call that has been started, for use by its completion callback. Pooled, so
+   * that starting target calls does not allocate once the pool has warmed up.
+   */
+  struct InflightOperation {
+    SequencerImpl* sequencer{};
+    Envoy::MonotonicTime start;
+    Envoy::MonotonicTime intended_start;
+  };
+
+  /**
+   * @return InflightOperation& An operation from the pool, which is handed back by complete().
+   */
+  InflightOperation& acquireOperation();
+  /**
+   * Records the latencies of a completed target call, and hands its state back to the pool.
+   *
+   * @param operation The state of the completed target call.
+   */
+  void complete(InflightOperation& operation);
+
   SequencerTarget target_;
   const PlatformUtil& platform_util_;
   Envoy::Event::Dispatcher& dispatcher_;
@@ -116,6 +212,8 @@ private:
   std::unique_ptr<RateLimiter> rate_limiter_;
   StatisticPtr latency_statistic_;
   StatisticPtr blocked_statistic_;
+  StatisticPtr intended_latency_statistic_;
+  SequencerOverheadStatistics overhead_statistics_;
   Envoy::Event::TimerPtr periodic_timer_;
   Envoy::Event::TimerPtr spin_timer_;
   uint64_t targets_initiated_{0};
@@ -123,9 +221,31 @@ private:
   bool running_{};
   bool blocked_{};
   Envoy::MonotonicTime blocked_start_;
+  // The last time the target accepted a call after having refused. Releases that were due before
+  // then are late because of the target, and don't count towards generator saturation.
+  Envoy::MonotonicTime unblocked_at_{Envoy::MonotonicTime::min()};
   nighthawk::client::SequencerIdleStrategy::SequencerIdleStrategyOptions idle_strategy_;
   TerminationPredicatePtr termination_predicate_;
   TerminationPredicate::Status last_termination_status_;
+  // Acquisitions that were obtained from the rate limiter but not yet started, because the target
+  // refused. They are started before acquiring more. The first one is due at the intended start
+  // below.
+  uint64_t unstarted_acquisitions_{0};
+  Envoy::MonotonicTime unstarted_intended_start_;
+  // Size of the batch most recently acquired from the rate limiter.
+  uint64_t acquired_batch_size_{0};
+  // Owns all operations. Those that are not in flight are listed in free_operations_.
+  std::vector<std::unique_ptr<InflightOperation>> operations_;
+  std::vector<InflightOperation*> free_operations_;
+  // Point in time the spin timer was last armed for by armReleaseTimer(), if it is still pending.
+  std::optional<Envoy::MonotonicTime> armed_wakeup_;
+  // Point in time the periodic timer was last armed for.
+  std::optional<Envoy::MonotonicTime> periodic_wakeup_;
+  // CPU time of the thread when the sequencer started.
+  std::chrono::nanoseconds thread_cpu_time_at_start_{0};
+  // Moving average of how late the armed spin timer fires.
+  std::chrono::nanoseconds timer_lateness_{0};
+  std::chrono::nanoseconds spin_window_{TimerIdleStrategyInitialSpinWindow};
   Envoy::Stats::ScopeSharedPtr scope_;
   SequencerStats sequencer_stats_;
 };
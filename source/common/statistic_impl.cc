@@ -1,5 +1,6 @@
 #include "source/common/statistic_impl.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <fstream>
@@ -7,6 +8,7 @@
 
 #include "external/dep_hdrhistogram_c/include/hdr/hdr_histogram_log.h"
 #include "external/envoy/source/common/common/assert.h"
+#include "external/envoy/source/common/common/lock_guard.h"
 #include "external/envoy/source/common/protobuf/utility.h"
 
 #include "absl/strings/str_cat.h"
@@ -27,6 +29,16 @@ static void setDurationFromNanos(Envoy::Protobuf::Duration& mutable_duration,
   mutable_duration.set_nanos(nanos % one_billion);
 }
 
+// Quantiles reported by statistics that do not have a natural set of their own. Based on
+// hdr_proto_json.gold.
+const std::vector<double>& reportedQuantiles() {
+  static const std::vector<double>* quantiles =
+      new std::vector<double>{0,    0.1,   0.2,  0.3,   0.4,  0.5,   0.55,  0.6,
+                              0.65, 0.7,   0.75, 0.775, 0.8,  0.825, 0.85,  0.875,
+                              0.90, 0.925, 0.95, 0.975, 0.99, 0.995, 0.999, 1};
+  return *quantiles;
+}
+
 } // namespace
 
 std::string StatisticImpl::toString() const {
@@ -234,67 +246,242 @@ StatisticPtr InMemoryStatistic::combine(const Statistic& statistic) const {
   return combined;
 }
 
-const int HdrStatistic::SignificantDigits = 4;
+// Read access to the values of an HdrStatistic as a histogram. While the values are still kept
+// as-is, they are copied into a temporary histogram. Its range only extends to the largest value,
+// which keeps it small. The bucket layout, and thereby the reported values, does not depend on the
+// range.
+class HdrStatistic::HistogramView {
+public:
+  explicit HistogramView(const HdrStatistic& statistic, bool configured_range = false)
+      : histogram_(statistic.histogram_) {
+    if (histogram_ == nullptr) {
+      int64_t highest_trackable_value = statistic.config_.highest_trackable_value;
+      if (!configured_range) {
+        const auto max_value =
+            std::max_element(statistic.sparse_values_.begin(), statistic.sparse_values_.end());
+        highest_trackable_value = std::max<int64_t>(
+            2, max_value == statistic.sparse_values_.end() ? 0 : *max_value);
+      }
+      owned_ = allocateHistogram(highest_trackable_value, statistic.config_.significant_digits);
+      for (const uint64_t value : statistic.sparse_values_) {
+        hdr_record_value(owned_, value);
+      }
+      histogram_ = owned_;
+    }
+  }
+  ~HistogramView() {
+    if (owned_ != nullptr) {
+      hdr_close(owned_);
+    }
+  }
+  struct hdr_histogram* get() const { return histogram_; }
 
-HdrStatistic::HdrStatistic() : histogram_(nullptr) {
-  // Upper bound of 60 seconds (tracking in nanoseconds).
-  const uint64_t max_latency = 1000L * 1000 * 1000 * 60;
+private:
+  struct hdr_histogram* histogram_;
+  struct hdr_histogram* owned_{nullptr};
+};
 
-  int status = hdr_init(1 /* min trackable value */, max_latency, HdrStatistic::SignificantDigits,
-                        &histogram_);
-  ASSERT(status == 0);
-  ASSERT(histogram_ != nullptr);
-}
+// The buckets values kept as-is fall into, looked up without allocating any counts. Means,
+// deviations and extremes computed with it match those of an allocated histogram.
+class HdrStatistic::BucketLayout {
+public:
+  explicit BucketLayout(const HdrStatisticConfig& config) : layout_() {
+    struct hdr_histogram_bucket_config bucket_config;
+    const int status = hdr_calculate_bucket_config(1 /* min trackable value */,
+                                                   config.highest_trackable_value,
+                                                   config.significant_digits, &bucket_config);
+    RELEASE_ASSERT(status == 0, "Failed to calculate HdrHistogram bucket layout.");
+    hdr_init_preallocated(&layout_, &bucket_config);
+  }
+  // The value hdr_mean() and hdr_stddev() use for the bucket of value.
+  int64_t median(uint64_t value) const { return hdr_median_equivalent_value(&layout_, value); }
+  // The values hdr_value_at_percentile() reports for the lowest and highest rank in the bucket.
+  int64_t lowest(uint64_t value) const { return hdr_lowest_equivalent_value(&layout_, value); }
+  int64_t highest(uint64_t value) const {
+    return hdr_next_non_equivalent_value(&layout_, value) - 1;
+  }
+
+private:
+  struct hdr_histogram layout_;
+};
+
+HdrStatistic::HdrStatistic(const HdrStatisticConfig& config) : config_(config) {}
 
-// TODO(oschaaf): valgrind complains when a Histogram is created but never used.
 HdrStatistic::~HdrStatistic() {
-  ASSERT(histogram_ != nullptr);
-  hdr_close(histogram_);
-  histogram_ = nullptr;
+  if (histogram_ != nullptr) {
+    hdr_close(histogram_);
+    histogram_ = nullptr;
+  }
 }
 
-void HdrStatistic::addValue(uint64_t value) {
-  // Failure to record a value can happen when it exceeds the configured minimum
-  // or maximum value we passed when initializing histogram_.
+struct hdr_histogram* HdrStatistic::allocateHistogram(int64_t highest_trackable_value,
+                                                      int significant_digits) {
+  struct hdr_histogram* histogram = nullptr;
+  const int status = hdr_init(1 /* min trackable value */, highest_trackable_value,
+                              significant_digits, &histogram);
+  RELEASE_ASSERT(status == 0, "Failed to initialize HdrHistogram.");
+  return histogram;
+}
+
+void HdrStatistic::ensureHistogram() {
+  if (histogram_ != nullptr) {
+    return;
+  }
+  histogram_ = allocateHistogram(config_.highest_trackable_value, config_.significant_digits);
+  for (const uint64_t value : sparse_values_) {
+    hdr_record_value(histogram_, value);
+  }
+  sparse_values_.clear();
+  sparse_values_.shrink_to_fit();
+}
+
+bool HdrStatistic::insertValue(uint64_t value) {
+  // Out of range values are dropped up front, so that it does not matter whether the histogram
+  // has been allocated yet.
+  if (value > static_cast<uint64_t>(config_.highest_trackable_value)) {
+    dropped_count_++;
+    return false;
+  }
+  if (histogram_ == nullptr) {
+    if (sparse_values_.size() < config_.sparse_capacity) {
+      sparse_values_.push_back(value);
+      return true;
+    }
+    ensureHistogram();
+  }
   if (!hdr_record_value(histogram_, value)) {
+    dropped_count_++;
+    return false;
+  }
+  return true;
+}
+
+void HdrStatistic::addValue(uint64_t value) {
+  if (!insertValue(value)) {
     ENVOY_LOG_EVERY_POW_2(warn, "Failed to record value of {} into HdrHistogram.", value);
   } else {
     StatisticImpl::addValue(value);
+    if (interval_recorder_ != nullptr) {
+      interval_recorder_->recordValue(value);
+    }
   }
 }
 
 // We override count for the Hdr statistics, because it may have dropped
 // out of range values. hence our own tracking may be inaccurate.
-uint64_t HdrStatistic::count() const { return histogram_->total_count; }
-double HdrStatistic::mean() const { return count() == 0 ? std::nan("") : hdr_mean(histogram_); }
-double HdrStatistic::pvariance() const { return pstdev() * pstdev(); }
-double HdrStatistic::pstdev() const { return count() == 0 ? std::nan("") : hdr_stddev(histogram_); }
+uint64_t HdrStatistic::count() const {
+  return histogram_ != nullptr ? histogram_->total_count : sparse_values_.size();
+}
+double HdrStatistic::mean() const {
+  if (count() == 0) {
+    return std::nan("");
+  }
+  if (histogram_ != nullptr) {
+    return hdr_mean(histogram_);
+  }
+  const BucketLayout layout(config_);
+  int64_t total = 0;
+  for (const uint64_t value : sparse_values_) {
+    total += layout.median(value);
+  }
+  return (total * 1.0) / sparse_values_.size();
+}
+double HdrStatistic::pvariance() const {
+  const double stdev = pstdev();
+  return stdev * stdev;
+}
+double HdrStatistic::pstdev() const {
+  if (count() == 0) {
+    return std::nan("");
+  }
+  if (histogram_ != nullptr) {
+    return hdr_stddev(histogram_);
+  }
+  const BucketLayout layout(config_);
+  const double sparse_mean = mean();
+  double geometric_dev_total = 0.0;
+  for (const uint64_t value : sparse_values_) {
+    const double dev = (layout.median(value) * 1.0) - sparse_mean;
+    geometric_dev_total += dev * dev;
+  }
+  return sqrt(geometric_dev_total / sparse_values_.size());
+}
 uint64_t HdrStatistic::min() const {
-  return count() == 0 ? UINT64_MAX : hdr_value_at_percentile(histogram_, 0);
+  if (count() == 0) {
+    return UINT64_MAX;
+  }
+  if (histogram_ != nullptr) {
+    return hdr_value_at_percentile(histogram_, 0);
+  }
+  return BucketLayout(config_).lowest(
+      *std::min_element(sparse_values_.begin(), sparse_values_.end()));
+}
+uint64_t HdrStatistic::max() const {
+  if (histogram_ != nullptr) {
+    return hdr_value_at_percentile(histogram_, 100);
+  }
+  if (sparse_values_.empty()) {
+    return 0;
+  }
+  return BucketLayout(config_).highest(
+      *std::max_element(sparse_values_.begin(), sparse_values_.end()));
 }
-uint64_t HdrStatistic::max() const { return hdr_value_at_percentile(histogram_, 100); }
 
-StatisticPtr HdrStatistic::combine(const Statistic& statistic) const {
-  auto combined = std::make_unique<HdrStatistic>();
-  const auto& b = dynamic_cast<const HdrStatistic&>(statistic);
+uint64_t HdrStatistic::valueAtPercentile(double percentile) const {
+  return hdr_value_at_percentile(HistogramView(*this).get(), percentile);
+}
+
+void HdrStatistic::enableIntervalRecording() {
+  ASSERT(count() == 0);
+  interval_recorder_ = std::make_shared<HdrIntervalRecorder>(config_);
+}
 
+void HdrStatistic::addValuesOf(const HdrStatistic& other) {
+  dropped_count_ += other.dropped_count_;
+  if (other.histogram_ == nullptr) {
+    for (const uint64_t value : other.sparse_values_) {
+      insertValue(value);
+    }
+    return;
+  }
+  ensureHistogram();
   // Dropping a value can happen when it exceeds the configured minimum
   // or maximum value we passed when initializing histogram_.
-  int dropped;
-  dropped = hdr_add(combined->histogram_, this->histogram_);
-  dropped += hdr_add(combined->histogram_, b.histogram_);
+  const int64_t dropped = hdr_add(histogram_, other.histogram_);
   if (dropped > 0) {
     ENVOY_LOG(warn, "Combining HdrHistograms dropped values.");
+    dropped_count_ += dropped;
+  }
+}
+
+StatisticPtr HdrStatistic::combine(const Statistic& statistic) const {
+  const auto& b = dynamic_cast<const HdrStatistic&>(statistic);
+  HdrStatisticConfig config = config_;
+  config.highest_trackable_value =
+      std::max(config_.highest_trackable_value, b.config_.highest_trackable_value);
+  auto combined = std::make_unique<HdrStatistic>(config);
+  // Combining statistics that only hold a few values does not need to allocate a histogram.
+  if (histogram_ == nullptr && b.histogram_ == nullptr &&
+      sparse_values_.size() + b.sparse_values_.size() <= config.sparse_capacity) {
+    combined->sparse_values_.reserve(sparse_values_.size() + b.sparse_values_.size());
+  } else {
+    combined->ensureHistogram();
   }
+  combined->addValuesOf(*this);
+  combined->addValuesOf(b);
   return combined;
 }
 
 nighthawk::client::Statistic HdrStatistic::toProto(SerializationDomain domain) const {
+  // The summary does not need a view of values kept as-is, so the percentiles below are the only
+  // reason to build one.
   nighthawk::client::Statistic proto = StatisticImpl::toProto(domain);
+  proto.set_dropped_count(dropped_count_);
 
+  const HistogramView view(*this);
   struct hdr_iter iter;
   struct hdr_iter_percentiles* percentiles;
-  hdr_iter_percentile_init(&iter, histogram_, 5 /*ticks_per_half_distance*/);
+  hdr_iter_percentile_init(&iter, view.get(), 5 /*ticks_per_half_distance*/);
 
   percentiles = &iter.specifics.percentiles;
   while (hdr_iter_next(&iter)) {
@@ -314,8 +501,10 @@ nighthawk::client::Statistic HdrStatistic::toProto(SerializationDomain domain) c
 }
 
 absl::StatusOr<std::unique_ptr<std::istream>> HdrStatistic::serializeNative() const {
+  // The encoding carries the range of the histogram, so encode at the configured one.
+  const HistogramView view(*this, /*configured_range=*/true);
   char* data;
-  if (hdr_log_encode(histogram_, &data) == 0) {
+  if (hdr_log_encode(view.get(), &data) == 0) {
     auto write_stream = std::make_unique<std::stringstream>();
     *write_stream << absl::string_view(data, strlen(data));
     // Free the memory allocated by hrd_log_encode.
@@ -332,16 +521,151 @@ absl::Status HdrStatistic::deserializeNative(std::istream& stream) {
   // hdr_log_decode allocates memory for the new hdr histogram.
   if (hdr_log_decode(&new_histogram, const_cast<char*>(s.c_str()), s.length()) == 0) {
     // Free the memory allocated by our current hdr histogram.
-    hdr_close(histogram_);
+    if (histogram_ != nullptr) {
+      hdr_close(histogram_);
+    }
     // Swap in the new histogram.
     // NOTE: Our destructor will eventually call hdr_close on the new one.
     histogram_ = new_histogram;
+    sparse_values_.clear();
+    dropped_count_ = 0;
+    config_.highest_trackable_value = new_histogram->highest_trackable_value;
+    config_.significant_digits = new_histogram->significant_figures;
     return absl::OkStatus();
   }
   ENVOY_LOG(error, "Failed to read back HdrHistogram data.");
   return absl::Status{absl::StatusCode::kInternal, "Failed to read back HdrHistogram data"};
 }
 
+absl::StatusOr<std::unique_ptr<HdrStatistic>>
+HdrStatistic::fromProto(const nighthawk::client::Statistic& proto) {
+  if (proto.hdr_histogram().empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Statistic '", proto.id(), "' has no HdrHistogram encoding"));
+  }
+  auto statistic = std::make_unique<HdrStatistic>();
+  std::istringstream stream(proto.hdr_histogram());
+  absl::Status status = statistic->deserializeNative(stream);
+  if (!status.ok()) {
+    return status;
+  }
+  statistic->setId(proto.id());
+  // The encoding only carries the recorded values.
+  statistic->dropped_count_ = proto.dropped_count();
+  return statistic;
+}
+
+Statistic::SerializationDomain
+HdrStatistic::serializationDomain(const nighthawk::client::Statistic& proto) {
+  return proto.mean_type_case() == nighthawk::client::Statistic::kRawMean
+             ? SerializationDomain::RAW
+             : SerializationDomain::DURATION;
+}
+
+absl::Status HdrStatistic::renderPercentiles(nighthawk::client::Statistic& proto) {
+  if (proto.hdr_histogram().empty() || proto.percentiles_size() > 0) {
+    return absl::OkStatus();
+  }
+  absl::StatusOr<std::unique_ptr<HdrStatistic>> statistic = fromProto(proto);
+  if (!statistic.ok()) {
+    return statistic.status();
+  }
+  *proto.mutable_percentiles() =
+      (*statistic)->toProto(serializationDomain(proto)).percentiles();
+  return absl::OkStatus();
+}
+
+HdrIntervalRecorder::HdrIntervalRecorder(const HdrStatisticConfig& config) : config_(config) {}
+
+HdrIntervalRecorder::~HdrIntervalRecorder() {
+  for (struct hdr_histogram* pending : pending_) {
+    if (pending != nullptr) {
+      hdr_close(pending);
+    }
+  }
+  if (initialized_.load(std::memory_order_acquire)) {
+    hdr_interval_recorder_destroy(&recorder_);
+  }
+}
+
+bool HdrIntervalRecorder::recordValue(uint64_t value) {
+  // Only the recording thread sets initialized_, so a relaxed load suffices here.
+  if (!initialized_.load(std::memory_order_relaxed)) {
+    const int status = hdr_interval_recorder_init_all(&recorder_, 1 /* min trackable value */,
+                                                      config_.highest_trackable_value,
+                                                      config_.significant_digits);
+    RELEASE_ASSERT(status == 0, "Failed to initialize HdrHistogram interval recorder.");
+    initialized_.store(true, std::memory_order_release);
+  }
+  return hdr_interval_recorder_record_value(&recorder_, value) != 0;
+}
+
+uint32_t HdrIntervalRecorder::addReader() {
+  Envoy::Thread::LockGuard guard(sample_lock_);
+  pending_.push_back(nullptr);
+  return pending_.size() - 1;
+}
+
+void HdrIntervalRecorder::sampleInto(HdrStatistic& statistic, uint32_t reader) {
+  // The sampled histogram is owned by recorder_, and stays untouched until the next sample.
+  // Serialize samples so that a concurrent one cannot clear it while we are reading from it.
+  Envoy::Thread::LockGuard guard(sample_lock_);
+  RELEASE_ASSERT(reader < pending_.size(), "Unknown HdrHistogram interval reader.");
+  if (!initialized_.load(std::memory_order_acquire)) {
+    // Nothing has been recorded yet.
+    return;
+  }
+  // A single reader takes the samples as they are. Only once there are more, values sampled by
+  // one reader have to be kept for the others.
+  if (pending_.size() > 1) {
+    for (struct hdr_histogram*& pending : pending_) {
+      if (pending == nullptr) {
+        pending = HdrStatistic::allocateHistogram(config_.highest_trackable_value,
+                                                  config_.significant_digits);
+      }
+    }
+  }
+  const struct hdr_histogram* sample = hdr_interval_recorder_sample(&recorder_);
+  for (uint32_t other = 0; other < pending_.size(); other++) {
+    if (other != reader) {
+      addHistogram(pending_[other], sample);
+    }
+  }
+  if (pending_[reader] != nullptr && pending_[reader]->total_count > 0) {
+    statistic.ensureHistogram();
+    addHistogram(statistic.histogram_, pending_[reader]);
+    hdr_reset(pending_[reader]);
+  }
+  if (sample->total_count > 0) {
+    statistic.ensureHistogram();
+    addHistogram(statistic.histogram_, sample);
+  }
+}
+
+void HdrIntervalRecorder::addHistogram(struct hdr_histogram* to, const struct hdr_histogram* from) {
+  if (hdr_add(to, from) > 0) {
+    ENVOY_LOG(warn, "Sampling an HdrHistogram interval dropped values.");
+  }
+}
+
+void HdrIntervalSampler::addRecorder(absl::string_view id, HdrIntervalRecorderSharedPtr recorder) {
+  const uint32_t reader = recorder->addReader();
+  recorders_[std::string(id)].emplace_back(std::move(recorder), reader);
+}
+
+std::vector<std::unique_ptr<HdrStatistic>> HdrIntervalSampler::sample() {
+  std::vector<std::unique_ptr<HdrStatistic>> intervals;
+  for (const auto& [id, recorders] : recorders_) {
+    auto interval = std::make_unique<HdrStatistic>(recorders.front().first->config());
+    interval->setId(id);
+    for (const auto& [recorder, reader] : recorders) {
+      recorder->sampleInto(*interval, reader);
+    }
+    intervals.push_back(std::move(interval));
+  }
+  return intervals;
+}
+
 CircllhistStatistic::CircllhistStatistic() {
   histogram_ = hist_alloc();
   ASSERT(histogram_ != nullptr);
@@ -381,10 +705,7 @@ nighthawk::client::Statistic CircllhistStatistic::toProto(SerializationDomain do
     return proto;
   }
 
-  // List of quantiles is based on hdr_proto_json.gold.
-  const std::vector<double> quantiles{0,    0.1,   0.2,  0.3,   0.4,  0.5,   0.55,  0.6,
-                                      0.65, 0.7,   0.75, 0.775, 0.8,  0.825, 0.85,  0.875,
-                                      0.90, 0.925, 0.95, 0.975, 0.99, 0.995, 0.999, 1};
+  const std::vector<double>& quantiles = reportedQuantiles();
   std::vector<double> computed_quantiles(quantiles.size(), 0.0);
   hist_approx_quantile(histogram_, quantiles.data(), quantiles.size(), computed_quantiles.data());
   for (size_t i = 0; i < quantiles.size(); i++) {
@@ -402,6 +723,124 @@ nighthawk::client::Statistic CircllhistStatistic::toProto(SerializationDomain do
   return proto;
 }
 
+DDSketchStatistic::DDSketchStatistic(double relative_accuracy)
+    : relative_accuracy_(relative_accuracy),
+      gamma_((1 + relative_accuracy) / (1 - relative_accuracy)),
+      inverse_log_gamma_(1 / std::log(gamma_)) {
+  ASSERT(relative_accuracy > 0 && relative_accuracy < 1);
+}
+
+uint32_t DDSketchStatistic::bucketIndex(uint64_t value) const {
+  return static_cast<uint32_t>(
+      std::ceil(std::log(static_cast<double>(value)) * inverse_log_gamma_));
+}
+
+uint64_t DDSketchStatistic::bucketValue(uint32_t index) const {
+  return std::llround(2 * std::pow(gamma_, index) / (gamma_ + 1));
+}
+
+void DDSketchStatistic::addValue(uint64_t value) {
+  StatisticImpl::addValue(value);
+  if (value == 0) {
+    zero_count_++;
+  } else {
+    const uint32_t index = bucketIndex(value);
+    if (index >= buckets_.size()) {
+      buckets_.resize(index + 1);
+    }
+    buckets_[index]++;
+  }
+  // Tracks the mean and variance like StreamingStatistic does.
+  const double delta = value - mean_;
+  const double delta_n = delta / count_;
+  mean_ += delta_n;
+  accumulated_variance_ += delta * delta_n * (count_ - 1.0);
+}
+
+double DDSketchStatistic::mean() const { return count_ == 0 ? std::nan("") : mean_; }
+
+double DDSketchStatistic::pvariance() const {
+  return count_ == 0 ? std::nan("") : accumulated_variance_ / count_;
+}
+
+double DDSketchStatistic::pstdev() const {
+  return count_ == 0 ? std::nan("") : sqrt(pvariance());
+}
+
+uint64_t DDSketchStatistic::significantDigits() const {
+  // 1% relative accuracy amounts to about two significant digits.
+  return std::max(1, static_cast<int>(-std::log10(relative_accuracy_)));
+}
+
+StatisticPtr DDSketchStatistic::combine(const Statistic& statistic) const {
+  const DDSketchStatistic& a = *this;
+  const auto& b = dynamic_cast<const DDSketchStatistic&>(statistic);
+  // Buckets only line up between sketches of the same accuracy.
+  ASSERT(a.relative_accuracy_ == b.relative_accuracy_);
+  auto combined = std::make_unique<DDSketchStatistic>(relative_accuracy_);
+
+  combined->buckets_ = a.buckets_;
+  combined->buckets_.resize(std::max(a.buckets_.size(), b.buckets_.size()));
+  for (size_t i = 0; i < b.buckets_.size(); i++) {
+    combined->buckets_[i] += b.buckets_[i];
+  }
+  combined->zero_count_ = a.zero_count_ + b.zero_count_;
+  combined->min_ = std::min(a.min(), b.min());
+  combined->max_ = std::max(a.max(), b.max());
+  combined->count_ = a.count() + b.count();
+  if (combined->count_ > 0) {
+    combined->mean_ = ((a.count() * a.mean_) + (b.count() * b.mean_)) / combined->count_;
+    combined->accumulated_variance_ =
+        a.accumulated_variance_ + b.accumulated_variance_ +
+        pow(a.mean_ - b.mean_, 2) * a.count() * b.count() / combined->count();
+  }
+  return combined;
+}
+
+std::pair<uint64_t, uint64_t> DDSketchStatistic::valueAtRank(uint64_t rank) const {
+  uint64_t cumulative_count = zero_count_;
+  if (rank < cumulative_count) {
+    return {0, cumulative_count};
+  }
+  for (uint32_t index = 0; index < buckets_.size(); index++) {
+    cumulative_count += buckets_[index];
+    if (rank < cumulative_count) {
+      // The bounds of the statistic are exact, and tighter than those of the bucket.
+      return {std::clamp(bucketValue(index), min_, max_), cumulative_count};
+    }
+  }
+  return {max_, cumulative_count};
+}
+
+uint64_t DDSketchStatistic::valueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  return valueAtRank(static_cast<uint64_t>(percentile / 100 * (count_ - 1))).first;
+}
+
+nighthawk::client::Statistic DDSketchStatistic::toProto(SerializationDomain domain) const {
+  nighthawk::client::Statistic proto = StatisticImpl::toProto(domain);
+  if (count() == 0) {
+    return proto;
+  }
+
+  for (const double quantile : reportedQuantiles()) {
+    const auto [value, cumulative_count] =
+        valueAtRank(static_cast<uint64_t>(quantile * (count_ - 1)));
+    nighthawk::client::Percentile* percentile = proto.add_percentiles();
+    if (domain == Statistic::SerializationDomain::DURATION) {
+      setDurationFromNanos(*percentile->mutable_duration(), value);
+    } else {
+      percentile->set_raw_value(value);
+    }
+    percentile->set_percentile(quantile);
+    percentile->set_count(cumulative_count);
+  }
+
+  return proto;
+}
+
 SinkableStatistic::SinkableStatistic(Envoy::Stats::Scope& scope, std::optional<int> worker_id)
     : Envoy::Stats::HistogramImplHelper(scope.symbolTable()), scope_(scope), worker_id_(worker_id) {
 }
@@ -418,8 +857,9 @@ Envoy::Stats::Histogram::Unit SinkableStatistic::unit() const {
 
 Envoy::Stats::SymbolTable& SinkableStatistic::symbolTable() { return scope_.symbolTable(); }
 
-SinkableHdrStatistic::SinkableHdrStatistic(Envoy::Stats::Scope& scope, std::optional<int> worker_id)
-    : SinkableStatistic(scope, worker_id) {}
+SinkableHdrStatistic::SinkableHdrStatistic(Envoy::Stats::Scope& scope, std::optional<int> worker_id,
+                                           const HdrStatisticConfig& config)
+    : SinkableStatistic(scope, worker_id), HdrStatistic(config) {}
 
 void SinkableHdrStatistic::recordValue(uint64_t value) {
   HdrStatistic::addValue(value);
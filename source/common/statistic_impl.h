@@ -1,12 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "nighthawk/common/statistic.h"
 
 #include "external/dep_hdrhistogram_c/include/hdr/hdr_histogram.h"
+#include "external/dep_hdrhistogram_c/include/hdr/hdr_interval_recorder.h"
 #include "external/envoy/source/common/common/logger.h"
+#include "external/envoy/source/common/common/non_copyable.h"
+#include "external/envoy/source/common/common/thread.h"
 #include "external/envoy/source/common/stats/histogram_impl.h"
 
 #include "source/common/frequency.h"
@@ -130,12 +137,34 @@ private:
   StatisticPtr streaming_stats_;
 };
 
+class HdrIntervalRecorder;
+using HdrIntervalRecorderSharedPtr = std::shared_ptr<HdrIntervalRecorder>;
+
+/**
+ * Range, precision and memory layout of an HdrStatistic.
+ */
+struct HdrStatisticConfig {
+  // Largest value that can be recorded. Latencies are recorded in nanoseconds. Larger values are
+  // dropped, see HdrStatistic::droppedCount(). Must be at least 2.
+  int64_t highest_trackable_value{60L * 1000 * 1000 * 1000};
+  // Number of significant decimal digits that values are kept at, from 1 to 5.
+  int significant_digits{4};
+  // Number of values that are kept as-is before the histogram is allocated. A histogram takes
+  // megabytes at the default range and precision, which is wasted on statistics that only ever
+  // hold a few values. 0 allocates the histogram as soon as the first value is added.
+  uint32_t sparse_capacity{0};
+};
+
 /**
- * HdrStatistic uses HdrHistogram under the hood to compute statistics.
+ * HdrStatistic uses HdrHistogram under the hood to compute statistics. The histogram is allocated
+ * on demand, see HdrStatisticConfig::sparse_capacity.
  */
 class HdrStatistic : public StatisticImpl {
 public:
-  HdrStatistic();
+  /**
+   * @param config The range, precision and memory layout of the statistic.
+   */
+  explicit HdrStatistic(const HdrStatisticConfig& config = {});
   ~HdrStatistic() override;
   void addValue(uint64_t sample_value) override;
   uint64_t count() const override;
@@ -147,17 +176,186 @@ public:
 
   StatisticPtr combine(const Statistic& statistic) const override;
   nighthawk::client::Statistic toProto(SerializationDomain domain) const override;
-  uint64_t significantDigits() const override { return SignificantDigits; }
+  uint64_t significantDigits() const override { return config_.significant_digits; }
   StatisticPtr createNewInstanceOfSameType() const override {
-    return std::make_unique<HdrStatistic>();
+    return std::make_unique<HdrStatistic>(config_);
   };
 
   absl::StatusOr<std::unique_ptr<std::istream>> serializeNative() const override;
+  /**
+   * Replaces the values of the statistic with the decoded ones. The range and precision of the
+   * statistic are taken from the encoding.
+   */
   absl::Status deserializeNative(std::istream&) override;
 
+  /**
+   * @param percentile The percentile to look up, in the range [0, 100].
+   * @return uint64_t The highest value that is equivalent to the value at the percentile.
+   */
+  uint64_t valueAtPercentile(double percentile) const;
+
+  /**
+   * @return const HdrStatisticConfig& The range, precision and memory layout of the statistic.
+   */
+  const HdrStatisticConfig& config() const { return config_; }
+
+  /**
+   * @return uint64_t The number of values that were dropped because they exceeded the highest
+   * trackable value. These are not included in count().
+   */
+  uint64_t droppedCount() const { return dropped_count_; }
+
+  /**
+   * @return bool true once the histogram has been allocated, false while values are kept as-is.
+   */
+  bool histogramAllocated() const { return histogram_ != nullptr; }
+
+  /**
+   * Makes addValue() also record each value into an interval recorder, from which another thread
+   * can sample the values added since its previous sample while this statistic is in use. Must be
+   * called before any values are added.
+   */
+  void enableIntervalRecording();
+
+  /**
+   * @return HdrIntervalRecorderSharedPtr The interval recorder set up by
+   * enableIntervalRecording(), or nullptr if interval recording is not enabled.
+   */
+  HdrIntervalRecorderSharedPtr intervalRecorder() const { return interval_recorder_; }
+
+  /**
+   * Reconstructs a statistic from the native HdrHistogram encoding embedded in its proto.
+   * @param proto The statistic proto, which must have hdr_histogram set.
+   * @return absl::StatusOr<std::unique_ptr<HdrStatistic>> The statistic, carrying the id and the
+   * dropped count of the proto, or an error if the proto holds no valid encoding.
+   */
+  static absl::StatusOr<std::unique_ptr<HdrStatistic>>
+  fromProto(const nighthawk::client::Statistic& proto);
+
+  /**
+   * @param proto A statistic proto.
+   * @return SerializationDomain The serialization domain the proto was written in.
+   */
+  static SerializationDomain serializationDomain(const nighthawk::client::Statistic& proto);
+
+  /**
+   * Fills in the percentiles of a statistic proto from its native HdrHistogram encoding, if it has
+   * one and no percentiles yet.
+   * @param proto The statistic proto to update.
+   * @return absl::Status An error if the embedded encoding could not be decoded.
+   */
+  static absl::Status renderPercentiles(nighthawk::client::Statistic& proto);
+
+private:
+  friend class HdrIntervalRecorder;
+  class BucketLayout;
+  class HistogramView;
+
+  // Allocates an empty histogram, to be freed with hdr_close().
+  static struct hdr_histogram* allocateHistogram(int64_t highest_trackable_value,
+                                                 int significant_digits);
+  // Records a value without feeding the interval recorder. Returns false if the value was dropped.
+  bool insertValue(uint64_t value);
+  // Allocates histogram_ if needed, and moves the values that were kept as-is into it.
+  void ensureHistogram();
+  // Adds the values of another statistic. Values exceeding our range are dropped.
+  void addValuesOf(const HdrStatistic& other);
+
+  HdrStatisticConfig config_;
+  struct hdr_histogram* histogram_{nullptr};
+  // Values added while histogram_ is not allocated yet, at most config_.sparse_capacity.
+  std::vector<uint64_t> sparse_values_;
+  uint64_t dropped_count_{0};
+  HdrIntervalRecorderSharedPtr interval_recorder_;
+};
+
+/**
+ * Double buffered HdrHistogram, built on the writer-reader phaser of HdrHistogram_c. Values are
+ * recorded into an active histogram. sampleInto() swaps in a cleared histogram, waits for
+ * recordings that are in progress on the old one to finish, and hands out the values it holds.
+ * Recording never blocks and takes no locks, so reader threads can report on intervals while the
+ * writer keeps recording.
+ *
+ * Multiple readers, each sampling at their own pace, can be registered with addReader(). Every
+ * reader sees every recorded value exactly once: values swapped out for one reader are kept
+ * pending for the others until they sample. With a single reader nothing is kept pending.
+ */
+class HdrIntervalRecorder : Envoy::NonCopyable,
+                            public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param config The range and precision of the recorded histograms. The histograms are allocated
+   * when the first value is recorded.
+   */
+  explicit HdrIntervalRecorder(const HdrStatisticConfig& config = {});
+  ~HdrIntervalRecorder();
+
+  /**
+   * Records a value into the active histogram. Wait-free, but not safe to call from multiple
+   * threads at the same time.
+   * @param value The value to record.
+   * @return bool false if the value is out of the trackable range and was dropped.
+   */
+  bool recordValue(uint64_t value);
+
+  /**
+   * Registers a reader. The first sample of a reader may include values recorded before it was
+   * registered. Safe to call concurrently with recordValue() and sampleInto().
+   * @return uint32_t The reader number to pass to sampleInto().
+   */
+  uint32_t addReader();
+
+  /**
+   * Adds the values recorded since the previous sample of a reader to a statistic. Safe to call
+   * concurrently with recordValue() and with itself.
+   * @param statistic The statistic that the values will be added to.
+   * @param reader The reader number, as returned by addReader().
+   */
+  void sampleInto(HdrStatistic& statistic, uint32_t reader);
+
+  /**
+   * @return const HdrStatisticConfig& The range and precision of the recorded histograms.
+   */
+  const HdrStatisticConfig& config() const { return config_; }
+
+private:
+  void addHistogram(struct hdr_histogram* to, const struct hdr_histogram* from);
+
+  const HdrStatisticConfig config_;
+  // Set by recordValue() once the histograms of recorder_ are allocated. sampleInto() leaves
+  // recorder_ alone until then.
+  std::atomic<bool> initialized_{false};
+  // Serializes sampleInto() and addReader(). recordValue() synchronizes with sampleInto() through
+  // the phaser in recorder_.
+  Envoy::Thread::MutexBasicLockable sample_lock_;
+  struct hdr_interval_recorder recorder_;
+  // Values sampled by other readers that a reader has not seen yet. Entries are allocated once
+  // there are multiple readers and values have been recorded.
+  std::vector<struct hdr_histogram*> pending_ ABSL_GUARDED_BY(sample_lock_);
+};
+
+/**
+ * Samples the interval recorders of statistics as a reader of its own. Recorders added with the
+ * same id, e.g. the same statistic of different client workers, are merged into a single interval
+ * statistic.
+ */
+class HdrIntervalSampler {
+public:
+  /**
+   * Registers the sampler as a reader of an interval recorder.
+   * @param id The id of the statistic that feeds the recorder.
+   * @param recorder The interval recorder to sample.
+   */
+  void addRecorder(absl::string_view id, HdrIntervalRecorderSharedPtr recorder);
+
+  /**
+   * @return std::vector<std::unique_ptr<HdrStatistic>> For each id, in lexical order, a statistic
+   * holding the values recorded since the previous sample. The statistic carries the id.
+   */
+  std::vector<std::unique_ptr<HdrStatistic>> sample();
+
 private:
-  static const int SignificantDigits;
-  struct hdr_histogram* histogram_;
+  std::map<std::string, std::vector<std::pair<HdrIntervalRecorderSharedPtr, uint32_t>>> recorders_;
 };
 
 /**
@@ -186,6 +384,60 @@ private:
   histogram_t* histogram_;
 };
 
+/**
+ * DDSketchStatistic counts values in buckets whose bounds grow by a constant factor, after the
+ * DDSketch paper. Reported percentiles are within a fixed relative error of the exact value.
+ * Adding a value takes a logarithm and an increment, and memory grows with the logarithm of the
+ * largest value: about 10KB at 1% relative accuracy for latencies of up to 60 seconds. The count,
+ * mean, standard deviation, min and max are tracked exactly.
+ */
+class DDSketchStatistic : public StatisticImpl {
+public:
+  /**
+   * @param relative_accuracy Upper bound on the relative error of reported percentiles, in the
+   * range (0, 1).
+   */
+  explicit DDSketchStatistic(double relative_accuracy = 0.01);
+
+  void addValue(uint64_t value) override;
+  double mean() const override;
+  double pvariance() const override;
+  double pstdev() const override;
+  StatisticPtr combine(const Statistic& statistic) const override;
+  bool resistsCatastrophicCancellation() const override { return true; }
+  uint64_t significantDigits() const override;
+  StatisticPtr createNewInstanceOfSameType() const override {
+    return std::make_unique<DDSketchStatistic>(relative_accuracy_);
+  }
+  nighthawk::client::Statistic toProto(SerializationDomain domain) const override;
+
+  /**
+   * @param percentile The percentile to look up, in the range [0, 100].
+   * @return uint64_t An estimate of the value at the percentile, within the relative accuracy of
+   * the exact value. 0 if the statistic holds no values.
+   */
+  uint64_t valueAtPercentile(double percentile) const;
+
+private:
+  // Index of the bucket holding values in (gamma^(index - 1), gamma^index]. Values are at least 1,
+  // so indices are never negative.
+  uint32_t bucketIndex(uint64_t value) const;
+  // Estimate for the values in a bucket, which has the same relative error to both of its bounds.
+  uint64_t bucketValue(uint32_t index) const;
+  // Estimate of the value of the given rank, counting from 0, and the number of values up to and
+  // including its bucket.
+  std::pair<uint64_t, uint64_t> valueAtRank(uint64_t rank) const;
+
+  const double relative_accuracy_;
+  const double gamma_;
+  const double inverse_log_gamma_;
+  std::vector<uint64_t> buckets_;
+  // Values of 0, which have no bucket.
+  uint64_t zero_count_{0};
+  double mean_{0};
+  double accumulated_variance_{0};
+};
+
 /**
  * In order to be able to flush a histogram value to downstream Envoy stats Sinks, abstract class
  * SinkableStatistic takes the Scope reference in the constructor and wraps the
@@ -224,7 +476,8 @@ class SinkableHdrStatistic : public SinkableStatistic, public HdrStatistic {
 public:
   // The constructor takes the Scope reference which is used to flush a histogram value to
   // downstream stats Sinks through deliverHistogramToSinks().
-  SinkableHdrStatistic(Envoy::Stats::Scope& scope, std::optional<int> worker_id = std::nullopt);
+  SinkableHdrStatistic(Envoy::Stats::Scope& scope, std::optional<int> worker_id = std::nullopt,
+                       const HdrStatisticConfig& config = {});
 
   // Envoy::Stats::Histogram
   void recordValue(uint64_t value) override;
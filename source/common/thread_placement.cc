@@ -0,0 +1,152 @@
+#include "source/common/thread_placement.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <fstream>
+#include <string>
+
+#include "external/envoy/source/common/common/macros.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Nighthawk {
+
+absl::StatusOr<std::vector<uint32_t>> ThreadPlacement::parseCpuList(absl::string_view cpu_list) {
+  std::vector<uint32_t> cpus;
+  for (absl::string_view range : absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',')) {
+    const std::pair<absl::string_view, absl::string_view> bounds =
+        absl::StrSplit(range, absl::MaxSplits('-', 1));
+    uint32_t first;
+    uint32_t last;
+    if (!absl::SimpleAtoi(bounds.first, &first)) {
+      return absl::InvalidArgumentError(absl::StrCat("Invalid CPU in list: '", range, "'"));
+    }
+    last = first;
+    if (range.find('-') != absl::string_view::npos && !absl::SimpleAtoi(bounds.second, &last)) {
+      return absl::InvalidArgumentError(absl::StrCat("Invalid CPU range in list: '", range, "'"));
+    }
+    if (last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Descending CPU range in list: '", range, "'"));
+    }
+    if (last >= MaxCpus) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("CPU out of range in list: '", range, "', must be below ", MaxCpus));
+    }
+    for (uint32_t cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+absl::Status ThreadPlacement::pinCurrentThread(uint32_t cpu) {
+#ifdef __linux__
+  if (cpu >= CPU_SETSIZE) {
+    return absl::InvalidArgumentError(absl::StrCat("CPU ", cpu, " is out of range"));
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (result != 0) {
+    return absl::InternalError(
+        absl::StrCat("Failed to pin thread to CPU ", cpu, " (error ", result, ")"));
+  }
+  return absl::OkStatus();
+#else
+  UNREFERENCED_PARAMETER(cpu);
+  return absl::UnimplementedError("Pinning threads to CPUs is only supported on Linux");
+#endif
+}
+
+std::optional<uint32_t> ThreadPlacement::numaNodeOfCpu(uint32_t cpu) {
+#ifdef __linux__
+  std::ifstream possible_file("/sys/devices/system/node/possible");
+  std::string possible;
+  if (!std::getline(possible_file, possible)) {
+    return std::nullopt;
+  }
+  // Node numbers use the same list format as CPUs.
+  const absl::StatusOr<std::vector<uint32_t>> nodes = parseCpuList(possible);
+  if (!nodes.ok()) {
+    return std::nullopt;
+  }
+  for (const uint32_t node : *nodes) {
+    std::ifstream cpulist_file(absl::StrCat("/sys/devices/system/node/node", node, "/cpulist"));
+    std::string cpulist;
+    if (!std::getline(cpulist_file, cpulist) || absl::StripAsciiWhitespace(cpulist).empty()) {
+      continue;
+    }
+    const absl::StatusOr<std::vector<uint32_t>> cpus = parseCpuList(cpulist);
+    if (cpus.ok() && std::find(cpus->begin(), cpus->end(), cpu) != cpus->end()) {
+      return node;
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(cpu);
+#endif
+  return std::nullopt;
+}
+
+absl::Status ThreadPlacement::preferNumaNodeForCurrentThread(std::optional<uint32_t> numa_node) {
+#ifdef __linux__
+  long result;
+  if (numa_node.has_value()) {
+    if (numa_node.value() >= MaxNumaNodes) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("NUMA node ", numa_node.value(), " is out of range"));
+    }
+    constexpr uint32_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+    std::array<unsigned long, MaxNumaNodes / bits_per_word> node_mask{};
+    node_mask[numa_node.value() / bits_per_word] |= 1UL << (numa_node.value() % bits_per_word);
+    // The kernel expects one more than the number of bits in the mask.
+    result = syscall(SYS_set_mempolicy, MPOL_PREFERRED, node_mask.data(), MaxNumaNodes + 1);
+  } else {
+    result = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+  }
+  if (result != 0) {
+    return absl::InternalError(absl::StrCat("Failed to set memory policy (errno ", errno, ")"));
+  }
+  return absl::OkStatus();
+#else
+  UNREFERENCED_PARAMETER(numa_node);
+  return absl::UnimplementedError("NUMA memory policies are only supported on Linux");
+#endif
+}
+
+ScopedNumaNodePreference::ScopedNumaNodePreference(std::optional<uint32_t> numa_node) {
+  if (!numa_node.has_value()) {
+    return;
+  }
+  const absl::Status status = ThreadPlacement::preferNumaNodeForCurrentThread(numa_node);
+  if (!status.ok()) {
+    ENVOY_LOG(warn, "Not preferring NUMA node {}: {}", numa_node.value(), status.message());
+    return;
+  }
+  active_ = true;
+}
+
+ScopedNumaNodePreference::~ScopedNumaNodePreference() {
+  if (active_) {
+    const absl::Status status = ThreadPlacement::preferNumaNodeForCurrentThread(std::nullopt);
+    if (!status.ok()) {
+      ENVOY_LOG(warn, "Failed to restore the default memory policy: {}", status.message());
+    }
+  }
+}
+
+} // namespace Nighthawk
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "external/envoy/source/common/common/logger.h"
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace Nighthawk {
+
+/**
+ * Helpers for placing threads, and the memory they allocate, on the CPUs and NUMA nodes of the
+ * machine. Placement is only supported on Linux. Elsewhere, the methods that change placement
+ * return an UnimplementedError, and NUMA nodes are never known.
+ */
+class ThreadPlacement {
+public:
+  // Upper bound (exclusive) on the CPU numbers and NUMA node numbers we handle.
+  static constexpr uint32_t MaxCpus = 1024;
+  static constexpr uint32_t MaxNumaNodes = 1024;
+
+  /**
+   * Parses a list of CPUs in the format used by taskset -c and sysfs, e.g. "0-3,8".
+   *
+   * @param cpu_list The list to parse.
+   * @return absl::StatusOr<std::vector<uint32_t>> The CPUs, in the order listed. An error if the
+   * list is empty or malformed, or if it holds a CPU beyond MaxCpus.
+   */
+  static absl::StatusOr<std::vector<uint32_t>> parseCpuList(absl::string_view cpu_list);
+
+  /**
+   * Pins the calling thread to a single CPU.
+   *
+   * @param cpu The CPU to pin to.
+   * @return absl::Status An error if the thread could not be pinned.
+   */
+  static absl::Status pinCurrentThread(uint32_t cpu);
+
+  /**
+   * @param cpu The CPU to look up.
+   * @return std::optional<uint32_t> The NUMA node the CPU belongs to, if it can be determined.
+   */
+  static std::optional<uint32_t> numaNodeOfCpu(uint32_t cpu);
+
+  /**
+   * Sets the memory policy of the calling thread.
+   *
+   * @param numa_node The NUMA node to preferably allocate memory on. When unset, the default
+   * policy of allocating on the node the thread runs on is restored.
+   * @return absl::Status An error if the policy could not be set.
+   */
+  static absl::Status preferNumaNodeForCurrentThread(std::optional<uint32_t> numa_node);
+};
+
+/**
+ * While in scope, memory allocated by the calling thread is preferably placed on a NUMA node.
+ * Failures are logged, as allocating elsewhere only affects performance.
+ */
+class ScopedNumaNodePreference : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param numa_node The NUMA node to prefer. When unset, this does nothing.
+   */
+  explicit ScopedNumaNodePreference(std::optional<uint32_t> numa_node);
+  ~ScopedNumaNodePreference();
+
+  ScopedNumaNodePreference(const ScopedNumaNodePreference&) = delete;
+  ScopedNumaNodePreference& operator=(const ScopedNumaNodePreference&) = delete;
+
+private:
+  bool active_{false};
+};
+
+} // namespace Nighthawk
@@ -17,22 +17,33 @@ namespace Nighthawk {
 std::map<std::string, uint64_t>
 Utility::mapCountersFromStore(const Envoy::Stats::Store& store,
                               const StoreCounterFilter& filter) const {
-  std::map<std::string, uint64_t> results;
+  return mapCountersFromStoreByWorker(store, filter).global;
+}
+
+CounterValuesByWorker
+Utility::mapCountersFromStoreByWorker(const Envoy::Stats::Store& store,
+                                      const StoreCounterFilter& filter) const {
+  CounterValuesByWorker results;
 
   for (const auto& stat : store.counters()) {
-    if (filter(stat->name(), stat->value())) {
-      std::string stat_name = stat->name();
+    const uint64_t value = stat->value();
+    std::string stat_name = stat->name();
+    if (filter(stat_name, value)) {
       // Strip off cluster.[x]. & worker.[x]. prefixes.
       std::vector<std::string> v = absl::StrSplit(stat_name, '.');
       if (v[0] == "cluster" || v[0] == "worker") {
         v.erase(v.begin());
       }
-      int tmp;
-      if (absl::SimpleAtoi(v[0], &tmp)) {
+      int worker_number;
+      const bool worker_scoped = absl::SimpleAtoi(v[0], &worker_number);
+      if (worker_scoped) {
         v.erase(v.begin());
       }
       stat_name = absl::StrJoin(v, ".");
-      results[stat_name] += stat->value();
+      results.global[stat_name] += value;
+      if (worker_scoped) {
+        results.per_worker[worker_number][stat_name] += value;
+      }
     }
   }
   return results;
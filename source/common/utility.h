@@ -18,6 +18,15 @@ namespace Nighthawk {
 
 using StoreCounterFilter = std::function<bool(absl::string_view, const uint64_t)>;
 
+/**
+ * Counter values keyed by name, both summed over all workers and split out per worker.
+ */
+struct CounterValuesByWorker {
+  std::map<std::string, uint64_t> global;
+  // Keyed by worker number. Only holds the counters that are scoped to a worker.
+  std::map<int, std::map<std::string, uint64_t>> per_worker;
+};
+
 class Utility {
 public:
   /**
@@ -31,6 +40,18 @@ public:
       const StoreCounterFilter& filter = [](absl::string_view, const uint64_t) {
         return true;
       }) const;
+  /**
+   * Like mapCountersFromStore(), but also splits out the counters scoped to each worker, in a
+   * single pass over the store.
+   * @param filter function that returns true iff a counter should be included, based on the name
+   * and value it gets passed. The default filter includes all counters.
+   * @return CounterValuesByWorker the global and per worker counter values.
+   */
+  CounterValuesByWorker mapCountersFromStoreByWorker(
+      const Envoy::Stats::Store& store,
+      const StoreCounterFilter& filter = [](absl::string_view, const uint64_t) {
+        return true;
+      }) const;
   /**
    * Finds the position of the port separator in the host:port fragment.
    *
@@ -3,12 +3,15 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "source/common/thread_placement.h"
+
 namespace Nighthawk {
 
 WorkerImpl::WorkerImpl(Envoy::Api::Api& api, Envoy::ThreadLocal::Instance& tls,
                        Envoy::Stats::Store& store)
     : thread_factory_(api.threadFactory()), dispatcher_(api.allocateDispatcher("worker_thread")),
-      tls_(tls), store_(store), time_source_(api.timeSource()) {
+      tls_(tls), store_(store), time_source_(api.timeSource()),
+      completed_(complete_.get_future().share()) {
   tls.registerThread(*dispatcher_, false);
 }
 
@@ -34,6 +37,7 @@ void WorkerImpl::start() {
   started_ = true;
   shutdown_ = false;
   thread_ = std::thread([this]() {
+    applyPlacement();
     dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
     work();
     complete_.set_value();
@@ -43,6 +47,33 @@ void WorkerImpl::start() {
   });
 }
 
-void WorkerImpl::waitForCompletion() { complete_.get_future().wait(); }
+void WorkerImpl::setPlacement(const WorkerPlacement& placement) {
+  RELEASE_ASSERT(!started_, "WorkerImpl::setPlacement() must be called before start()");
+  placement_ = placement;
+}
+
+void WorkerImpl::applyPlacement() {
+  if (!placement_.has_value()) {
+    return;
+  }
+  const absl::Status pin_status = ThreadPlacement::pinCurrentThread(placement_->cpu);
+  if (!pin_status.ok()) {
+    ENVOY_LOG(warn, "Worker thread not pinned: {}", pin_status.message());
+  }
+  if (placement_->numa_node.has_value()) {
+    const absl::Status numa_status =
+        ThreadPlacement::preferNumaNodeForCurrentThread(placement_->numa_node);
+    if (!numa_status.ok()) {
+      ENVOY_LOG(warn, "Worker thread memory not placed on NUMA node {}: {}",
+                placement_->numa_node.value(), numa_status.message());
+    }
+  }
+}
+
+void WorkerImpl::waitForCompletion() { completed_.wait(); }
+
+bool WorkerImpl::waitForCompletionFor(std::chrono::milliseconds timeout) {
+  return completed_.wait_for(timeout) == std::future_status::ready;
+}
 
 } // namespace Nighthawk
@@ -21,7 +21,9 @@ public:
   ~WorkerImpl() override;
 
   void start() override;
+  void setPlacement(const WorkerPlacement& placement) override;
   void waitForCompletion() override;
+  bool waitForCompletionFor(std::chrono::milliseconds timeout) override;
   void initiateShutdown() override;
   void shutdown() override;
 
@@ -38,9 +40,15 @@ protected:
   Envoy::TimeSource& time_source_;
 
 private:
+  // Applies placement_ to the calling thread.
+  void applyPlacement();
+
   std::thread thread_;
+  std::optional<WorkerPlacement> placement_;
   bool started_{};
   std::promise<void> complete_;
+  // Shared so that the completion can be waited for more than once.
+  const std::shared_future<void> completed_;
   std::promise<void> signal_thread_to_exit_;
   // Tracks whether signal_thread_to_exit_ has been fired, making initiateShutdown() idempotent
   // (std::promise::set_value() throws when called twice).
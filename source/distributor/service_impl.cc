@@ -2,10 +2,15 @@
 
 #include <grpc++/grpc++.h>
 
+#include <future>
+#include <vector>
+
 #include "envoy/config/core/v3/base.pb.h"
 
 #include "external/envoy/source/common/common/assert.h"
+#include "external/envoy/source/common/common/lock_guard.h"
 #include "external/envoy/source/common/protobuf/message_validator_impl.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
 #include "external/envoy/source/common/protobuf/utility.h"
 
 #include "api/distributor/distributor.pb.validate.h"
@@ -15,6 +20,10 @@
 namespace Nighthawk {
 namespace {
 
+using ::Envoy::Protobuf::util::TimeUtil;
+
+constexpr int64_t kDefaultSynchronizedStartDelayMs = 1000;
+
 grpc::Status validateRequest(const nighthawk::DistributedRequest& request) {
   Envoy::ProtobufMessage::ValidationVisitor& validation_visitor =
       Envoy::ProtobufMessage::getStrictValidationVisitor();
@@ -40,33 +49,62 @@ grpc::Status validateRequest(const nighthawk::DistributedRequest& request) {
 
 } // namespace
 
+std::shared_ptr<grpc::Channel> NighthawkDistributorServiceImpl::getOrCreateChannel(
+    const envoy::config::core::v3::Address& service) {
+  const std::string target = fmt::format("{}:{}", service.socket_address().address(),
+                                         service.socket_address().port_value());
+  Envoy::Thread::LockGuard lock_guard(channels_lock_);
+  std::shared_ptr<grpc::Channel>& channel = channels_[target];
+  if (channel == nullptr) {
+    channel = grpc::CreateChannel(target, grpc::InsecureChannelCredentials());
+  }
+  return channel;
+}
+
 absl::StatusOr<nighthawk::client::ExecutionResponse>
 NighthawkDistributorServiceImpl::handleExecutionRequest(
     const envoy::config::core::v3::Address& service,
-    const nighthawk::client::ExecutionRequest& request) const {
+    const nighthawk::client::CommandLineOptions& options) {
   RELEASE_ASSERT(service_client_ != nullptr, "service_client_ != nullptr");
-  std::shared_ptr<grpc::Channel> channel;
-  channel = grpc::CreateChannel(fmt::format("{}:{}", service.socket_address().address(),
-                                            service.socket_address().port_value()),
-                                grpc::InsecureChannelCredentials());
   std::unique_ptr<nighthawk::client::NighthawkService::Stub> stub =
-      std::make_unique<nighthawk::client::NighthawkService::Stub>(channel);
-  return service_client_->PerformNighthawkBenchmark(stub.get(), request.start_request().options());
+      std::make_unique<nighthawk::client::NighthawkService::Stub>(getOrCreateChannel(service));
+  return service_client_->PerformNighthawkBenchmark(stub.get(), options);
 }
 
 // Translates one or more backend response into a single reply message
 std::tuple<grpc::Status, nighthawk::DistributedResponse>
-NighthawkDistributorServiceImpl::handleRequest(const nighthawk::DistributedRequest& request) const {
+NighthawkDistributorServiceImpl::handleRequest(const nighthawk::DistributedRequest& request) {
   ENVOY_LOG(trace, "Handling execution request");
+  nighthawk::client::CommandLineOptions options =
+      request.execution_request().start_request().options();
+  if (request.services_size() > 1 && !options.has_scheduled_start()) {
+    // Stamp a shared start, so load generated by the services overlaps instead of trickling in as
+    // each of them gets around to it.
+    const Envoy::Protobuf::Duration start_delay =
+        request.has_synchronized_start_delay()
+            ? request.synchronized_start_delay()
+            : TimeUtil::MillisecondsToDuration(kDefaultSynchronizedStartDelayMs);
+    *options.mutable_scheduled_start() = TimeUtil::GetCurrentTime() + start_delay;
+    ENVOY_LOG(debug, "Scheduling a synchronized start for {} services at {}",
+              request.services_size(), TimeUtil::ToString(options.scheduled_start()));
+  }
+  // Fan out to all services at once. Each call blocks until its service finishes the execution.
+  std::vector<std::future<absl::StatusOr<nighthawk::client::ExecutionResponse>>> futures;
+  futures.reserve(request.services_size());
+  for (const envoy::config::core::v3::Address& service : request.services()) {
+    // We pass in std::launch::async to avoid lazy evaluation, so the executions run concurrently.
+    futures.push_back(std::async(std::launch::async,
+                                 &NighthawkDistributorServiceImpl::handleExecutionRequest, this,
+                                 std::cref(service), std::cref(options)));
+  }
   nighthawk::DistributedResponse response;
   bool has_errors = false;
-  for (const envoy::config::core::v3::Address& service : request.services()) {
-    absl::StatusOr<nighthawk::client::ExecutionResponse> execution_response =
-        handleExecutionRequest(service, request.execution_request());
+  for (int i = 0; i < request.services_size(); i++) {
+    absl::StatusOr<nighthawk::client::ExecutionResponse> execution_response = futures[i].get();
     nighthawk::DistributedServiceResponse* service_response = response.add_service_response();
-    service_response->mutable_service()->MergeFrom(service);
+    service_response->mutable_service()->MergeFrom(request.services(i));
     if (execution_response.ok()) {
-      *service_response->mutable_execution_response() = execution_response.value();
+      *service_response->mutable_execution_response() = *std::move(execution_response);
     } else {
       service_response->mutable_error()->set_code(
           static_cast<int>(execution_response.status().code()));
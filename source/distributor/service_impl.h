@@ -1,18 +1,26 @@
 #pragma once
 
+#include <memory>
+#include <string>
 #include <tuple>
 
 #include "nighthawk/common/nighthawk_service_client.h"
 
 #include "external/envoy/source/common/common/logger.h"
 #include "external/envoy/source/common/common/statusor.h"
+#include "external/envoy/source/common/common/thread.h"
 
 #include "api/distributor/distributor.grpc.pb.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Nighthawk {
 
 /**
- * Implements a real-world distributor gRPC service.
+ * Implements a real-world distributor gRPC service. An execution request is delegated to all
+ * services concurrently, and when there is more than one service they are handed a shared
+ * scheduled_start so that they begin generating load at the same instant. Channels to the services
+ * are cached and reused across requests.
  */
 class NighthawkDistributorServiceImpl final
     : public nighthawk::NighthawkDistributor::Service,
@@ -34,12 +42,18 @@ public:
 
 private:
   std::tuple<grpc::Status, nighthawk::DistributedResponse>
-  handleRequest(const nighthawk::DistributedRequest& request) const;
+  handleRequest(const nighthawk::DistributedRequest& request);
   absl::StatusOr<nighthawk::client::ExecutionResponse>
   handleExecutionRequest(const envoy::config::core::v3::Address& service,
-                         const nighthawk::client::ExecutionRequest& request) const;
+                         const nighthawk::client::CommandLineOptions& options);
+  std::shared_ptr<grpc::Channel>
+  getOrCreateChannel(const envoy::config::core::v3::Address& service);
 
   std::unique_ptr<NighthawkServiceClient> service_client_;
+  Envoy::Thread::MutexBasicLockable channels_lock_;
+  // Channels to the services, keyed by their target. Requests to the same service share a channel.
+  absl::flat_hash_map<std::string, std::shared_ptr<grpc::Channel>>
+      channels_ ABSL_GUARDED_BY(channels_lock_);
 };
 
 } // namespace Nighthawk
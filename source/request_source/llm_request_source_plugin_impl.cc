@@ -65,6 +65,17 @@ std::string GenerateRandomPrompt(int num_tokens) {
 
 } // namespace
 
+LlmRequestSourcePlugin::LlmRequestSourcePlugin(std::string model_name, int req_token_count,
+                                               int resp_max_tokens,
+                                               Envoy::Http::RequestHeaderMapPtr header)
+    : model_name_(model_name), req_token_count_(req_token_count),
+      resp_max_tokens_(resp_max_tokens), header_(std::move(header)) {
+  header_->setMethod(
+      envoy::config::core::v3::RequestMethod_Name(envoy::config::core::v3::RequestMethod::POST));
+  header_->setContentType("application/json");
+  header_->setPath("/v1/completions");
+}
+
 Nighthawk::RequestGenerator LlmRequestSourcePlugin::get() {
   return [this]() -> std::unique_ptr<Nighthawk::Request> {
     Envoy::Http::RequestHeaderMapPtr headers = Envoy::Http::RequestHeaderMapImpl::create();
@@ -85,15 +96,9 @@ Nighthawk::RequestGenerator LlmRequestSourcePlugin::get() {
     )json",
                         model_name_, resp_max_tokens_, GenerateRandomPrompt(req_token_count_));
 
-    headers->setMethod(
-        envoy::config::core::v3::RequestMethod_Name(envoy::config::core::v3::RequestMethod::POST));
-    headers->setContentType("application/json");
     headers->setContentLength(body.size());
 
-    auto path_key = Envoy::Http::LowerCaseString(":path");
-    headers->setCopy(path_key, "/v1/completions");
-
-    return std::make_unique<Nighthawk::RequestImpl>(std::move(headers), body);
+    return std::make_unique<Nighthawk::RequestImpl>(std::move(headers), std::move(body));
   };
 }
 
@@ -45,9 +45,7 @@ class LlmRequestSourcePlugin : public Nighthawk::RequestSource,
                                public Envoy::Logger::Loggable<Envoy::Logger::Id::http> {
 public:
   explicit LlmRequestSourcePlugin(std::string model_name, int req_token_count, int resp_max_tokens,
-                                  Envoy::Http::RequestHeaderMapPtr header)
-      : model_name_(model_name), req_token_count_(req_token_count),
-        resp_max_tokens_(resp_max_tokens), header_(std::move(header)) {};
+                                  Envoy::Http::RequestHeaderMapPtr header);
 
   Nighthawk::RequestGenerator get() override;
   void initOnThread() override {};
@@ -62,7 +60,8 @@ private:
   int resp_max_tokens_;
   // The options_list will be used to apply headers to the request.
   std::unique_ptr<const nighthawk::client::RequestOptionsList> options_list_;
-  // Headers for the request.
+  // Template for the request headers. Everything except the content length is identical across
+  // requests, and gets applied once at construction time.
   Envoy::Http::RequestHeaderMapPtr header_;
 };
 
@@ -0,0 +1,120 @@
+#include "source/request_source/mapped_trace_request_source_plugin_impl.h"
+
+#include <memory>
+
+#include "nighthawk/common/exception.h"
+
+#include "external/envoy/source/common/common/lock_guard.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+#include "external/envoy/source/common/protobuf/utility.h"
+
+#include "source/common/request_impl.h"
+#include "source/request_source/request_options_list_plugin_impl.h"
+
+namespace Nighthawk {
+
+std::string MappedTraceRequestSourceFactory::name() const {
+  return "nighthawk.mapped-trace-request-source-plugin";
+}
+
+Envoy::ProtobufTypes::MessagePtr MappedTraceRequestSourceFactory::createEmptyConfigProto() {
+  return std::make_unique<nighthawk::request_source::MappedTraceRequestSourceConfig>();
+}
+
+RequestSourcePtr MappedTraceRequestSourceFactory::createRequestSourcePlugin(
+    const Envoy::Protobuf::Message& message, Envoy::Api::Api& api,
+    Envoy::Http::RequestHeaderMapPtr header) {
+  return createRequestSourcePluginForWorker(message, api, std::move(header), {});
+}
+
+RequestSourcePtr MappedTraceRequestSourceFactory::createRequestSourcePluginForWorker(
+    const Envoy::Protobuf::Message& message, Envoy::Api::Api&,
+    Envoy::Http::RequestHeaderMapPtr header, const WorkerContext& worker_context) {
+  const auto* any = Envoy::Protobuf::DynamicCastToGenerated<const Envoy::Protobuf::Any>(&message);
+  nighthawk::request_source::MappedTraceRequestSourceConfig config;
+  THROW_IF_NOT_OK(Envoy::MessageUtil::unpackTo(*any, config));
+  MappedRequestTraceSharedPtr trace = mapTrace(config.file_path());
+  const uint64_t trace_records = trace->recordCount();
+  RequestTracePartition partition =
+      RequestTracePartition::create(config.partitioning(), trace_records, worker_context);
+  // A trace replay rate limiter releases nothing for an empty partition, so the records sent in
+  // that case only matter when the request source is used with another rate limiter.
+  if (partition.record_count == 0) {
+    partition = RequestTracePartition::contiguous(trace_records, WorkerContext{});
+  }
+  absl::StatusOr<RequestTraceCursor> cursor_or =
+      RequestTraceCursor::create(std::move(trace), partition);
+  if (!cursor_or.ok()) {
+    throw NighthawkException(std::string(cursor_or.status().message()));
+  }
+  return std::make_unique<MappedTraceRequestSource>(*std::move(cursor_or), std::move(header),
+                                                    config.num_requests());
+}
+
+MappedRequestTraceSharedPtr MappedTraceRequestSourceFactory::mapTrace(const std::string& path) {
+  Envoy::Thread::LockGuard lock_guard(traces_lock_);
+  std::weak_ptr<const MappedRequestTrace>& cached_trace = traces_[path];
+  MappedRequestTraceSharedPtr trace = cached_trace.lock();
+  if (trace == nullptr) {
+    absl::StatusOr<MappedRequestTraceSharedPtr> trace_or = MappedRequestTrace::open(path);
+    if (!trace_or.ok()) {
+      traces_.erase(path);
+      throw NighthawkException(std::string(trace_or.status().message()));
+    }
+    trace = *std::move(trace_or);
+    cached_trace = trace;
+  }
+  return trace;
+}
+
+REGISTER_FACTORY(MappedTraceRequestSourceFactory, RequestSourcePluginConfigFactory);
+
+MappedTraceRequestSource::MappedTraceRequestSource(RequestTraceCursor cursor,
+                                                   Envoy::Http::RequestHeaderMapPtr header,
+                                                   uint32_t total_requests)
+    : cursor_(std::move(cursor)), header_(std::move(header)), total_requests_(total_requests) {}
+
+RequestPtr MappedTraceRequestSource::decodeRecord(RequestTraceCursor& cursor) {
+  absl::StatusOr<RequestTraceRecord> record = cursor.next();
+  if (!record.ok()) {
+    ENVOY_LOG(error, "Failed to read request trace: {}", record.status().message());
+    return nullptr;
+  }
+  if (!request_options_.ParseFromArray(record->request_options.data(),
+                                       record->request_options.size())) {
+    ENVOY_LOG(error, "Failed to parse request trace record");
+    return nullptr;
+  }
+  HeaderMapPtr header = OptionsListRequestSource::materializeHeaders(*header_, request_options_);
+  if (request_options_.json_body().empty()) {
+    return std::make_unique<RequestImpl>(std::move(header));
+  }
+  return std::make_unique<RequestImpl>(
+      std::move(header), std::make_shared<const std::string>(request_options_.json_body()));
+}
+
+RequestGenerator MappedTraceRequestSource::get() {
+  RequestGenerator request_generator = [this, generated = uint64_t(0),
+                                        cursor = cursor_]() mutable -> RequestPtr {
+    // if total_requests_ is 0, then we never stop generating requests.
+    if (generated >= total_requests_ && total_requests_ != 0) {
+      return nullptr;
+    }
+    ++generated;
+    // if the trace is empty, we just return the default header.
+    if (cursor.partition().record_count == 0) {
+      return std::make_unique<RequestImpl>(header_);
+    }
+    // Wrap around to the start of the partition once all its records have been replayed.
+    if (cursor.done()) {
+      cursor.rewind();
+    }
+    return decodeRecord(cursor);
+  };
+  return request_generator;
+}
+
+void MappedTraceRequestSource::initOnThread() {}
+void MappedTraceRequestSource::destroyOnThread() {}
+
+} // namespace Nighthawk
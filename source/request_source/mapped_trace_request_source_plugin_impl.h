@@ -0,0 +1,113 @@
+#pragma once
+
+// Implementation of a RequestSourceConfigFactory that replays a memory-mapped request trace.
+
+#include "envoy/registry/registry.h"
+
+#include "nighthawk/request_source/request_source_plugin_config_factory.h"
+
+#include "external/envoy/source/common/common/logger.h"
+#include "external/envoy/source/common/common/thread.h"
+
+#include "api/client/options.pb.h"
+#include "api/request_source/request_source_plugin.pb.h"
+
+#include "source/common/request_trace.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Nighthawk {
+
+// Request Source that replays a partition of a memory-mapped request trace. The trace is shared
+// read-only between all request sources created from it, and records are decoded one at a time
+// as requests are generated, so memory usage does not grow with the size of the trace.
+// @param cursor Cursor over the partition of the trace to replay. Workers whose partition is
+// empty, which happens when the trace has fewer records than there are workers, should be handed
+// a cursor over the full trace.
+// @param header The default header that will be overridden by values taken from the trace
+// records, any values not overridden will be used.
+// @param total_requests The number of requests the requestGenerator produced by get() will
+// generate. 0 means it is unlimited. If total_requests exceeds the number of records in the
+// partition, it will loop.
+// This is not thread safe.
+class MappedTraceRequestSource : public RequestSource,
+                                 public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  MappedTraceRequestSource(RequestTraceCursor cursor, Envoy::Http::RequestHeaderMapPtr header,
+                           uint32_t total_requests);
+
+  RequestGenerator get() override;
+
+  // default implementation
+  void initOnThread() override;
+  void destroyOnThread() override;
+
+  /**
+   * @return uint64_t Number of the first record of the partition replayed by this source.
+   */
+  uint64_t firstRecord() const { return cursor_.partition().first_record; }
+
+  /**
+   * @return uint64_t Number of records in the partition replayed by this source.
+   */
+  uint64_t recordCount() const { return cursor_.partition().record_count; }
+
+  /**
+   * @return uint64_t Distance between two consecutive records of the partition replayed by this
+   * source.
+   */
+  uint64_t recordStride() const { return cursor_.partition().stride; }
+
+private:
+  // Decodes the next record of |cursor| into a request. Returns nullptr if the record is corrupt.
+  RequestPtr decodeRecord(RequestTraceCursor& cursor);
+
+  // Prototype cursor, positioned at the start of the partition. Each generator copies it.
+  const RequestTraceCursor cursor_;
+  const HeaderMapPtr header_;
+  const uint32_t total_requests_;
+  // Scratch message, reused for decoding each record.
+  nighthawk::client::RequestOptions request_options_;
+};
+
+// Factory that creates a MappedTraceRequestSource from a MappedTraceRequestSourceConfig proto.
+// Registered as an Envoy plugin. Traces are memory-mapped once per file, and the mapping is shared
+// by all request sources that are alive at the same time. Each request source replays the
+// partition of the trace that belongs to the worker it is created for, as selected by the
+// partitioning field of the configuration.
+// This class is thread-safe.
+// Usage: assume you are passed an appropriate Any type object called config, an Api
+// object called api, and a default header called header. auto& config_factory =
+//     Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+//         "nighthawk.mapped-trace-request-source-plugin");
+// RequestSourcePtr plugin = config_factory.createRequestSourcePluginForWorker(
+//     config, api, std::move(header), {worker_number, worker_count});
+class MappedTraceRequestSourceFactory : public virtual RequestSourcePluginConfigFactory {
+public:
+  std::string name() const override;
+  Envoy::ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  // Creates a request source that replays the full trace. This method will error if the trace can
+  // not be mapped, e.g. it could not be found or is not a valid trace.
+  RequestSourcePtr createRequestSourcePlugin(const Envoy::Protobuf::Message& message,
+                                             Envoy::Api::Api& api,
+                                             Envoy::Http::RequestHeaderMapPtr header) override;
+
+  // Creates a request source that replays the partition of the trace belonging to the worker.
+  RequestSourcePtr
+  createRequestSourcePluginForWorker(const Envoy::Protobuf::Message& message, Envoy::Api::Api& api,
+                                     Envoy::Http::RequestHeaderMapPtr header,
+                                     const WorkerContext& worker_context) override;
+
+private:
+  MappedRequestTraceSharedPtr mapTrace(const std::string& path);
+
+  Envoy::Thread::MutexBasicLockable traces_lock_;
+  absl::flat_hash_map<std::string, std::weak_ptr<const MappedRequestTrace>>
+      traces_ ABSL_GUARDED_BY(traces_lock_);
+};
+
+// This factory will be activated through RequestSourceFactory in factories.h
+DECLARE_FACTORY(MappedTraceRequestSourceFactory);
+
+} // namespace Nighthawk
@@ -73,54 +73,68 @@ OptionsListRequestSource::OptionsListRequestSource(
     const uint32_t total_requests, Envoy::Http::RequestHeaderMapPtr header,
     std::unique_ptr<const nighthawk::client::RequestOptionsList> options_list)
     : header_(std::move(header)), options_list_(std::move(options_list)),
-      total_requests_(total_requests) {}
+      total_requests_(total_requests) {
+  request_headers_.reserve(options_list_->options_size());
+  request_bodies_.reserve(options_list_->options_size());
+  for (const nighthawk::client::RequestOptions& request_option : options_list_->options()) {
+    request_headers_.push_back(materializeHeaders(*header_, request_option));
+    request_bodies_.push_back(
+        request_option.json_body().empty()
+            ? nullptr
+            : std::make_shared<const std::string>(request_option.json_body()));
+  }
+}
+
+HeaderMapPtr OptionsListRequestSource::materializeHeaders(
+    const Envoy::Http::RequestHeaderMap& base_header,
+    const nighthawk::client::RequestOptions& request_option) {
+  // Initialize the header with the values from the default header.
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  Envoy::Http::HeaderMapImpl::copyFrom(*header, base_header);
+
+  // Override the default values with the values from the request_option
+  header->setMethod(envoy::config::core::v3::RequestMethod_Name(request_option.request_method()));
+  uint32_t request_body_length = 0;
+  if (!request_option.json_body().empty()) {
+    request_body_length = request_option.json_body().size();
+  } else {
+    request_body_length = request_option.request_body_size().value();
+  }
+  const uint32_t content_length = request_body_length;
+
+  if (content_length > 0) {
+    header->setContentLength(
+        content_length); // Content length is used later in stream_decoder to populate the body
+  }
+  // If json_body is provided, we should set the ContentType as application/json.
+  if (!request_option.json_body().empty()) {
+    header->setContentType("application/json");
+  }
+  for (const envoy::config::core::v3::HeaderValueOption& option_header :
+       request_option.request_headers()) {
+    auto lower_case_key = Envoy::Http::LowerCaseString(std::string(option_header.header().key()));
+    header->setCopy(lower_case_key, std::string(option_header.header().value()));
+  }
+  return header;
+}
 
 RequestGenerator OptionsListRequestSource::get() {
   request_count_.push_back(0);
   uint32_t& lambda_counter = request_count_.back();
   RequestGenerator request_generator = [this, lambda_counter]() mutable -> RequestPtr {
-    // Initialize the header with the values from the default header.
-    Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
-    Envoy::Http::HeaderMapImpl::copyFrom(*header, *header_);
-
     // if request_max is 0, then we never stop generating requests.
     if (lambda_counter >= total_requests_ && total_requests_ != 0) {
       return nullptr;
     }
     // if the options_list_ is empty, we just return the default header.
-    if (options_list_->options_size() == 0) {
-      return std::make_unique<RequestImpl>(std::move(header));
+    if (request_headers_.empty()) {
+      return std::make_unique<RequestImpl>(header_);
     }
 
-    // Increment the counter and get the request_option from the list for the current iteration.
-    const uint32_t index = lambda_counter % options_list_->options_size();
-    nighthawk::client::RequestOptions request_option = options_list_->options().at(index);
+    // Increment the counter and hand out the materialized request for the current iteration.
+    const uint32_t index = lambda_counter % request_headers_.size();
     ++lambda_counter;
-
-    // Override the default values with the values from the request_option
-    header->setMethod(envoy::config::core::v3::RequestMethod_Name(request_option.request_method()));
-    uint32_t request_body_length = 0;
-    if (!request_option.json_body().empty()) {
-      request_body_length = request_option.json_body().size();
-    } else {
-      request_body_length = request_option.request_body_size().value();
-    }
-    const uint32_t content_length = request_body_length;
-
-    if (content_length > 0) {
-      header->setContentLength(
-          content_length); // Content length is used later in stream_decoder to populate the body
-    }
-    // If json_body is provided, we should set the ContentType as application/json.
-    if (!request_option.json_body().empty()) {
-      header->setContentType("application/json");
-    }
-    for (const envoy::config::core::v3::HeaderValueOption& option_header :
-         request_option.request_headers()) {
-      auto lower_case_key = Envoy::Http::LowerCaseString(std::string(option_header.header().key()));
-      header->setCopy(lower_case_key, std::string(option_header.header().value()));
-    }
-    return std::make_unique<RequestImpl>(std::move(header), request_option.json_body());
+    return std::make_unique<RequestImpl>(request_headers_[index], request_bodies_[index]);
   };
   return request_generator;
 }
@@ -26,7 +26,9 @@ namespace Nighthawk {
 // source. The RequestGenerator produced by get() will use options from the options_list to
 // overwrite values in the default header, and create new requests. if total_requests is greater
 // than the length of options_list, it will loop. If the options_list_ is empty, we just return the
-// default header. This is not thread safe.
+// default header. Each entry of the options_list is materialized into an immutable header map and
+// body at construction time, which get shared by all requests generated from that entry. This is
+// not thread safe.
 class OptionsListRequestSource : public RequestSource {
 public:
   OptionsListRequestSource(
@@ -41,9 +43,19 @@ public:
   void initOnThread() override;
   void destroyOnThread() override;
 
+  // Builds the immutable header map for a single request_option, by applying its overrides to
+  // base_header.
+  static HeaderMapPtr materializeHeaders(const Envoy::Http::RequestHeaderMap& base_header,
+                                         const nighthawk::client::RequestOptions& request_option);
+
 private:
-  Envoy::Http::RequestHeaderMapPtr header_;
+
+  const HeaderMapPtr header_;
   std::unique_ptr<const nighthawk::client::RequestOptionsList> options_list_;
+  // Request headers and bodies, materialized once per entry in options_list_ and shared by all
+  // requests that are generated from that entry. Entries without a json_body hold a nullptr body.
+  std::vector<HeaderMapPtr> request_headers_;
+  std::vector<RequestBodySharedPtr> request_bodies_;
   std::vector<uint32_t> request_count_;
   const uint32_t total_requests_;
 };
@@ -47,13 +47,17 @@ grpc::Status SinkServiceImpl::SinkRequestStream(
   RELEASE_ASSERT(stream != nullptr, "stream == nullptr");
   while (stream->Read(&request)) {
     ENVOY_LOG(trace, "Inbound SinkRequest {}", absl::StrCat(request));
-    absl::StatusOr<std::vector<nighthawk::client::ExecutionResponse>> execution_responses =
-        sink_->LoadExecutionResult(request.execution_id());
-    if (!execution_responses.status().ok()) {
-      return abslStatusToGrpcStatus(execution_responses.status());
+    // Fold the stored pieces into the aggregate one at a time, so they need not all be held in
+    // memory at once.
+    ExecutionResponseMerger merger(request.execution_id());
+    const absl::Status visit_status = sink_->VisitExecutionResult(
+        request.execution_id(), [&merger](const nighthawk::client::ExecutionResponse& piece) {
+          return merger.addResponse(piece);
+        });
+    if (!visit_status.ok()) {
+      return abslStatusToGrpcStatus(visit_status);
     }
-    absl::StatusOr<nighthawk::client::ExecutionResponse> response =
-        mergeExecutionResponses(request.execution_id(), *execution_responses);
+    absl::StatusOr<nighthawk::client::ExecutionResponse> response = merger.toProto();
     if (!response.status().ok()) {
       return abslStatusToGrpcStatus(response.status());
     }
@@ -68,7 +72,7 @@ grpc::Status SinkServiceImpl::SinkRequestStream(
 }
 
 absl::Status mergeOutput(const nighthawk::client::Output& input_to_merge,
-                         nighthawk::client::Output& merge_target) {
+                         nighthawk::client::Output& merge_target, ResultMerger& global_result) {
   if (!merge_target.has_options()) {
     // If no options are set, that means this is the first part of the merge.
     // Set some properties that shouldbe equal amongst all Output instances.
@@ -96,41 +100,86 @@ absl::Status mergeOutput(const nighthawk::client::Output& input_to_merge,
   for (const nighthawk::client::Result& result : input_to_merge.results()) {
     merge_target.add_results()->MergeFrom(result);
   }
+  // The global result of an output already aggregates its per-worker results, so merging it
+  // alone avoids counting the same requests twice.
+  for (const nighthawk::client::Result& result : input_to_merge.results()) {
+    if (result.name() == "global") {
+      return global_result.addResult(result);
+    }
+  }
+  for (const nighthawk::client::Result& result : input_to_merge.results()) {
+    absl::Status status = global_result.addResult(result);
+    if (!status.ok()) {
+      return status;
+    }
+  }
   return absl::OkStatus();
 }
 
-absl::StatusOr<nighthawk::client::ExecutionResponse>
-mergeExecutionResponses(const std::string& requested_execution_id,
-                        const std::vector<nighthawk::client::ExecutionResponse>& responses) {
-  if (responses.size() == 0) {
+ExecutionResponseMerger::ExecutionResponseMerger(std::string execution_id)
+    : execution_id_(std::move(execution_id)) {
+  aggregated_response_.set_execution_id(execution_id_);
+}
+
+absl::Status
+ExecutionResponseMerger::addResponse(const nighthawk::client::ExecutionResponse& response) {
+  if (response.execution_id() != execution_id_) {
+    return absl::Status(absl::StatusCode::kInternal,
+                        fmt::format("Expected execution_id '{}' got '{}'", execution_id_,
+                                    response.execution_id()));
+  }
+  // If any error exists, set an error code and message & append the details of each such
+  // occurrence.
+  if (response.has_error_detail()) {
+    ::google::rpc::Status* error_detail = aggregated_response_.mutable_error_detail();
+    error_detail->set_code(-1);
+    error_detail->set_message("One or more remote execution(s) terminated with a failure.");
+    std::ignore = error_detail->add_details()->PackFrom(response.error_detail());
+  }
+  absl::Status merge_status =
+      mergeOutput(response.output(), *aggregated_response_.mutable_output(), global_result_);
+  if (merge_status.code() == absl::StatusCode::kFailedPrecondition) {
+    // The results are still appended as they are, only the exact global result is left out.
+    if (merge_global_result_) {
+      ENVOY_LOG(warn, "Execution '{}' is not merged into a global result: {}", execution_id_,
+                merge_status.message());
+    }
+    merge_global_result_ = false;
+  } else if (!merge_status.ok()) {
+    return merge_status;
+  }
+  response_count_++;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<nighthawk::client::ExecutionResponse> ExecutionResponseMerger::toProto() const {
+  if (response_count_ == 0) {
     return absl::Status(absl::StatusCode::kNotFound, "No results");
   }
+  nighthawk::client::ExecutionResponse response = aggregated_response_;
+  if (merge_global_result_ && global_result_.resultCount() > 0) {
+    // Goes in front of the appended results, so that it is the first one named "global".
+    Envoy::Protobuf::RepeatedPtrField<nighthawk::client::Result>* results =
+        response.mutable_output()->mutable_results();
+    *results->Add() = global_result_.toProto();
+    for (int i = results->size() - 1; i > 0; i--) {
+      results->SwapElements(i, i - 1);
+    }
+  }
+  return response;
+}
 
-  nighthawk::client::ExecutionResponse aggregated_response;
-  nighthawk::client::Output aggregated_output;
-  aggregated_response.set_execution_id(requested_execution_id);
+absl::StatusOr<nighthawk::client::ExecutionResponse>
+mergeExecutionResponses(const std::string& requested_execution_id,
+                        const std::vector<nighthawk::client::ExecutionResponse>& responses) {
+  ExecutionResponseMerger merger(requested_execution_id);
   for (const nighthawk::client::ExecutionResponse& execution_response : responses) {
-    if (execution_response.execution_id() != requested_execution_id) {
-      return absl::Status(absl::StatusCode::kInternal,
-                          fmt::format("Expected execution_id '{}' got '{}'", requested_execution_id,
-                                      execution_response.execution_id()));
-    }
-    // If any error exists, set an error code and message & append the details of each such
-    // occurrence.
-    if (execution_response.has_error_detail()) {
-      ::google::rpc::Status* error_detail = aggregated_response.mutable_error_detail();
-      error_detail->set_code(-1);
-      error_detail->set_message("One or more remote execution(s) terminated with a failure.");
-      std::ignore = error_detail->add_details()->PackFrom(execution_response.error_detail());
-    }
-    absl::Status merge_status = mergeOutput(execution_response.output(), aggregated_output);
+    absl::Status merge_status = merger.addResponse(execution_response);
     if (!merge_status.ok()) {
       return merge_status;
     }
   }
-
-  *(aggregated_response.mutable_output()) = aggregated_output;
-  return aggregated_response;
+  return merger.toProto();
 }
 
 } // namespace Nighthawk
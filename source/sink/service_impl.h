@@ -10,13 +10,56 @@
 #endif
 
 #include <memory>
+#include <string>
 
 #include "external/envoy/source/common/common/logger.h"
 
 #include "nighthawk/sink/sink.h"
 
+#include "source/common/result_merger.h"
+
 namespace Nighthawk {
 
+/**
+ * Incrementally merges the ExecutionResponse messages associated to an execution into a single
+ * ExecutionResponse. The results of the outputs are appended, error details are collected, and the
+ * results are also merged exactly into a cluster-wide "global" result (see ResultMerger), which
+ * precedes the appended results. When a statistic can not be merged exactly because it carries no
+ * native encoding, the cluster-wide result is left out.
+ *
+ * This is not thread safe.
+ */
+class ExecutionResponseMerger : public Envoy::Logger::Loggable<Envoy::Logger::Id::main> {
+public:
+  /**
+   * @param execution_id The execution-id that the responses to merge must be associated to.
+   */
+  explicit ExecutionResponseMerger(std::string execution_id);
+
+  /**
+   * Merges a response into the aggregate.
+   *
+   * @param response The response to merge.
+   * @return absl::Status Should be checked before proceeding to merge further responses.
+   */
+  absl::Status addResponse(const nighthawk::client::ExecutionResponse& response);
+
+  /**
+   * @return absl::StatusOr<nighthawk::client::ExecutionResponse> The merged response, or status
+   * kNotFound when no responses were merged.
+   */
+  absl::StatusOr<nighthawk::client::ExecutionResponse> toProto() const;
+
+private:
+  const std::string execution_id_;
+  uint64_t response_count_{0};
+  // Holds the merged error details, and the output with the appended results.
+  nighthawk::client::ExecutionResponse aggregated_response_;
+  ResultMerger global_result_{"global"};
+  // Cleared once a result could not be merged exactly into global_result_.
+  bool merge_global_result_{true};
+};
+
 /**
  * Transform a vector of ExecutionResponse messages into a single ExecutionResponse, by merging
  * associated outputs and error details.
@@ -31,14 +74,20 @@ mergeExecutionResponses(const std::string& execution_id,
                         const std::vector<nighthawk::client::ExecutionResponse>& responses);
 
 /**
- * Merge one output into another.
+ * Merge one output into another. The options, timestamp and version of the outputs must match.
+ * The results of the source output are appended to those of the target. The global result of the
+ * source output, or all its results if it has no global result, are also merged into
+ * global_result.
  *
  * @param source The source Output that should be merged into target.
  * @param target The target of the merge.
- * @return absl::Status Should be checked before proceeding to use target.
+ * @param global_result Aggregate that the results of source are merged into.
+ * @return absl::Status Should be checked before proceeding to use target. Status
+ * kFailedPrecondition indicates that the results were appended to target, but could not be merged
+ * into global_result (see ResultMerger::addResult()).
  */
-absl::Status mergeOutput(const nighthawk::client::Output& source,
-                         nighthawk::client::Output& target);
+absl::Status mergeOutput(const nighthawk::client::Output& source, nighthawk::client::Output& target,
+                         ResultMerger& global_result);
 
 /**
  * Obtain a grpc::Status based on an absl::Status
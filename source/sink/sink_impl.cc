@@ -90,20 +90,36 @@ FileSinkImpl::StoreExecutionResultPiece(const nighthawk::client::ExecutionRespon
 
 absl::StatusOr<std::vector<nighthawk::client::ExecutionResponse>>
 FileSinkImpl::LoadExecutionResult(absl::string_view execution_id) const {
+  std::vector<nighthawk::client::ExecutionResponse> responses;
+  absl::Status status = VisitExecutionResult(
+      execution_id, [&responses](const nighthawk::client::ExecutionResponse& response) {
+        responses.push_back(response);
+        return absl::OkStatus();
+      });
+  if (!status.ok()) {
+    return status;
+  }
+  return responses;
+}
+
+absl::Status FileSinkImpl::VisitExecutionResult(
+    absl::string_view execution_id,
+    const std::function<absl::Status(const nighthawk::client::ExecutionResponse&)>& visitor)
+    const {
   absl::Status status = validateKey(execution_id, true);
   if (!status.ok()) {
     return status;
   }
   std::filesystem::path filesystem_directory_path("/tmp/nh/" + std::string(execution_id) + "/");
-  std::vector<nighthawk::client::ExecutionResponse> responses;
   std::error_code error_code;
+  // Reused for parsing each fragment, so only a single one is held in memory at a time.
+  nighthawk::client::ExecutionResponse response;
 
   for (const auto& it :
        std::filesystem::directory_iterator(filesystem_directory_path, error_code)) {
     if (error_code.value()) {
       break;
     }
-    nighthawk::client::ExecutionResponse response;
     std::ifstream ifs(it.path(), std::ios_base::binary);
     if (!response.ParseFromIstream(&ifs)) {
       return absl::InternalError(
@@ -111,12 +127,15 @@ FileSinkImpl::LoadExecutionResult(absl::string_view execution_id) const {
     } else {
       ENVOY_LOG_MISC(trace, "Loaded '{}'.", std::string(it.path()));
     }
-    responses.push_back(response);
+    status = visitor(response);
+    if (!status.ok()) {
+      return status;
+    }
   }
   if (error_code.value()) {
     return absl::NotFoundError(error_code.message());
   }
-  return responses;
+  return absl::OkStatus();
 }
 
 absl::Status
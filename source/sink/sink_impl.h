@@ -8,7 +8,7 @@ namespace Nighthawk {
 
 /**
  * Filesystem based implementation of Sink. Uses /tmp/nh/{execution_id}/ to store and load
- * data.
+ * data. Visiting an execution result parses one stored fragment at a time.
  */
 class FileSinkImpl : public Sink {
 public:
@@ -16,6 +16,10 @@ public:
   StoreExecutionResultPiece(const nighthawk::client::ExecutionResponse& response) override;
   absl::StatusOr<std::vector<nighthawk::client::ExecutionResponse>>
   LoadExecutionResult(absl::string_view id) const override;
+  absl::Status VisitExecutionResult(
+      absl::string_view id,
+      const std::function<absl::Status(const nighthawk::client::ExecutionResponse&)>& visitor)
+      const override;
 };
 
 /**
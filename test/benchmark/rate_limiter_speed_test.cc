@@ -0,0 +1,172 @@
+// Measures the cost of RateLimiter::tryAcquireOne() for each of the rate limiter implementations.
+// The sequencer calls it at least once per started request, and on each idle wake up.
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+
+#include "external/envoy/source/common/common/assert.h"
+
+#include "source/common/rate_limiter_impl.h"
+#include "source/common/request_trace.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+using namespace std::chrono_literals;
+
+// Time source that advances a fixed step each time the monotonic time is sampled, so that the rate
+// limiters under test keep releasing acquisitions without the benchmark having to sleep.
+class SteppingTimeSource : public Envoy::TimeSource {
+public:
+  explicit SteppingTimeSource(std::chrono::nanoseconds step) : step_(step) {}
+  Envoy::SystemTime systemTime() override {
+    return Envoy::SystemTime(std::chrono::duration_cast<Envoy::SystemTime::duration>(now_));
+  }
+  Envoy::MonotonicTime monotonicTime() override {
+    now_ += step_;
+    return Envoy::MonotonicTime(now_);
+  }
+
+private:
+  const std::chrono::nanoseconds step_;
+  std::chrono::nanoseconds now_{1s};
+};
+
+// Uniform distribution over the range GraduallyOpeningRateLimiterFilter requires.
+class UniformPerMillionSampler : public DiscreteNumericDistributionSampler {
+public:
+  uint64_t getValue() override { return inner_.getValue() + 1; }
+  uint64_t min() const override { return 1; }
+  uint64_t max() const override { return 1000000; }
+
+private:
+  UniformRandomDistributionSamplerImpl inner_{999999};
+};
+
+// With a step of 1us and a frequency of 500kHz, about every other call acquires.
+constexpr std::chrono::nanoseconds kTimeStep = 1us;
+constexpr Frequency kFrequency = Frequency(500000);
+
+void acquireInLoop(benchmark::State& state, RateLimiter& rate_limiter) {
+  uint64_t acquired = 0;
+  for (auto _ : state) { // NOLINT
+    if (rate_limiter.tryAcquireOne()) {
+      acquired++;
+    }
+  }
+  state.counters["acquired_per_call"] =
+      benchmark::Counter(acquired, benchmark::Counter::kAvgIterations);
+}
+
+void bmLinearRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  LinearRateLimiter rate_limiter(time_source, kFrequency);
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmLinearRateLimiter);
+
+void bmLinearRampingRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  // A ramp that doesn't end within the benchmark, to measure the ramping computations.
+  LinearRampingRateLimiterImpl rate_limiter(time_source, 1000s, kFrequency);
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmLinearRampingRateLimiter);
+
+void bmBurstingRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  BurstingRateLimiter rate_limiter(std::make_unique<LinearRateLimiter>(time_source, kFrequency),
+                                   /*burst_size=*/16);
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmBurstingRateLimiter);
+
+void bmScheduledStartingRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  const Envoy::MonotonicTime start = time_source.monotonicTime() + 1ms;
+  ScheduledStartingRateLimiter rate_limiter(
+      std::make_unique<LinearRateLimiter>(time_source, kFrequency), start);
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmScheduledStartingRateLimiter);
+
+void bmDistributionSamplingRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  DistributionSamplingRateLimiterImpl rate_limiter(
+      std::make_unique<UniformRandomDistributionSamplerImpl>(/*upper_bound=*/1000),
+      std::make_unique<LinearRateLimiter>(time_source, kFrequency));
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmDistributionSamplingRateLimiter);
+
+void bmGraduallyOpeningRateLimiterFilter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  GraduallyOpeningRateLimiterFilter rate_limiter(
+      1000s, std::make_unique<UniformPerMillionSampler>(),
+      std::make_unique<LinearRateLimiter>(time_source, kFrequency));
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmGraduallyOpeningRateLimiterFilter);
+
+void bmZipfRateLimiter(benchmark::State& state) {
+  SteppingTimeSource time_source(kTimeStep);
+  ZipfRateLimiterImpl rate_limiter(std::make_unique<LinearRateLimiter>(time_source, kFrequency));
+  acquireInLoop(state, rate_limiter);
+}
+BENCHMARK(bmZipfRateLimiter);
+
+// Writes a trace of records that are 2us apart, so that about every other call acquires.
+MappedRequestTraceSharedPtr writeTrace(uint32_t record_count) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "rate_limiter_speed_test.nhtrace").string();
+  {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    RequestTraceWriter writer(output);
+    const nighthawk::client::RequestOptions request_options;
+    for (uint32_t i = 0; i < record_count; i++) {
+      RELEASE_ASSERT(writer.addRecord(request_options, i * 2 * kTimeStep).ok(),
+                     "failed to write trace");
+    }
+    RELEASE_ASSERT(writer.finish().ok(), "failed to write trace");
+  }
+  absl::StatusOr<MappedRequestTraceSharedPtr> trace = MappedRequestTrace::open(path);
+  RELEASE_ASSERT(trace.ok(), std::string(trace.status().message()));
+  std::filesystem::remove(path);
+  return *trace;
+}
+
+void bmTraceReplayRateLimiter(benchmark::State& state) {
+  const MappedRequestTraceSharedPtr trace = writeTrace(1 << 16);
+  const RequestTracePartition partition{0, 1, trace->recordCount()};
+  SteppingTimeSource time_source(kTimeStep);
+  auto create_rate_limiter = [&]() {
+    absl::StatusOr<RequestTraceCursor> cursor = RequestTraceCursor::create(trace, partition);
+    RELEASE_ASSERT(cursor.ok(), std::string(cursor.status().message()));
+    return std::make_unique<TraceReplayRateLimiterImpl>(time_source, *std::move(cursor), 1.0);
+  };
+  std::unique_ptr<TraceReplayRateLimiterImpl> rate_limiter = create_rate_limiter();
+  uint64_t acquired = 0;
+  for (auto _ : state) { // NOLINT
+    if (rate_limiter->tryAcquireOne()) {
+      acquired++;
+    } else if (rate_limiter->nextReleaseTime() == std::nullopt) {
+      // The trace has been replayed, start over.
+      state.PauseTiming();
+      rate_limiter = create_rate_limiter();
+      state.ResumeTiming();
+    }
+  }
+  state.counters["acquired_per_call"] =
+      benchmark::Counter(acquired, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(bmTraceReplayRateLimiter);
+
+} // namespace
+} // namespace Nighthawk
@@ -0,0 +1,127 @@
+// Measures RequestGenerator throughput of the in-process request sources. The remote (gRPC)
+// request source is not covered here, as it needs a request source service to pull from.
+
+#include <filesystem>
+#include <fstream>
+
+#include "external/envoy/source/common/common/assert.h"
+#include "external/envoy/source/common/http/header_map_impl.h"
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "api/client/options.pb.h"
+
+#include "source/common/request_source_impl.h"
+#include "source/common/request_trace.h"
+#include "source/request_source/llm_request_source_plugin_impl.h"
+#include "source/request_source/mapped_trace_request_source_plugin_impl.h"
+#include "source/request_source/request_options_list_plugin_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+Envoy::Http::RequestHeaderMapPtr makeDefaultHeader() {
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  header->setMethod("GET");
+  header->setPath("/");
+  header->setHost("127.0.0.1");
+  header->setScheme("http");
+  return header;
+}
+
+void drainGenerator(benchmark::State& state, RequestSource& request_source) {
+  RequestGenerator generator = request_source.get();
+  for (auto _ : state) { // NOLINT
+    RequestPtr request = generator();
+    benchmark::DoNotOptimize(request);
+  }
+}
+
+void bmStaticRequestSource(benchmark::State& state) {
+  StaticRequestSourceImpl request_source(makeDefaultHeader());
+  drainGenerator(state, request_source);
+}
+BENCHMARK(bmStaticRequestSource);
+
+// The argument specifies the number of header overrides that each of the options carries.
+void bmOptionsListRequestSource(benchmark::State& state) {
+  auto options_list = std::make_unique<nighthawk::client::RequestOptionsList>();
+  for (int i = 0; i < 8; i++) {
+    nighthawk::client::RequestOptions* request_options = options_list->add_options();
+    request_options->set_request_method(envoy::config::core::v3::RequestMethod::POST);
+    request_options->set_json_body(absl::StrCat(R"({"message": ")", i, R"("})"));
+    for (int j = 0; j < state.range(0); j++) {
+      envoy::config::core::v3::HeaderValue* header =
+          request_options->add_request_headers()->mutable_header();
+      header->set_key(absl::StrCat("x-override-", j));
+      header->set_value(absl::StrCat("value-", i));
+    }
+  }
+  OptionsListRequestSource request_source(/*total_requests=*/0, makeDefaultHeader(),
+                                          std::move(options_list));
+  drainGenerator(state, request_source);
+}
+BENCHMARK(bmOptionsListRequestSource)->Arg(0)->Arg(8)->Arg(32);
+
+void bmLlmRequestSource(benchmark::State& state) {
+  LlmRequestSourcePlugin request_source("model", /*req_token_count=*/state.range(0),
+                                        /*resp_max_tokens=*/100, makeDefaultHeader());
+  drainGenerator(state, request_source);
+}
+BENCHMARK(bmLlmRequestSource)->Arg(10)->Arg(1000);
+
+// The argument specifies the number of header overrides that each record of the trace carries.
+void bmMappedTraceRequestSource(benchmark::State& state) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "request_source_speed_test.nhtrace").string();
+  {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    RequestTraceWriter writer(output);
+    for (int i = 0; i < 1024; i++) {
+      nighthawk::client::RequestOptions request_options;
+      request_options.set_request_method(envoy::config::core::v3::RequestMethod::POST);
+      request_options.set_json_body(absl::StrCat(R"({"message": ")", i, R"("})"));
+      for (int j = 0; j < state.range(0); j++) {
+        envoy::config::core::v3::HeaderValue* header =
+            request_options.add_request_headers()->mutable_header();
+        header->set_key(absl::StrCat("x-override-", j));
+        header->set_value(absl::StrCat("value-", i));
+      }
+      RELEASE_ASSERT(writer.addRecord(request_options).ok(), "failed to write trace");
+    }
+    RELEASE_ASSERT(writer.finish().ok(), "failed to write trace");
+  }
+  absl::StatusOr<MappedRequestTraceSharedPtr> trace = MappedRequestTrace::open(path);
+  RELEASE_ASSERT(trace.ok(), std::string(trace.status().message()));
+  std::filesystem::remove(path);
+  absl::StatusOr<RequestTraceCursor> cursor =
+      RequestTraceCursor::create(*trace, RequestTracePartition{0, 1, (*trace)->recordCount()});
+  RELEASE_ASSERT(cursor.ok(), std::string(cursor.status().message()));
+  MappedTraceRequestSource request_source(*std::move(cursor), makeDefaultHeader(),
+                                          /*total_requests=*/0);
+  drainGenerator(state, request_source);
+}
+BENCHMARK(bmMappedTraceRequestSource)->Arg(0)->Arg(8);
+
+// Measures popping from the ring of a shared request source, which a producer thread keeps topped
+// up from a static request source. Pops that find the ring empty are reported as starved.
+void bmSharedRequestSourceConsumer(benchmark::State& state) {
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest();
+  Envoy::Stats::IsolatedStoreImpl store;
+  auto shared_source = std::make_shared<SharedRequestSourceImpl>(
+      std::make_unique<StaticRequestSourceImpl>(makeDefaultHeader()), /*capacity=*/1024,
+      SharedRequestSourceImpl::ProducerMode::Thread, api->threadFactory());
+  RequestSourcePtr consumer = shared_source->createConsumer(*store.rootScope());
+  consumer->initOnThread();
+  drainGenerator(state, *consumer);
+  state.counters["starved"] =
+      store.rootScope()->counterFromString("shared_request_source_starved").value();
+  consumer->destroyOnThread();
+}
+BENCHMARK(bmSharedRequestSourceConsumer);
+
+} // namespace
+} // namespace Nighthawk
@@ -0,0 +1,119 @@
+// Measures the overhead SequencerImpl adds per target call: acquiring from the rate limiter,
+// starting the target, and recording the latencies when the target completes. The rate limiter
+// and the target are stand-ins that cost next to nothing.
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "external/envoy/source/common/event/dispatcher_impl.h"
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "source/common/platform_util_impl.h"
+#include "source/common/rate_limiter_impl.h"
+#include "source/common/sequencer_impl.h"
+#include "source/common/statistic_impl.h"
+#include "source/common/termination_predicate_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+// Releases a fixed number of acquisitions right away, and nothing after that.
+class BudgetRateLimiter : public RateLimiterBaseImpl {
+public:
+  BudgetRateLimiter(Envoy::TimeSource& time_source, uint64_t budget)
+      : RateLimiterBaseImpl(time_source), budget_(budget) {}
+  bool tryAcquireOne() override { return tryAcquire(1) == 1; }
+  uint64_t tryAcquire(uint64_t max_count) override {
+    elapsed();
+    const uint64_t count = std::min(max_count, budget_);
+    budget_ -= count;
+    return count;
+  }
+  void releaseOne() override { budget_++; }
+  std::optional<Envoy::MonotonicTime> nextReleaseTime() const override { return std::nullopt; }
+
+private:
+  uint64_t budget_;
+};
+
+// Terminates once a number of target calls has completed.
+class CompletionCountTerminationPredicate : public TerminationPredicateBaseImpl {
+public:
+  CompletionCountTerminationPredicate(const uint64_t& completed, uint64_t limit)
+      : completed_(completed), limit_(limit) {}
+  TerminationPredicate::Status evaluate() override {
+    return completed_ >= limit_ ? TerminationPredicate::Status::TERMINATE
+                                : TerminationPredicate::Status::PROCEED;
+  }
+
+private:
+  const uint64_t& completed_;
+  const uint64_t limit_;
+};
+
+// Target that completes the calls started during a dispatcher loop iteration on the next
+// iteration, like responses arriving for a batch of requests.
+class BatchCompletingTarget {
+public:
+  explicit BatchCompletingTarget(Envoy::Event::Dispatcher& dispatcher)
+      : complete_callback_(dispatcher.createSchedulableCallback([this]() { completeAll(); })) {}
+
+  bool start(OperationCallback callback) {
+    pending_.push_back(std::move(callback));
+    complete_callback_->scheduleCallbackNextIteration();
+    return true;
+  }
+
+  const uint64_t& completed() const { return completed_; }
+
+private:
+  void completeAll() {
+    std::vector<OperationCallback> pending;
+    pending.swap(pending_);
+    for (OperationCallback& callback : pending) {
+      completed_++;
+      callback(true, true);
+    }
+  }
+
+  Envoy::Event::SchedulableCallbackPtr complete_callback_;
+  std::vector<OperationCallback> pending_;
+  uint64_t completed_{0};
+};
+
+// The argument specifies the number of target calls per sequencer run.
+void bmSequencerRun(benchmark::State& state) {
+  const uint64_t target_calls = state.range(0);
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest();
+  Envoy::Event::DispatcherPtr dispatcher = api->allocateDispatcher("bench");
+  Envoy::Stats::IsolatedStoreImpl store;
+  PlatformUtilImpl platform_util;
+  for (auto _ : state) { // NOLINT
+    BatchCompletingTarget target(*dispatcher);
+    SequencerImpl sequencer(
+        platform_util, *dispatcher, api->timeSource(),
+        std::make_unique<BudgetRateLimiter>(api->timeSource(), target_calls),
+        [&target](OperationCallback callback) { return target.start(std::move(callback)); },
+        std::make_unique<HdrStatistic>(), std::make_unique<HdrStatistic>(),
+        std::make_unique<HdrStatistic>(),
+        SequencerOverheadStatistics{
+            std::make_unique<HdrStatistic>(), std::make_unique<HdrStatistic>(),
+            std::make_unique<HdrStatistic>(), std::make_unique<HdrStatistic>()},
+        nighthawk::client::SequencerIdleStrategy::SPIN,
+        std::make_unique<CompletionCountTerminationPredicate>(target.completed(), target_calls),
+        *store.rootScope());
+    sequencer.start();
+    sequencer.waitForCompletion();
+    benchmark::DoNotOptimize(target.completed());
+  }
+  state.SetItemsProcessed(state.iterations() * target_calls);
+}
+BENCHMARK(bmSequencerRun)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Nighthawk
@@ -0,0 +1,105 @@
+// Measures the cost of the Statistic operations on Nighthawk's hot paths: addValue() is called for
+// each request on the worker threads, combine() and toProto() when results are assembled.
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "source/common/statistic_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Nighthawk {
+namespace {
+
+// Latency-like values in nanoseconds, spread over a few orders of magnitude so that many
+// HdrHistogram buckets are touched.
+std::vector<uint64_t> makeValues(uint64_t count) {
+  std::mt19937_64 generator(42);
+  std::lognormal_distribution<double> distribution(13.0, 1.5);
+  std::vector<uint64_t> values;
+  values.reserve(count);
+  for (uint64_t i = 0; i < count; i++) {
+    values.push_back(static_cast<uint64_t>(distribution(generator)) + 1);
+  }
+  return values;
+}
+
+template <class T> std::unique_ptr<T> makeFilledStatistic(uint64_t value_count) {
+  auto statistic = std::make_unique<T>();
+  for (const uint64_t value : makeValues(value_count)) {
+    statistic->addValue(value);
+  }
+  return statistic;
+}
+
+template <class T> void bmAddValue(benchmark::State& state) {
+  const std::vector<uint64_t> values = makeValues(4096);
+  T statistic;
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT
+    statistic.addValue(values[i++ & (values.size() - 1)]);
+  }
+  benchmark::DoNotOptimize(statistic.count());
+}
+BENCHMARK_TEMPLATE(bmAddValue, HdrStatistic);
+BENCHMARK_TEMPLATE(bmAddValue, StreamingStatistic);
+BENCHMARK_TEMPLATE(bmAddValue, CircllhistStatistic);
+BENCHMARK_TEMPLATE(bmAddValue, DDSketchStatistic);
+BENCHMARK_TEMPLATE(bmAddValue, SimpleStatistic);
+
+void bmHdrStatisticAddValueWithIntervalRecording(benchmark::State& state) {
+  const std::vector<uint64_t> values = makeValues(4096);
+  HdrStatistic statistic;
+  statistic.enableIntervalRecording();
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT
+    statistic.addValue(values[i++ & (values.size() - 1)]);
+  }
+  benchmark::DoNotOptimize(statistic.count());
+}
+BENCHMARK(bmHdrStatisticAddValueWithIntervalRecording);
+
+// The argument specifies the number of values held by each of the combined statistics. The cost of
+// combining HdrStatistic instances depends on the number of buckets in use, not on the count.
+void bmHdrStatisticCombine(benchmark::State& state) {
+  const std::unique_ptr<HdrStatistic> a = makeFilledStatistic<HdrStatistic>(state.range(0));
+  const std::unique_ptr<HdrStatistic> b = makeFilledStatistic<HdrStatistic>(state.range(0));
+  for (auto _ : state) { // NOLINT
+    StatisticPtr combined = a->combine(*b);
+    benchmark::DoNotOptimize(combined);
+  }
+}
+BENCHMARK(bmHdrStatisticCombine)->Arg(0)->Arg(1000)->Arg(100000);
+
+// Like bmHdrStatisticCombine, for statistics that keep their values as-is until they hold more than
+// 4096, as the status class latency statistics do.
+void bmHdrStatisticCombineSparse(benchmark::State& state) {
+  HdrStatisticConfig config;
+  config.sparse_capacity = 4096;
+  HdrStatistic a(config);
+  HdrStatistic b(config);
+  for (const uint64_t value : makeValues(state.range(0))) {
+    a.addValue(value);
+    b.addValue(value);
+  }
+  for (auto _ : state) { // NOLINT
+    StatisticPtr combined = a.combine(b);
+    benchmark::DoNotOptimize(combined);
+  }
+}
+BENCHMARK(bmHdrStatisticCombineSparse)->Arg(0)->Arg(10)->Arg(1000);
+
+void bmHdrStatisticToProto(benchmark::State& state) {
+  const std::unique_ptr<HdrStatistic> statistic =
+      makeFilledStatistic<HdrStatistic>(state.range(0));
+  for (auto _ : state) { // NOLINT
+    nighthawk::client::Statistic proto =
+        statistic->toProto(Statistic::SerializationDomain::DURATION);
+    benchmark::DoNotOptimize(proto);
+  }
+}
+BENCHMARK(bmHdrStatisticToProto)->Arg(0)->Arg(1000)->Arg(100000);
+
+} // namespace
+} // namespace Nighthawk
@@ -0,0 +1,152 @@
+// Compares the cost of a StreamDecoder lifecycle when decoders are allocated per request and
+// deferred-deleted, versus when they are recycled through a StreamDecoderPool.
+// The heap_allocations_per_request counter reports how many times operator new was called by the
+// benchmark thread for each request, including the response headers the benchmark creates. It is
+// only available when the binary is built without tcmalloc (--define tcmalloc=disabled), as
+// tcmalloc provides its own operator new.
+
+#include <cstdlib>
+#include <new>
+
+#include "external/envoy/source/common/common/random_generator.h"
+#include "external/envoy/source/common/event/dispatcher_impl.h"
+#include "external/envoy/source/common/http/header_map_impl.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "source/client/stream_decoder.h"
+#include "source/common/statistic_impl.h"
+
+#include "benchmark/benchmark.h"
+
+#if !defined(TCMALLOC) && !defined(GPERFTOOLS_TCMALLOC)
+#define NIGHTHAWK_COUNT_HEAP_ALLOCATIONS 1
+
+namespace {
+thread_local uint64_t heap_allocations = 0;
+} // namespace
+
+// The array, nothrow and sized forms are implemented in terms of these by the standard library.
+void* operator new(std::size_t size) {
+  heap_allocations++;
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+namespace Nighthawk {
+namespace Client {
+namespace {
+
+// Reports the heap allocations made by the benchmark thread while the benchmark was running, per
+// iteration.
+class HeapAllocationCounter {
+public:
+  HeapAllocationCounter() : start_(current()) {}
+
+  void report(benchmark::State& state) const {
+#ifdef NIGHTHAWK_COUNT_HEAP_ALLOCATIONS
+    state.counters["heap_allocations_per_request"] =
+        benchmark::Counter(current() - start_, benchmark::Counter::kAvgIterations);
+#else
+    state.SetLabel("heap allocations are only counted without tcmalloc");
+#endif
+  }
+
+private:
+  static uint64_t current() {
+#ifdef NIGHTHAWK_COUNT_HEAP_ALLOCATIONS
+    return heap_allocations;
+#else
+    return 0;
+#endif
+  }
+
+  const uint64_t start_;
+};
+
+class NullCompletionCallback : public StreamDecoderCompletionCallback {
+public:
+  void onComplete(bool, const Envoy::Http::ResponseHeaderMap&) override {}
+  void onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason) override {}
+  void exportLatency(const uint32_t, const uint64_t) override {}
+  void handleResponseData(const Envoy::Buffer::Instance&) override {}
+  void onEndpointComplete(const Envoy::Upstream::HostDescription&, uint32_t,
+                          std::optional<uint64_t>) override {}
+};
+
+// Bundles the worker-level dependencies a StreamDecoder needs.
+class StreamDecoderBenchmarkContext {
+public:
+  StreamDecoderBenchmarkContext()
+      : api_(Envoy::Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("bench")),
+        request_headers_(std::make_shared<Envoy::Http::TestRequestHeaderMapImpl>(
+            std::initializer_list<std::pair<std::string, std::string>>(
+                {{":method", "GET"}, {":path", "/"}}))) {}
+
+  Envoy::Http::ResponseHeaderMapPtr responseHeaders() {
+    return std::make_unique<Envoy::Http::TestResponseHeaderMapImpl>(
+        std::initializer_list<std::pair<std::string, std::string>>({{":status", "200"}}));
+  }
+
+  Envoy::Api::ApiPtr api_;
+  Envoy::Event::DispatcherPtr dispatcher_;
+  NullCompletionCallback completion_callback_;
+  StreamingStatistic connect_statistic_;
+  StreamingStatistic latency_statistic_;
+  StreamingStatistic response_header_size_statistic_;
+  StreamingStatistic response_body_size_statistic_;
+  StreamingStatistic origin_latency_statistic_;
+  Envoy::Random::RandomGeneratorImpl random_generator_;
+  Envoy::Tracing::TracerSharedPtr tracer_;
+  HeaderMapPtr request_headers_;
+};
+
+void bmStreamDecoderAllocatePerRequest(benchmark::State& state) {
+  StreamDecoderBenchmarkContext context;
+  const HeapAllocationCounter allocations;
+  for (auto _ : state) { // NOLINT
+    auto* decoder = new StreamDecoder(
+        *context.dispatcher_, context.api_->timeSource(), context.completion_callback_,
+        [](bool, bool) {}, context.connect_statistic_, context.latency_statistic_,
+        context.response_header_size_statistic_, context.response_body_size_statistic_,
+        context.origin_latency_statistic_, context.request_headers_, nullptr, false, 0,
+        context.random_generator_, context.tracer_, "");
+    decoder->decodeHeaders(context.responseHeaders(), true);
+    context.dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  }
+  allocations.report(state);
+}
+BENCHMARK(bmStreamDecoderAllocatePerRequest);
+
+void bmStreamDecoderPooled(benchmark::State& state) {
+  StreamDecoderBenchmarkContext context;
+  StreamDecoderPool pool(*context.dispatcher_, context.api_->timeSource(),
+                         context.completion_callback_, context.connect_statistic_,
+                         context.latency_statistic_, context.response_header_size_statistic_,
+                         context.response_body_size_statistic_, context.origin_latency_statistic_,
+                         context.random_generator_, context.tracer_, "");
+  // Warm up the pool, so that the decoder allocation is not counted.
+  pool.acquire([](bool, bool) {}, context.request_headers_, nullptr, false, 0)
+      .decodeHeaders(context.responseHeaders(), true);
+  context.dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  const HeapAllocationCounter allocations;
+  for (auto _ : state) { // NOLINT
+    StreamDecoder& decoder =
+        pool.acquire([](bool, bool) {}, context.request_headers_, nullptr, false, 0);
+    decoder.decodeHeaders(context.responseHeaders(), true);
+    context.dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  }
+  allocations.report(state);
+  state.counters["decoders_allocated"] = pool.allocatedCount();
+}
+BENCHMARK(bmStreamDecoderPooled);
+
+} // namespace
+} // namespace Client
+} // namespace Nighthawk
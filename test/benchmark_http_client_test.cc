@@ -73,7 +73,7 @@ public:
                    std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
                    std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
                    std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
-                   std::make_unique<StreamingStatistic>()) {
+                   std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>()) {
     auto header_map_param = std::initializer_list<std::pair<std::string, std::string>>{
         {":scheme", "http"}, {":method", "GET"}, {":path", "/"}, {":host", "localhost"}};
     default_header_map_ =
@@ -278,6 +278,7 @@ TEST_F(BenchmarkClientHttpTest, EnableLatencyMeasurement) {
   EXPECT_EQ(10, client_->statistics()["benchmark_http_client.response_header_size"]->count());
   EXPECT_EQ(10, client_->statistics()["benchmark_http_client.response_body_size"]->count());
   EXPECT_EQ(0, client_->statistics()["benchmark_http_client.latency_2xx"]->count());
+  EXPECT_EQ(0, client_->statistics()["benchmark_http_client.request_generation"]->count());
   client_->setShouldMeasureLatencies(true);
 
   verifyBenchmarkClientProcessesExpectedInflightRequests(client_setup_param);
@@ -286,6 +287,7 @@ TEST_F(BenchmarkClientHttpTest, EnableLatencyMeasurement) {
   EXPECT_EQ(20, client_->statistics()["benchmark_http_client.response_header_size"]->count());
   EXPECT_EQ(20, client_->statistics()["benchmark_http_client.response_body_size"]->count());
   EXPECT_EQ(10, client_->statistics()["benchmark_http_client.latency_2xx"]->count());
+  EXPECT_EQ(10, client_->statistics()["benchmark_http_client.request_generation"]->count());
 }
 
 TEST_F(BenchmarkClientHttpTest, ExportSuccessLatency) {
@@ -362,6 +364,82 @@ TEST_F(BenchmarkClientHttpTest, PoolFailures) {
   EXPECT_EQ(2, getCounter("pool_connection_failure"));
 }
 
+TEST_F(BenchmarkClientHttpTest, EndpointStatisticsAreOnlyTrackedWhenEnabled) {
+  RequestGenerator default_request_generator = getDefaultRequestGenerator();
+  setupBenchmarkClient(default_request_generator);
+  NiceMock<Envoy::Upstream::MockHostDescription> host;
+  client_->onEndpointComplete(host, 200, 10);
+  EXPECT_EQ(12, client_->statistics().size());
+}
+
+TEST_F(BenchmarkClientHttpTest, EndpointStatisticsAreTrackedPerEndpoint) {
+  RequestGenerator default_request_generator = getDefaultRequestGenerator();
+  setupBenchmarkClient(default_request_generator);
+  client_->enableEndpointStatistics(
+      [](absl::string_view) { return std::make_unique<StreamingStatistic>(); });
+  NiceMock<Envoy::Upstream::MockHostDescription> host_a;
+  NiceMock<Envoy::Upstream::MockHostDescription> host_b;
+  ON_CALL(host_a, address())
+      .WillByDefault(Return(Envoy::Network::Utility::resolveUrl("tcp://127.0.0.1:80")));
+  ON_CALL(host_b, address())
+      .WillByDefault(Return(Envoy::Network::Utility::resolveUrl("tcp://127.0.0.2:80")));
+  client_->onEndpointComplete(host_a, 200, 10);
+  client_->onEndpointComplete(host_a, 200, 30);
+  client_->onEndpointComplete(host_a, 503, std::nullopt);
+  client_->onEndpointComplete(host_b, 0, std::nullopt);
+
+  EXPECT_EQ(2, getCounter("endpoint.127_0_0_1_80.http_2xx"));
+  EXPECT_EQ(1, getCounter("endpoint.127_0_0_1_80.http_5xx"));
+  EXPECT_EQ(0, getCounter("endpoint.127_0_0_1_80.failures"));
+  EXPECT_EQ(1, getCounter("endpoint.127_0_0_2_80.failures"));
+  StatisticPtrMap statistics = client_->statistics();
+  const Statistic* latency_a =
+      statistics["benchmark_http_client.request_to_response.endpoint.127_0_0_1_80"];
+  ASSERT_NE(latency_a, nullptr);
+  EXPECT_EQ(2, latency_a->count());
+  EXPECT_DOUBLE_EQ(20, latency_a->mean());
+  const Statistic* latency_b =
+      statistics["benchmark_http_client.request_to_response.endpoint.127_0_0_2_80"];
+  ASSERT_NE(latency_b, nullptr);
+  EXPECT_EQ(0, latency_b->count());
+}
+
+TEST_F(BenchmarkClientHttpTest, HashHeaderFallsBackToDefaultPickWhenNoPoolIsAvailable) {
+  RequestGenerator request_generator = [this]() {
+    return std::make_unique<RequestImpl>(default_header_map_);
+  };
+  setupBenchmarkClient(request_generator);
+  client_->setHashHeader(":path");
+  // No pool for the endpoint the request hashes to, but there is one for a pick without a hash.
+  EXPECT_CALL(thread_local_cluster_, httpConnPool(_, _, _, NotNull()))
+      .WillOnce(Return(std::nullopt));
+  EXPECT_CALL(thread_local_cluster_, httpConnPool(_, _, _, IsNull()))
+      .WillOnce(Return(Envoy::Upstream::HttpPoolData([]() {}, &pool_)));
+  EXPECT_CALL(pool_, newStream(_, _, _)).WillOnce(Return(nullptr));
+  EXPECT_TRUE(client_->tryStartRequest([](bool, bool) {}));
+  EXPECT_EQ(0, getCounter("pool_unavailable"));
+}
+
+TEST_F(BenchmarkClientHttpTest, HashHeaderDropsRequestWhenNoPoolIsAvailable) {
+  uint64_t generated = 0;
+  RequestGenerator request_generator = [this, &generated]() {
+    generated++;
+    return std::make_unique<RequestImpl>(default_header_map_);
+  };
+  setupBenchmarkClient(request_generator);
+  client_->setHashHeader(":path");
+  EXPECT_CALL(thread_local_cluster_, httpConnPool(_, _, _, _))
+      .WillOnce(Return(std::nullopt))
+      .WillOnce(Return(std::nullopt))
+      .WillOnce(Return(Envoy::Upstream::HttpPoolData([]() {}, &pool_)));
+  EXPECT_CALL(pool_, newStream(_, _, _)).WillOnce(Return(nullptr));
+  EXPECT_FALSE(client_->tryStartRequest([](bool, bool) {}));
+  EXPECT_EQ(1, getCounter("pool_unavailable"));
+  // The next attempt starts a new request, rather than retrying the dropped one.
+  EXPECT_TRUE(client_->tryStartRequest([](bool, bool) {}));
+  EXPECT_EQ(2, generated);
+}
+
 TEST_F(BenchmarkClientHttpTest, RequestMethodPost) {
   RequestGenerator request_generator = []() {
     auto header = std::make_shared<Envoy::Http::TestRequestHeaderMapImpl>(
@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "external/envoy/source/common/protobuf/protobuf.h"
 
 #include "api/client/options.pb.h"
@@ -85,6 +87,71 @@ TEST(PerformNighthawkBenchmark, ReturnsNighthawkResponseSuccessfully) {
   EXPECT_THAT(actual_response, EqualsProto(expected_response));
 }
 
+TEST(PerformNighthawkBenchmark, SkipsProgressReports) {
+  ExecutionResponse progress_response;
+  progress_response.set_progress_report(true);
+  ExecutionResponse expected_response;
+  expected_response.set_execution_id("final");
+  nighthawk::client::MockNighthawkServiceStub mock_nighthawk_service_stub;
+  EXPECT_CALL(mock_nighthawk_service_stub, ExecutionStreamRaw)
+      .WillOnce([&progress_response, &expected_response](grpc::ClientContext*) {
+        auto* mock_reader_writer =
+            new MockClientReaderWriter<ExecutionRequest, ExecutionResponse>();
+        // Progress reports may precede the final response.
+        EXPECT_CALL(*mock_reader_writer, Read(_))
+            .WillOnce(DoAll(SetArgPointee<0>(progress_response), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(progress_response), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(expected_response), Return(true)))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*mock_reader_writer, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*mock_reader_writer, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*mock_reader_writer, Finish()).WillOnce(Return(grpc::Status::OK));
+        return mock_reader_writer;
+      });
+
+  NighthawkServiceClientImpl client;
+  absl::StatusOr<ExecutionResponse> response_or =
+      client.PerformNighthawkBenchmark(&mock_nighthawk_service_stub, CommandLineOptions());
+  ASSERT_TRUE(response_or.ok());
+  EXPECT_THAT(response_or.value(), EqualsProto(expected_response));
+}
+
+TEST(PerformNighthawkBenchmark, PassesProgressReportsToCallback) {
+  ExecutionResponse progress_response;
+  progress_response.set_progress_report(true);
+  progress_response.mutable_output()->add_results()->set_name("progress");
+  ExecutionResponse expected_response;
+  expected_response.set_execution_id("final");
+  nighthawk::client::MockNighthawkServiceStub mock_nighthawk_service_stub;
+  EXPECT_CALL(mock_nighthawk_service_stub, ExecutionStreamRaw)
+      .WillOnce([&progress_response, &expected_response](grpc::ClientContext*) {
+        auto* mock_reader_writer =
+            new MockClientReaderWriter<ExecutionRequest, ExecutionResponse>();
+        EXPECT_CALL(*mock_reader_writer, Read(_))
+            .WillOnce(DoAll(SetArgPointee<0>(progress_response), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(progress_response), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(expected_response), Return(true)))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*mock_reader_writer, Write(_, _)).WillOnce(Return(true));
+        EXPECT_CALL(*mock_reader_writer, WritesDone()).WillOnce(Return(true));
+        EXPECT_CALL(*mock_reader_writer, Finish()).WillOnce(Return(grpc::Status::OK));
+        return mock_reader_writer;
+      });
+
+  std::vector<nighthawk::client::Output> progress_reports;
+  NighthawkServiceClientImpl client;
+  absl::StatusOr<ExecutionResponse> response_or = client.PerformNighthawkBenchmark(
+      &mock_nighthawk_service_stub, CommandLineOptions(),
+      [&progress_reports](const nighthawk::client::Output& progress) {
+        progress_reports.push_back(progress);
+      });
+  ASSERT_TRUE(response_or.ok());
+  EXPECT_THAT(response_or.value(), EqualsProto(expected_response));
+  ASSERT_EQ(progress_reports.size(), 2);
+  EXPECT_THAT(progress_reports[0], EqualsProto(progress_response.output()));
+  EXPECT_THAT(progress_reports[1], EqualsProto(progress_response.output()));
+}
+
 TEST(PerformNighthawkBenchmark, ReturnsErrorIfNighthawkServiceDoesNotSendResponse) {
   nighthawk::client::MockNighthawkServiceStub mock_nighthawk_service_stub;
   // Configure the mock Nighthawk Service stub to return an inner mock channel when the code under
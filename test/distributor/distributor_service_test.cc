@@ -1,5 +1,9 @@
 #include <grpc++/grpc++.h>
 
+#include <atomic>
+#include <vector>
+
+#include "external/envoy/source/common/protobuf/protobuf.h"
 #include "external/envoy/test/test_common/environment.h"
 #include "external/envoy/test/test_common/network_utility.h"
 #include "external/envoy/test/test_common/utility.h"
@@ -10,8 +14,11 @@
 #include "source/distributor/service_impl.h"
 
 #include "test/mocks/common/mock_nighthawk_service_client.h"
+#include "test/test_common/proto_matchers.h"
 
+#include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "gtest/gtest.h"
 
 namespace Nighthawk {
@@ -19,8 +26,12 @@ namespace {
 
 using ::nighthawk::DistributedRequest;
 using ::nighthawk::DistributedResponse;
+using ::Envoy::Protobuf::util::TimeUtil;
 using ::nighthawk::client::ExecutionRequest;
 using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ::testing::InvokeWithoutArgs;
+using ::testing::Property;
 using ::testing::Return;
 using ::testing::TestWithParam;
 using ::testing::ValuesIn;
@@ -175,6 +186,95 @@ TEST_P(DistributorServiceWithMockServiceClientTest, DistributeToTwoServicesYield
   EXPECT_EQ(response_.service_response_size(), 2);
 }
 
+TEST_P(DistributorServiceWithMockServiceClientTest, DistributeToTwoServicesRunsConcurrently) {
+  // Each execution waits for the other to start. Sequential delegation would time out.
+  absl::Notification first_started;
+  absl::Notification second_started;
+  std::atomic<int> started{0};
+  std::atomic<int> overlapped{0};
+  EXPECT_CALL(*mock_nighthawk_service_client_, PerformNighthawkBenchmark(_, _))
+      .Times(2)
+      .WillRepeatedly(
+          InvokeWithoutArgs([&]() -> absl::StatusOr<nighthawk::client::ExecutionResponse> {
+            const bool is_first = started++ == 0;
+            (is_first ? first_started : second_started).Notify();
+            if ((is_first ? second_started : first_started)
+                    .WaitForNotificationWithTimeout(absl::Seconds(10))) {
+              overlapped++;
+            }
+            return nighthawk::client::ExecutionResponse();
+          }));
+  std::unique_ptr<grpc::ClientReaderWriter<DistributedRequest, DistributedResponse>> reader_writer =
+      stub_->DistributedRequestStream(&context_);
+  *request_.add_services() = request_.services(0);
+  request_.mutable_execution_request()->mutable_start_request()->mutable_options();
+  EXPECT_TRUE(reader_writer->Write(request_, {}));
+  EXPECT_TRUE(reader_writer->WritesDone());
+  ASSERT_TRUE(reader_writer->Read(&response_));
+  EXPECT_TRUE(reader_writer->Finish().ok());
+  EXPECT_EQ(overlapped, 2);
+}
+
+TEST_P(DistributorServiceWithMockServiceClientTest, DistributeToTwoServicesStampsSharedStart) {
+  std::vector<nighthawk::client::CommandLineOptions> received_options;
+  absl::Mutex lock;
+  EXPECT_CALL(*mock_nighthawk_service_client_, PerformNighthawkBenchmark(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](nighthawk::client::NighthawkService::StubInterface*,
+                                 const nighthawk::client::CommandLineOptions& options) {
+        absl::MutexLock guard(&lock);
+        received_options.push_back(options);
+        return nighthawk::client::ExecutionResponse();
+      }));
+  std::unique_ptr<grpc::ClientReaderWriter<DistributedRequest, DistributedResponse>> reader_writer =
+      stub_->DistributedRequestStream(&context_);
+  *request_.add_services() = request_.services(0);
+  request_.mutable_execution_request()->mutable_start_request()->mutable_options();
+  *request_.mutable_synchronized_start_delay() = TimeUtil::SecondsToDuration(30);
+  const Envoy::Protobuf::Timestamp before = TimeUtil::GetCurrentTime();
+  EXPECT_TRUE(reader_writer->Write(request_, {}));
+  EXPECT_TRUE(reader_writer->WritesDone());
+  ASSERT_TRUE(reader_writer->Read(&response_));
+  EXPECT_TRUE(reader_writer->Finish().ok());
+  ASSERT_EQ(received_options.size(), 2);
+  ASSERT_TRUE(received_options[0].has_scheduled_start());
+  EXPECT_GE(received_options[0].scheduled_start(), before + TimeUtil::SecondsToDuration(30));
+  EXPECT_THAT(received_options[1], EqualsProto(received_options[0]));
+}
+
+TEST_P(DistributorServiceWithMockServiceClientTest, ExplicitScheduledStartIsKept) {
+  const Envoy::Protobuf::Timestamp scheduled_start = TimeUtil::SecondsToTimestamp(4102444800);
+  EXPECT_CALL(*mock_nighthawk_service_client_,
+              PerformNighthawkBenchmark(_, Property(&nighthawk::client::CommandLineOptions::
+                                                        scheduled_start,
+                                                    EqualsProto(scheduled_start))))
+      .Times(2);
+  std::unique_ptr<grpc::ClientReaderWriter<DistributedRequest, DistributedResponse>> reader_writer =
+      stub_->DistributedRequestStream(&context_);
+  *request_.add_services() = request_.services(0);
+  *request_.mutable_execution_request()
+       ->mutable_start_request()
+       ->mutable_options()
+       ->mutable_scheduled_start() = scheduled_start;
+  EXPECT_TRUE(reader_writer->Write(request_, {}));
+  EXPECT_TRUE(reader_writer->WritesDone());
+  ASSERT_TRUE(reader_writer->Read(&response_));
+  EXPECT_TRUE(reader_writer->Finish().ok());
+}
+
+TEST_P(DistributorServiceWithMockServiceClientTest, SingleServiceIsNotScheduled) {
+  EXPECT_CALL(*mock_nighthawk_service_client_,
+              PerformNighthawkBenchmark(
+                  _, Property(&nighthawk::client::CommandLineOptions::has_scheduled_start, false)));
+  std::unique_ptr<grpc::ClientReaderWriter<DistributedRequest, DistributedResponse>> reader_writer =
+      stub_->DistributedRequestStream(&context_);
+  request_.mutable_execution_request()->mutable_start_request()->mutable_options();
+  EXPECT_TRUE(reader_writer->Write(request_, {}));
+  EXPECT_TRUE(reader_writer->WritesDone());
+  ASSERT_TRUE(reader_writer->Read(&response_));
+  EXPECT_TRUE(reader_writer->Finish().ok());
+}
+
 TEST_P(DistributorServiceWithMockServiceClientTest,
        DistributeToSingleServiceErrorReplyYieldsFailure) {
   const std::string kExpectedErrorMessage = "artificial nighthawk service error";
@@ -7,6 +7,7 @@
 
 #include "source/client/factories_impl.h"
 #include "source/common/request_source_impl.h"
+#include "source/common/statistic_impl.h"
 
 #include "test/mocks/client/mock_benchmark_client.h"
 #include "test/mocks/client/mock_options.h"
@@ -45,12 +46,180 @@ TEST_F(FactoriesTest, CreateBenchmarkClient) {
   EXPECT_CALL(options_, openLoop());
   EXPECT_CALL(options_, responseHeaderWithLatencyInput());
   EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  EXPECT_CALL(options_, statsSinks());
+  EXPECT_CALL(options_, progressReportInterval());
+  EXPECT_CALL(options_, timeSliceInterval());
   StaticRequestSourceImpl request_generator(
       std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
   auto benchmark_client =
       factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
                      /*worker_id=*/0, request_generator, {});
   EXPECT_NE(nullptr, benchmark_client.get());
+  for (const auto& statistic : benchmark_client->statistics()) {
+    const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(statistic.second);
+    if (hdr_statistic != nullptr) {
+      EXPECT_EQ(hdr_statistic->intervalRecorder(), nullptr) << statistic.first;
+      // Histograms are only allocated once values are added.
+      EXPECT_FALSE(hdr_statistic->histogramAllocated()) << statistic.first;
+    }
+  }
+  const auto* latency_5xx = dynamic_cast<const HdrStatistic*>(
+      benchmark_client->statistics().at("benchmark_http_client.latency_5xx"));
+  ASSERT_NE(latency_5xx, nullptr);
+  EXPECT_GT(latency_5xx->config().sparse_capacity, 0);
+}
+
+TEST_F(FactoriesTest, CreateBenchmarkClientRecordsIntervalsWhenStatsSinksAreConfigured) {
+  BenchmarkClientFactoryImpl factory(options_);
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  EXPECT_CALL(options_, connections());
+  EXPECT_CALL(options_, protocol()).WillOnce(Return(Envoy::Http::Protocol::Http11));
+  EXPECT_CALL(options_, maxPendingRequests());
+  EXPECT_CALL(options_, maxActiveRequests());
+  EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, openLoop());
+  EXPECT_CALL(options_, responseHeaderWithLatencyInput());
+  EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  EXPECT_CALL(options_, statsSinks())
+      .WillOnce(Return(std::vector<envoy::config::metrics::v3::StatsSink>(1)));
+  StaticRequestSourceImpl request_generator(
+      std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
+  auto benchmark_client =
+      factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
+                     /*worker_id=*/0, request_generator, {});
+  const StatisticPtrMap statistics = benchmark_client->statistics();
+  for (const std::string& id : {"benchmark_http_client.request_to_response",
+                                "benchmark_http_client.latency_2xx"}) {
+    ASSERT_EQ(statistics.count(id), 1) << id;
+    const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(statistics.at(id));
+    ASSERT_NE(hdr_statistic, nullptr) << id;
+    EXPECT_NE(hdr_statistic->intervalRecorder(), nullptr) << id;
+  }
+}
+
+TEST_F(FactoriesTest, CreateBenchmarkClientRecordsIntervalsForProgressReports) {
+  BenchmarkClientFactoryImpl factory(options_, /*request_event_log=*/nullptr,
+                                     []() { return true; });
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  EXPECT_CALL(options_, connections());
+  EXPECT_CALL(options_, protocol()).WillOnce(Return(Envoy::Http::Protocol::Http11));
+  EXPECT_CALL(options_, maxPendingRequests());
+  EXPECT_CALL(options_, maxActiveRequests());
+  EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, openLoop());
+  EXPECT_CALL(options_, responseHeaderWithLatencyInput());
+  EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  EXPECT_CALL(options_, statsSinks());
+  EXPECT_CALL(options_, progressReportInterval()).WillOnce(Return(1));
+  StaticRequestSourceImpl request_generator(
+      std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
+  auto benchmark_client =
+      factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
+                     /*worker_id=*/0, request_generator, {});
+  const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(
+      benchmark_client->statistics().at("benchmark_http_client.request_to_response"));
+  ASSERT_NE(hdr_statistic, nullptr);
+  EXPECT_NE(hdr_statistic->intervalRecorder(), nullptr);
+}
+
+TEST_F(FactoriesTest, CreateBenchmarkClientSkipsIntervalsWithoutProgressReports) {
+  // Nobody receives progress reports, e.g. when running from the CLI.
+  BenchmarkClientFactoryImpl factory(options_, /*request_event_log=*/nullptr,
+                                     []() { return false; });
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  EXPECT_CALL(options_, connections());
+  EXPECT_CALL(options_, protocol()).WillOnce(Return(Envoy::Http::Protocol::Http11));
+  EXPECT_CALL(options_, maxPendingRequests());
+  EXPECT_CALL(options_, maxActiveRequests());
+  EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, openLoop());
+  EXPECT_CALL(options_, responseHeaderWithLatencyInput());
+  EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  EXPECT_CALL(options_, statsSinks());
+  EXPECT_CALL(options_, progressReportInterval()).WillOnce(Return(1));
+  EXPECT_CALL(options_, timeSliceInterval());
+  StaticRequestSourceImpl request_generator(
+      std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
+  auto benchmark_client =
+      factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
+                     /*worker_id=*/0, request_generator, {});
+  const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(
+      benchmark_client->statistics().at("benchmark_http_client.request_to_response"));
+  ASSERT_NE(hdr_statistic, nullptr);
+  EXPECT_EQ(hdr_statistic->intervalRecorder(), nullptr);
+}
+
+TEST_F(FactoriesTest, CreateBenchmarkClientRecordsIntervalsForTimeSlices) {
+  BenchmarkClientFactoryImpl factory(options_);
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  EXPECT_CALL(options_, connections());
+  EXPECT_CALL(options_, protocol()).WillOnce(Return(Envoy::Http::Protocol::Http11));
+  EXPECT_CALL(options_, maxPendingRequests());
+  EXPECT_CALL(options_, maxActiveRequests());
+  EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, openLoop());
+  EXPECT_CALL(options_, responseHeaderWithLatencyInput());
+  EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  EXPECT_CALL(options_, statsSinks());
+  EXPECT_CALL(options_, progressReportInterval());
+  EXPECT_CALL(options_, timeSliceInterval()).WillOnce(Return(1));
+  StaticRequestSourceImpl request_generator(
+      std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
+  auto benchmark_client =
+      factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
+                     /*worker_id=*/0, request_generator, {});
+  const auto* hdr_statistic = dynamic_cast<const HdrStatistic*>(
+      benchmark_client->statistics().at("benchmark_http_client.latency_2xx"));
+  ASSERT_NE(hdr_statistic, nullptr);
+  EXPECT_NE(hdr_statistic->intervalRecorder(), nullptr);
+}
+
+TEST_F(FactoriesTest, CreateBenchmarkClientRoutesStatisticsToConfiguredBackends) {
+  BenchmarkClientFactoryImpl factory(options_);
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  EXPECT_CALL(options_, connections());
+  EXPECT_CALL(options_, protocol()).WillOnce(Return(Envoy::Http::Protocol::Http11));
+  EXPECT_CALL(options_, maxPendingRequests());
+  EXPECT_CALL(options_, maxActiveRequests());
+  EXPECT_CALL(options_, maxRequestsPerConnection());
+  EXPECT_CALL(options_, openLoop());
+  EXPECT_CALL(options_, responseHeaderWithLatencyInput());
+  EXPECT_CALL(options_, timeout());
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends())
+      .WillOnce(Return(StatisticBackendMap{
+          {"*", nighthawk::client::StatisticBackend::NONE},
+          {"benchmark_http_client.request_to_response", nighthawk::client::StatisticBackend::HDR},
+          {"benchmark_http_client.latency_2xx",
+           nighthawk::client::StatisticBackend::CIRCLLHIST}}));
+  EXPECT_CALL(options_, statsSinks());
+  EXPECT_CALL(options_, progressReportInterval());
+  EXPECT_CALL(options_, timeSliceInterval());
+  StaticRequestSourceImpl request_generator(
+      std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>());
+  auto benchmark_client =
+      factory.create(*api_, dispatcher_, stats_scope_, cluster_manager, tracer_, "foocluster",
+                     /*worker_id=*/0, request_generator, {});
+  const StatisticPtrMap statistics = benchmark_client->statistics();
+  EXPECT_NE(nullptr, dynamic_cast<const HdrStatistic*>(
+                         statistics.at("benchmark_http_client.request_to_response")));
+  EXPECT_NE(nullptr, dynamic_cast<const SinkableCircllhistStatistic*>(
+                         statistics.at("benchmark_http_client.latency_2xx")));
+  for (const std::string& id :
+       {"benchmark_http_client.queue_to_connect", "benchmark_http_client.response_body_size",
+        "benchmark_http_client.latency_5xx"}) {
+    EXPECT_NE(nullptr, dynamic_cast<const NullStatistic*>(statistics.at(id))) << id;
+  }
 }
 
 TEST_F(FactoriesTest, CreateRequestSourcePluginWithWorkingJsonReturnsWorkingRequestSource) {
@@ -71,6 +240,7 @@ TEST_F(FactoriesTest, CreateRequestSourcePluginWithWorkingJsonReturnsWorkingRequ
   Envoy::MessageUtil::loadFromJson(request_source_plugin_config_json,
                                    request_source_plugin_config.value(),
                                    Envoy::ProtobufMessage::getStrictValidationVisitor());
+  EXPECT_CALL(options_, sharedRequestSourceCapacity());
   EXPECT_CALL(options_, requestMethod());
   EXPECT_CALL(options_, requestBodySize());
   EXPECT_CALL(options_, uri()).Times(2).WillRepeatedly(Return("http://foo/"));
@@ -87,7 +257,8 @@ TEST_F(FactoriesTest, CreateRequestSourcePluginWithWorkingJsonReturnsWorkingRequ
   RequestSourceFactoryImpl factory(options_, *api_);
   Envoy::Upstream::ClusterManagerPtr cluster_manager;
   Nighthawk::RequestSourcePtr request_source = factory.create(
-      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource");
+      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource",
+      /*worker_number=*/0);
   EXPECT_NE(nullptr, request_source.get());
   Nighthawk::RequestGenerator generator = request_source->get();
   Nighthawk::RequestPtr request = generator();
@@ -111,6 +282,7 @@ TEST_F(FactoriesTest, CreateRequestSourcePluginWithNonWorkingJsonThrowsError) {
   Envoy::MessageUtil::loadFromJson(request_source_plugin_config_json,
                                    request_source_plugin_config.value(),
                                    Envoy::ProtobufMessage::getStrictValidationVisitor());
+  EXPECT_CALL(options_, sharedRequestSourceCapacity());
   EXPECT_CALL(options_, requestMethod());
   EXPECT_CALL(options_, requestBodySize());
   EXPECT_CALL(options_, uri()).Times(2).WillRepeatedly(Return("http://foo/"));
@@ -128,13 +300,14 @@ TEST_F(FactoriesTest, CreateRequestSourcePluginWithNonWorkingJsonThrowsError) {
   Envoy::Upstream::ClusterManagerPtr cluster_manager;
   EXPECT_THROW_WITH_REGEX(
       factory.create(cluster_manager, dispatcher_, *stats_scope_.createScope("foo."),
-                     "requestsource"),
+                     "requestsource", /*worker_number=*/0),
       NighthawkException,
       "Request Source plugin loading error should have been caught during input validation");
 }
 
 TEST_F(FactoriesTest, CreateRequestSource) {
   std::optional<envoy::config::core::v3::TypedExtensionConfig> request_source_plugin_config;
+  EXPECT_CALL(options_, sharedRequestSourceCapacity());
   EXPECT_CALL(options_, requestMethod());
   EXPECT_CALL(options_, requestBodySize());
   EXPECT_CALL(options_, uri()).Times(2).WillRepeatedly(Return("http://foo/"));
@@ -151,12 +324,14 @@ TEST_F(FactoriesTest, CreateRequestSource) {
   RequestSourceFactoryImpl factory(options_, *api_);
   Envoy::Upstream::ClusterManagerPtr cluster_manager;
   RequestSourcePtr request_generator = factory.create(
-      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource");
+      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource",
+      /*worker_number=*/0);
   EXPECT_NE(nullptr, request_generator.get());
 }
 
 TEST_F(FactoriesTest, CreateRemoteRequestSource) {
   std::optional<envoy::config::core::v3::TypedExtensionConfig> request_source_plugin_config;
+  EXPECT_CALL(options_, sharedRequestSourceCapacity());
   EXPECT_CALL(options_, requestMethod());
   EXPECT_CALL(options_, requestBodySize());
   EXPECT_CALL(options_, uri()).Times(2).WillRepeatedly(Return("http://foo/"));
@@ -171,10 +346,46 @@ TEST_F(FactoriesTest, CreateRemoteRequestSource) {
   RequestSourceFactoryImpl factory(options_, *api_);
   Envoy::Upstream::ClusterManagerPtr cluster_manager;
   RequestSourcePtr request_generator = factory.create(
-      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource");
+      cluster_manager, dispatcher_, *stats_scope_.createScope("foo."), "requestsource",
+      /*worker_number=*/0);
   EXPECT_NE(nullptr, request_generator.get());
 }
 
+TEST_F(FactoriesTest, CreateSharedRequestSource) {
+  std::optional<envoy::config::core::v3::TypedExtensionConfig> request_source_plugin_config;
+  EXPECT_CALL(options_, sharedRequestSourceCapacity()).Times(2).WillRepeatedly(Return(16));
+  EXPECT_CALL(options_, requestMethod());
+  EXPECT_CALL(options_, requestBodySize());
+  EXPECT_CALL(options_, uri()).Times(2).WillRepeatedly(Return("http://foo/"));
+  // Once to select the producer mode, and once to create the upstream request source.
+  EXPECT_CALL(options_, requestSource()).Times(2);
+  EXPECT_CALL(options_, requestSourcePluginConfig())
+      .WillRepeatedly(ReturnRef(request_source_plugin_config));
+  EXPECT_CALL(options_, toCommandLineOptions())
+      .WillOnce(Return(ByMove(std::make_unique<nighthawk::client::CommandLineOptions>())));
+  RequestSourceFactoryImpl factory(options_, *api_, /*worker_count=*/2);
+  Envoy::Upstream::ClusterManagerPtr cluster_manager;
+  Envoy::Stats::ScopeSharedPtr scope_0 = stats_scope_.createScope("0.");
+  Envoy::Stats::ScopeSharedPtr scope_1 = stats_scope_.createScope("1.");
+  RequestSourcePtr request_source_0 =
+      factory.create(cluster_manager, dispatcher_, *scope_0, "0.requestsource",
+                     /*worker_number=*/0);
+  RequestSourcePtr request_source_1 =
+      factory.create(cluster_manager, dispatcher_, *scope_1, "1.requestsource",
+                     /*worker_number=*/1);
+  ASSERT_NE(nullptr, dynamic_cast<SharedRequestSourceConsumerImpl*>(request_source_0.get()));
+  ASSERT_NE(nullptr, dynamic_cast<SharedRequestSourceConsumerImpl*>(request_source_1.get()));
+  // Both workers draw from the static request source, which is fed to them by the producer thread.
+  for (RequestSourcePtr* request_source : {&request_source_0, &request_source_1}) {
+    RequestGenerator generator = (*request_source)->get();
+    RequestPtr request;
+    while (request == nullptr) {
+      request = generator();
+    }
+    EXPECT_EQ("/", request->header()->getPathValue());
+  }
+}
+
 TEST_F(FactoriesTest, CreateSequencer) {}
 class SequencerFactoryTest
     : public FactoriesTest,
@@ -195,13 +406,16 @@ public:
         .WillOnce(Return(sequencer_idle_strategy));
     EXPECT_CALL(dispatcher_, createTimer_(_)).Times(2);
     EXPECT_CALL(options_, jitterUniform()).WillOnce(Return(1ns));
+    EXPECT_CALL(options_, hdrHistogramConfigs());
+    EXPECT_CALL(options_, statisticBackends());
     Envoy::Event::SimulatedTimeSystem time_system;
     const SequencerTarget dummy_sequencer_target = [](const CompletionCallback&) -> bool {
       return true;
     };
     auto sequencer = factory.create(api_->timeSource(), dispatcher_, dummy_sequencer_target,
                                     std::make_unique<MockTerminationPredicate>(), stats_scope_,
-                                    time_system.monotonicTime() + 10ms, *api_);
+                                    time_system.monotonicTime() + 10ms, *api_,
+                                    /*worker_number=*/0);
     EXPECT_NE(nullptr, sequencer.get());
   }
 };
@@ -231,6 +445,8 @@ TEST_P(SequencerFactoryTest, ValidRateLimiterPluginCreatesWorkingSequencer) {
       .WillRepeatedly(ReturnRef(rate_limiter_plugin_config));
   EXPECT_CALL(options_, sequencerIdleStrategy()).WillOnce(Return(GetParam()));
   EXPECT_CALL(dispatcher_, createTimer_(_)).Times(2);
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
 
   // LinearRampingRateLimiter specific. Adjust if test fails because of any
   // changes made to the LinearRampingRateLimiterImplFactory.
@@ -245,7 +461,7 @@ TEST_P(SequencerFactoryTest, ValidRateLimiterPluginCreatesWorkingSequencer) {
 
   auto sequencer = factory.create(api_->timeSource(), dispatcher_, dummy_sequencer_target,
                                   std::make_unique<MockTerminationPredicate>(), stats_scope_,
-                                  time_system.monotonicTime() + 10ms, *api_);
+                                  time_system.monotonicTime() + 10ms, *api_, /*worker_number=*/0);
   EXPECT_NE(nullptr, sequencer.get());
 }
 
@@ -270,6 +486,8 @@ TEST_P(SequencerFactoryTest, UnknownRateLimiterPluginThrowsException) {
   EXPECT_CALL(options_, rateLimiterPluginConfig())
       .Times(AtLeast(1))
       .WillRepeatedly(ReturnRef(rate_limiter_plugin_config));
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
 
   Envoy::Event::SimulatedTimeSystem time_system;
   const SequencerTarget dummy_sequencer_target = [](const CompletionCallback&) -> bool {
@@ -278,7 +496,8 @@ TEST_P(SequencerFactoryTest, UnknownRateLimiterPluginThrowsException) {
 
   EXPECT_THROW_WITH_REGEX(factory.create(api_->timeSource(), dispatcher_, dummy_sequencer_target,
                                          std::make_unique<MockTerminationPredicate>(), stats_scope_,
-                                         time_system.monotonicTime() + 10ms, *api_),
+                                         time_system.monotonicTime() + 10ms, *api_,
+                                         /*worker_number=*/0),
                           NighthawkException, "Rate Limiter plugin loading error");
 }
 
@@ -288,8 +507,65 @@ INSTANTIATE_TEST_SUITE_P(SequencerIdleStrategies, SequencerFactoryTest,
                                    nighthawk::client::SequencerIdleStrategy::SPIN}));
 
 TEST_F(FactoriesTest, CreateStatistic) {
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
   StatisticFactoryImpl factory(options_);
-  EXPECT_NE(nullptr, factory.create().get());
+  StatisticPtr statistic = factory.create("foo");
+  ASSERT_NE(nullptr, statistic.get());
+  EXPECT_EQ("foo", statistic->id());
+}
+
+TEST_F(FactoriesTest, CreateStatisticRoutesToConfiguredBackend) {
+  const StatisticBackendMap backends{
+      {"*", nighthawk::client::StatisticBackend::NONE},
+      {"circllhist", nighthawk::client::StatisticBackend::CIRCLLHIST},
+      {"streaming", nighthawk::client::StatisticBackend::STREAMING},
+      {"sketch", nighthawk::client::StatisticBackend::SKETCH},
+      {"hdr", nighthawk::client::StatisticBackend::HDR}};
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends()).WillOnce(Return(backends));
+  StatisticFactoryImpl factory(options_);
+  EXPECT_NE(nullptr, dynamic_cast<CircllhistStatistic*>(factory.create("circllhist").get()));
+  EXPECT_NE(nullptr, dynamic_cast<StreamingStatistic*>(factory.create("streaming").get()));
+  EXPECT_NE(nullptr, dynamic_cast<DDSketchStatistic*>(factory.create("sketch").get()));
+  EXPECT_NE(nullptr, dynamic_cast<HdrStatistic*>(factory.create("hdr").get()));
+  // "*" takes precedence over the default backend.
+  EXPECT_NE(nullptr, dynamic_cast<NullStatistic*>(factory.create("foo").get()));
+  EXPECT_EQ(nighthawk::client::StatisticBackend::NONE,
+            factory.backend("foo", nighthawk::client::StatisticBackend::STREAMING));
+}
+
+TEST_F(FactoriesTest, CreateStatisticDefaultsToHdr) {
+  EXPECT_CALL(options_, hdrHistogramConfigs());
+  EXPECT_CALL(options_, statisticBackends());
+  StatisticFactoryImpl factory(options_);
+  EXPECT_NE(nullptr, dynamic_cast<HdrStatistic*>(factory.create("foo").get()));
+  const StatisticPtr streaming =
+      factory.create("foo", nighthawk::client::StatisticBackend::STREAMING);
+  EXPECT_NE(nullptr, dynamic_cast<StreamingStatistic*>(streaming.get()));
+  EXPECT_EQ(nighthawk::client::StatisticBackend::HDR,
+            factory.backend("foo", nighthawk::client::StatisticBackend::DEFAULT));
+}
+
+TEST_F(FactoriesTest, CreateStatisticAppliesHdrHistogramConfigs) {
+  HdrHistogramConfigMap configs;
+  configs["foo"].mutable_highest_trackable_value()->set_value(1000);
+  configs["foo"].mutable_significant_digits()->set_value(2);
+  configs["*"].mutable_significant_digits()->set_value(3);
+  EXPECT_CALL(options_, hdrHistogramConfigs()).WillOnce(Return(configs));
+  EXPECT_CALL(options_, statisticBackends());
+  StatisticFactoryImpl factory(options_);
+
+  const StatisticPtr statistic = factory.create("foo");
+  const auto* foo = dynamic_cast<const HdrStatistic*>(statistic.get());
+  ASSERT_NE(nullptr, foo);
+  EXPECT_EQ(1000, foo->config().highest_trackable_value);
+  EXPECT_EQ(2, foo->significantDigits());
+
+  // Falls back to "*", and to the defaults for what "*" leaves unset.
+  const HdrStatisticConfig bar = factory.hdrStatisticConfig("bar");
+  EXPECT_EQ(HdrStatisticConfig().highest_trackable_value, bar.highest_trackable_value);
+  EXPECT_EQ(3, bar.significant_digits);
 }
 
 class OutputFormatterFactoryTest
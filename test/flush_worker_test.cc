@@ -13,8 +13,10 @@
 #include "external/envoy/test/mocks/stats/mocks.h"
 #include "external/envoy/test/mocks/thread_local/mocks.h"
 #include "external/envoy/test/mocks/upstream/cluster_manager.h"
+#include "external/envoy/test/test_common/utility.h"
 
 #include "source/client/flush_worker_impl.h"
+#include "source/common/statistic_impl.h"
 
 #include "gtest/gtest.h"
 
@@ -162,6 +164,41 @@ TEST_F(FlushWorkerTest, FinalFlush) {
   worker.shutdown();
 }
 
+// Verify that each flush publishes the percentiles of the values recorded since the previous
+// flush, merged over all recorders that share an id.
+TEST_F(FlushWorkerTest, FlushPublishesIntervalPercentiles) {
+  std::chrono::milliseconds stats_flush_interval{10};
+  NiceMock<Envoy::Upstream::MockClusterManager> mock_cluster_manager;
+
+  FlushWorkerImpl worker(stats_flush_interval, api_, tls_, store_, stats_sinks_,
+                         mock_cluster_manager);
+  auto recorder_1 = std::make_shared<HdrIntervalRecorder>();
+  auto recorder_2 = std::make_shared<HdrIntervalRecorder>();
+  worker.addIntervalRecorder("latency", recorder_1);
+  worker.addIntervalRecorder("latency", recorder_2);
+  for (uint64_t value = 1; value <= 50; value++) {
+    recorder_1->recordValue(value);
+    recorder_2->recordValue(value + 50);
+  }
+
+  worker.start();
+  worker.waitForCompletion();
+  EXPECT_CALL(*sink_, flush(_));
+  worker.shutdown();
+
+  const auto gauge_value = [this](absl::string_view name) {
+    Envoy::Stats::GaugeSharedPtr gauge =
+        Envoy::TestUtility::findGauge(store_, absl::StrCat("interval.latency.", name));
+    EXPECT_NE(gauge, nullptr) << name;
+    return gauge != nullptr ? gauge->value() : 0;
+  };
+  EXPECT_EQ(gauge_value("count"), 100);
+  EXPECT_EQ(gauge_value("p50"), 50);
+  EXPECT_EQ(gauge_value("p90"), 90);
+  EXPECT_EQ(gauge_value("p99"), 99);
+  EXPECT_EQ(gauge_value("p999"), 100);
+}
+
 } // namespace
 } // namespace Client
 } // namespace Nighthawk
@@ -315,15 +315,16 @@ class IntegrationTestBase():
     assert (client_process.returncode == 0)
     return stdout.decode('utf-8')
 
-  def startNighthawkGrpcService(self, service_name="traffic-generator-service"):
+  def startNighthawkGrpcService(self, service_name="traffic-generator-service", extra_args=None):
     """Start the Nighthawk gRPC service.
 
     Args:
         service_name (String, optional): Service type to start. Defaults to "traffic-generator-service".
+        extra_args (List[String], optional): Additional command line arguments for the service.
     """
     host = self.server_ip if self.ip_version == IpVersion.IPV4 else "[%s]" % self.server_ip
     self.grpc_service = NighthawkGrpcService(self._nighthawk_service_path, host, self.ip_version,
-                                             service_name)
+                                             service_name, extra_args)
     assert (self.grpc_service.start())
 
 
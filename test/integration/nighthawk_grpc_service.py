@@ -28,7 +28,8 @@ class NighthawkGrpcService(object):
                server_binary_path,
                server_ip,
                ip_version,
-               service_name="traffic-generator-service"):
+               service_name="traffic-generator-service",
+               extra_args=None):
     """Initialize the Nighthawk gRPC service.
 
     Args:
@@ -36,6 +37,7 @@ class NighthawkGrpcService(object):
     server_ip: IP address, indicates which ip address should be used by the gRPC service listener.
     ip_version: IP Version, indicates if IPv4 or IPv6 should be used.
     service_name: The Nighthawk service to run.
+    extra_args: Optional list of additional command line arguments to pass to the service.
     ...
     """
     assert ip_version != IpVersion.UNKNOWN
@@ -49,6 +51,7 @@ class NighthawkGrpcService(object):
     self._server_thread = threading.Thread(target=self._serverThreadRunner)
     self._address_file = None
     self._service_name = service_name
+    self._extra_args = extra_args if extra_args is not None else []
 
   def _serverThreadRunner(self):
     with tempfile.NamedTemporaryFile(mode="w", delete=False, suffix=".tmp") as tmp:
@@ -56,7 +59,7 @@ class NighthawkGrpcService(object):
       args = [
           self._server_binary_path, "--listener-address-file", self._address_file, "--listen",
           "%s:0" % str(self.server_ip), "--service", self._service_name
-      ]
+      ] + self._extra_args
       logging.info("Nighthawk grpc service popen() args: [%s]" % args)
       self._server_process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
       _, stderr = self._server_process.communicate()
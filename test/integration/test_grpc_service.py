@@ -21,6 +21,21 @@ def test_grpc_service_happy_flow(http_test_server_fixture):
   asserts.assertEqual(counters["requestsource.internal.upstream_rq_200"], 1)
 
 
+def test_grpc_service_unbatched_happy_flow(http_test_server_fixture):
+  """Test that the remote request source works against a service that does not batch responses."""
+  http_test_server_fixture.startNighthawkGrpcService(
+      "dummy-request-source", ["--request-source-max-batch-size", "1"])
+  parsed_json, _ = http_test_server_fixture.runNighthawkClient([
+      "--termination-predicate", "benchmark.http_2xx:5", "--rps 10",
+      "--request-source %s:%s" % (http_test_server_fixture.grpc_service.server_ip,
+                                  http_test_server_fixture.grpc_service.server_port),
+      http_test_server_fixture.getTestServerRootUri()
+  ])
+  counters = http_test_server_fixture.getNighthawkCounterMapFromJson(parsed_json)
+  asserts.assertGreaterEqual(counters["benchmark.http_2xx"], 5)
+  asserts.assertEqual(counters["requestsource.internal.upstream_rq_200"], 1)
+
+
 def test_grpc_service_down(http_test_server_fixture):
   """Test that the gRPC service detects that a test server is down."""
   parsed_json, _ = http_test_server_fixture.runNighthawkClient([
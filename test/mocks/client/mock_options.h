@@ -62,6 +62,17 @@ public:
               requestSourcePluginConfig, (), (const, override));
   MOCK_METHOD(std::optional<envoy::config::core::v3::TypedExtensionConfig>&,
               rateLimiterPluginConfig, (), (const, override));
+  MOCK_METHOD(uint32_t, sharedRequestSourceCapacity, (), (const, override));
+  MOCK_METHOD(uint32_t, progressReportInterval, (), (const, override));
+  MOCK_METHOD(nighthawk::client::HistogramEncoding::HistogramEncodingOptions, histogramEncoding,
+              (), (const, override));
+  MOCK_METHOD(std::vector<uint32_t>, workerCpus, (), (const, override));
+  MOCK_METHOD(std::optional<uint32_t>, flushWorkerCpu, (), (const, override));
+  MOCK_METHOD(bool, numaLocalAllocation, (), (const, override));
+  MOCK_METHOD(std::string, requestEventLog, (), (const, override));
+  MOCK_METHOD(uint32_t, timeSliceInterval, (), (const, override));
+  MOCK_METHOD(HdrHistogramConfigMap, hdrHistogramConfigs, (), (const, override));
+  MOCK_METHOD(StatisticBackendMap, statisticBackends, (), (const, override));
   MOCK_METHOD(std::string, trace, (), (const, override));
   MOCK_METHOD(nighthawk::client::H1ConnectionReuseStrategy::H1ConnectionReuseStrategyOptions,
               h1ConnectionReuseStrategy, (), (const, override));
@@ -76,6 +87,9 @@ public:
               (const, override));
   MOCK_METHOD(std::string, multiTargetPath, (), (const, override));
   MOCK_METHOD(bool, multiTargetUseHttps, (), (const, override));
+  MOCK_METHOD(nighthawk::client::MultiTargetLbPolicy::MultiTargetLbPolicyOptions,
+              multiTargetLbPolicy, (), (const, override));
+  MOCK_METHOD(std::string, multiTargetHashHeader, (), (const, override));
   MOCK_METHOD(std::vector<std::string>, labels, (), (const, override));
   MOCK_METHOD(bool, simpleWarmup, (), (const, override));
   MOCK_METHOD(bool, noDuration, (), (const, override));
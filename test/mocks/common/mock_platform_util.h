@@ -12,6 +12,7 @@ public:
 
   MOCK_METHOD(void, yieldCurrentThread, (), (const, override));
   MOCK_METHOD(void, sleep, (std::chrono::microseconds), (const, override));
+  MOCK_METHOD(std::chrono::nanoseconds, currentThreadCpuTime, (), (const, override));
 };
 
 } // namespace Nighthawk
\ No newline at end of file
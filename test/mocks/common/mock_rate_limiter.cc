@@ -2,7 +2,16 @@
 
 namespace Nighthawk {
 
-MockRateLimiter::MockRateLimiter() = default;
+MockRateLimiter::MockRateLimiter() {
+  // Bulk acquisitions are driven by tryAcquireOne() by default, so expectations on it still apply.
+  ON_CALL(*this, tryAcquire).WillByDefault([this](uint64_t max_count) {
+    uint64_t count = 0;
+    while (count < max_count && tryAcquireOne()) {
+      count++;
+    }
+    return count;
+  });
+}
 
 MockDiscreteNumericDistributionSampler::MockDiscreteNumericDistributionSampler() = default;
 
@@ -11,10 +11,14 @@ public:
   MockRateLimiter();
 
   MOCK_METHOD(bool, tryAcquireOne, (), (override));
+  MOCK_METHOD(uint64_t, tryAcquire, (uint64_t), (override));
   MOCK_METHOD(void, releaseOne, (), (override));
   MOCK_METHOD(Envoy::TimeSource&, timeSource, (), (override));
   MOCK_METHOD(std::chrono::nanoseconds, elapsed, (), (override));
   MOCK_METHOD(std::optional<Envoy::SystemTime>, firstAcquisitionTime, (), (const, override));
+  MOCK_METHOD(std::optional<Envoy::MonotonicTime>, scheduledReleaseTime, (uint64_t),
+              (const, override));
+  MOCK_METHOD(std::optional<Envoy::MonotonicTime>, nextReleaseTime, (), (const, override));
 };
 
 class MockDiscreteNumericDistributionSampler : public DiscreteNumericDistributionSampler {
@@ -12,7 +12,7 @@ public:
   MOCK_METHOD(RequestSourcePtr, create,
               (const Envoy::Upstream::ClusterManagerPtr& cluster_manager,
                Envoy::Event::Dispatcher& dispatcher, Envoy::Stats::Scope& scope,
-               absl::string_view service_cluster_name),
+               absl::string_view service_cluster_name, uint32_t worker_number),
               (const, override));
 };
 
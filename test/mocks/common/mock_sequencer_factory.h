@@ -13,7 +13,8 @@ public:
               (Envoy::TimeSource & time_source, Envoy::Event::Dispatcher& dispatcher,
                const SequencerTarget& sequencer_target,
                TerminationPredicatePtr&& termination_predicate, Envoy::Stats::Scope& scope,
-               const Envoy::MonotonicTime scheduled_starting_time, Envoy::Api::Api& api),
+               const Envoy::MonotonicTime scheduled_starting_time, Envoy::Api::Api& api,
+               uint32_t worker_number),
               (const, override));
 };
 
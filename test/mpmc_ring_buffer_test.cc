@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "source/common/mpmc_ring_buffer.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+TEST(MpmcRingBufferTest, CapacityIsRoundedUpToPowerOfTwo) {
+  EXPECT_EQ(MpmcRingBuffer<int>(1).capacity(), 2);
+  EXPECT_EQ(MpmcRingBuffer<int>(5).capacity(), 8);
+  EXPECT_EQ(MpmcRingBuffer<int>(1024).capacity(), 1024);
+}
+
+TEST(MpmcRingBufferTest, PushAndPopInFifoOrderAcrossWrapAround) {
+  MpmcRingBuffer<int> ring(4);
+  int value = 0;
+  EXPECT_FALSE(ring.tryPop(value));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 4; i++) {
+      EXPECT_TRUE(ring.tryPush(round * 4 + i));
+    }
+    EXPECT_FALSE(ring.tryPush(-1));
+    EXPECT_EQ(ring.sizeApprox(), 4);
+    for (int i = 0; i < 4; i++) {
+      ASSERT_TRUE(ring.tryPop(value));
+      EXPECT_EQ(value, round * 4 + i);
+    }
+    EXPECT_FALSE(ring.tryPop(value));
+    EXPECT_EQ(ring.sizeApprox(), 0);
+  }
+}
+
+TEST(MpmcRingBufferTest, FailedPushLeavesValueIntact) {
+  MpmcRingBuffer<std::unique_ptr<int>> ring(2);
+  EXPECT_TRUE(ring.tryPush(std::make_unique<int>(1)));
+  EXPECT_TRUE(ring.tryPush(std::make_unique<int>(3)));
+  auto value = std::make_unique<int>(2);
+  EXPECT_FALSE(ring.tryPush(std::move(value)));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 2);
+  std::unique_ptr<int> popped;
+  ASSERT_TRUE(ring.tryPop(popped));
+  EXPECT_EQ(*popped, 1);
+}
+
+TEST(MpmcRingBufferTest, ConcurrentProducersAndConsumersTransferEachValueOnce) {
+  constexpr uint64_t kProducers = 4;
+  constexpr uint64_t kConsumers = 4;
+  constexpr uint64_t kValuesPerProducer = 100000;
+  MpmcRingBuffer<uint64_t> ring(64);
+  std::vector<std::vector<uint64_t>> consumed(kConsumers);
+  std::atomic<uint64_t> consumed_count{0};
+  std::vector<std::thread> threads;
+  for (uint64_t producer = 0; producer < kProducers; producer++) {
+    threads.emplace_back([&ring, producer]() {
+      for (uint64_t i = 0; i < kValuesPerProducer; i++) {
+        while (!ring.tryPush(producer * kValuesPerProducer + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (uint64_t consumer = 0; consumer < kConsumers; consumer++) {
+    threads.emplace_back([&ring, &consumed, &consumed_count, consumer]() {
+      uint64_t value;
+      while (consumed_count.load() < kProducers * kValuesPerProducer) {
+        if (ring.tryPop(value)) {
+          consumed[consumer].push_back(value);
+          consumed_count++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  std::vector<bool> seen(kProducers * kValuesPerProducer, false);
+  for (const std::vector<uint64_t>& values : consumed) {
+    // Values of a single producer are popped in the order they were pushed.
+    std::vector<int64_t> last_per_producer(kProducers, -1);
+    for (const uint64_t value : values) {
+      ASSERT_LT(value, seen.size());
+      EXPECT_FALSE(seen[value]);
+      seen[value] = true;
+      const uint64_t producer = value / kValuesPerProducer;
+      EXPECT_GT(static_cast<int64_t>(value), last_per_producer[producer]);
+      last_per_producer[producer] = value;
+    }
+  }
+  for (const bool value_seen : seen) {
+    ASSERT_TRUE(value_seen);
+  }
+}
+
+} // namespace
+} // namespace Nighthawk
@@ -209,7 +209,12 @@ TEST_F(OptionsImplTest, AlmostAll) {
       "--max-active-requests 11 --max-requests-per-connection 12 --sequencer-idle-strategy sleep "
       "--termination-predicate t1:1 --termination-predicate t2:2 --failure-predicate f1:1 "
       "--failure-predicate f2:2 --no-default-failure-predicates --jitter-uniform .00001s "
-      "--max-concurrent-streams 42 "
+      "--max-concurrent-streams 42 --shared-request-source-capacity 64 "
+      "--progress-report-interval 3 --histogram-encoding native "
+      "--worker-cpus 0-1,4 --flush-worker-cpu 5 --numa-local-allocation "
+      "--request-event-log requests.nhevlog --time-slice-interval 2 "
+      "--hdr-histogram-config sequencer.blocking:1000000000:3 "
+      "--statistic-backend sequencer.blocking:sketch "
       "--experimental-h1-connection-reuse-strategy lru --label label1 --label label2 {} "
       "--simple-warmup --stats-sinks {} --stats-sinks {} --stats-flush-interval 10 "
       "--latency-response-header-name zz --user-defined-plugin-config {}",
@@ -266,6 +271,23 @@ TEST_F(OptionsImplTest, AlmostAll) {
   EXPECT_TRUE(options->noDefaultFailurePredicates());
   EXPECT_EQ(10us, options->jitterUniform());
   EXPECT_EQ(42, options->maxConcurrentStreams());
+  EXPECT_EQ(64, options->sharedRequestSourceCapacity());
+  EXPECT_EQ(3, options->progressReportInterval());
+  EXPECT_EQ(nighthawk::client::HistogramEncoding::NATIVE, options->histogramEncoding());
+  const std::vector<uint32_t> expected_worker_cpus{0, 1, 4};
+  EXPECT_EQ(expected_worker_cpus, options->workerCpus());
+  EXPECT_EQ(5, options->flushWorkerCpu());
+  EXPECT_TRUE(options->numaLocalAllocation());
+  EXPECT_EQ("requests.nhevlog", options->requestEventLog());
+  EXPECT_EQ(2, options->timeSliceInterval());
+  ASSERT_EQ(1, options->hdrHistogramConfigs().size());
+  const nighthawk::client::HdrHistogramConfig& hdr_histogram_config =
+      options->hdrHistogramConfigs().at("sequencer.blocking");
+  EXPECT_EQ(1000000000, hdr_histogram_config.highest_trackable_value().value());
+  EXPECT_EQ(3, hdr_histogram_config.significant_digits().value());
+  const StatisticBackendMap expected_statistic_backends{
+      {"sequencer.blocking", nighthawk::client::StatisticBackend::SKETCH}};
+  EXPECT_EQ(expected_statistic_backends, options->statisticBackends());
   EXPECT_EQ(nighthawk::client::H1ConnectionReuseStrategy::LRU,
             options->h1ConnectionReuseStrategy());
   const std::vector<std::string> expected_labels{"label1", "label2"};
@@ -354,6 +376,20 @@ TEST_F(OptionsImplTest, AlmostAll) {
   EXPECT_EQ(1, cmd->mutable_termination_predicates()->erase("t1"));
   EXPECT_EQ(cmd->jitter_uniform().nanos(), options->jitterUniform().count());
   EXPECT_EQ(cmd->max_concurrent_streams().value(), options->maxConcurrentStreams());
+  EXPECT_EQ(cmd->shared_request_source_capacity().value(), options->sharedRequestSourceCapacity());
+  EXPECT_EQ(cmd->progress_report_interval().value(), options->progressReportInterval());
+  EXPECT_EQ(cmd->histogram_encoding().value(), options->histogramEncoding());
+  EXPECT_THAT(cmd->worker_cpus(), ElementsAreArray(expected_worker_cpus));
+  EXPECT_EQ(cmd->flush_worker_cpu().value(), options->flushWorkerCpu());
+  EXPECT_EQ(cmd->numa_local_allocation().value(), options->numaLocalAllocation());
+  EXPECT_EQ(cmd->request_event_log().value(), options->requestEventLog());
+  EXPECT_EQ(cmd->time_slice_interval().value(), options->timeSliceInterval());
+  ASSERT_EQ(1, cmd->hdr_histogram_configs().size());
+  EXPECT_TRUE(util(cmd->hdr_histogram_configs().at("sequencer.blocking"),
+                   options->hdrHistogramConfigs().at("sequencer.blocking")));
+  ASSERT_EQ(1, cmd->statistic_backends().size());
+  EXPECT_EQ(cmd->statistic_backends().at("sequencer.blocking"),
+            options->statisticBackends().at("sequencer.blocking"));
   EXPECT_EQ(cmd->experimental_h1_connection_reuse_strategy().value(),
             options->h1ConnectionReuseStrategy());
   EXPECT_THAT(cmd->labels(), ElementsAreArray(expected_labels));
@@ -494,6 +530,58 @@ TEST_F(OptionsImplTest, InLineOptionsListRequestSourcePluginIsMutuallyExclusiveW
       "--request-source and --request_source_plugin_config cannot both be set.");
 }
 
+TEST_F(OptionsImplTest, HdrHistogramConfigs) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(fmt::format(
+      "{} --hdr-histogram-config *:2000000000:2 "
+      "--hdr-histogram-config benchmark_http_client.request_to_response.endpoint.[::1]:80:10:5 {}",
+      client_name_, good_test_uri_));
+  const HdrHistogramConfigMap configs = options->hdrHistogramConfigs();
+  ASSERT_EQ(2, configs.size());
+  EXPECT_EQ(2000000000, configs.at("*").highest_trackable_value().value());
+  EXPECT_EQ(2, configs.at("*").significant_digits().value());
+  // Ids may contain ':'.
+  const nighthawk::client::HdrHistogramConfig& endpoint =
+      configs.at("benchmark_http_client.request_to_response.endpoint.[::1]:80");
+  EXPECT_EQ(10, endpoint.highest_trackable_value().value());
+  EXPECT_EQ(5, endpoint.significant_digits().value());
+
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --hdr-histogram-config sequencer.blocking:3 {}", client_name_, good_test_uri_)),
+      MalformedArgvException, "--hdr-histogram-config must be in the format");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format("{} --hdr-histogram-config *:x:3 {}",
+                                                 client_name_, good_test_uri_)),
+      MalformedArgvException, "--hdr-histogram-config must be in the format");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format("{} --hdr-histogram-config *:1000:6 {}",
+                                                 client_name_, good_test_uri_)),
+      MalformedArgvException, "significant_digits");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format("{} --hdr-histogram-config *:1:3 {}",
+                                                 client_name_, good_test_uri_)),
+      MalformedArgvException, "highest_trackable_value");
+}
+
+TEST_F(OptionsImplTest, StatisticBackends) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(fmt::format(
+      "{} --statistic-backend *:NONE --statistic-backend "
+      "benchmark_http_client.request_to_response.endpoint.[::1]:80:circllhist {}",
+      client_name_, good_test_uri_));
+  const StatisticBackendMap expected{
+      {"*", nighthawk::client::StatisticBackend::NONE},
+      {"benchmark_http_client.request_to_response.endpoint.[::1]:80",
+       nighthawk::client::StatisticBackend::CIRCLLHIST}};
+  EXPECT_EQ(expected, options->statisticBackends());
+
+  for (const std::string& bad : {"sketch", "*:default", "*:bogus"}) {
+    EXPECT_THROW_WITH_REGEX(
+        TestUtility::createOptionsImpl(
+            fmt::format("{} --statistic-backend {} {}", client_name_, bad, good_test_uri_)),
+        MalformedArgvException, "--statistic-backend must be in the format");
+  }
+}
+
 TEST_F(OptionsImplTest, BadRequestSourcePluginSpecification) {
   // Bad JSON
   EXPECT_THROW_WITH_REGEX(
@@ -1214,7 +1302,42 @@ TEST_P(OptionsImplSequencerIdleStrategyTest, SequencerIdleStrategyValues) {
 }
 
 INSTANTIATE_TEST_SUITE_P(SequencerIdleStrategyOptionsTest, OptionsImplSequencerIdleStrategyTest,
-                         Values("sleep", "poll", "spin"));
+                         Values("sleep", "poll", "spin", "timer"));
+
+class OptionsImplHistogramEncodingTest : public OptionsImplTest,
+                                        public WithParamInterface<const char*> {};
+
+// Test we accept all possible --histogram-encoding values.
+TEST_P(OptionsImplHistogramEncodingTest, HistogramEncodingValues) {
+  TestUtility::createOptionsImpl(
+      fmt::format("{} --histogram-encoding {} {}", client_name_, GetParam(), good_test_uri_));
+}
+
+INSTANTIATE_TEST_SUITE_P(HistogramEncodingOptionsTest, OptionsImplHistogramEncodingTest,
+                         Values("percentiles", "native", "percentiles_and_native"));
+
+// Test we don't accept any bad --histogram-encoding values.
+TEST_F(OptionsImplTest, HistogramEncodingValuesAreConstrained) {
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} {} --histogram-encoding foo", client_name_, good_test_uri_)),
+                          MalformedArgvException, "--histogram-encoding");
+}
+
+// Test we reject malformed --worker-cpus values.
+TEST_F(OptionsImplTest, WorkerCpusMustBeACpuList) {
+  for (const char* worker_cpus : {"foo", "3-1", "0,,2", "1024"}) {
+    EXPECT_THROW_WITH_REGEX(
+        TestUtility::createOptionsImpl(fmt::format("{} {} --worker-cpus {}", client_name_,
+                                                   good_test_uri_, worker_cpus)),
+        MalformedArgvException, "--worker-cpus");
+  }
+}
+
+TEST_F(OptionsImplTest, NumaLocalAllocationRequiresWorkerCpus) {
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} {} --numa-local-allocation", client_name_, good_test_uri_)),
+                          MalformedArgvException, "--numa-local-allocation requires --worker-cpus");
+}
 
 // Test we don't accept any bad -sequencer-idle-strategy values.
 TEST_F(OptionsImplTest, SequencerIdleStrategyValuesAreConstrained) {
@@ -1235,6 +1358,56 @@ TEST_F(OptionsImplTest, RequestHeaderValueWithColonsAndSpaces) {
   verifyHeaderOptionParse(":authority: baz", ":authority", "baz");
 }
 
+TEST_F(OptionsImplTest, MultiTargetLoadBalancing) {
+  std::unique_ptr<OptionsImpl> options = TestUtility::createOptionsImpl(
+      fmt::format("{} --multi-target-endpoint 1.1.1.1:3@5 "
+                  "--multi-target-endpoint [::1]:5 "
+                  "--multi-target-path /x/y/z --multi-target-lb-policy maglev "
+                  "--multi-target-hash-header x-user",
+                  client_name_));
+
+  EXPECT_EQ(nighthawk::client::MultiTargetLbPolicy::MAGLEV, options->multiTargetLbPolicy());
+  EXPECT_EQ("x-user", options->multiTargetHashHeader());
+  ASSERT_EQ(2, options->multiTargetEndpoints().size());
+  EXPECT_EQ("1.1.1.1", options->multiTargetEndpoints()[0].address().value());
+  EXPECT_EQ(3, options->multiTargetEndpoints()[0].port().value());
+  EXPECT_EQ(5, options->multiTargetEndpoints()[0].weight().value());
+  EXPECT_EQ("[::1]", options->multiTargetEndpoints()[1].address().value());
+  EXPECT_FALSE(options->multiTargetEndpoints()[1].has_weight());
+
+  CommandLineOptionsPtr cmd = options->toCommandLineOptions();
+  EXPECT_EQ(nighthawk::client::MultiTargetLbPolicy::MAGLEV,
+            cmd->multi_target().lb_policy().value());
+  EXPECT_EQ("x-user", cmd->multi_target().hash_header().value());
+  EXPECT_EQ(5, cmd->multi_target().endpoints(0).weight().value());
+
+  OptionsImpl options_from_proto(*cmd);
+  EXPECT_EQ(nighthawk::client::MultiTargetLbPolicy::MAGLEV,
+            options_from_proto.multiTargetLbPolicy());
+  EXPECT_EQ("x-user", options_from_proto.multiTargetHashHeader());
+  EXPECT_EQ(5, options_from_proto.multiTargetEndpoints()[0].weight().value());
+}
+
+TEST_F(OptionsImplTest, MultiTargetHashHeaderOnlyWithHashingPolicies) {
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --multi-target-path /x/y/z --multi-target-endpoint 1.2.3.4:5 "
+                      "--multi-target-lb-policy ring_hash",
+                      client_name_)),
+      MalformedArgvException, "--multi-target-hash-header is required with");
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(
+          fmt::format("{} --multi-target-path /x/y/z --multi-target-endpoint 1.2.3.4:5 "
+                      "--multi-target-lb-policy least_request --multi-target-hash-header x-user",
+                      client_name_)),
+      MalformedArgvException, "--multi-target-hash-header is required with");
+  EXPECT_THROW_WITH_REGEX(TestUtility::createOptionsImpl(fmt::format(
+                              "{} --multi-target-hash-header x-user {}", client_name_,
+                              good_test_uri_)),
+                          MalformedArgvException,
+                          "URI and --multi-target-\\* options cannot both be specified.");
+}
+
 TEST_F(OptionsImplTest, MultiTargetEndpointMalformed) {
   EXPECT_THROW_WITH_REGEX(
       TestUtility::createOptionsImpl(fmt::format(
@@ -1270,6 +1443,16 @@ TEST_F(OptionsImplTest, MultiTargetEndpointMalformed) {
       TestUtility::createOptionsImpl(
           fmt::format("{} --multi-target-path /x/y/z --multi-target-endpoint :", client_name_)),
       MalformedArgvException, "must be in the format");
+
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --multi-target-path /x/y/z --multi-target-endpoint 1.1.1.1:3@0", client_name_)),
+      MalformedArgvException, "weight must be a positive integer");
+
+  EXPECT_THROW_WITH_REGEX(
+      TestUtility::createOptionsImpl(fmt::format(
+          "{} --multi-target-path /x/y/z --multi-target-endpoint 1.1.1.1:3@x", client_name_)),
+      MalformedArgvException, "weight must be a positive integer");
 }
 
 TEST_F(OptionsImplTest, BothUriAndMultiTargetSpecified) {
@@ -1,7 +1,10 @@
+#include <google/protobuf/util/time_util.h>
+
 #include "external/envoy/test/test_common/simulated_time_system.h"
 
 #include "source/client/options_impl.h"
 #include "source/client/output_collector_impl.h"
+#include "source/common/statistic_impl.h"
 
 #include "test/client/utility.h"
 #include "test/test_common/proto_matchers.h"
@@ -16,6 +19,7 @@ namespace Client {
 namespace {
 
 using ::Envoy::Protobuf::TextFormat;
+using ::Envoy::Protobuf::util::TimeUtil;
 using ::nighthawk::client::UserDefinedOutput;
 
 class OutputCollectorTest : public Test, public Envoy::Event::TestUsingSimulatedTime {
@@ -80,6 +84,84 @@ TEST_F(OutputCollectorTest, AddResultWorksWithNoUserDefinedOutputs) {
   EXPECT_EQ(full_output.results(0).user_defined_outputs_size(), 0);
 }
 
+TEST_F(OutputCollectorTest, NativeHistogramEncodingReplacesPercentiles) {
+  std::unique_ptr<OptionsImpl> options =
+      TestUtility::createOptionsImpl("foo --histogram-encoding native https://unresolved.host/");
+  OutputCollectorImpl collector(simTime(), *options);
+  std::vector<StatisticPtr> statistics;
+  statistics.push_back(std::make_unique<HdrStatistic>());
+  statistics.back()->setId("latency");
+  statistics.back()->addValue(1000);
+  statistics.back()->addValue(2000);
+  statistics.push_back(std::make_unique<StreamingStatistic>());
+  statistics.back()->setId("streaming");
+  statistics.back()->addValue(1000);
+  collector.addResult("global", statistics, {}, std::chrono::nanoseconds::zero(), std::nullopt,
+                      {});
+
+  nighthawk::client::Output output = collector.toProto();
+  ASSERT_EQ(output.results(0).statistics_size(), 2);
+  const nighthawk::client::Statistic& latency = output.results(0).statistics(0);
+  EXPECT_FALSE(latency.hdr_histogram().empty());
+  EXPECT_EQ(latency.percentiles_size(), 0);
+  EXPECT_EQ(latency.count(), 2);
+  // Only HdrHistogram backed statistics have a native encoding.
+  EXPECT_TRUE(output.results(0).statistics(1).hdr_histogram().empty());
+  absl::StatusOr<std::unique_ptr<HdrStatistic>> decoded = HdrStatistic::fromProto(latency);
+  ASSERT_TRUE(decoded.ok());
+  EXPECT_EQ((*decoded)->count(), 2);
+}
+
+TEST_F(OutputCollectorTest, PercentilesAreTheDefaultHistogramEncoding) {
+  std::unique_ptr<OptionsImpl> options =
+      TestUtility::createOptionsImpl("foo https://unresolved.host/");
+  OutputCollectorImpl collector(simTime(), *options);
+  std::vector<StatisticPtr> statistics;
+  statistics.push_back(std::make_unique<HdrStatistic>());
+  statistics.back()->addValue(1000);
+  collector.addResult("global", statistics, {}, std::chrono::nanoseconds::zero(), std::nullopt,
+                      {});
+
+  const nighthawk::client::Output output = collector.toProto();
+  const nighthawk::client::Statistic& statistic = output.results(0).statistics(0);
+  EXPECT_TRUE(statistic.hdr_histogram().empty());
+  EXPECT_GT(statistic.percentiles_size(), 0);
+}
+
+TEST_F(OutputCollectorTest, TimeSlicesAttachToTheirResult) {
+  std::unique_ptr<OptionsImpl> options =
+      TestUtility::createOptionsImpl("foo --histogram-encoding native https://unresolved.host/");
+  OutputCollectorImpl collector(simTime(), *options);
+  std::vector<StatisticPtr> statistics;
+  statistics.push_back(std::make_unique<HdrStatistic>());
+  statistics.back()->setId("latency");
+  statistics.back()->addValue(1000);
+  const Envoy::SystemTime start(10s);
+  // A slice added ahead of its result is kept until the result is added.
+  collector.addTimeSlice("global", start, 1s, statistics, {{"requests", 1}});
+  collector.addResult("worker_0", {}, {}, std::chrono::nanoseconds::zero(), std::nullopt, {});
+  collector.addResult("global", {}, {}, std::chrono::nanoseconds::zero(), std::nullopt, {});
+  collector.addTimeSlice("global", start + 1s, 1s, {}, {});
+
+  const nighthawk::client::Output output = collector.toProto();
+  ASSERT_EQ(output.results_size(), 2);
+  EXPECT_EQ(output.results(0).time_slices_size(), 0);
+  const nighthawk::client::Result& global = output.results(1);
+  ASSERT_EQ(global.time_slices_size(), 2);
+  const nighthawk::client::TimeSlice& first = global.time_slices(0);
+  EXPECT_EQ(TimeUtil::TimestampToSeconds(first.start()), 10);
+  EXPECT_EQ(TimeUtil::DurationToSeconds(first.duration()), 1);
+  ASSERT_EQ(first.statistics_size(), 1);
+  EXPECT_EQ(first.statistics(0).id(), "latency");
+  EXPECT_EQ(first.statistics(0).count(), 1);
+  // Slices follow the histogram encoding option, like the statistics of the result.
+  EXPECT_FALSE(first.statistics(0).hdr_histogram().empty());
+  ASSERT_EQ(first.counters_size(), 1);
+  EXPECT_EQ(first.counters(0).name(), "requests");
+  EXPECT_EQ(first.counters(0).value(), 1);
+  EXPECT_EQ(TimeUtil::TimestampToSeconds(global.time_slices(1).start()), 11);
+}
+
 } // namespace
 } // namespace Client
 } // namespace Nighthawk
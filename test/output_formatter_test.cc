@@ -1,4 +1,7 @@
 #include <chrono>
+#include <memory>
+#include <sstream>
+#include <vector>
 
 #include "nighthawk/common/exception.h"
 
@@ -112,6 +115,21 @@ TEST_F(OutputCollectorTest, CliFormatter) {
                         "test/test_data/output_formatter.txt.gold");
 }
 
+TEST_F(OutputCollectorTest, CliFormatterShowsDroppedValues) {
+  nighthawk::client::Output output = collector_->toProto();
+  for (nighthawk::client::Result& result : *output.mutable_results()) {
+    if (result.name() == "global") {
+      result.mutable_statistics(2)->set_dropped_count(3);
+    }
+  }
+  ConsoleOutputFormatterImpl formatter;
+  absl::StatusOr<std::string> formatted = formatter.formatProto(output);
+  ASSERT_TRUE(formatted.ok());
+  EXPECT_THAT(*formatted, HasSubstr("dropped: 3 (above the histogram range)"));
+  // Nothing is shown for statistics without dropped values.
+  EXPECT_THAT(*formatter.formatProto(collector_->toProto()), Not(HasSubstr("dropped:")));
+}
+
 TEST_F(OutputCollectorTest, JsonFormatter) {
   JsonOutputFormatterImpl formatter;
   EXPECT_EQ((formatter.formatProto(collector_->toProto())).ok(), true);
@@ -152,6 +170,46 @@ TEST_F(OutputCollectorTest, PrometheusFormatter) {
                         "test/test_data/output_formatter.prometheus.gold");
 }
 
+TEST_F(OutputCollectorTest, StreamedOutputMatchesFormattedString) {
+  const nighthawk::client::Output output = collector_->toProto();
+  std::vector<std::unique_ptr<OutputFormatterImpl>> formatters;
+  formatters.push_back(std::make_unique<ConsoleOutputFormatterImpl>());
+  formatters.push_back(std::make_unique<JsonOutputFormatterImpl>());
+  formatters.push_back(std::make_unique<YamlOutputFormatterImpl>());
+  formatters.push_back(std::make_unique<DottedStringOutputFormatterImpl>());
+  formatters.push_back(std::make_unique<CsvOutputFormatterImpl>());
+  formatters.push_back(std::make_unique<PrometheusOutputFormatterImpl>());
+  for (const auto& formatter : formatters) {
+    std::ostringstream stream;
+    ASSERT_TRUE(formatter->formatProtoToStream(output, stream).ok());
+    EXPECT_EQ(stream.str(), formatter->formatProto(output).value());
+  }
+}
+
+TEST_F(OutputCollectorTest, StreamedJsonMatchesJsonString) {
+  const nighthawk::client::Output output = collector_->toProto();
+  JsonOutputFormatterImpl formatter;
+  std::ostringstream stream;
+  ASSERT_TRUE(formatter.formatProtoToStream(output, stream).ok());
+  EXPECT_EQ(stream.str(), Envoy::MessageUtil::getJsonStringFromMessage(output, true, true).value());
+}
+
+TEST_F(OutputCollectorTest, FailedFormattingWritesNothing) {
+  nighthawk::client::Output output = collector_->toProto();
+  // An Any holding a type that is not known can't be converted to json.
+  Envoy::Protobuf::Any* any =
+      output.mutable_options()->mutable_request_source_plugin_config()->mutable_typed_config();
+  any->set_type_url("type.googleapis.com/unknown.Type");
+  any->set_value("not a message");
+  std::ostringstream stream;
+  EXPECT_FALSE(JsonOutputFormatterImpl().formatProtoToStream(output, stream).ok());
+  EXPECT_EQ(stream.str(), "");
+  // Without a global result, there is nothing to render the fortio output from.
+  output.clear_results();
+  EXPECT_FALSE(FortioOutputFormatterImpl().formatProtoToStream(output, stream).ok());
+  EXPECT_EQ(stream.str(), "");
+}
+
 TEST_F(OutputCollectorTest, GetLowerCaseOutputFormats) {
   auto output_formats = OutputFormatterImpl::getLowerCaseOutputFormats();
   // When you're looking at this code you probably just added an output format.
@@ -283,6 +341,7 @@ TEST_F(StatidToNameTest, TestTranslations) {
                                         "benchmark_http_client.response_body_size",
                                         "benchmark_http_client.response_header_size",
                                         "sequencer.callback",
+                                        "sequencer.intended_callback",
                                         "sequencer.blocking"};
   for (const std::string& id : ids) {
     EXPECT_NE(ConsoleOutputFormatterImpl::statIdtoFriendlyStatName(id), id);
@@ -302,6 +361,29 @@ TEST_F(MediumOutputCollectorTest, FortioPedanticFormatter) {
   EXPECT_THAT(output_proto, EqualsProto(expected_output_proto));
 }
 
+TEST_F(MediumOutputCollectorTest, FortioPedanticFormatterUsesFortioNumberFormats) {
+  const nighthawk::client::Output input_proto =
+      loadProtoFromFile("test/test_data/output_formatter.medium.proto.gold");
+  FortioPedanticOutputFormatterImpl formatter;
+  const std::string pedantic_json = formatter.formatProto(input_proto).value();
+  EXPECT_THAT(pedantic_json, HasSubstr("\"RequestedQPS\": \"30\","));
+  EXPECT_THAT(pedantic_json, HasSubstr("\"Count\": 53,"));
+  EXPECT_THAT(pedantic_json, HasSubstr("\"200\": 56"));
+  EXPECT_THAT(pedantic_json, HasSubstr("\"BytesSent\": 3528,"));
+  EXPECT_THAT(pedantic_json, HasSubstr("\"Percent\": 55.000000000000007,"));
+  EXPECT_THAT(pedantic_json, Not(HasSubstr("\"Count\": \"")));
+
+  // Apart from the number formats, the output is the same as that of the Fortio formatter.
+  FortioOutputFormatterImpl fortio_formatter;
+  nighthawk::client::FortioResult pedantic_result, fortio_result;
+  Envoy::MessageUtil::loadFromJson(pedantic_json, pedantic_result,
+                                   Envoy::ProtobufMessage::getStrictValidationVisitor());
+  Envoy::MessageUtil::loadFromJson(fortio_formatter.formatProto(input_proto).value(),
+                                   fortio_result,
+                                   Envoy::ProtobufMessage::getStrictValidationVisitor());
+  EXPECT_THAT(pedantic_result, EqualsProto(fortio_result));
+}
+
 TEST_F(MediumOutputCollectorTest, FortioPedanticFormatterMissingGlobalResult) {
   nighthawk::client::Output output_proto = collector_->toProto();
   output_proto.clear_results();
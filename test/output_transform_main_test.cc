@@ -1,15 +1,23 @@
+#include <iterator>
+
 #include "nighthawk/common/exception.h"
 
 #include "external/envoy/test/test_common/environment.h"
 #include "external/envoy/test/test_common/network_utility.h"
+#include "external/envoy/test/test_common/simulated_time_system.h"
 #include "external/envoy/test/test_common/utility.h"
 
 #include "api/client/service.pb.h"
 
 #include "source/client/output_formatter_impl.h"
 #include "source/client/output_transform_main.h"
+#include "source/common/request_event_log.h"
+#include "source/common/statistic_impl.h"
+
+#include "test/test_common/environment.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 using namespace testing;
@@ -71,5 +79,119 @@ TEST_F(OutputTransformMainTest, HappyFlowForAllOutputFormats) {
   }
 }
 
+// Statistics that only carry a native encoding are merged exactly, and rendered into percentiles.
+TEST_F(OutputTransformMainTest, MergeResults) {
+  nighthawk::client::Output output;
+  output.mutable_options()->mutable_uri()->set_value("http://127.0.0.1/");
+  for (const uint64_t value : {1, 1000}) {
+    HdrStatistic statistic;
+    statistic.setId("latency");
+    statistic.addValue(value);
+    auto encoding = statistic.serializeNative();
+    ASSERT_TRUE(encoding.ok());
+    nighthawk::client::Result* result = output.add_results();
+    result->set_name(absl::StrCat("worker_", value));
+    nighthawk::client::Statistic* statistic_proto = result->add_statistics();
+    statistic_proto->set_id("latency");
+    statistic_proto->set_hdr_histogram(
+        std::string(std::istreambuf_iterator<char>(**encoding), std::istreambuf_iterator<char>()));
+  }
+  std::vector<const char*> argv = {"foo", "--output-format", "human", "--merge-results"};
+  stream_ << Envoy::MessageUtil::getJsonStringFromMessageOrError(output, true, true);
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  EXPECT_EQ(main.run(), 0);
+}
+
+TEST_F(OutputTransformMainTest, MergeResultsRejectsBadEncoding) {
+  nighthawk::client::Output output;
+  output.mutable_options()->mutable_uri()->set_value("http://127.0.0.1/");
+  nighthawk::client::Statistic* statistic = output.add_results()->add_statistics();
+  statistic->set_id("latency");
+  statistic->set_hdr_histogram("bad");
+  std::vector<const char*> argv = {"foo", "--output-format", "json", "--merge-results"};
+  stream_ << Envoy::MessageUtil::getJsonStringFromMessageOrError(output, true, true);
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+// Writes a request event log holding a successful request which completed 1.5s into the log, and
+// one that failed to obtain a connection 2.5s into it.
+std::string writeRequestEventLog(absl::string_view name) {
+  const std::string path = TestEnvironment::temporaryPath(std::string(name));
+  Envoy::Event::SimulatedTimeSystem time_system;
+  RequestEventLog log(path, 1);
+  EXPECT_TRUE(log.start(Envoy::Thread::threadFactoryForTest(), time_system).ok());
+  const uint64_t origin_ns = time_system.monotonicTime().time_since_epoch().count();
+  RequestEventRecord success{};
+  success.start_ns = origin_ns + 1000000000;
+  success.connect_ns = success.start_ns + 1000;
+  success.first_byte_ns = success.connect_ns + 2000;
+  success.complete_ns = origin_ns + 1500000000;
+  success.connection_id = 3;
+  success.response_code = 200;
+  success.outcome = RequestEventOutcome::Complete;
+  log.producer(0).record(success);
+  RequestEventRecord failure{};
+  failure.start_ns = origin_ns + 2000000000;
+  failure.complete_ns = origin_ns + 2500000000;
+  failure.connection_id = RequestEventLogFormat::kNoConnectionId;
+  failure.request_index = 1;
+  failure.outcome = RequestEventOutcome::PoolFailure;
+  log.producer(0).record(failure);
+  log.stop();
+  return path;
+}
+
+TEST_F(OutputTransformMainTest, RequestEventLogToCsv) {
+  const std::string path = writeRequestEventLog("to_csv.nhevlog");
+  std::vector<const char*> argv = {"foo", "--output-format", "csv", "--request-event-log",
+                                   path.c_str()};
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  testing::internal::CaptureStdout();
+  EXPECT_EQ(main.run(), 0);
+  const std::string csv = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(csv, "worker,request_index,connection_id,start_ns,connect_ns,first_byte_ns,complete_ns,"
+                 "outcome,response_code,request_bytes,response_bytes\n"
+                 "0,0,3,1000000000,1000001000,1000003000,1500000000,complete,200,0,0\n"
+                 "0,1,,2000000000,,,2500000000,pool_failure,0,0,0\n");
+}
+
+TEST_F(OutputTransformMainTest, RequestEventLogToBuckets) {
+  const std::string path = writeRequestEventLog("to_buckets.nhevlog");
+  std::vector<const char*> argv = {"foo",         "--output-format", "json", "--request-event-log",
+                                   path.c_str(), "--bucket-width",  "1000"};
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  testing::internal::CaptureStdout();
+  EXPECT_EQ(main.run(), 0);
+  nighthawk::client::Output output;
+  Envoy::MessageUtil::loadFromJson(testing::internal::GetCapturedStdout(), output,
+                                   Envoy::ProtobufMessage::getStrictValidationVisitor());
+  ASSERT_EQ(output.results_size(), 3);
+  EXPECT_EQ(output.results(0).name(), "bucket_1000ms");
+  EXPECT_EQ(output.results(1).name(), "bucket_2000ms");
+  EXPECT_EQ(output.results(2).name(), "global");
+  // The first bucket holds the successful request, and has latencies.
+  EXPECT_EQ(output.results(0).statistics_size(), 3);
+  EXPECT_EQ(output.results(1).statistics_size(), 0);
+  ASSERT_EQ(output.results(1).counters_size(), 2);
+  EXPECT_EQ(output.results(1).counters(0).name(), "pool_failures");
+  EXPECT_EQ(output.results(2).counters_size(), 3);
+}
+
+TEST_F(OutputTransformMainTest, RequestEventLogRequiresCsvWithoutBuckets) {
+  const std::string path = writeRequestEventLog("requires_csv.nhevlog");
+  std::vector<const char*> argv = {"foo", "--output-format", "json", "--request-event-log",
+                                   path.c_str()};
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+TEST_F(OutputTransformMainTest, RequestEventLogMissing) {
+  std::vector<const char*> argv = {"foo", "--output-format", "csv", "--request-event-log",
+                                   "/nonexistent/log.nhevlog"};
+  OutputTransformMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
 } // namespace Client
 } // namespace Nighthawk
@@ -292,6 +292,44 @@ TEST_P(ProcessTest, RunProcessWithStatsSinkConfigured) {
   EXPECT_GT(numFlushes, 0);
 }
 
+TEST_P(ProcessTest, RecordsTimeSlicesOfTheGlobalResult) {
+  options_ = TestUtility::createOptionsImpl(
+      fmt::format("foo --duration 2 --rps 10 --concurrency 2 --failure-predicate foo:0 "
+                  "--time-slice-interval 1 https://{}/",
+                  loopback_address_));
+  ASSERT_TRUE(runProcess(RunExpectation::EXPECT_SUCCESS).ok());
+  uint64_t connection_failures = 0;
+  for (const nighthawk::client::Result& result : output_proto_.results()) {
+    if (result.name() != "global") {
+      EXPECT_EQ(result.time_slices_size(), 0);
+      continue;
+    }
+    // A 2 second execution spans at least two slices, and the final slice is added after the
+    // workers complete.
+    ASSERT_GE(result.time_slices_size(), 2);
+    for (int i = 0; i < result.time_slices_size(); i++) {
+      const nighthawk::client::TimeSlice& time_slice = result.time_slices(i);
+      EXPECT_EQ(Envoy::Protobuf::util::TimeUtil::DurationToSeconds(time_slice.duration()), 1);
+      EXPECT_EQ(time_slice.start().nanos(), 0);
+      if (i > 0) {
+        EXPECT_EQ(time_slice.start().seconds(), result.time_slices(i - 1).start().seconds() + 1);
+      }
+      for (const nighthawk::client::Counter& counter : time_slice.counters()) {
+        if (counter.name() == "benchmark.pool_connection_failure") {
+          connection_failures += counter.value();
+        }
+      }
+    }
+    // The counter increments of the slices add up to the counter of the result.
+    for (const nighthawk::client::Counter& counter : result.counters()) {
+      if (counter.name() == "benchmark.pool_connection_failure") {
+        EXPECT_EQ(connection_failures, counter.value());
+      }
+    }
+  }
+  EXPECT_GT(connection_failures, 0);
+}
+
 TEST_P(ProcessTest, NoFlushWhenCancelExecutionBeforeLoadTestBegin) {
   FakeStatsSinkFactory factory;
   Envoy::Registry::InjectFactory<NighthawkStatsSinkFactory> registered(factory);
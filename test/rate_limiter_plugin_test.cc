@@ -3,6 +3,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include <chrono>
+#include <fstream>
 #include <string>
 
 #include "envoy/api/api.h"
@@ -13,15 +14,22 @@
 #include "test/mocks/client/mock_options.h"
 
 #include "api/rate_limiter/linear_ramping_rate_limiter.pb.h"
+#include "api/rate_limiter/trace_replay_rate_limiter.pb.h"
+#include "api/request_source/request_source_plugin.pb.h"
 #include "nighthawk/common/rate_limiter.h"
 #include "nighthawk/common/rate_limiter_plugin_config_factory.h"
 #include "source/common/rate_limiter_impl.h"
+#include "source/common/request_trace.h"
 
+#include "test/test_common/environment.h"
 #include "test/test_common/proto_matchers.h"
 
 namespace Nighthawk {
 namespace Client {
 
+using namespace std::chrono_literals;
+using ::nighthawk::request_source::MappedTraceRequestSourceConfig;
+
 class LinearRampingRateLimiterPluginTest : public testing::Test {
 public:
   LinearRampingRateLimiterPluginTest() : api_(Envoy::Api::createApiForTest(stats_store_)) {}
@@ -130,5 +138,140 @@ TEST_F(LinearRampingRateLimiterPluginTest, ZeroRampTimeThrowsException) {
       NighthawkException, "ramp_time must be positive");
 }
 
+class TraceReplayRateLimiterPluginTest : public testing::Test {
+public:
+  TraceReplayRateLimiterPluginTest() : api_(Envoy::Api::createApiForTest(stats_store_)) {}
+
+  // Writes a trace with one record per entry in |start_offsets|, and returns its path.
+  std::string writeTrace(absl::string_view name,
+                         const std::vector<std::chrono::nanoseconds>& start_offsets) {
+    const std::string path = TestEnvironment::temporaryPath(std::string(name));
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    RequestTraceWriter writer(output, /*index_stride=*/2);
+    for (const std::chrono::nanoseconds start_offset : start_offsets) {
+      EXPECT_TRUE(writer.addRecord(nighthawk::client::RequestOptions(), start_offset).ok());
+    }
+    EXPECT_TRUE(writer.finish().ok());
+    return path;
+  }
+
+  RateLimiterPtr createRateLimiter(
+      const std::string& path, std::optional<double> speedup, const WorkerContext& worker_context,
+      MappedTraceRequestSourceConfig::Partitioning partitioning =
+          MappedTraceRequestSourceConfig::CONTIGUOUS) {
+    nighthawk::rate_limiter::TraceReplayRateLimiterConfig config;
+    config.set_file_path(path);
+    if (speedup.has_value()) {
+      config.mutable_speedup()->set_value(*speedup);
+    }
+    config.set_partitioning(partitioning);
+    Envoy::Protobuf::Any config_any;
+    std::ignore = config_any.PackFrom(config);
+    auto& config_factory =
+        Envoy::Config::Utility::getAndCheckFactoryByName<RateLimiterPluginConfigFactory>(
+            plugin_name_);
+    return config_factory.createRateLimiterPluginForWorker(config_any, *api_, time_system_,
+                                                           options_, worker_context);
+  }
+
+  Envoy::Stats::MockIsolatedStatsStore stats_store_;
+  Envoy::Api::ApiPtr api_;
+  Envoy::Event::SimulatedTimeSystem time_system_;
+  testing::NiceMock<MockOptions> options_;
+  const std::string plugin_name_ = "nighthawk.trace-replay-rate-limiter-plugin";
+};
+
+TEST_F(TraceReplayRateLimiterPluginTest, CreateEmptyConfigProtoCreatesCorrectType) {
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RateLimiterPluginConfigFactory>(
+          plugin_name_);
+  const Envoy::ProtobufTypes::MessagePtr empty_config = config_factory.createEmptyConfigProto();
+  const nighthawk::rate_limiter::TraceReplayRateLimiterConfig expected_config;
+  EXPECT_THAT(*empty_config, EqualsProto(expected_config));
+}
+
+TEST_F(TraceReplayRateLimiterPluginTest, MissingTraceThrowsException) {
+  EXPECT_THROW(createRateLimiter(TestEnvironment::temporaryPath("missing.nhtrace"), std::nullopt,
+                                 {}),
+               NighthawkException);
+}
+
+TEST_F(TraceReplayRateLimiterPluginTest, ReleasesWorkerRecordsAtTheirStartOffsets) {
+  const std::string path = writeTrace("trace_replay.nhtrace", {0ms, 1ms, 2ms, 3ms, 4ms, 5ms});
+  // Worker 1 out of 2 is dealt the records at 1ms, 3ms and 5ms.
+  RateLimiterPtr rate_limiter =
+      createRateLimiter(path, std::nullopt, {1, 2}, MappedTraceRequestSourceConfig::STRIDED);
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(1ms);
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(0), start + 1ms);
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(1ms);
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(1ms);
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  // An acquisition that is handed back can be re-acquired right away, and is still due at the same
+  // point in time.
+  rate_limiter->releaseOne();
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(0), start + 3ms);
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  // Overdue records are released right away, at the point in time they were due.
+  time_system_.advanceTimeWait(10ms);
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(0), start + 5ms);
+  // The partition is exhausted.
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(10s);
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+}
+
+TEST_F(TraceReplayRateLimiterPluginTest, PartitionsLikeTheRequestSourceByDefault) {
+  const std::string path = writeTrace("trace_replay_contiguous.nhtrace", {0ms, 1ms, 2ms, 3ms});
+  // Worker 1 out of 2 is dealt the second half of the trace, as the request source would.
+  const RequestTracePartition partition =
+      RequestTracePartition::create(MappedTraceRequestSourceConfig::CONTIGUOUS, 4, {1, 2});
+  EXPECT_EQ(partition.first_record, 2);
+  EXPECT_EQ(partition.record_count, 2);
+  RateLimiterPtr rate_limiter = createRateLimiter(path, std::nullopt, {1, 2});
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  time_system_.advanceTimeWait(10ms);
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 2);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(0), start + 2ms);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(1), start + 3ms);
+
+  // Workers with an empty partition release nothing.
+  rate_limiter = createRateLimiter(path, std::nullopt, {0, 6});
+  time_system_.advanceTimeWait(10ms);
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 0);
+}
+
+TEST_F(TraceReplayRateLimiterPluginTest, BatchReportsScheduledReleaseTimeOfEachRecord) {
+  const std::string path = writeTrace("trace_replay_batch.nhtrace", {1ms, 2ms, 4ms});
+  RateLimiterPtr rate_limiter = createRateLimiter(path, std::nullopt, {});
+  const Envoy::MonotonicTime start = time_system_.monotonicTime();
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 0);
+  time_system_.advanceTimeWait(5ms);
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 3);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(0), start + 1ms);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(1), start + 2ms);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(2), start + 4ms);
+  EXPECT_EQ(rate_limiter->scheduledReleaseTime(3), std::nullopt);
+}
+
+TEST_F(TraceReplayRateLimiterPluginTest, SpeedupCompressesStartOffsets) {
+  const std::string path = writeTrace("trace_replay_speedup.nhtrace", {0ms, 2ms, 4ms});
+  RateLimiterPtr rate_limiter = createRateLimiter(path, 2.0, {});
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(1ms);
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+  time_system_.advanceTimeWait(1ms);
+  EXPECT_TRUE(rate_limiter->tryAcquireOne());
+  EXPECT_FALSE(rate_limiter->tryAcquireOne());
+}
+
 } // namespace Client
 } // namespace Nighthawk
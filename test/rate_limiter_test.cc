@@ -37,6 +37,62 @@ TEST_F(RateLimiterTest, LinearRateLimiterTest) {
   EXPECT_FALSE(rate_limiter.tryAcquireOne());
 }
 
+TEST_F(RateLimiterTest, LinearRateLimiterScheduledReleaseTimeTest) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  LinearRateLimiter rate_limiter(time_system, 10_Hz);
+  const Envoy::MonotonicTime start = time_system.monotonicTime();
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+  EXPECT_EQ(rate_limiter.scheduledReleaseTime(0), std::nullopt);
+  // Fall behind by a second. The acquisitions that were due in the meantime report the points in
+  // time they were due at, not the time they were acquired at.
+  time_system.advanceTimeWait(1s);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(rate_limiter.tryAcquireOne());
+    EXPECT_EQ(rate_limiter.scheduledReleaseTime(0), start + 50ms + i * 100ms);
+  }
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+}
+
+TEST_F(RateLimiterTest, LinearRateLimiterBulkAcquisitionTest) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  LinearRateLimiter rate_limiter(time_system, 10_Hz);
+  const Envoy::MonotonicTime start = time_system.monotonicTime();
+  EXPECT_EQ(rate_limiter.tryAcquire(10), 0);
+  time_system.advanceTimeWait(1s);
+  // Ten acquisitions are due. Each acquisition of a batch reports its own scheduled release time.
+  EXPECT_EQ(rate_limiter.tryAcquire(4), 4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(rate_limiter.scheduledReleaseTime(i), start + 50ms + i * 100ms);
+  }
+  EXPECT_EQ(rate_limiter.scheduledReleaseTime(4), std::nullopt);
+  EXPECT_EQ(rate_limiter.tryAcquire(100), 6);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(rate_limiter.scheduledReleaseTime(i), start + 450ms + i * 100ms);
+  }
+  EXPECT_EQ(rate_limiter.tryAcquire(100), 0);
+  // Failed acquisitions leave the most recent batch in place.
+  EXPECT_EQ(rate_limiter.scheduledReleaseTime(5), start + 950ms);
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+}
+
+TEST_F(RateLimiterTest, LinearRateLimiterNextReleaseTimeTest) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  LinearRateLimiter rate_limiter(time_system, 10_Hz);
+  // Nothing is known before the rate limiter has started.
+  EXPECT_EQ(rate_limiter.nextReleaseTime(), std::nullopt);
+  const Envoy::MonotonicTime start = time_system.monotonicTime();
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+  EXPECT_EQ(rate_limiter.nextReleaseTime(), start + 50ms);
+  time_system.advanceTimeWait(49ms);
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+  time_system.advanceTimeWait(1ms);
+  EXPECT_TRUE(rate_limiter.tryAcquireOne());
+  EXPECT_EQ(rate_limiter.nextReleaseTime(), start + 150ms);
+  // A released acquisition is due again right away.
+  rate_limiter.releaseOne();
+  EXPECT_EQ(rate_limiter.nextReleaseTime(), start + 50ms);
+}
+
 TEST_F(RateLimiterTest, LinearRateLimiterInvalidArgumentTest) {
   Envoy::Event::SimulatedTimeSystem time_system;
   EXPECT_THROW(LinearRateLimiter rate_limiter(time_system, 0_Hz), NighthawkException);
@@ -69,6 +125,25 @@ TEST_F(RateLimiterTest, BurstingRateLimiterTest) {
   EXPECT_FALSE(rate_limiter->tryAcquireOne());
 }
 
+TEST_F(RateLimiterTest, BurstingRateLimiterBulkAcquisitionTest) {
+  const uint64_t burst_size = 3;
+  std::unique_ptr<MockRateLimiter> mock_rate_limiter = std::make_unique<MockRateLimiter>();
+  MockRateLimiter& unsafe_mock_rate_limiter = *mock_rate_limiter;
+  InSequence s;
+
+  EXPECT_CALL(unsafe_mock_rate_limiter, tryAcquireOne)
+      .Times(burst_size)
+      .WillRepeatedly(Return(true));
+  RateLimiterPtr rate_limiter =
+      std::make_unique<BurstingRateLimiter>(std::move(mock_rate_limiter), burst_size);
+
+  // A released burst is drained up to the requested count.
+  EXPECT_EQ(rate_limiter->tryAcquire(2), 2);
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 1);
+  EXPECT_CALL(unsafe_mock_rate_limiter, tryAcquireOne).WillOnce(Return(false));
+  EXPECT_EQ(rate_limiter->tryAcquire(10), 0);
+}
+
 TEST_F(RateLimiterTest, ScheduledStartingRateLimiterTest) {
   Envoy::Event::SimulatedTimeSystem time_system;
   const auto schedule_delay = 10ms;
@@ -106,6 +181,29 @@ TEST_F(RateLimiterTest, ScheduledStartingRateLimiterTest) {
   }
 }
 
+TEST_F(RateLimiterTest, ScheduledStartingRateLimiterNextReleaseTimeTest) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  const Envoy::MonotonicTime scheduled_starting_time = time_system.monotonicTime() + 10ms;
+  std::unique_ptr<MockRateLimiter> mock_rate_limiter = std::make_unique<MockRateLimiter>();
+  MockRateLimiter& unsafe_mock_rate_limiter = *mock_rate_limiter;
+  EXPECT_CALL(unsafe_mock_rate_limiter, timeSource).WillRepeatedly(ReturnRef(time_system));
+  RateLimiterPtr rate_limiter = std::make_unique<ScheduledStartingRateLimiter>(
+      std::move(mock_rate_limiter), scheduled_starting_time);
+  // Nothing is released before the scheduled start, regardless of the wrapped rate limiter.
+  EXPECT_CALL(unsafe_mock_rate_limiter, nextReleaseTime)
+      .WillOnce(Return(std::nullopt))
+      .WillOnce(Return(scheduled_starting_time - 5ms))
+      .WillOnce(Return(scheduled_starting_time + 5ms));
+  EXPECT_EQ(rate_limiter->nextReleaseTime(), scheduled_starting_time);
+  EXPECT_EQ(rate_limiter->nextReleaseTime(), scheduled_starting_time);
+  EXPECT_EQ(rate_limiter->nextReleaseTime(), scheduled_starting_time + 5ms);
+  // Once started, a wrapped rate limiter that has nothing left to release is not masked by the
+  // (by now past) scheduled start.
+  time_system.setMonotonicTime(scheduled_starting_time + 1ms);
+  EXPECT_CALL(unsafe_mock_rate_limiter, nextReleaseTime).WillOnce(Return(std::nullopt));
+  EXPECT_EQ(rate_limiter->nextReleaseTime(), std::nullopt);
+}
+
 TEST_F(RateLimiterTest, ScheduledStartingRateLimiterTestBadArgs) {
   Envoy::Event::SimulatedTimeSystem time_system;
   // Verify we enforce future-only scheduling.
@@ -328,6 +426,26 @@ TEST_F(DistributionSamplingRateLimiterTest, QueuedAcquisitionCorrectReleaseOrder
   EXPECT_EQ(acquisition_timings, input_acquisition_timings_ms);
 }
 
+// When the wrapped rate limiter releases late, the offsets apply to the intended release times, so
+// the lag is reported as part of the scheduled release times.
+TEST_F(DistributionSamplingRateLimiterTest, OffsetsApplyToScheduledReleaseTimes) {
+  const Envoy::MonotonicTime now = time_system_.monotonicTime();
+  EXPECT_CALL(mock_inner_rate_limiter_, tryAcquire(_)).WillOnce(Return(2)).WillOnce(Return(0));
+  EXPECT_CALL(mock_inner_rate_limiter_, scheduledReleaseTime(0)).WillOnce(Return(now - 10ms));
+  EXPECT_CALL(mock_inner_rate_limiter_, scheduledReleaseTime(1)).WillOnce(Return(now - 5ms));
+  EXPECT_CALL(mock_discrete_numeric_distribution_sampler_, getValue)
+      .WillOnce(Return(3e6))
+      .WillOnce(Return(20e6));
+  // The first release was due 7ms ago, the second one is due in 15ms.
+  EXPECT_EQ(rate_limiter_->tryAcquire(10), 1);
+  EXPECT_EQ(rate_limiter_->scheduledReleaseTime(0), now - 7ms);
+  EXPECT_CALL(mock_inner_rate_limiter_, nextReleaseTime).WillOnce(Return(std::nullopt));
+  EXPECT_EQ(rate_limiter_->nextReleaseTime(), now + 15ms);
+  time_system_.setMonotonicTime(now + 15ms);
+  EXPECT_EQ(rate_limiter_->tryAcquire(10), 1);
+  EXPECT_EQ(rate_limiter_->scheduledReleaseTime(0), now + 15ms);
+}
+
 class LinearRampingRateLimiterImplTest : public Test {
 public:
   /**
@@ -406,6 +524,46 @@ TEST_F(LinearRampingRateLimiterImplTest, TimingVerificationTest) {
   checkAcquisitionTimings(40000_Hz, 7s);
 }
 
+TEST_F(LinearRampingRateLimiterImplTest, ScheduledReleaseTimeMatchesAcquisitionTimings) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  LinearRampingRateLimiterImpl rate_limiter(time_system, 5s, 5_Hz);
+  const Envoy::MonotonicTime start = time_system.monotonicTime();
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+  // Acquire everything that was due during the ramp and a second after it, all at once.
+  time_system.advanceTimeWait(6s);
+  std::vector<int64_t> scheduled_offsets;
+  while (rate_limiter.tryAcquireOne()) {
+    scheduled_offsets.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            rate_limiter.scheduledReleaseTime(0).value() - start)
+            .count());
+  }
+  // Matches the timings of TimingVerificationTest, followed by a steady 5Hz.
+  const std::vector<int64_t> expected_offsets = {
+      1000000, 1732050, 2236067, 2645751, 3000000, 3316624, 3605551, 3872983, 4123105,
+      4358898, 4582575, 4795831, 5000000, 5100000, 5300000, 5500000, 5700000, 5900000};
+  ASSERT_EQ(scheduled_offsets.size(), expected_offsets.size());
+  for (size_t i = 0; i < expected_offsets.size(); i++) {
+    EXPECT_NEAR(scheduled_offsets[i], expected_offsets[i], 1);
+  }
+}
+
+TEST_F(LinearRampingRateLimiterImplTest, NextReleaseTimeAnticipatesScheduledReleaseTime) {
+  Envoy::Event::SimulatedTimeSystem time_system;
+  LinearRampingRateLimiterImpl rate_limiter(time_system, 5s, 5_Hz);
+  EXPECT_FALSE(rate_limiter.tryAcquireOne());
+  for (int i = 0; i < 20; i++) {
+    const std::optional<Envoy::MonotonicTime> next_release_time = rate_limiter.nextReleaseTime();
+    ASSERT_TRUE(next_release_time.has_value());
+    // Just ahead of the announced release nothing is acquired yet, just after it we acquire.
+    time_system.setMonotonicTime(next_release_time.value() - 1us);
+    EXPECT_FALSE(rate_limiter.tryAcquireOne());
+    time_system.setMonotonicTime(next_release_time.value() + 1us);
+    EXPECT_TRUE(rate_limiter.tryAcquireOne());
+    EXPECT_EQ(rate_limiter.scheduledReleaseTime(0), next_release_time);
+  }
+}
+
 TEST_F(LinearRampingRateLimiterImplTest, ExtendedDurationGivesCorrectTotalRequests) {
   Envoy::Event::SimulatedTimeSystem time_system;
   const unsigned int ramp_time_sec = 5;
@@ -0,0 +1,138 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "external/envoy/test/test_common/simulated_time_system.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "source/common/request_event_log.h"
+
+#include "test/test_common/environment.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+using ::testing::Test;
+
+RequestEventRecord makeRecord(uint64_t start_ns, uint16_t response_code) {
+  RequestEventRecord record{};
+  record.start_ns = start_ns;
+  record.connect_ns = start_ns + 10;
+  record.first_byte_ns = start_ns + 20;
+  record.complete_ns = start_ns + 30;
+  record.connection_id = 7;
+  record.response_code = response_code;
+  record.outcome = RequestEventOutcome::Complete;
+  return record;
+}
+
+std::vector<RequestEventRecord> readAll(const std::string& path,
+                                        RequestEventLogFileHeader& header) {
+  std::ifstream input(path, std::ios::in | std::ios::binary);
+  RequestEventLogReader reader(input);
+  EXPECT_TRUE(reader.readHeader().ok());
+  header = reader.header();
+  std::vector<RequestEventRecord> records;
+  RequestEventRecord record;
+  for (;;) {
+    absl::StatusOr<bool> next = reader.next(record);
+    EXPECT_TRUE(next.ok());
+    if (!next.ok() || !*next) {
+      break;
+    }
+    records.push_back(record);
+  }
+  return records;
+}
+
+class RequestEventLogTest : public Test {
+public:
+  Envoy::Event::SimulatedTimeSystem time_system_;
+};
+
+TEST_F(RequestEventLogTest, WritesRecordsOfAllWorkers) {
+  const std::string path = TestEnvironment::temporaryPath("all_workers.nhevlog");
+  time_system_.setMonotonicTime(Envoy::MonotonicTime(std::chrono::seconds(1)));
+  RequestEventLog log(path, 2);
+  ASSERT_TRUE(log.start(Envoy::Thread::threadFactoryForTest(), time_system_).ok());
+  for (uint32_t worker_id = 0; worker_id < 2; worker_id++) {
+    RequestEventLogProducer& producer = log.producer(worker_id);
+    for (uint16_t i = 0; i < 3; i++) {
+      RequestEventRecord record = makeRecord(1000 * i, 200 + i);
+      record.request_index = producer.nextRequestIndex();
+      producer.record(record);
+    }
+  }
+  log.stop();
+  EXPECT_EQ(6, log.recordsWritten());
+  EXPECT_EQ(0, log.recordsDropped());
+
+  RequestEventLogFileHeader header;
+  const std::vector<RequestEventRecord> records = readAll(path, header);
+  EXPECT_EQ(1000000000, header.monotonic_origin_ns);
+  ASSERT_EQ(6, records.size());
+  // Records of a worker keep their order.
+  std::vector<uint64_t> next_index(2, 0);
+  for (const RequestEventRecord& record : records) {
+    ASSERT_LT(record.worker_id, 2);
+    EXPECT_EQ(next_index[record.worker_id], record.request_index);
+    EXPECT_EQ(1000 * record.request_index, record.start_ns);
+    EXPECT_EQ(200 + record.request_index, record.response_code);
+    EXPECT_EQ(7, record.connection_id);
+    next_index[record.worker_id]++;
+  }
+}
+
+TEST_F(RequestEventLogTest, DropsRecordsWhenTheRingIsFull) {
+  const std::string path = TestEnvironment::temporaryPath("full_ring.nhevlog");
+  RequestEventLog log(path, 1, 2);
+  // Without a writer thread nothing drains the ring.
+  RequestEventLogProducer& producer = log.producer(0);
+  for (uint64_t i = 0; i < 5; i++) {
+    RequestEventRecord record = makeRecord(i, 200);
+    producer.record(record);
+  }
+  EXPECT_EQ(3, producer.dropped());
+  EXPECT_EQ(3, log.recordsDropped());
+  ASSERT_TRUE(log.start(Envoy::Thread::threadFactoryForTest(), time_system_).ok());
+  log.stop();
+  EXPECT_EQ(2, log.recordsWritten());
+}
+
+TEST_F(RequestEventLogTest, StartFailsOnUnwritablePath) {
+  RequestEventLog log("/nonexistent/directory/log.nhevlog", 1);
+  EXPECT_FALSE(log.start(Envoy::Thread::threadFactoryForTest(), time_system_).ok());
+  log.stop();
+}
+
+TEST_F(RequestEventLogTest, ReaderRejectsBadInput) {
+  std::stringstream empty;
+  EXPECT_FALSE(RequestEventLogReader(empty).readHeader().ok());
+
+  std::stringstream bad_magic(std::string(sizeof(RequestEventLogFileHeader), 'x'));
+  EXPECT_FALSE(RequestEventLogReader(bad_magic).readHeader().ok());
+
+  RequestEventLogFileHeader header{};
+  memcpy(header.magic, RequestEventLogFormat::kMagic.data(), sizeof(header.magic));
+  header.version = RequestEventLogFormat::kVersion;
+  header.record_size = sizeof(RequestEventRecord);
+  std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+  // Half a record.
+  data.append(sizeof(RequestEventRecord) / 2, '\0');
+  std::stringstream partial(data);
+  RequestEventLogReader reader(partial);
+  ASSERT_TRUE(reader.readHeader().ok());
+  RequestEventRecord record;
+  EXPECT_FALSE(reader.next(record).ok());
+
+  header.record_size = 32;
+  std::stringstream bad_record_size(
+      std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+  EXPECT_FALSE(RequestEventLogReader(bad_record_size).readHeader().ok());
+}
+
+} // namespace
+} // namespace Nighthawk
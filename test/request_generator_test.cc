@@ -1,14 +1,22 @@
 #include <chrono>
+#include <deque>
 
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
 #include "external/envoy/test/test_common/utility.h"
 
+#include "source/common/request_impl.h"
 #include "source/common/request_source_impl.h"
 
+#include "test/mocks/common/mock_request_source.h"
+
 #include "gtest/gtest.h"
 
 namespace Nighthawk {
 namespace Client {
 
+using ::testing::NiceMock;
+using ::testing::Return;
+
 class RequestSourceTest : public testing::Test {};
 
 TEST_F(RequestSourceTest, StaticRequestSourceImpl) {
@@ -23,5 +31,139 @@ TEST_F(RequestSourceTest, StaticRequestSourceImpl) {
   ASSERT_EQ(generator(), nullptr);
 }
 
+class SharedRequestSourceTest : public testing::Test {
+public:
+  SharedRequestSourceTest()
+      : api_(Envoy::Api::createApiForTest()), scope_0_(store_.createScope("0.")),
+        scope_1_(store_.createScope("1.")) {}
+
+  uint64_t starved(Envoy::Stats::Scope& scope) {
+    return scope.counterFromString("shared_request_source_starved").value();
+  }
+
+  Envoy::Api::ApiPtr api_;
+  Envoy::Stats::IsolatedStoreImpl store_;
+  Envoy::Stats::ScopeSharedPtr scope_0_;
+  Envoy::Stats::ScopeSharedPtr scope_1_;
+};
+
+TEST_F(SharedRequestSourceTest, ProducerThreadFeedsAllConsumersUntilExhausted) {
+  constexpr uint64_t kYields = 100;
+  auto shared_source = std::make_shared<SharedRequestSourceImpl>(
+      std::make_unique<StaticRequestSourceImpl>(
+          std::make_unique<Envoy::Http::TestRequestHeaderMapImpl>(), kYields),
+      /*capacity=*/5, SharedRequestSourceImpl::ProducerMode::Thread, api_->threadFactory());
+  EXPECT_EQ(shared_source->capacity(), 8);
+  RequestSourcePtr consumer_0 = shared_source->createConsumer(*scope_0_);
+  RequestSourcePtr consumer_1 = shared_source->createConsumer(*scope_1_);
+  consumer_0->initOnThread();
+  consumer_1->initOnThread();
+  RequestGenerator generator_0 = consumer_0->get();
+  RequestGenerator generator_1 = consumer_1->get();
+  uint64_t received = 0;
+  while (received < kYields) {
+    received += generator_0() != nullptr;
+    received += generator_1() != nullptr;
+  }
+  // Wait for the producer to find out that the upstream request source has been exhausted. From
+  // then on, an empty ring is no longer reported as starvation.
+  for (;;) {
+    const uint64_t starved_before = starved(*scope_0_);
+    ASSERT_EQ(generator_0(), nullptr);
+    if (starved(*scope_0_) == starved_before) {
+      break;
+    }
+  }
+  const uint64_t starved_0 = starved(*scope_0_);
+  const uint64_t starved_1 = starved(*scope_1_);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(generator_0(), nullptr);
+    EXPECT_EQ(generator_1(), nullptr);
+  }
+  EXPECT_EQ(starved(*scope_0_), starved_0);
+  EXPECT_EQ(starved(*scope_1_), starved_1);
+  consumer_0->destroyOnThread();
+  consumer_1->destroyOnThread();
+}
+
+TEST_F(SharedRequestSourceTest, OwningWorkerDrivesUpstreamAndOthersCountStarvation) {
+  std::deque<RequestPtr> upstream_requests;
+  auto upstream = std::make_unique<NiceMock<MockRequestSource>>();
+  MockRequestSource& upstream_ref = *upstream;
+  EXPECT_CALL(upstream_ref, get()).WillOnce(Return([&upstream_requests]() -> RequestPtr {
+    if (upstream_requests.empty()) {
+      return nullptr;
+    }
+    RequestPtr request = std::move(upstream_requests.front());
+    upstream_requests.pop_front();
+    return request;
+  }));
+  EXPECT_CALL(upstream_ref, initOnThread());
+  EXPECT_CALL(upstream_ref, destroyOnThread());
+  auto shared_source = std::make_shared<SharedRequestSourceImpl>(
+      std::move(upstream), /*capacity=*/4, SharedRequestSourceImpl::ProducerMode::OwningWorker,
+      api_->threadFactory());
+  RequestSourcePtr owner = shared_source->createConsumer(*scope_0_);
+  RequestSourcePtr consumer = shared_source->createConsumer(*scope_1_);
+  owner->initOnThread();
+  consumer->initOnThread();
+  RequestGenerator owner_generator = owner->get();
+  RequestGenerator consumer_generator = consumer->get();
+
+  EXPECT_EQ(consumer_generator(), nullptr);
+  EXPECT_EQ(starved(*scope_1_), 1);
+  for (int i = 0; i < 6; i++) {
+    upstream_requests.push_back(
+        std::make_unique<RequestImpl>(std::make_shared<Envoy::Http::TestRequestHeaderMapImpl>()));
+  }
+  // The owner fills the ring, which holds four requests, and takes the first one.
+  EXPECT_NE(owner_generator(), nullptr);
+  EXPECT_EQ(upstream_requests.size(), 1);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(consumer_generator(), nullptr);
+  }
+  EXPECT_EQ(consumer_generator(), nullptr);
+  EXPECT_EQ(starved(*scope_1_), 2);
+  // A request that did not fit in the ring is kept, and offered next.
+  EXPECT_NE(owner_generator(), nullptr);
+  EXPECT_NE(owner_generator(), nullptr);
+  // The upstream request source running dry is not taken to mean that it is exhausted.
+  EXPECT_EQ(owner_generator(), nullptr);
+  EXPECT_EQ(starved(*scope_0_), 1);
+  consumer->destroyOnThread();
+  owner->destroyOnThread();
+}
+
+TEST_F(SharedRequestSourceTest, ConsumersYieldTheirOwnCopyOfTheHeaders) {
+  Envoy::Http::RequestHeaderMapPtr header{
+      new Envoy::Http::TestRequestHeaderMapImpl{{":method", "GET"}, {"x-test", "value"}}};
+  auto shared_source = std::make_shared<SharedRequestSourceImpl>(
+      std::make_unique<StaticRequestSourceImpl>(std::move(header), /*max_yields=*/4),
+      /*capacity=*/4, SharedRequestSourceImpl::ProducerMode::OwningWorker, api_->threadFactory());
+  RequestSourcePtr owner = shared_source->createConsumer(*scope_0_);
+  RequestSourcePtr consumer = shared_source->createConsumer(*scope_1_);
+  owner->initOnThread();
+  consumer->initOnThread();
+  RequestGenerator owner_generator = owner->get();
+  RequestGenerator consumer_generator = consumer->get();
+  RequestPtr owner_request_1 = owner_generator();
+  RequestPtr owner_request_2 = owner_generator();
+  RequestPtr consumer_request = consumer_generator();
+  ASSERT_NE(owner_request_1, nullptr);
+  ASSERT_NE(owner_request_2, nullptr);
+  ASSERT_NE(consumer_request, nullptr);
+  // A worker reuses its copy, but doesn't share it with other workers.
+  EXPECT_EQ(owner_request_1->header(), owner_request_2->header());
+  EXPECT_NE(owner_request_1->header(), consumer_request->header());
+  EXPECT_EQ(*owner_request_1->header(), *consumer_request->header());
+  EXPECT_EQ(consumer_request->header()
+                ->get(Envoy::Http::LowerCaseString("x-test"))[0]
+                ->value()
+                .getStringView(),
+            "value");
+  consumer->destroyOnThread();
+  owner->destroyOnThread();
+}
+
 } // namespace Client
 } // namespace Nighthawk
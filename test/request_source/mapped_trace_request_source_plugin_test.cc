@@ -0,0 +1,241 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "envoy/http/header_map.h"
+
+#include "nighthawk/common/exception.h"
+#include "nighthawk/common/request.h"
+#include "nighthawk/common/request_source.h"
+#include "nighthawk/request_source/request_source_plugin_config_factory.h"
+
+#include "external/envoy/source/common/config/utility.h"
+#include "external/envoy/source/common/http/header_map_impl.h"
+#include "external/envoy/source/common/protobuf/protobuf.h"
+#include "external/envoy/test/mocks/api/mocks.h"
+#include "external/envoy/test/mocks/stats/mocks.h"
+#include "external/envoy/test/test_common/file_system_for_test.h"
+#include "external/envoy/test/test_common/utility.h"
+
+#include "api/client/options.pb.h"
+#include "api/request_source/request_source_plugin.pb.h"
+
+#include "source/common/request_trace.h"
+#include "source/request_source/mapped_trace_request_source_plugin_impl.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/proto_matchers.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+using nighthawk::request_source::MappedTraceRequestSourceConfig;
+using ::testing::Test;
+
+constexpr absl::string_view kPluginName = "nighthawk.mapped-trace-request-source-plugin";
+
+nighthawk::client::RequestOptions makeRequestOptions(uint32_t record_number) {
+  nighthawk::client::RequestOptions request_options;
+  envoy::config::core::v3::HeaderValueOption* header = request_options.add_request_headers();
+  header->mutable_header()->set_key(":path");
+  header->mutable_header()->set_value(absl::StrCat("/record-", record_number));
+  if (record_number % 2 == 0) {
+    request_options.set_json_body(absl::StrCat("{\"record\":", record_number, "}"));
+  }
+  return request_options;
+}
+
+class MappedTraceRequestSourcePluginTest : public Test {
+public:
+  MappedTraceRequestSourcePluginTest() : api_(Envoy::Api::createApiForTest(stats_store_)) {}
+
+  // Writes a trace holding |record_count| records, and returns its path.
+  std::string writeTrace(absl::string_view name, uint32_t record_count, uint32_t index_stride) {
+    const std::string path = TestEnvironment::temporaryPath(std::string(name));
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    RequestTraceWriter writer(output, index_stride);
+    for (uint32_t i = 0; i < record_count; i++) {
+      EXPECT_TRUE(writer.addRecord(makeRequestOptions(i), std::chrono::milliseconds(i)).ok());
+    }
+    EXPECT_TRUE(writer.finish().ok());
+    return path;
+  }
+
+  RequestSourcePtr createRequestSource(
+      const std::string& path, uint32_t num_requests, const WorkerContext& worker_context,
+      MappedTraceRequestSourceConfig::Partitioning partitioning =
+          MappedTraceRequestSourceConfig::CONTIGUOUS) {
+    MappedTraceRequestSourceConfig config;
+    config.set_file_path(path);
+    config.set_num_requests(num_requests);
+    config.set_partitioning(partitioning);
+    Envoy::Protobuf::Any config_any;
+    std::ignore = config_any.PackFrom(config);
+    auto& config_factory =
+        Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+            std::string(kPluginName));
+    Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+    header->setMethod("GET");
+    return config_factory.createRequestSourcePluginForWorker(config_any, *api_, std::move(header),
+                                                             worker_context);
+  }
+
+  Envoy::Stats::MockIsolatedStatsStore stats_store_;
+  Envoy::Api::ApiPtr api_;
+};
+
+TEST_F(MappedTraceRequestSourcePluginTest, CreateEmptyConfigProtoCreatesCorrectType) {
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          std::string(kPluginName));
+  const Envoy::ProtobufTypes::MessagePtr empty_config = config_factory.createEmptyConfigProto();
+  const MappedTraceRequestSourceConfig expected_config;
+  EXPECT_THAT(*empty_config, EqualsProto(expected_config));
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, MappedTraceRoundTripsRecords) {
+  const std::string path = writeTrace("round_trip.nhtrace", 10, 3);
+  absl::StatusOr<MappedRequestTraceSharedPtr> trace = MappedRequestTrace::open(path);
+  ASSERT_TRUE(trace.ok()) << trace.status();
+  ASSERT_EQ((*trace)->recordCount(), 10);
+  EXPECT_TRUE((*trace)->hasStartOffsets());
+  for (uint32_t i = 0; i < 10; i++) {
+    absl::StatusOr<uint64_t> offset = (*trace)->recordOffset(i);
+    ASSERT_TRUE(offset.ok()) << offset.status();
+    uint64_t next_offset = 0;
+    absl::StatusOr<RequestTraceRecord> record = (*trace)->recordAt(*offset, next_offset);
+    ASSERT_TRUE(record.ok()) << record.status();
+    EXPECT_EQ(record->start_offset, std::chrono::milliseconds(i));
+    nighthawk::client::RequestOptions request_options;
+    ASSERT_TRUE(request_options.ParseFromArray(record->request_options.data(),
+                                               record->request_options.size()));
+    EXPECT_THAT(request_options, EqualsProto(makeRequestOptions(i)));
+  }
+  EXPECT_FALSE((*trace)->recordOffset(10).ok());
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, WriterRejectsDecreasingStartOffsets) {
+  std::stringstream output;
+  RequestTraceWriter writer(output);
+  EXPECT_TRUE(writer.addRecord(makeRequestOptions(0), std::chrono::milliseconds(2)).ok());
+  EXPECT_FALSE(writer.addRecord(makeRequestOptions(1), std::chrono::milliseconds(1)).ok());
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, OpenRejectsInvalidFiles) {
+  EXPECT_FALSE(MappedRequestTrace::open(TestEnvironment::temporaryPath("does-not-exist")).ok());
+  const std::string path = TestEnvironment::temporaryPath("not_a_trace.nhtrace");
+  {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << std::string(64, 'x');
+  }
+  EXPECT_FALSE(MappedRequestTrace::open(path).ok());
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, CreateRequestSourceThrowsOnMissingTrace) {
+  EXPECT_THROW(createRequestSource(TestEnvironment::temporaryPath("missing.nhtrace"), 0, {}),
+               NighthawkException);
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, ReplaysTraceAndLoops) {
+  const std::string path = writeTrace("replay.nhtrace", 3, 2);
+  RequestSourcePtr request_source = createRequestSource(path, 5, {});
+  RequestGenerator generator = request_source->get();
+  const std::vector<std::string> expected_paths = {"/record-0", "/record-1", "/record-2",
+                                                   "/record-0", "/record-1"};
+  for (const std::string& expected_path : expected_paths) {
+    RequestPtr request = generator();
+    ASSERT_NE(request, nullptr);
+    EXPECT_EQ(request->header()->getPathValue(), expected_path);
+    EXPECT_EQ(request->header()->getMethodValue(), "GET");
+  }
+  EXPECT_EQ(generator(), nullptr);
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, RequestBodyIsTakenFromTheTrace) {
+  const std::string path = writeTrace("body.nhtrace", 2, 1);
+  RequestSourcePtr request_source = createRequestSource(path, 2, {});
+  RequestGenerator generator = request_source->get();
+  RequestPtr with_body = generator();
+  ASSERT_NE(with_body, nullptr);
+  EXPECT_EQ(with_body->body(), "{\"record\":0}");
+  EXPECT_EQ(with_body->header()->getContentTypeValue(), "application/json");
+  RequestPtr without_body = generator();
+  ASSERT_NE(without_body, nullptr);
+  EXPECT_EQ(without_body->sharedBody(), nullptr);
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, WorkersReplayDisjointPartitions) {
+  const std::string path = writeTrace("partitions.nhtrace", 10, 4);
+  std::vector<std::string> replayed_paths;
+  for (uint32_t worker_number = 0; worker_number < 3; worker_number++) {
+    RequestSourcePtr request_source = createRequestSource(path, 0, {worker_number, 3});
+    const auto* mapped_source = dynamic_cast<MappedTraceRequestSource*>(request_source.get());
+    ASSERT_NE(mapped_source, nullptr);
+    RequestGenerator generator = request_source->get();
+    for (uint64_t i = 0; i < mapped_source->recordCount(); i++) {
+      RequestPtr request = generator();
+      ASSERT_NE(request, nullptr);
+      replayed_paths.push_back(std::string(request->header()->getPathValue()));
+    }
+    // The partition loops once it has been replayed.
+    RequestPtr request = generator();
+    ASSERT_NE(request, nullptr);
+    EXPECT_EQ(request->header()->getPathValue(),
+              absl::StrCat("/record-", mapped_source->firstRecord()));
+  }
+  ASSERT_EQ(replayed_paths.size(), 10);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_EQ(replayed_paths[i], absl::StrCat("/record-", i));
+  }
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, StridedWorkersReplayInterleavedRecords) {
+  const std::string path = writeTrace("strided.nhtrace", 7, 2);
+  std::vector<std::vector<std::string>> expected_paths = {
+      {"/record-0", "/record-3", "/record-6", "/record-0"},
+      {"/record-1", "/record-4", "/record-1"},
+      {"/record-2", "/record-5", "/record-2"}};
+  for (uint32_t worker_number = 0; worker_number < 3; worker_number++) {
+    RequestSourcePtr request_source = createRequestSource(
+        path, 0, {worker_number, 3}, MappedTraceRequestSourceConfig::STRIDED);
+    RequestGenerator generator = request_source->get();
+    for (const std::string& expected_path : expected_paths[worker_number]) {
+      RequestPtr request = generator();
+      ASSERT_NE(request, nullptr);
+      EXPECT_EQ(request->header()->getPathValue(), expected_path);
+    }
+  }
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, WorkersShareTraceSmallerThanWorkerCount) {
+  const std::string path = writeTrace("small.nhtrace", 2, 8);
+  RequestSourcePtr request_source = createRequestSource(path, 0, {3, 4});
+  const auto* mapped_source = dynamic_cast<MappedTraceRequestSource*>(request_source.get());
+  ASSERT_NE(mapped_source, nullptr);
+  EXPECT_EQ(mapped_source->firstRecord(), 1);
+  EXPECT_EQ(mapped_source->recordCount(), 1);
+  request_source = createRequestSource(path, 0, {0, 4});
+  mapped_source = dynamic_cast<MappedTraceRequestSource*>(request_source.get());
+  ASSERT_NE(mapped_source, nullptr);
+  EXPECT_EQ(mapped_source->firstRecord(), 0);
+  EXPECT_EQ(mapped_source->recordCount(), 2);
+}
+
+TEST_F(MappedTraceRequestSourcePluginTest, EmptyTraceYieldsDefaultHeader) {
+  const std::string path = writeTrace("empty.nhtrace", 0, 8);
+  RequestSourcePtr request_source = createRequestSource(path, 2, {});
+  RequestGenerator generator = request_source->get();
+  RequestPtr request = generator();
+  ASSERT_NE(request, nullptr);
+  EXPECT_EQ(request->header()->getMethodValue(), "GET");
+  EXPECT_NE(generator(), nullptr);
+  EXPECT_EQ(generator(), nullptr);
+}
+
+} // namespace
+} // namespace Nighthawk
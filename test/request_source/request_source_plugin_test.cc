@@ -453,6 +453,40 @@ TEST_F(InLineRequestSourcePluginTest,
   EXPECT_EQ(request3, nullptr);
 }
 
+TEST_F(InLineRequestSourcePluginTest, RequestsForTheSameOptionShareMaterializedHeadersAndBody) {
+  Envoy::MessageUtil util;
+  nighthawk::client::RequestOptionsList options_list;
+  THROW_IF_NOT_OK(
+      util.loadFromFile(/*file to load*/ Nighthawk::TestEnvironment::runfilesPath(
+                            "test/request_source/test_data/test-jsonconfig-ab.yaml"),
+                        /*out parameter*/ options_list,
+                        /*validation visitor*/ Envoy::ProtobufMessage::getStrictValidationVisitor(),
+                        /*Api*/ *api_));
+  nighthawk::request_source::InLineOptionsListRequestSourceConfig config =
+      MakeInLinePluginConfig(options_list, /*num_requests*/ 4);
+  Envoy::Protobuf::Any config_any;
+  std::ignore = config_any.PackFrom(config);
+  auto& config_factory =
+      Envoy::Config::Utility::getAndCheckFactoryByName<RequestSourcePluginConfigFactory>(
+          "nighthawk.in-line-options-list-request-source-plugin");
+  Envoy::Http::RequestHeaderMapPtr header = Envoy::Http::RequestHeaderMapImpl::create();
+  RequestSourcePtr plugin =
+      config_factory.createRequestSourcePlugin(config_any, *api_, std::move(header));
+  plugin->initOnThread();
+  Nighthawk::RequestGenerator generator = plugin->get();
+  Nighthawk::RequestPtr request1 = generator();
+  Nighthawk::RequestPtr request2 = generator();
+  Nighthawk::RequestPtr request3 = generator();
+  ASSERT_NE(request1, nullptr);
+  ASSERT_NE(request2, nullptr);
+  ASSERT_NE(request3, nullptr);
+  EXPECT_EQ(request1->header().get(), request3->header().get());
+  EXPECT_EQ(request1->sharedBody().get(), request3->sharedBody().get());
+  EXPECT_NE(request1->header().get(), request2->header().get());
+  EXPECT_EQ(request3->header()->getPathValue(), "/a");
+  EXPECT_EQ(request3->header()->getContentTypeValue(), "application/json");
+}
+
 TEST_F(InLineRequestSourcePluginTest,
        CreateRequestSourcePluginWithJsonBodyGetsWorkingRequestGeneratorThatEndsAtNumRequest) {
   Envoy::MessageUtil util;
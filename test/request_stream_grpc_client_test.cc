@@ -1,6 +1,12 @@
+#include <string>
+#include <vector>
+
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
 
+#include "external/envoy/source/common/stats/isolated_store_impl.h"
+#include "external/envoy/test/mocks/event/mocks.h"
+#include "external/envoy/test/mocks/grpc/mocks.h"
 #include "external/envoy/test/test_common/utility.h"
 
 #include "api/request_source/service.pb.h"
@@ -17,8 +23,8 @@ namespace {
 
 using ::nighthawk::request_source::RequestSpecifier;
 
-// The grpc client itself is tested via the python based integration tests.
-// It is convenient to test message translation here.
+// The grpc client itself is tested end to end via the python based integration tests.
+// It is convenient to test message translation and buffering here.
 class ProtoRequestHelperTest : public Test {
 public:
   void translateExpectingEqual() {
@@ -104,5 +110,93 @@ TEST_F(ProtoRequestHelperTest, AmbiguousHost) {
   translateExpectingEqual();
 }
 
+// Test that each request specifier of a batched response is translated on its own.
+TEST_F(ProtoRequestHelperTest, BatchedRequestSpecifiers) {
+  base_header_ = Envoy::Http::TestRequestHeaderMapImpl{{":method", "GET"}};
+  response_.add_request_specifiers()->mutable_path()->set_value("/a");
+  response_.add_request_specifiers()->mutable_path()->set_value("/b");
+  std::vector<std::string> paths;
+  for (const RequestSpecifier& request_specifier : response_.request_specifiers()) {
+    RequestPtr request =
+        ProtoRequestHelper::requestSpecifierToRequest(base_header_, request_specifier);
+    EXPECT_EQ(request->header()->getMethodValue(), "GET");
+    paths.push_back(std::string(request->header()->getPathValue()));
+  }
+  EXPECT_THAT(paths, ElementsAre("/a", "/b"));
+}
+
+class RequestStreamGrpcClientTest : public Test {
+public:
+  // Size of the length-prefixed message framing that precedes each serialized gRPC message.
+  static constexpr uint64_t kGrpcFrameHeaderSize = 5;
+
+  RequestStreamGrpcClientTest() : async_client_(new NiceMock<Envoy::Grpc::MockAsyncClient>()) {
+    EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+    ON_CALL(async_stream_, sendMessageRaw_(_, false))
+        .WillByDefault(Invoke([this](Envoy::Buffer::InstancePtr& buffer, bool) {
+          buffer->drain(kGrpcFrameHeaderSize);
+          nighthawk::request_source::RequestStreamRequest request;
+          ASSERT_TRUE(request.ParseFromString(buffer->toString()));
+          sent_requests_.push_back(request);
+        }));
+  }
+
+  std::unique_ptr<RequestStreamGrpcClientImpl> createClient(uint32_t header_buffer_length) {
+    return std::make_unique<RequestStreamGrpcClientImpl>(
+        Envoy::Grpc::RawAsyncClientPtr(async_client_), dispatcher_, base_header_,
+        header_buffer_length, *store_.rootScope());
+  }
+
+  static Envoy::Grpc::ResponsePtr<nighthawk::request_source::RequestStreamResponse>
+  makeResponse(const std::vector<std::string>& paths, bool batched) {
+    auto response = std::make_unique<nighthawk::request_source::RequestStreamResponse>();
+    for (const std::string& path : paths) {
+      RequestSpecifier* request_specifier = batched ? response->add_request_specifiers()
+                                                    : response->mutable_request_specifier();
+      request_specifier->mutable_path()->set_value(path);
+    }
+    return response;
+  }
+
+  NiceMock<Envoy::Grpc::MockAsyncClient>* async_client_;
+  NiceMock<Envoy::Grpc::MockAsyncStream> async_stream_;
+  NiceMock<Envoy::Event::MockDispatcher> dispatcher_;
+  Envoy::Stats::IsolatedStoreImpl store_;
+  Envoy::Http::TestRequestHeaderMapImpl base_header_{{":method", "GET"}};
+  std::vector<nighthawk::request_source::RequestStreamRequest> sent_requests_;
+};
+
+TEST_F(RequestStreamGrpcClientTest, DrainsBatchedAndUnbatchedResponsesAndDetectsStarvation) {
+  std::unique_ptr<RequestStreamGrpcClientImpl> client = createClient(4);
+  client->start();
+  ASSERT_EQ(sent_requests_.size(), 1);
+  EXPECT_EQ(sent_requests_[0].quantity(), 4);
+  EXPECT_EQ(sent_requests_[0].max_batch_size(), RequestStreamGrpcClientImpl::kDefaultMaxBatchSize);
+  EXPECT_EQ(client->prefetchWindow(), 4);
+
+  client->onReceiveMessage(makeResponse({"/a", "/b", "/c"}, true));
+  client->onReceiveMessage(makeResponse({"/d"}, false));
+  std::vector<std::string> paths;
+  for (int i = 0; i < 4; i++) {
+    RequestPtr request = client->maybeDequeue();
+    ASSERT_NE(request, nullptr);
+    EXPECT_EQ(request->header()->getMethodValue(), "GET");
+    paths.push_back(std::string(request->header()->getPathValue()));
+  }
+  EXPECT_THAT(paths, ElementsAre("/a", "/b", "/c", "/d"));
+  // Draining the buffer once all requested headers have arrived asks for more.
+  ASSERT_EQ(sent_requests_.size(), 2);
+  EXPECT_GE(sent_requests_[1].quantity(), 1);
+
+  // The next batch has not arrived yet: the client starves, and widens its prefetch window.
+  EXPECT_EQ(client->maybeDequeue(), nullptr);
+  EXPECT_EQ(store_.rootScope()->counterFromString("remote_request_source_starved").value(), 1);
+  EXPECT_GT(client->prefetchWindow(), 4);
+  EXPECT_LE(client->prefetchWindow(),
+            4 * RequestStreamGrpcClientImpl::kMaxPrefetchWindowMultiplier);
+  // A request is still in flight, so no further request is sent.
+  EXPECT_EQ(sent_requests_.size(), 2);
+}
+
 } // namespace
 } // namespace Nighthawk
@@ -0,0 +1,90 @@
+#include <sstream>
+
+#include "external/envoy/test/test_common/utility.h"
+
+#include "api/client/options.pb.h"
+
+#include "source/client/request_trace_converter_main.h"
+#include "source/common/request_trace.h"
+
+#include "test/test_common/environment.h"
+
+#include "gtest/gtest.h"
+
+using namespace testing;
+
+namespace Nighthawk {
+namespace Client {
+
+class RequestTraceConverterMainTest : public Test {
+public:
+  std::stringstream stream_;
+};
+
+TEST_F(RequestTraceConverterMainTest, BadArgs) {
+  std::vector<const char*> argv = {"foo", "bar"};
+  EXPECT_THROW(RequestTraceConverterMain(argv.size(), argv.data(), stream_), std::exception);
+}
+
+TEST_F(RequestTraceConverterMainTest, BadInput) {
+  const std::string output_path = TestEnvironment::temporaryPath("bad_input.nhtrace");
+  std::vector<const char*> argv = {"foo", "--output", output_path.c_str()};
+  stream_ << "{invalid_field:1}";
+  RequestTraceConverterMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+TEST_F(RequestTraceConverterMainTest, DecreasingStartOffsetsAreRejected) {
+  const std::string output_path = TestEnvironment::temporaryPath("decreasing.nhtrace");
+  std::vector<const char*> argv = {"foo", "--output", output_path.c_str()};
+  stream_ << "{options: [{start_offset: '2s'}, {start_offset: '1s'}]}";
+  RequestTraceConverterMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+TEST_F(RequestTraceConverterMainTest, ZeroIndexStrideIsRejected) {
+  const std::string output_path = TestEnvironment::temporaryPath("zero_stride.nhtrace");
+  std::vector<const char*> argv = {"foo", "--output", output_path.c_str(), "--index-stride", "0"};
+  stream_ << "{options: []}";
+  RequestTraceConverterMain main(argv.size(), argv.data(), stream_);
+  EXPECT_NE(main.run(), 0);
+}
+
+TEST_F(RequestTraceConverterMainTest, ConvertsYamlOptionsList) {
+  const std::string output_path = TestEnvironment::temporaryPath("converted.nhtrace");
+  std::vector<const char*> argv = {"foo", "--output", output_path.c_str(), "--index-stride", "2"};
+  stream_ << R"(
+options:
+  - request_method: 1
+    request_headers:
+      - { header: { key: ":path", value: "/a" } }
+  - request_method: 3
+    json_body: '{"b":1}'
+    start_offset: 0.25s
+  - request_method: 1
+    start_offset: 1s
+    request_headers:
+      - { header: { key: ":path", value: "/c" } }
+)";
+  RequestTraceConverterMain main(argv.size(), argv.data(), stream_);
+  ASSERT_EQ(main.run(), 0);
+
+  absl::StatusOr<MappedRequestTraceSharedPtr> trace = MappedRequestTrace::open(output_path);
+  ASSERT_TRUE(trace.ok()) << trace.status();
+  ASSERT_EQ((*trace)->recordCount(), 3);
+  absl::StatusOr<uint64_t> offset = (*trace)->recordOffset(1);
+  ASSERT_TRUE(offset.ok());
+  uint64_t next_offset = 0;
+  absl::StatusOr<RequestTraceRecord> record = (*trace)->recordAt(*offset, next_offset);
+  ASSERT_TRUE(record.ok());
+  EXPECT_EQ(record->start_offset, std::chrono::milliseconds(250));
+  nighthawk::client::RequestOptions request_options;
+  ASSERT_TRUE(request_options.ParseFromArray(record->request_options.data(),
+                                             record->request_options.size()));
+  EXPECT_EQ(request_options.json_body(), "{\"b\":1}");
+  // The start offset is only stored in the record header.
+  EXPECT_FALSE(request_options.has_start_offset());
+}
+
+} // namespace Client
+} // namespace Nighthawk
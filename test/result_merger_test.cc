@@ -0,0 +1,161 @@
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "external/envoy/source/common/protobuf/protobuf.h"
+
+#include "source/common/result_merger.h"
+#include "source/common/statistic_impl.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+using ::Envoy::Protobuf::util::TimeUtil;
+using ::testing::HasSubstr;
+
+// Builds a statistic proto that embeds its native encoding, holding values [from, to).
+nighthawk::client::Statistic makeStatistic(absl::string_view id, uint64_t from, uint64_t to) {
+  HdrStatistic statistic;
+  statistic.setId(id);
+  for (uint64_t value = from; value < to; value++) {
+    statistic.addValue(value);
+  }
+  nighthawk::client::Statistic proto = statistic.toProto(Statistic::SerializationDomain::DURATION);
+  auto encoding = statistic.serializeNative();
+  EXPECT_TRUE(encoding.ok());
+  proto.set_hdr_histogram(
+      std::string(std::istreambuf_iterator<char>(**encoding), std::istreambuf_iterator<char>()));
+  return proto;
+}
+
+nighthawk::client::Result makeResult(uint64_t from, uint64_t to, int64_t start_seconds) {
+  nighthawk::client::Result result;
+  result.set_name("worker");
+  *result.add_statistics() = makeStatistic("latency", from, to);
+  nighthawk::client::Counter* counter = result.add_counters();
+  counter->set_name("requests");
+  counter->set_value(to - from);
+  *result.mutable_execution_start() = TimeUtil::SecondsToTimestamp(start_seconds);
+  *result.mutable_execution_duration() = TimeUtil::SecondsToDuration(start_seconds);
+  return result;
+}
+
+TEST(ResultMergerTest, MergesStatisticsExactlyAndSumsCounters) {
+  ResultMerger merger("global");
+  ASSERT_TRUE(merger.addResult(makeResult(1, 1001, 4)).ok());
+  ASSERT_TRUE(merger.addResult(makeResult(100000, 101000, 2)).ok());
+  EXPECT_EQ(merger.resultCount(), 2);
+
+  const nighthawk::client::Result merged = merger.toProto();
+  EXPECT_EQ(merged.name(), "global");
+  ASSERT_EQ(merged.counters_size(), 1);
+  EXPECT_EQ(merged.counters(0).value(), 2000);
+  EXPECT_EQ(TimeUtil::TimestampToSeconds(merged.execution_start()), 2);
+  EXPECT_EQ(TimeUtil::DurationToSeconds(merged.execution_duration()), 3);
+  ASSERT_EQ(merged.statistics_size(), 1);
+  EXPECT_EQ(merged.statistics(0).id(), "latency");
+  EXPECT_EQ(merged.statistics(0).count(), 2000);
+  EXPECT_GT(merged.statistics(0).percentiles_size(), 0);
+
+  // The merge is exact: it matches recording all values into a single histogram.
+  absl::StatusOr<std::unique_ptr<HdrStatistic>> decoded =
+      HdrStatistic::fromProto(merged.statistics(0));
+  ASSERT_TRUE(decoded.ok());
+  HdrStatistic expected;
+  for (uint64_t value = 1; value < 1001; value++) {
+    expected.addValue(value);
+  }
+  for (uint64_t value = 100000; value < 101000; value++) {
+    expected.addValue(value);
+  }
+  for (const double percentile : {50., 90., 99., 99.9}) {
+    EXPECT_EQ((*decoded)->valueAtPercentile(percentile), expected.valueAtPercentile(percentile));
+  }
+}
+
+TEST(ResultMergerTest, StatisticsWithoutEncodingFail) {
+  ResultMerger merger("global");
+  nighthawk::client::Result result = makeResult(1, 10, 1);
+  result.mutable_statistics(0)->clear_hdr_histogram();
+  const absl::Status status = merger.addResult(result);
+  EXPECT_EQ(status.code(), absl::StatusCode::kFailedPrecondition);
+  EXPECT_THAT(status.message(), HasSubstr("no native encoding"));
+  EXPECT_EQ(merger.resultCount(), 0);
+  EXPECT_EQ(merger.toProto().counters_size(), 0);
+}
+
+TEST(ResultMergerTest, EmptyStatisticsWithoutEncodingAreSkipped) {
+  ResultMerger merger("global");
+  nighthawk::client::Result result = makeResult(1, 10, 1);
+  *result.add_statistics() = nighthawk::client::Statistic();
+  result.mutable_statistics(1)->set_id("empty");
+  ASSERT_TRUE(merger.addResult(result).ok());
+  EXPECT_EQ(merger.toProto().statistics_size(), 1);
+}
+
+TEST(ResultMergerTest, BadEncodingLeavesAggregateUntouched) {
+  ResultMerger merger("global");
+  nighthawk::client::Result result = makeResult(1, 10, 1);
+  *result.add_statistics() = makeStatistic("other", 1, 10);
+  result.mutable_statistics(1)->set_hdr_histogram("bad");
+  EXPECT_FALSE(merger.addResult(result).ok());
+  EXPECT_EQ(merger.resultCount(), 0);
+  const nighthawk::client::Result merged = merger.toProto();
+  EXPECT_EQ(merged.statistics_size(), 0);
+  EXPECT_EQ(merged.counters_size(), 0);
+}
+
+TEST(ResultMergerTest, MergesTimeSlicesWithTheSameStartAndDuration) {
+  const auto add_time_slice = [](nighthawk::client::Result& result, int64_t start_seconds,
+                                 uint64_t from, uint64_t to) {
+    nighthawk::client::TimeSlice* time_slice = result.add_time_slices();
+    *time_slice->mutable_start() = TimeUtil::SecondsToTimestamp(start_seconds);
+    *time_slice->mutable_duration() = TimeUtil::SecondsToDuration(1);
+    *time_slice->add_statistics() = makeStatistic("latency", from, to);
+    nighthawk::client::Counter* counter = time_slice->add_counters();
+    counter->set_name("requests");
+    counter->set_value(to - from);
+  };
+  ResultMerger merger("global");
+  nighthawk::client::Result first = makeResult(1, 10, 1);
+  add_time_slice(first, 100, 1, 5);
+  add_time_slice(first, 101, 5, 10);
+  nighthawk::client::Result second = makeResult(1, 10, 1);
+  add_time_slice(second, 101, 1, 10);
+  add_time_slice(second, 102, 1, 2);
+  ASSERT_TRUE(merger.addResult(first).ok());
+  ASSERT_TRUE(merger.addResult(second).ok());
+
+  const nighthawk::client::Result merged = merger.toProto();
+  ASSERT_EQ(merged.time_slices_size(), 3);
+  const std::vector<std::pair<int64_t, uint64_t>> expected = {{100, 4}, {101, 14}, {102, 1}};
+  for (int i = 0; i < merged.time_slices_size(); i++) {
+    const nighthawk::client::TimeSlice& time_slice = merged.time_slices(i);
+    EXPECT_EQ(TimeUtil::TimestampToSeconds(time_slice.start()), expected[i].first);
+    EXPECT_EQ(TimeUtil::DurationToSeconds(time_slice.duration()), 1);
+    ASSERT_EQ(time_slice.statistics_size(), 1);
+    EXPECT_EQ(time_slice.statistics(0).count(), expected[i].second);
+    EXPECT_FALSE(time_slice.statistics(0).hdr_histogram().empty());
+    ASSERT_EQ(time_slice.counters_size(), 1);
+    EXPECT_EQ(time_slice.counters(0).value(), expected[i].second);
+  }
+}
+
+TEST(ResultMergerTest, BadTimeSliceEncodingLeavesAggregateUntouched) {
+  ResultMerger merger("global");
+  nighthawk::client::Result result = makeResult(1, 10, 1);
+  nighthawk::client::TimeSlice* time_slice = result.add_time_slices();
+  *time_slice->add_statistics() = makeStatistic("latency", 1, 10);
+  time_slice->mutable_statistics(0)->set_hdr_histogram("bad");
+  EXPECT_FALSE(merger.addResult(result).ok());
+  const nighthawk::client::Result merged = merger.toProto();
+  EXPECT_EQ(merged.statistics_size(), 0);
+  EXPECT_EQ(merged.time_slices_size(), 0);
+}
+
+} // namespace
+} // namespace Nighthawk
@@ -1,5 +1,6 @@
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include "nighthawk/common/exception.h"
 #include "nighthawk/common/platform_util.h"
@@ -45,6 +46,11 @@ public:
         sequencer_target_(
             std::bind(&SequencerTestBase::callback_test, this, std::placeholders::_1)) {}
 
+  static SequencerOverheadStatistics makeOverheadStatistics() {
+    return {std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
+            std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>()};
+  }
+
   bool callback_test(const OperationCallback& f) {
     callback_test_count_++;
     f(true, true);
@@ -99,8 +105,13 @@ public:
         .WillRepeatedly(Invoke([&](const std::chrono::microseconds,
                                    const Envoy::ScopeTrackedObject*) { timer1_set_ = true; }));
     EXPECT_CALL(*timer2_, enableHRTimer(_, _))
-        .WillRepeatedly(Invoke([&](const std::chrono::microseconds,
-                                   const Envoy::ScopeTrackedObject*) { timer2_set_ = true; }));
+        .WillRepeatedly(Invoke(
+            [&](const std::chrono::microseconds delay, const Envoy::ScopeTrackedObject*) {
+              if (delay == 0us) {
+                timer2_immediate_enable_times_.push_back(time_system_.monotonicTime());
+              }
+              timer2_set_ = true;
+            }));
     EXPECT_CALL(*dispatcher_, exit()).WillOnce(Invoke([&]() { stopped_ = true; }));
     EXPECT_CALL(*dispatcher_, updateApproximateMonotonicTime()).Times(AtLeast(1));
     simulation_start_ = time_system_.monotonicTime();
@@ -149,6 +160,8 @@ public:
 
 protected:
   Envoy::MonotonicTime simulation_start_;
+  // Simulated times at which the second timer was enabled to fire immediately.
+  std::vector<Envoy::MonotonicTime> timer2_immediate_enable_times_;
 
 private:
   NiceMock<Envoy::Event::MockTimer>* timer1_; // not owned
@@ -167,8 +180,9 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterInteraction) {
       std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
-                          std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
-                          std::move(termination_predicate_), scope_);
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
   // Have the mock rate limiter gate two calls, and block everything else.
   EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne())
       .Times(AtLeast(3))
@@ -189,8 +203,9 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterSaturatedTargetInteraction) {
       std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
-                          std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
-                          std::move(termination_predicate_), scope_);
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
 
   EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne())
       .Times(AtLeast(3))
@@ -199,15 +214,269 @@ TEST_F(SequencerTestWithTimerEmulation, RateLimiterSaturatedTargetInteraction) {
       .WillRepeatedly(Return(false));
   EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).Times(2);
 
-  EXPECT_CALL(*target(), callback(_)).Times(2).WillOnce(Return(true)).WillOnce(Return(false));
+  // The sequencer holds on to the acquisition the target refused, and keeps offering it.
+  EXPECT_CALL(*target(), callback(_))
+      .Times(AtLeast(2))
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+
+  // The sequencer should not hand the refused acquisition back to the rate limiter.
+  EXPECT_CALL(rate_limiter_unsafe_ref_, releaseOne()).Times(0);
+  expectDispatcherRun();
+
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+}
+
+// Latency measured from the intended start includes the time the acquisition was overdue.
+TEST_F(SequencerTestWithTimerEmulation, IntendedLatencyIncludesSchedulingDelay) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
+  // The rate limiter releases a single acquisition late, which was due at the start.
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne())
+      .Times(AtLeast(4))
+      .WillOnce(Return(false))
+      .WillOnce(Return(false))
+      .WillOnce(Return(false))
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(0))
+      .WillOnce(Return(std::optional<Envoy::MonotonicTime>(simulation_start_)));
+  EXPECT_CALL(*target(), callback(_)).WillOnce(Invoke([](OperationCallback f) {
+    f(true, true);
+    return true;
+  }));
+  expectDispatcherRun();
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+  ASSERT_EQ(1, sequencer.latencyStatistic().count());
+  ASSERT_EQ(1, sequencer.intendedLatencyStatistic().count());
+  EXPECT_EQ(0, sequencer.latencyStatistic().mean());
+  EXPECT_GE(sequencer.intendedLatencyStatistic().mean(),
+            std::chrono::nanoseconds(NighthawkTimerResolution).count());
+}
+
+// Starting a release well after the rate limiter intended, while the target did not refuse, counts
+// as the load generator being saturated.
+TEST_F(SequencerTestWithTimerEmulation, LateStartCountsAsGeneratorSaturation) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
+  // The rate limiter releases a single acquisition 2ms late, which was due at the start.
+  bool released = false;
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne()).WillRepeatedly(Invoke([&]() {
+    if (released || time_system_.monotonicTime() - simulation_start_ < 2ms) {
+      return false;
+    }
+    released = true;
+    return true;
+  }));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(0))
+      .WillOnce(Return(std::optional<Envoy::MonotonicTime>(simulation_start_)));
+  EXPECT_CALL(*target(), callback(_)).WillOnce(Invoke([](OperationCallback f) {
+    f(true, true);
+    return true;
+  }));
+  EXPECT_CALL(platform_util_, currentThreadCpuTime())
+      .WillOnce(Return(std::chrono::nanoseconds(1ms)))
+      .WillOnce(Return(std::chrono::nanoseconds(3ms)));
+  expectDispatcherRun();
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+  EXPECT_EQ(1, scope_.counterFromString("sequencer.generator_saturated").value());
+  const SequencerOverheadStatistics& overhead = sequencer.overheadStatistics();
+  ASSERT_EQ(1, overhead.slippage->count());
+  EXPECT_GE(overhead.slippage->mean(), std::chrono::nanoseconds(2ms).count());
+  EXPECT_EQ(1, overhead.run_duration->count());
+  ASSERT_EQ(1, overhead.thread_cpu_time->count());
+  EXPECT_EQ(std::chrono::nanoseconds(2ms).count(), overhead.thread_cpu_time->mean());
+}
+
+// Releases that are late because the target refused to start them don't count as the load
+// generator being saturated.
+TEST_F(SequencerTestWithTimerEmulation, LateStartCausedByTargetIsNotGeneratorSaturation) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
+  // Two acquisitions are released at the start. Another one that was due 500us in is released
+  // once the rate limiter gets asked again.
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne())
+      .Times(AtLeast(5))
+      .WillOnce(Return(true))
+      .WillOnce(Return(true))
+      .WillOnce(Return(false))
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(0))
+      .WillOnce(Return(std::optional<Envoy::MonotonicTime>(simulation_start_)))
+      .WillOnce(Return(std::optional<Envoy::MonotonicTime>(simulation_start_ + 500us)));
+  // The intended start of the refused acquisition is looked up once.
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(1))
+      .WillOnce(Return(std::optional<Envoy::MonotonicTime>(simulation_start_)));
+  // The target refuses the second acquisition for 2ms, so the rate limiter isn't asked again
+  // until then.
+  EXPECT_CALL(*target(), callback(_)).WillRepeatedly(Invoke([&](OperationCallback f) {
+    if (time_system_.monotonicTime() - simulation_start_ < 2ms &&
+        sequencer.overheadStatistics().slippage->count() == 1) {
+      return false;
+    }
+    f(true, true);
+    return true;
+  }));
+  expectDispatcherRun();
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+  EXPECT_EQ(0, scope_.counterFromString("sequencer.generator_saturated").value());
+  EXPECT_EQ(3, sequencer.overheadStatistics().slippage->count());
+  EXPECT_EQ(1, sequencer.blockedStatistic().count());
+}
 
-  // The sequencer should call RateLimiter::releaseOne() when the target returns false.
-  EXPECT_CALL(rate_limiter_unsafe_ref_, releaseOne());
+// A batch released after falling behind measures the latency of each acquisition from the point in
+// time it was due.
+TEST_F(SequencerTestWithTimerEmulation, CatchUpBatchUsesIntendedStartOfEachAcquisition) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
+  // Three acquisitions that were due 1ms apart are released 4ms in, all at once.
+  bool released = false;
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquire(_)).WillRepeatedly(Invoke([&](uint64_t) {
+    if (released || time_system_.monotonicTime() - simulation_start_ < 4ms) {
+      return 0;
+    }
+    released = true;
+    return 3;
+  }));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](uint64_t index) {
+        return std::optional<Envoy::MonotonicTime>(simulation_start_ +
+                                                   static_cast<int64_t>(index) * 1ms);
+      }));
+  EXPECT_CALL(*target(), callback(_)).Times(3).WillRepeatedly(Invoke([](OperationCallback f) {
+    f(true, true);
+    return true;
+  }));
   expectDispatcherRun();
+  EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
+  sequencer.start();
+  sequencer.waitForCompletion();
+  // All three were started and completed at the same time, so the intended latencies differ by
+  // how far apart they were due.
+  const Statistic& intended_latency = sequencer.intendedLatencyStatistic();
+  ASSERT_EQ(3, intended_latency.count());
+  EXPECT_GE(intended_latency.max(), std::chrono::nanoseconds(4ms).count());
+  EXPECT_EQ(std::chrono::nanoseconds(2ms).count(), intended_latency.max() - intended_latency.min());
+  EXPECT_EQ(intended_latency.max() - std::chrono::nanoseconds(1ms).count(),
+            intended_latency.mean());
+  const Statistic& slippage = *sequencer.overheadStatistics().slippage;
+  ASSERT_EQ(3, slippage.count());
+  EXPECT_EQ(std::chrono::nanoseconds(2ms).count(), slippage.max() - slippage.min());
+  EXPECT_EQ(0, sequencer.latencyStatistic().max());
+}
 
+// Everything the rate limiter releases at once is started as a single batch.
+TEST_F(SequencerTestWithTimerEmulation, StartsReleasedBatch) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquire(_))
+      .Times(AtLeast(2))
+      .WillOnce(Return(3))
+      .WillRepeatedly(Return(0));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne()).Times(0);
+  EXPECT_CALL(rate_limiter_unsafe_ref_, scheduledReleaseTime(_))
+      .Times(3)
+      .WillRepeatedly(Return(std::optional<Envoy::MonotonicTime>(simulation_start_)));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).Times(2);
+  EXPECT_CALL(*target(), callback(_)).Times(3).WillRepeatedly(Invoke([](OperationCallback f) {
+    f(true, true);
+    return true;
+  }));
+  expectDispatcherRun();
   EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
   sequencer.start();
   sequencer.waitForCompletion();
+  EXPECT_EQ(3, sequencer.latencyStatistic().count());
+  EXPECT_EQ(3, sequencer.intendedLatencyStatistic().count());
+}
+
+// The timer idle strategy consults the rate limiter for the next release instead of spinning or
+// sleeping.
+TEST_F(SequencerTestWithTimerEmulation, TimerIdleStrategyWaitsForNextRelease) {
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
+                          callback, std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::TIMER, std::move(termination_predicate_), scope_);
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne())
+      .Times(AtLeast(2))
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, nextReleaseTime())
+      .Times(AtLeast(1))
+      .WillRepeatedly(Return(std::optional<Envoy::MonotonicTime>(simulation_start_ + 10ms)));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).Times(2);
+  EXPECT_CALL(*target(), callback(_)).WillOnce(Return(true));
+  expectDispatcherRun();
+  EXPECT_CALL(platform_util_, yieldCurrentThread()).Times(0);
+  EXPECT_CALL(platform_util_, sleep(_)).Times(0);
+  sequencer.start();
+  sequencer.waitForCompletion();
+}
+
+// Once the scheduled start has passed, an exhausted rate limiter must not make the timer idle
+// strategy spin on the (past) scheduled start.
+TEST_F(SequencerTestWithTimerEmulation, TimerIdleStrategyDoesNotSpinAfterScheduledStart) {
+  const Envoy::MonotonicTime scheduled_starting_time = simulation_start_ + 5ms;
+  EXPECT_CALL(rate_limiter_unsafe_ref_, timeSource).WillRepeatedly(ReturnRef(time_system_));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, tryAcquireOne()).WillRepeatedly(Return(false));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, nextReleaseTime()).WillRepeatedly(Return(std::nullopt));
+  EXPECT_CALL(rate_limiter_unsafe_ref_, elapsed()).WillRepeatedly(Return(0ns));
+  SequencerTarget callback =
+      std::bind(&MockSequencerTarget::callback, target(), std::placeholders::_1);
+  SequencerImpl sequencer(
+      platform_util_, *dispatcher_, time_system_,
+      std::make_unique<ScheduledStartingRateLimiter>(std::move(rate_limiter_),
+                                                     scheduled_starting_time),
+      callback, std::make_unique<StreamingStatistic>(), std::make_unique<StreamingStatistic>(),
+      std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+      SequencerIdleStrategy::TIMER, std::move(termination_predicate_), scope_);
+  EXPECT_CALL(*target(), callback(_)).Times(0);
+  expectDispatcherRun();
+  EXPECT_CALL(platform_util_, yieldCurrentThread()).Times(0);
+  EXPECT_CALL(platform_util_, sleep(_)).Times(0);
+  sequencer.start();
+  sequencer.waitForCompletion();
+  for (const Envoy::MonotonicTime& time : timer2_immediate_enable_times_) {
+    EXPECT_LE(time, scheduled_starting_time);
+  }
 }
 
 // The integration tests use a LinearRateLimiter.
@@ -231,16 +500,21 @@ public:
   void testRegularFlow(SequencerIdleStrategy::SequencerIdleStrategyOptions idle_strategy) {
     SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                             sequencer_target_, std::make_unique<StreamingStatistic>(),
-                            std::make_unique<StreamingStatistic>(), idle_strategy,
-                            std::move(termination_predicate_), scope_);
+                            std::make_unique<StreamingStatistic>(),
+                            std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                            idle_strategy, std::move(termination_predicate_), scope_);
     EXPECT_EQ(0, callback_test_count_);
     EXPECT_EQ(0, sequencer.latencyStatistic().count());
     sequencer.start();
     sequencer.waitForCompletion();
     EXPECT_EQ(test_number_of_intervals_, callback_test_count_);
     EXPECT_EQ(test_number_of_intervals_, sequencer.latencyStatistic().count());
+    EXPECT_EQ(test_number_of_intervals_, sequencer.intendedLatencyStatistic().count());
     EXPECT_EQ(0, sequencer.blockedStatistic().count());
-    EXPECT_EQ(2, sequencer.statistics().size());
+    EXPECT_EQ(7, sequencer.statistics().size());
+    EXPECT_EQ(test_number_of_intervals_, sequencer.overheadStatistics().slippage->count());
+    EXPECT_EQ(1, sequencer.overheadStatistics().thread_cpu_time->count());
+    EXPECT_EQ(0, scope_.counterFromString("sequencer.generator_saturated").value());
     const auto execution_duration = time_system_.monotonicTime() - simulation_start_;
     EXPECT_EQ(sequencer.executionDuration(), execution_duration);
   }
@@ -264,6 +538,12 @@ TEST_F(SequencerIntegrationTest, IdleStrategySleep) {
   testRegularFlow(SequencerIdleStrategy::SLEEP);
 }
 
+TEST_F(SequencerIntegrationTest, IdleStrategyTimer) {
+  EXPECT_CALL(platform_util_, yieldCurrentThread()).Times(0);
+  EXPECT_CALL(platform_util_, sleep(_)).Times(0);
+  testRegularFlow(SequencerIdleStrategy::TIMER);
+}
+
 // Test an always saturated sequencer target. A concrete example would be a http benchmark client
 // not being able to start any requests, for example due to misconfiguration or system conditions.
 TEST_F(SequencerIntegrationTest, AlwaysSaturatedTargetTest) {
@@ -271,8 +551,9 @@ TEST_F(SequencerIntegrationTest, AlwaysSaturatedTargetTest) {
       std::bind(&SequencerIntegrationTest::saturated_test, this, std::placeholders::_1);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
-                          std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
-                          std::move(termination_predicate_), scope_);
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
   EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
   sequencer.start();
   sequencer.waitForCompletion();
@@ -289,8 +570,9 @@ TEST_F(SequencerIntegrationTest, CallbacksDoNotInfluenceTestDuration) {
       std::bind(&SequencerIntegrationTest::timeout_test, this, std::placeholders::_1);
   SequencerImpl sequencer(platform_util_, *dispatcher_, time_system_, std::move(rate_limiter_),
                           callback, std::make_unique<StreamingStatistic>(),
-                          std::make_unique<StreamingStatistic>(), SequencerIdleStrategy::SLEEP,
-                          std::move(termination_predicate_), scope_);
+                          std::make_unique<StreamingStatistic>(),
+                          std::make_unique<StreamingStatistic>(), makeOverheadStatistics(),
+                          SequencerIdleStrategy::SLEEP, std::move(termination_predicate_), scope_);
   EXPECT_CALL(platform_util_, sleep(_)).Times(AtLeast(1));
   auto pre_timeout = time_system_.monotonicTime();
   sequencer.start();
@@ -174,6 +174,29 @@ TEST_P(ServiceTest, Basic) {
   EXPECT_TRUE(status.ok());
 }
 
+// Test that progress reports are streamed ahead of the final response when requested.
+TEST_P(ServiceTest, ProgressReports) {
+  auto options = request_.mutable_start_request()->mutable_options();
+  options->mutable_duration()->set_seconds(3);
+  options->mutable_progress_report_interval()->set_value(1);
+  auto r = stub_->ExecutionStream(&context_);
+  r->Write(request_, {});
+  r->WritesDone();
+  int progress_reports = 0;
+  while (r->Read(&response_) && response_.progress_report()) {
+    ++progress_reports;
+    EXPECT_FALSE(response_.has_error_detail());
+    ASSERT_EQ(response_.output().results().size(), 1);
+    EXPECT_EQ(response_.output().results(0).name(), "progress");
+  }
+  EXPECT_GE(progress_reports, 1);
+  EXPECT_FALSE(response_.progress_report());
+  EXPECT_TRUE(response_.has_output());
+  EXPECT_GE(response_.output().results(0).counters().size(), 8);
+  auto status = r->Finish();
+  EXPECT_TRUE(status.ok());
+}
+
 // Test that attempts to perform concurrent executions result in a
 // failure being returned.
 TEST_P(ServiceTest, NoConcurrentStart) {
@@ -1,5 +1,6 @@
 #include <grpc++/grpc++.h>
 
+#include <iterator>
 #include <vector>
 
 #include "external/envoy/test/test_common/environment.h"
@@ -8,6 +9,7 @@
 
 #include "api/sink/sink.pb.h"
 
+#include "source/common/statistic_impl.h"
 #include "source/sink/service_impl.h"
 
 #include "test/mocks/sink/mock_sink.h"
@@ -280,14 +282,87 @@ TEST(ResponseVectorHandling, NoResultsInOutputYieldsNone) {
   EXPECT_EQ(response.value().output().results().size(), 0);
 }
 
-TEST(ResponseVectorHandling, MergeThreeYieldsThree) {
+TEST(ResponseVectorHandling, MergeThreeYieldsGlobalResultAndThree) {
   ExecutionResponse result;
   result.mutable_output()->add_results();
   std::vector<ExecutionResponse> responses{result, result, result};
   absl::StatusOr<ExecutionResponse> response =
       mergeExecutionResponses(/*execution_id=*/"", responses);
   EXPECT_TRUE(response.ok());
-  EXPECT_EQ(response.value().output().results().size(), 3);
+  ASSERT_EQ(response.value().output().results().size(), 4);
+  EXPECT_EQ(response.value().output().results(0).name(), "global");
+}
+
+// Builds a node response with a global result holding |count| latency samples of |value|, and a
+// per-worker result that duplicates it.
+ExecutionResponse makeNodeResponse(uint64_t value, uint64_t count) {
+  HdrStatistic statistic;
+  statistic.setId("latency");
+  for (uint64_t i = 0; i < count; i++) {
+    statistic.addValue(value);
+  }
+  auto encoding = statistic.serializeNative();
+  EXPECT_TRUE(encoding.ok());
+  nighthawk::client::Statistic statistic_proto =
+      statistic.toProto(Statistic::SerializationDomain::DURATION);
+  statistic_proto.set_hdr_histogram(
+      std::string(std::istreambuf_iterator<char>(**encoding), std::istreambuf_iterator<char>()));
+  ExecutionResponse response;
+  for (const std::string& name : {"worker_0", "global"}) {
+    nighthawk::client::Result* result = response.mutable_output()->add_results();
+    result->set_name(name);
+    *result->add_statistics() = statistic_proto;
+    nighthawk::client::Counter* counter = result->add_counters();
+    counter->set_name("upstream_rq_total");
+    counter->set_value(count);
+  }
+  return response;
+}
+
+TEST(ResponseVectorHandling, MergeBuildsExactGlobalResultFromNodeGlobalResults) {
+  std::vector<ExecutionResponse> responses{makeNodeResponse(1000, 99),
+                                           makeNodeResponse(1000000, 1)};
+  absl::StatusOr<ExecutionResponse> response =
+      mergeExecutionResponses(/*execution_id=*/"", responses);
+  ASSERT_TRUE(response.ok()) << response.status();
+  // The merged global result precedes the results of both nodes.
+  ASSERT_EQ(response->output().results_size(), 5);
+  EXPECT_EQ(response->output().results(1).statistics(0).count(), 99);
+  EXPECT_EQ(response->output().results(4).statistics(0).count(), 1);
+  const nighthawk::client::Result& global = response->output().results(0);
+  EXPECT_EQ(global.name(), "global");
+  ASSERT_EQ(global.counters_size(), 1);
+  EXPECT_EQ(global.counters(0).value(), 100);
+  ASSERT_EQ(global.statistics_size(), 1);
+  EXPECT_EQ(global.statistics(0).count(), 100);
+  absl::StatusOr<std::unique_ptr<HdrStatistic>> merged =
+      HdrStatistic::fromProto(global.statistics(0));
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  // Averaging the per-node p99 values would land halfway; the exact merge does not.
+  EXPECT_NEAR((*merged)->valueAtPercentile(99), 1000, 1);
+  EXPECT_NEAR((*merged)->valueAtPercentile(100), 1000000, 1000);
+}
+
+TEST(ResponseVectorHandling, MergeBadEncodingFails) {
+  ExecutionResponse node_response = makeNodeResponse(1000, 1);
+  node_response.mutable_output()->mutable_results(1)->mutable_statistics(0)->set_hdr_histogram(
+      "bad");
+  std::vector<ExecutionResponse> responses{node_response};
+  EXPECT_FALSE(mergeExecutionResponses(/*execution_id=*/"", responses).ok());
+}
+
+TEST(ResponseVectorHandling, MergeWithoutEncodingKeepsNodeResults) {
+  ExecutionResponse node_response = makeNodeResponse(1000, 1);
+  for (nighthawk::client::Result& result : *node_response.mutable_output()->mutable_results()) {
+    result.mutable_statistics(0)->clear_hdr_histogram();
+  }
+  std::vector<ExecutionResponse> responses{makeNodeResponse(1000, 1), node_response};
+  absl::StatusOr<ExecutionResponse> response =
+      mergeExecutionResponses(/*execution_id=*/"", responses);
+  ASSERT_TRUE(response.ok()) << response.status();
+  // No exact global result can be built, but no node results are lost either.
+  ASSERT_EQ(response->output().results_size(), 4);
+  EXPECT_THAT(response->output().results(3), EqualsProto(node_response.output().results(1)));
 }
 
 TEST(MergeOutputs, MergeDivergingOptionsInResultsFails) {
@@ -299,9 +374,10 @@ TEST(MergeOutputs, MergeDivergingOptionsInResultsFails) {
   nighthawk::client::CommandLineOptions* options_2 = output_2.mutable_options();
   options_2->mutable_requests_per_second()->set_value(2);
   nighthawk::client::Output merged_output;
-  absl::Status status_1 = mergeOutput(output_1, merged_output);
+  ResultMerger global_result("global");
+  absl::Status status_1 = mergeOutput(output_1, merged_output, global_result);
   EXPECT_TRUE(status_1.ok());
-  absl::Status status_2 = mergeOutput(output_2, merged_output);
+  absl::Status status_2 = mergeOutput(output_2, merged_output, global_result);
   EXPECT_FALSE(status_2.ok());
   EXPECT_THAT(status_2.message(), HasSubstr("Options divergence detected"));
 }
@@ -316,9 +392,10 @@ TEST(MergeOutputs, MergeDivergingVersionsInResultsFails) {
   response_2.set_execution_id(kTestId);
   response_2.mutable_output()->mutable_version()->mutable_version()->set_major_number(2);
   nighthawk::client::Output merged_output;
-  absl::Status status_1 = mergeOutput(response_1.output(), merged_output);
+  ResultMerger global_result("global");
+  absl::Status status_1 = mergeOutput(response_1.output(), merged_output, global_result);
   EXPECT_TRUE(status_1.ok());
-  absl::Status status_2 = mergeOutput(response_2.output(), merged_output);
+  absl::Status status_2 = mergeOutput(response_2.output(), merged_output, global_result);
   EXPECT_FALSE(status_2.ok());
   EXPECT_THAT(status_2.message(), HasSubstr("Version divergence detected"));
 }
@@ -79,6 +79,29 @@ TYPED_TEST(TypedSinkTest, Append) {
   EXPECT_EQ(status_or_execution_responses.value().size(), 2);
 }
 
+TYPED_TEST(TypedSinkTest, VisitStopsAtFirstError) {
+  TypeParam sink;
+  nighthawk::client::ExecutionResponse result_to_store;
+  *(result_to_store.mutable_execution_id()) = this->executionIdForTest();
+  ASSERT_TRUE(sink.StoreExecutionResultPiece(result_to_store).ok());
+  ASSERT_TRUE(sink.StoreExecutionResultPiece(result_to_store).ok());
+  int visited = 0;
+  auto visitor = [&visited](const nighthawk::client::ExecutionResponse&) {
+    visited++;
+    return absl::OkStatus();
+  };
+  ASSERT_TRUE(sink.VisitExecutionResult(this->executionIdForTest(), visitor).ok());
+  EXPECT_EQ(visited, 2);
+  visited = 0;
+  const absl::Status status = sink.VisitExecutionResult(
+      this->executionIdForTest(), [&visited](const nighthawk::client::ExecutionResponse&) {
+        visited++;
+        return absl::InternalError("stop");
+      });
+  EXPECT_EQ(status.message(), "stop");
+  EXPECT_EQ(visited, 1);
+}
+
 TEST(FileSinkTest, BadGuidShortString) {
   FileSinkImpl sink;
   const auto status_or_execution_responses =
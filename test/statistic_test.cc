@@ -1,8 +1,12 @@
 #include <google/protobuf/util/json_util.h>
 
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <iterator>
 #include <random>
 #include <string>
+#include <thread>
 #include <typeinfo> // std::bad_cast
 
 #include "external/envoy/source/common/protobuf/utility.h"
@@ -23,7 +27,7 @@ using namespace testing;
 namespace Nighthawk {
 
 using MyTypes = Types<SimpleStatistic, InMemoryStatistic, HdrStatistic, StreamingStatistic,
-                      CircllhistStatistic>;
+                      CircllhistStatistic, DDSketchStatistic>;
 
 template <typename T> class TypedStatisticTest : public Test {};
 
@@ -381,6 +385,65 @@ TEST(StatisticTest, CircllhistStatisticPercentilesProto) {
       << golden_json;
 }
 
+TEST(StatisticTest, DDSketchStatisticPercentilesWithinRelativeAccuracy) {
+  DDSketchStatistic statistic;
+  EXPECT_EQ(0, statistic.valueAtPercentile(50));
+  for (uint64_t i = 1; i <= 100000; i++) {
+    statistic.addValue(i);
+  }
+  for (const double percentile : {0.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+    const double exact = 1 + std::floor(percentile / 100 * 99999);
+    EXPECT_NEAR(exact, statistic.valueAtPercentile(percentile), exact * 0.01) << percentile;
+  }
+  // The lowest bucket only holds 1.
+  EXPECT_EQ(1, statistic.valueAtPercentile(0));
+
+  const nighthawk::client::Statistic proto =
+      statistic.toProto(Statistic::SerializationDomain::RAW);
+  EXPECT_EQ(24, proto.percentiles_size());
+  uint64_t previous_count = 0;
+  for (const nighthawk::client::Percentile& percentile : proto.percentiles()) {
+    EXPECT_GE(percentile.count(), previous_count);
+    const double exact = 1 + std::floor(percentile.percentile() * 99999);
+    EXPECT_NEAR(exact, percentile.raw_value(), exact * 0.01);
+    previous_count = percentile.count();
+  }
+  EXPECT_EQ(100000, previous_count);
+}
+
+TEST(StatisticTest, DDSketchStatisticZeroValues) {
+  DDSketchStatistic statistic;
+  statistic.addValue(0);
+  statistic.addValue(0);
+  statistic.addValue(1000);
+  EXPECT_EQ(0, statistic.valueAtPercentile(50));
+  EXPECT_NEAR(1000, statistic.valueAtPercentile(100), 10);
+}
+
+TEST(StatisticTest, DDSketchStatisticCombine) {
+  DDSketchStatistic a;
+  DDSketchStatistic b;
+  DDSketchStatistic all;
+  // b spans many more buckets than a.
+  for (uint64_t i = 1; i <= 1000; i++) {
+    a.addValue(i);
+    b.addValue(i * 1000);
+    all.addValue(i);
+    all.addValue(i * 1000);
+  }
+  const StatisticPtr combined = a.combine(b);
+  const auto& sketch = dynamic_cast<const DDSketchStatistic&>(*combined);
+  EXPECT_EQ(all.count(), sketch.count());
+  EXPECT_EQ(all.min(), sketch.min());
+  EXPECT_EQ(all.max(), sketch.max());
+  EXPECT_NEAR(all.mean(), sketch.mean(), all.mean() * 1e-9);
+  EXPECT_NEAR(all.pstdev(), sketch.pstdev(), all.pstdev() * 1e-9);
+  for (const double percentile : {10.0, 50.0, 75.0, 99.0}) {
+    EXPECT_EQ(all.valueAtPercentile(percentile), sketch.valueAtPercentile(percentile))
+        << percentile;
+  }
+}
+
 TEST(StatisticTest, CombineAcrossTypesFails) {
   HdrStatistic a;
   InMemoryStatistic b;
@@ -394,6 +457,9 @@ TEST(StatisticTest, CombineAcrossTypesFails) {
   EXPECT_THROW(c.combine(b), std::bad_cast);
   EXPECT_THROW(c.combine(d), std::bad_cast);
   EXPECT_THROW(d.combine(a), std::bad_cast);
+  DDSketchStatistic e;
+  EXPECT_THROW(e.combine(c), std::bad_cast);
+  EXPECT_THROW(c.combine(e), std::bad_cast);
 }
 
 TEST(StatisticTest, HdrStatisticOutOfRange) {
@@ -402,6 +468,302 @@ TEST(StatisticTest, HdrStatisticOutOfRange) {
   EXPECT_EQ(0, a.count());
 }
 
+TEST(StatisticTest, HdrStatisticAllocatesHistogramOnFirstValue) {
+  HdrStatistic statistic;
+  EXPECT_FALSE(statistic.histogramAllocated());
+  EXPECT_EQ(0, statistic.count());
+  EXPECT_TRUE(std::isnan(statistic.mean()));
+  EXPECT_EQ(UINT64_MAX, statistic.min());
+  EXPECT_FALSE(statistic.histogramAllocated());
+  statistic.addValue(1);
+  EXPECT_TRUE(statistic.histogramAllocated());
+}
+
+TEST(StatisticTest, HdrStatisticSparseValuesMatchDense) {
+  HdrStatisticConfig sparse_config;
+  sparse_config.sparse_capacity = 100;
+  HdrStatistic sparse(sparse_config);
+  HdrStatistic dense;
+  for (uint64_t value = 1234; value < 100 * 1234; value += 1234) {
+    sparse.addValue(value);
+    dense.addValue(value);
+  }
+  EXPECT_FALSE(sparse.histogramAllocated());
+  EXPECT_EQ(dense.count(), sparse.count());
+  EXPECT_DOUBLE_EQ(dense.mean(), sparse.mean());
+  EXPECT_DOUBLE_EQ(dense.pstdev(), sparse.pstdev());
+  EXPECT_EQ(dense.min(), sparse.min());
+  EXPECT_EQ(dense.max(), sparse.max());
+  EXPECT_EQ(dense.valueAtPercentile(99), sparse.valueAtPercentile(99));
+  EXPECT_THAT(sparse.toProto(Statistic::SerializationDomain::RAW),
+              Envoy::ProtoEq(dense.toProto(Statistic::SerializationDomain::RAW)));
+  absl::StatusOr<std::unique_ptr<std::istream>> sparse_encoding = sparse.serializeNative();
+  absl::StatusOr<std::unique_ptr<std::istream>> dense_encoding = dense.serializeNative();
+  ASSERT_TRUE(sparse_encoding.ok());
+  ASSERT_TRUE(dense_encoding.ok());
+  HdrStatistic decoded;
+  ASSERT_TRUE(decoded.deserializeNative(**sparse_encoding).ok());
+  EXPECT_EQ(dense.count(), decoded.count());
+  EXPECT_EQ(dense.valueAtPercentile(50), decoded.valueAtPercentile(50));
+
+  // Exceeding the capacity moves the values into a histogram.
+  sparse.addValue(1);
+  EXPECT_TRUE(sparse.histogramAllocated());
+  dense.addValue(1);
+  EXPECT_EQ(dense.count(), sparse.count());
+  EXPECT_EQ(1, sparse.min());
+  EXPECT_EQ(dense.max(), sparse.max());
+}
+
+TEST(StatisticTest, HdrStatisticSparseSummaryUsesBucketEquivalentValues) {
+  // A single significant digit puts neighbouring values into the same bucket.
+  HdrStatisticConfig dense_config;
+  dense_config.significant_digits = 1;
+  HdrStatisticConfig sparse_config = dense_config;
+  sparse_config.sparse_capacity = 10;
+  HdrStatistic sparse(sparse_config);
+  HdrStatistic dense(dense_config);
+  for (const uint64_t value : {1000, 1001, 1500, 3000, 3000, 70000}) {
+    sparse.addValue(value);
+    dense.addValue(value);
+  }
+  EXPECT_FALSE(sparse.histogramAllocated());
+  EXPECT_DOUBLE_EQ(dense.mean(), sparse.mean());
+  EXPECT_DOUBLE_EQ(dense.pstdev(), sparse.pstdev());
+  EXPECT_DOUBLE_EQ(dense.pvariance(), sparse.pvariance());
+  EXPECT_EQ(dense.min(), sparse.min());
+  EXPECT_EQ(dense.max(), sparse.max());
+  EXPECT_NE(70000, sparse.max());
+  EXPECT_THAT(sparse.toProto(Statistic::SerializationDomain::RAW),
+              Envoy::ProtoEq(dense.toProto(Statistic::SerializationDomain::RAW)));
+  EXPECT_FALSE(sparse.histogramAllocated());
+}
+
+TEST(StatisticTest, HdrStatisticCombineKeepsSparseValuesWithinCapacity) {
+  HdrStatisticConfig config;
+  config.sparse_capacity = 3;
+  HdrStatistic a(config);
+  HdrStatistic b(config);
+  a.addValue(1);
+  b.addValue(2);
+  b.addValue(3);
+  StatisticPtr combined = a.combine(b);
+  const auto& sparse = dynamic_cast<const HdrStatistic&>(*combined);
+  EXPECT_FALSE(sparse.histogramAllocated());
+  EXPECT_EQ(3, sparse.count());
+  EXPECT_EQ(1, sparse.min());
+  EXPECT_EQ(3, sparse.max());
+
+  // Over capacity, or combined with an allocated histogram, the result is allocated.
+  StatisticPtr twice = sparse.combine(b);
+  EXPECT_TRUE(dynamic_cast<const HdrStatistic&>(*twice).histogramAllocated());
+  EXPECT_EQ(5, twice->count());
+  HdrStatistic dense;
+  dense.addValue(4);
+  StatisticPtr mixed = dense.combine(sparse);
+  EXPECT_TRUE(dynamic_cast<const HdrStatistic&>(*mixed).histogramAllocated());
+  EXPECT_EQ(4, mixed->count());
+  EXPECT_EQ(1, mixed->min());
+  EXPECT_EQ(4, mixed->max());
+}
+
+TEST(StatisticTest, HdrStatisticConfiguredRangeAndPrecision) {
+  HdrStatisticConfig config;
+  config.highest_trackable_value = 1000;
+  config.significant_digits = 1;
+  HdrStatistic statistic(config);
+  EXPECT_EQ(1, statistic.significantDigits());
+  statistic.addValue(1000);
+  statistic.addValue(1001);
+  EXPECT_EQ(1, statistic.count());
+  EXPECT_EQ(1, statistic.droppedCount());
+  // A single significant digit lumps 1000 in with its neighbours.
+  EXPECT_NE(1000, statistic.max());
+
+  // Combining takes the wider range, and carries over dropped counts.
+  HdrStatistic wide;
+  wide.addValue(1001);
+  StatisticPtr combined = statistic.combine(wide);
+  EXPECT_EQ(2, combined->count());
+  EXPECT_EQ(1, dynamic_cast<const HdrStatistic&>(*combined).droppedCount());
+  EXPECT_EQ(1, combined->toProto(Statistic::SerializationDomain::RAW).dropped_count());
+
+  // Decoding adopts the range and precision of the encoding.
+  absl::StatusOr<std::unique_ptr<std::istream>> encoding = statistic.serializeNative();
+  ASSERT_TRUE(encoding.ok());
+  HdrStatistic decoded;
+  ASSERT_TRUE(decoded.deserializeNative(**encoding).ok());
+  EXPECT_EQ(1, decoded.significantDigits());
+  EXPECT_EQ(1, decoded.createNewInstanceOfSameType()->significantDigits());
+}
+
+TEST(StatisticTest, HdrIntervalRecorderAllocatesOnFirstValue) {
+  HdrStatisticConfig config;
+  config.significant_digits = 2;
+  HdrIntervalRecorder recorder(config);
+  const uint32_t first_reader = recorder.addReader();
+  const uint32_t second_reader = recorder.addReader();
+  HdrStatistic interval;
+  recorder.sampleInto(interval, first_reader);
+  EXPECT_EQ(0, interval.count());
+  EXPECT_FALSE(interval.histogramAllocated());
+  EXPECT_TRUE(recorder.recordValue(10));
+  recorder.sampleInto(interval, first_reader);
+  EXPECT_EQ(1, interval.count());
+  EXPECT_EQ(2, recorder.config().significant_digits);
+  HdrStatistic other_interval;
+  recorder.sampleInto(other_interval, second_reader);
+  EXPECT_EQ(1, other_interval.count());
+}
+
+TEST(StatisticTest, HdrStatisticIntervalRecording) {
+  HdrStatistic statistic;
+  EXPECT_EQ(nullptr, statistic.intervalRecorder());
+  statistic.enableIntervalRecording();
+  HdrIntervalRecorderSharedPtr recorder = statistic.intervalRecorder();
+  ASSERT_NE(nullptr, recorder);
+  const uint32_t reader = recorder->addReader();
+  statistic.addValue(100);
+  statistic.addValue(200);
+  // Out of range values are dropped by the interval recorder as well.
+  statistic.addValue(INT64_MAX);
+
+  HdrStatistic first_interval;
+  recorder->sampleInto(first_interval, reader);
+  EXPECT_EQ(2, first_interval.count());
+  EXPECT_EQ(100, first_interval.min());
+  EXPECT_EQ(200, first_interval.valueAtPercentile(100));
+
+  // Each sample only holds the values added since the previous one, while the statistic itself
+  // keeps all of them.
+  statistic.addValue(300);
+  HdrStatistic second_interval;
+  recorder->sampleInto(second_interval, reader);
+  EXPECT_EQ(1, second_interval.count());
+  EXPECT_EQ(300, second_interval.min());
+  EXPECT_EQ(3, statistic.count());
+
+  HdrStatistic empty_interval;
+  recorder->sampleInto(empty_interval, reader);
+  EXPECT_EQ(0, empty_interval.count());
+}
+
+TEST(StatisticTest, HdrIntervalRecorderSamplesConcurrentlyWithRecording) {
+  constexpr uint64_t kValueCount = 100000;
+  HdrIntervalRecorder recorder;
+  const uint32_t reader = recorder.addReader();
+  HdrStatistic sampled;
+  std::atomic<bool> done{false};
+  std::thread writer([&recorder, &done]() {
+    for (uint64_t i = 1; i <= kValueCount; i++) {
+      EXPECT_TRUE(recorder.recordValue(i));
+    }
+    done = true;
+  });
+  while (!done) {
+    recorder.sampleInto(sampled, reader);
+  }
+  writer.join();
+  recorder.sampleInto(sampled, reader);
+  // Every value ends up in exactly one interval.
+  EXPECT_EQ(kValueCount, sampled.count());
+  EXPECT_EQ(1, sampled.min());
+}
+
+TEST(StatisticTest, HdrIntervalRecorderReadersSeeEveryValue) {
+  HdrIntervalRecorder recorder;
+  const uint32_t first_reader = recorder.addReader();
+  const uint32_t second_reader = recorder.addReader();
+  EXPECT_NE(first_reader, second_reader);
+  EXPECT_TRUE(recorder.recordValue(100));
+  HdrStatistic first_interval;
+  recorder.sampleInto(first_interval, first_reader);
+  EXPECT_EQ(1, first_interval.count());
+
+  // Values sampled by one reader are kept for the other.
+  EXPECT_TRUE(recorder.recordValue(200));
+  HdrStatistic second_interval;
+  recorder.sampleInto(second_interval, second_reader);
+  EXPECT_EQ(2, second_interval.count());
+  EXPECT_EQ(100, second_interval.min());
+  EXPECT_EQ(200, second_interval.valueAtPercentile(100));
+
+  HdrStatistic third_interval;
+  recorder.sampleInto(third_interval, first_reader);
+  EXPECT_EQ(1, third_interval.count());
+  EXPECT_EQ(200, third_interval.min());
+  HdrStatistic empty_interval;
+  recorder.sampleInto(empty_interval, second_reader);
+  EXPECT_EQ(0, empty_interval.count());
+}
+
+TEST(StatisticTest, HdrIntervalSamplerMergesRecordersById) {
+  HdrIntervalSampler sampler;
+  auto first_recorder = std::make_shared<HdrIntervalRecorder>();
+  auto second_recorder = std::make_shared<HdrIntervalRecorder>();
+  auto other_recorder = std::make_shared<HdrIntervalRecorder>();
+  sampler.addRecorder("b", first_recorder);
+  sampler.addRecorder("b", second_recorder);
+  sampler.addRecorder("a", other_recorder);
+  EXPECT_TRUE(first_recorder->recordValue(1));
+  EXPECT_TRUE(second_recorder->recordValue(2));
+  EXPECT_TRUE(other_recorder->recordValue(3));
+
+  std::vector<std::unique_ptr<HdrStatistic>> intervals = sampler.sample();
+  ASSERT_EQ(2, intervals.size());
+  EXPECT_EQ("a", intervals[0]->id());
+  EXPECT_EQ(1, intervals[0]->count());
+  EXPECT_EQ("b", intervals[1]->id());
+  EXPECT_EQ(2, intervals[1]->count());
+  intervals = sampler.sample();
+  ASSERT_EQ(2, intervals.size());
+  EXPECT_EQ(0, intervals[0]->count());
+  EXPECT_EQ(0, intervals[1]->count());
+}
+
+TEST(StatisticTest, HdrStatisticFromProtoRoundTripsNativeEncoding) {
+  HdrStatistic statistic;
+  statistic.setId("foo");
+  for (uint64_t value = 1000; value <= 100000; value += 1000) {
+    statistic.addValue(value);
+  }
+  statistic.addValue(INT64_MAX);
+  nighthawk::client::Statistic proto =
+      statistic.toProto(Statistic::SerializationDomain::DURATION);
+  EXPECT_EQ(1, proto.dropped_count());
+  const auto encoding = statistic.serializeNative();
+  ASSERT_TRUE(encoding.ok());
+  proto.set_hdr_histogram(
+      std::string(std::istreambuf_iterator<char>(**encoding), std::istreambuf_iterator<char>()));
+
+  absl::StatusOr<std::unique_ptr<HdrStatistic>> decoded = HdrStatistic::fromProto(proto);
+  ASSERT_TRUE(decoded.ok()) << decoded.status();
+  EXPECT_EQ("foo", (*decoded)->id());
+  EXPECT_EQ(statistic.count(), (*decoded)->count());
+  EXPECT_EQ(1, (*decoded)->droppedCount());
+  EXPECT_EQ(statistic.valueAtPercentile(99), (*decoded)->valueAtPercentile(99));
+
+  // Percentiles dropped from the proto are rendered back from the encoding.
+  const auto expected_percentiles = proto.percentiles();
+  proto.clear_percentiles();
+  EXPECT_EQ(Statistic::SerializationDomain::DURATION, HdrStatistic::serializationDomain(proto));
+  ASSERT_TRUE(HdrStatistic::renderPercentiles(proto).ok());
+  ASSERT_EQ(expected_percentiles.size(), proto.percentiles_size());
+  for (int i = 0; i < proto.percentiles_size(); i++) {
+    EXPECT_TRUE(Envoy::TestUtility::protoEqual(proto.percentiles(i), expected_percentiles[i]));
+  }
+}
+
+TEST(StatisticTest, HdrStatisticFromProtoRejectsMissingOrBadEncodings) {
+  nighthawk::client::Statistic proto;
+  EXPECT_FALSE(HdrStatistic::fromProto(proto).ok());
+  // Without an encoding there is nothing to render.
+  EXPECT_TRUE(HdrStatistic::renderPercentiles(proto).ok());
+  proto.set_hdr_histogram("not an encoding");
+  EXPECT_FALSE(HdrStatistic::fromProto(proto).ok());
+  EXPECT_FALSE(HdrStatistic::renderPercentiles(proto).ok());
+}
+
 TEST(StatisticTest, NullStatistic) {
   NullStatistic stat;
   EXPECT_EQ(0, stat.count());
@@ -7,6 +7,7 @@
 #include "external/envoy/source/common/stats/isolated_store_impl.h"
 #include "external/envoy/test/mocks/http/mocks.h"
 #include "external/envoy/test/mocks/stream_info/mocks.h"
+#include "external/envoy/test/mocks/upstream/host.h"
 
 #include "source/client/stream_decoder.h"
 #include "source/common/statistic_impl.h"
@@ -29,7 +30,7 @@ public:
         request_headers_(std::make_shared<Envoy::Http::TestRequestHeaderMapImpl>(
             std::initializer_list<std::pair<std::string, std::string>>(
                 {{":method", "GET"}, {":path", "/foo"}}))),
-        request_body_(std::string("")), tracer_(std::make_unique<Envoy::Tracing::NullTracer>()),
+        tracer_(std::make_unique<Envoy::Tracing::NullTracer>()),
         test_header_(std::make_unique<Envoy::Http::TestResponseHeaderMapImpl>(
             std::initializer_list<std::pair<std::string, std::string>>({{":status", "200"}}))),
         test_trailer_(std::make_unique<Envoy::Http::TestResponseTrailerMapImpl>(
@@ -43,6 +44,11 @@ public:
     stream_decoder_export_latency_callbacks_++;
   }
   void handleResponseData(const Envoy::Buffer::Instance&) override { called_data_++; }
+  void onEndpointComplete(const Envoy::Upstream::HostDescription&, uint32_t response_code,
+                          std::optional<uint64_t> latency_ns) override {
+    endpoint_response_codes_.push_back(response_code);
+    endpoint_latencies_.push_back(latency_ns);
+  }
 
   Envoy::Event::TestRealTimeSystem time_system_;
   Envoy::Stats::IsolatedStoreImpl store_;
@@ -54,11 +60,13 @@ public:
   StreamingStatistic response_body_size_statistic_;
   StreamingStatistic origin_latency_statistic_;
   HeaderMapPtr request_headers_;
-  std::string request_body_;
+  RequestBodySharedPtr request_body_;
   uint64_t stream_decoder_completion_callbacks_{0};
   uint64_t pool_failures_{0};
   uint64_t stream_decoder_export_latency_callbacks_{0};
   uint64_t called_data_{0};
+  std::vector<uint32_t> endpoint_response_codes_;
+  std::vector<std::optional<uint64_t>> endpoint_latencies_;
   Envoy::Random::RandomGeneratorImpl random_generator_;
   Envoy::Tracing::TracerSharedPtr tracer_;
   Envoy::Http::ResponseHeaderMapPtr test_header_;
@@ -177,7 +185,7 @@ TEST_F(StreamDecoderTest, EmptyRequestBodyWithNonZeroRequestBodySize) {
   auto decoder = new StreamDecoder(
       *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
       response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
-      request_headers_, "", false, 4, random_generator_, tracer_, "");
+      request_headers_, nullptr, false, 4, random_generator_, tracer_, "");
   Envoy::Http::MockRequestEncoder stream_encoder;
   EXPECT_CALL(stream_encoder, getStream());
   Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
@@ -201,7 +209,8 @@ TEST_F(StreamDecoderTest, NonEmptyRequestBodyIgnoresProvidedRequestBodySize) {
   auto decoder = new StreamDecoder(
       *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
       response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
-      request_headers_, json_body, false, 0, random_generator_, tracer_, "");
+      request_headers_, std::make_shared<const std::string>(json_body), false, 0, random_generator_,
+      tracer_, "");
   Envoy::Http::MockRequestEncoder stream_encoder;
   EXPECT_CALL(stream_encoder, getStream());
   Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
@@ -219,6 +228,31 @@ TEST_F(StreamDecoderTest, NonEmptyRequestBodyIgnoresProvidedRequestBodySize) {
   delete decoder;
 }
 
+TEST_F(StreamDecoderTest, SharedRequestBodyIsNotCopied) {
+  RequestBodySharedPtr body = std::make_shared<const std::string>(R"({"Message": "Hello"})");
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, body, false, 0, random_generator_, tracer_, "");
+  Envoy::Http::MockRequestEncoder stream_encoder;
+  EXPECT_CALL(stream_encoder, getStream());
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  EXPECT_CALL(stream_encoder, encodeHeaders(_, false));
+  EXPECT_CALL(stream_encoder, encodeData(_, true))
+      .WillOnce(Invoke([&body](Envoy::Buffer::Instance& data, bool) {
+        // The buffer references the memory of the shared body, and keeps it alive.
+        EXPECT_EQ(body->data(), data.frontSlice().mem_);
+        EXPECT_EQ(body->size(), data.length());
+        EXPECT_GT(body.use_count(), 2);
+      }));
+  decoder->onPoolReady(stream_encoder, ptr, stream_info,
+                       {} /*std::optional<Envoy::Http::Protocol> protocol*/);
+  decoder->decodeHeaders(std::move(test_header_), true);
+  dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, body.use_count());
+}
+
 TEST_F(StreamDecoderTest, StreamResetTest) {
   bool is_complete = false;
   auto decoder = new StreamDecoder(
@@ -244,6 +278,93 @@ TEST_F(StreamDecoderTest, PoolFailureTest) {
   decoder->onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::Overflow, "fooreason",
                          ptr);
   EXPECT_EQ(1, pool_failures_);
+  // Without a host, there is no endpoint to report on.
+  EXPECT_TRUE(endpoint_response_codes_.empty());
+}
+
+TEST_F(StreamDecoderTest, EndpointCompletionIsReported) {
+  auto decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, request_body_, true, 0, random_generator_, tracer_, "");
+  NiceMock<Envoy::Http::MockRequestEncoder> stream_encoder;
+  Envoy::Upstream::HostDescriptionConstSharedPtr host =
+      std::make_shared<NiceMock<Envoy::Upstream::MockHostDescription>>();
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  decoder->onPoolReady(stream_encoder, host, stream_info,
+                       {} /*std::optional<Envoy::Http::Protocol> protocol*/);
+  decoder->decodeHeaders(std::move(test_header_), true);
+  ASSERT_EQ(endpoint_response_codes_, std::vector<uint32_t>{200});
+  ASSERT_EQ(1, endpoint_latencies_.size());
+  EXPECT_TRUE(endpoint_latencies_[0].has_value());
+
+  decoder = new StreamDecoder(
+      *dispatcher_, time_system_, *this, [](bool, bool) {}, connect_statistic_, latency_statistic_,
+      response_header_size_statistic_, response_body_size_statistic_, origin_latency_statistic_,
+      request_headers_, request_body_, true, 0, random_generator_, tracer_, "");
+  decoder->onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::RemoteConnectionFailure,
+                         "fooreason", host);
+  ASSERT_EQ(endpoint_response_codes_, (std::vector<uint32_t>{200, 0}));
+  EXPECT_FALSE(endpoint_latencies_[1].has_value());
+}
+
+TEST_F(StreamDecoderTest, PooledDecoderIsRecycledOnNextIteration) {
+  StreamDecoderPool pool(*dispatcher_, time_system_, *this, connect_statistic_, latency_statistic_,
+                         response_header_size_statistic_, response_body_size_statistic_,
+                         origin_latency_statistic_, random_generator_, tracer_, "");
+  uint64_t completions = 0;
+  StreamDecoder& decoder = pool.acquire([&completions](bool, bool) { completions++; },
+                                        request_headers_, request_body_, false, 0);
+  EXPECT_EQ(1, pool.allocatedCount());
+  decoder.decodeHeaders(std::move(test_header_), true);
+  EXPECT_EQ(1, completions);
+  // The completed decoder must not be handed out again in the same loop iteration.
+  EXPECT_EQ(0, pool.idleCount());
+  dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, pool.idleCount());
+
+  StreamDecoder& reused = pool.acquire([&completions](bool, bool) { completions++; },
+                                       request_headers_, request_body_, false, 0);
+  EXPECT_EQ(&decoder, &reused);
+  EXPECT_EQ(1, pool.allocatedCount());
+  EXPECT_EQ(0, pool.idleCount());
+  reused.decodeHeaders(
+      std::make_unique<Envoy::Http::TestResponseHeaderMapImpl>(
+          std::initializer_list<std::pair<std::string, std::string>>({{":status", "200"}})),
+      true);
+  EXPECT_EQ(2, completions);
+  EXPECT_EQ(2, stream_decoder_completion_callbacks_);
+}
+
+TEST_F(StreamDecoderTest, PooledDecoderPoolFailureIsRecycled) {
+  StreamDecoderPool pool(*dispatcher_, time_system_, *this, connect_statistic_, latency_statistic_,
+                         response_header_size_statistic_, response_body_size_statistic_,
+                         origin_latency_statistic_, random_generator_, tracer_, "");
+  StreamDecoder& decoder =
+      pool.acquire([](bool, bool) {}, request_headers_, request_body_, false, 0);
+  Envoy::Upstream::HostDescriptionConstSharedPtr ptr;
+  decoder.onPoolFailure(Envoy::Http::ConnectionPool::PoolFailureReason::Overflow, "fooreason",
+                        ptr);
+  EXPECT_EQ(1, pool_failures_);
+  dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, pool.idleCount());
+}
+
+TEST_F(StreamDecoderTest, InFlightPooledDecoderOutlivesPool) {
+  bool is_complete = false;
+  StreamDecoder* decoder;
+  {
+    StreamDecoderPool pool(*dispatcher_, time_system_, *this, connect_statistic_,
+                           latency_statistic_, response_header_size_statistic_,
+                           response_body_size_statistic_, origin_latency_statistic_,
+                           random_generator_, tracer_, "");
+    decoder = &pool.acquire([&is_complete](bool, bool) { is_complete = true; }, request_headers_,
+                            request_body_, false, 0);
+  }
+  // The decoder got detached from the pool, and should delete itself upon completion.
+  decoder->decodeHeaders(std::move(test_header_), true);
+  EXPECT_TRUE(is_complete);
+  dispatcher_->run(Envoy::Event::Dispatcher::RunType::NonBlock);
 }
 
 TEST_F(StreamDecoderTest, StreamResetReasonToResponseFlag) {
@@ -0,0 +1,30 @@
+#include <cstdint>
+#include <vector>
+
+#include "source/common/thread_placement.h"
+
+#include "gtest/gtest.h"
+
+namespace Nighthawk {
+namespace {
+
+TEST(ThreadPlacementTest, ParsesCpuLists) {
+  const absl::StatusOr<std::vector<uint32_t>> cpus = ThreadPlacement::parseCpuList(" 4,0-2,7-7\n");
+  ASSERT_TRUE(cpus.ok()) << cpus.status();
+  EXPECT_EQ(*cpus, (std::vector<uint32_t>{4, 0, 1, 2, 7}));
+}
+
+TEST(ThreadPlacementTest, RejectsMalformedCpuLists) {
+  for (const char* cpu_list : {"", "a", "1,", "-1", "1-", "3-2", "0-1024", "1 2"}) {
+    EXPECT_FALSE(ThreadPlacement::parseCpuList(cpu_list).ok()) << cpu_list;
+  }
+}
+
+TEST(ThreadPlacementTest, RejectsOutOfRangePlacements) {
+  EXPECT_FALSE(ThreadPlacement::pinCurrentThread(ThreadPlacement::MaxCpus).ok());
+  EXPECT_FALSE(
+      ThreadPlacement::preferNumaNodeForCurrentThread(ThreadPlacement::MaxNumaNodes).ok());
+}
+
+} // namespace
+} // namespace Nighthawk
@@ -194,6 +194,22 @@ TEST_F(UtilityTest, MapCountersFromStore) {
   EXPECT_EQ(counters.begin()->second, 2);
 }
 
+TEST_F(UtilityTest, MapCountersFromStoreByWorker) {
+  Envoy::Stats::IsolatedStoreImpl store;
+  store.counterFromString("foo").inc();
+  store.counterFromString("cluster.0.bar").add(2);
+  store.counterFromString("cluster.1.bar").add(3);
+  store.counterFromString("cluster.1.baz").inc();
+  store.counterFromString("cluster.1.zero");
+  const CounterValuesByWorker counters = Utility().mapCountersFromStoreByWorker(
+      store, [](absl::string_view, uint64_t value) { return value > 0; });
+  const std::map<std::string, uint64_t> expected_global{{"foo", 1}, {"bar", 5}, {"baz", 1}};
+  EXPECT_EQ(counters.global, expected_global);
+  const std::map<int, std::map<std::string, uint64_t>> expected_per_worker{
+      {0, {{"bar", 2}}}, {1, {{"bar", 3}, {"baz", 1}}}};
+  EXPECT_EQ(counters.per_worker, expected_per_worker);
+}
+
 TEST_F(UtilityTest, MultipleSemicolons) {
   EXPECT_THROW(UriImpl("HTTP://HTTP://a:111"), UriException);
 }
@@ -57,6 +57,8 @@ TEST_F(WorkerTest, WorkerExecutesOnThread) {
   ASSERT_TRUE(loader.ok());
   worker.start();
   worker.waitForCompletion();
+  // Completion can be waited for repeatedly.
+  EXPECT_TRUE(worker.waitForCompletionFor(std::chrono::milliseconds(0)));
 
   EXPECT_CALL(tls_, shutdownThread());
   ASSERT_TRUE(worker.ran_);